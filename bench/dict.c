@@ -0,0 +1,173 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2026 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains a microbenchmark of ladish_dict
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <stdio.h>
+#include <time.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "../daemon/common.h"
+#include "../daemon/dict.h"
+
+#define KEY_PREFIX "http://ladish.org/ns/canvas/"
+#define BIG_DICT_KEYS 500
+#define PORTS 5000
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+static long heap_used(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  return (long)mallinfo2().uordblks;
+#else
+  return 0;                     /* not available */
+#endif
+}
+
+static ladish_dict_handle g_ports[PORTS];
+
+/* room and studio dicts with many keys, looked up by key */
+static bool bench_big_get(void)
+{
+  ladish_dict_handle dict;
+  static char keys[BIG_DICT_KEYS][64];
+  unsigned int i;
+  unsigned int run;
+  unsigned int lookups;
+  double start;
+
+  if (!ladish_dict_create(&dict))
+  {
+    return false;
+  }
+
+  for (i = 0; i < BIG_DICT_KEYS; i++)
+  {
+    sprintf(keys[i], KEY_PREFIX "%u", i);
+    if (!ladish_dict_set(dict, keys[i], "value"))
+    {
+      return false;
+    }
+  }
+
+  lookups = 0;
+  start = now();
+  for (run = 0; run < 4000; run++)
+  {
+    for (i = 0; i < BIG_DICT_KEYS; i += 7)
+    {
+      if (ladish_dict_get(dict, keys[i]) == NULL)
+      {
+        return false;
+      }
+
+      lookups++;
+    }
+  }
+
+  printf("get on a %u-key dict:           %8.2f ns/op\n", BIG_DICT_KEYS, (now() - start) * 1000000000.0 / lookups);
+
+  ladish_dict_destroy(dict);
+  return true;
+}
+
+/* port dicts, the canvas writes back unchanged positions */
+static bool bench_port_dicts(void)
+{
+  unsigned int i;
+  unsigned int run;
+  long heap;
+  double start;
+
+  heap = heap_used();
+
+  for (i = 0; i < PORTS; i++)
+  {
+    if (!ladish_dict_create(g_ports + i) ||
+        !ladish_dict_set(g_ports[i], KEY_PREFIX "x", "100") ||
+        !ladish_dict_set(g_ports[i], KEY_PREFIX "y", "200") ||
+        !ladish_dict_set(g_ports[i], "http://ladish.org/ns/jack/port_type", "audio"))
+    {
+      return false;
+    }
+  }
+
+  printf("heap used by %u 3-key dicts:     %8ld bytes/dict\n", PORTS, (heap_used() - heap) / PORTS);
+
+  start = now();
+  for (run = 0; run < 200; run++)
+  {
+    for (i = 0; i < PORTS; i++)
+    {
+      if (!ladish_dict_set(g_ports[i], KEY_PREFIX "x", "100"))
+      {
+        return false;
+      }
+    }
+  }
+
+  printf("unchanged-value set on 3-key dicts: %8.2f ns/op\n", (now() - start) * 1000000000.0 / (200 * PORTS));
+
+  start = now();
+  for (run = 0; run < 200; run++)
+  {
+    for (i = 0; i < PORTS; i++)
+    {
+      if (!ladish_dict_set(g_ports[i], KEY_PREFIX "y", run % 2 == 0 ? "201" : "200") ||
+          ladish_dict_get(g_ports[i], KEY_PREFIX "y") == NULL)
+      {
+        return false;
+      }
+    }
+  }
+
+  printf("changing set + get on 3-key dicts:  %8.2f ns/op\n", (now() - start) * 1000000000.0 / (200 * PORTS));
+
+  for (i = 0; i < PORTS; i++)
+  {
+    ladish_dict_destroy(g_ports[i]);
+  }
+
+  return true;
+}
+
+int main(void)
+{
+  if (!bench_big_get() || !bench_port_dicts())
+  {
+    fprintf(stderr, "dict operation failed\n");
+    return 1;
+  }
+
+  return 0;
+}
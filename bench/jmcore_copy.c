@@ -0,0 +1,172 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2026 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains a microbenchmark of the jmcore audio copy kernel
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <float.h>
+
+#include "../jmcore_copy.h"
+
+#define PAIRS 64
+#define SAMPLES_PER_RUN (64 * 1024 * 1024)
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define UNIT "cycles"
+static uint64_t now(void) { return __rdtsc(); }
+#else
+#define UNIT "ns"
+static uint64_t now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+#endif
+
+static float * g_inputs[PAIRS];
+static float * g_outputs[PAIRS];
+
+/* what a process cycle costs per pair, for the copy kernel and for plain memcpy (jmcore before batching) */
+static void run(jack_nframes_t nframes, float gain, bool flush_denormals)
+{
+  unsigned int cycles;
+  unsigned int cycle;
+  unsigned int pair;
+  uint64_t start;
+  uint64_t copy;
+  uint64_t baseline;
+
+  cycles = SAMPLES_PER_RUN / (nframes * PAIRS);
+
+  start = now();
+  for (cycle = 0; cycle < cycles; cycle++)
+  {
+    for (pair = 0; pair < PAIRS; pair++)
+    {
+      forward_audio(g_outputs[pair], g_inputs[pair], nframes, gain, flush_denormals);
+      __asm__ __volatile__("" : : "r"(g_outputs[pair]) : "memory");
+    }
+  }
+  copy = now() - start;
+
+  start = now();
+  for (cycle = 0; cycle < cycles; cycle++)
+  {
+    for (pair = 0; pair < PAIRS; pair++)
+    {
+      memcpy(g_outputs[pair], g_inputs[pair], nframes * sizeof(float));
+      __asm__ __volatile__("" : : "r"(g_outputs[pair]) : "memory");
+    }
+  }
+  baseline = now() - start;
+
+  printf(
+    "%4u frames, gain %.1f%s: %8.1f %s/pair (memcpy %8.1f)\n",
+    (unsigned int)nframes,
+    gain,
+    flush_denormals ? ", flush" : "       ",
+    (double)copy / ((double)cycles * PAIRS),
+    UNIT,
+    (double)baseline / ((double)cycles * PAIRS));
+}
+
+static float magnitude(float value)
+{
+  return value < 0.0f ? -value : value;
+}
+
+/* the kernel must match the straightforward scalar code */
+static int check(float gain)
+{
+  unsigned int i;
+  float expected;
+
+  copy_audio(g_outputs[0], g_inputs[0], 255, gain);
+
+  for (i = 0; i < 255; i++)
+  {
+    expected = magnitude(g_inputs[0][i]) < FLT_MIN ? 0.0f : g_inputs[0][i] * gain;
+    if (magnitude(expected) < FLT_MIN)
+    {
+      expected = 0.0f;
+    }
+
+    if (g_outputs[0][i] != expected)
+    {
+      fprintf(stderr, "sample %u: %g * %g gives %g instead of %g\n", i, g_inputs[0][i], gain, g_outputs[0][i], expected);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+int main(void)
+{
+  static const jack_nframes_t sizes[] = {32, 64, 128, 256};
+  unsigned int pair;
+  unsigned int i;
+
+  srand(1);
+
+  for (pair = 0; pair < PAIRS; pair++)
+  {
+    g_inputs[pair] = malloc(256 * sizeof(float));
+    g_outputs[pair] = malloc(256 * sizeof(float));
+    if (g_inputs[pair] == NULL || g_outputs[pair] == NULL)
+    {
+      fprintf(stderr, "malloc() failed\n");
+      return 1;
+    }
+
+    /* one sample in 16 is a denormal, like a decaying reverb tail */
+    for (i = 0; i < 256; i++)
+    {
+      g_inputs[pair][i] = i % 16 == 0 ? 1e-40f : (float)rand() / RAND_MAX - 0.5f;
+    }
+  }
+
+  /* normal samples that become denormals with gain */
+  g_inputs[0][1] = FLT_MIN * 1.5f;
+  g_inputs[0][254] = -FLT_MIN * 1.5f;
+
+  if (check(1.0) != 0 || check(0.5) != 0)
+  {
+    return 1;
+  }
+
+  for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+  {
+    run(sizes[i], 1.0, false);
+    run(sizes[i], 1.0, true);
+    run(sizes[i], 0.5, false);
+  }
+
+  return 0;
+}
@@ -0,0 +1,220 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2026 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains a benchmark of saving a synthetic 5000-port studio
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../daemon/common.h"
+#include "../daemon/graph.h"
+#include "../daemon/app_supervisor.h"
+#include "../daemon/save.h"
+#include "../daemon/studio_internal.h"
+#include "../daemon/reactor.h"
+#include "../dbus_constants.h"
+
+#define CLIENTS 250
+#define PORTS_PER_CLIENT 20     /* half inputs, half outputs: 5000 ports */
+#define RUNS 20
+
+/* normally provided by main.c */
+bool g_quit;
+const char * g_dbus_unique_name;
+cdbus_object_path g_control_object;
+char * g_base_dir;
+
+static ladish_port_handle g_ports[CLIENTS][PORTS_PER_CLIENT];
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+/* the studio graph shares the ports with the JACK graph, the way virtualizer sets them up */
+static bool populate(ladish_graph_handle jgraph, ladish_graph_handle vgraph)
+{
+  ladish_client_handle jclient;
+  ladish_client_handle vclient;
+  unsigned int i;
+  unsigned int j;
+  char name[64];
+  uint32_t flags;
+
+  for (i = 0; i < CLIENTS; i++)
+  {
+    if (!ladish_client_create(NULL, &jclient) ||
+        !ladish_client_create(NULL, &vclient))
+    {
+      return false;
+    }
+
+    ladish_client_set_vgraph(jclient, vgraph);
+
+    sprintf(name, "client %u", i);
+    if (!ladish_graph_add_client(jgraph, jclient, name, false) ||
+        !ladish_graph_add_client(vgraph, vclient, name, false))
+    {
+      return false;
+    }
+
+    for (j = 0; j < PORTS_PER_CLIENT; j++)
+    {
+      if (!ladish_port_create(NULL, false, &g_ports[i][j]))
+      {
+        return false;
+      }
+
+      ladish_port_set_vgraph(g_ports[i][j], vgraph);
+
+      flags = j % 2 == 0 ? JACKDBUS_PORT_FLAG_OUTPUT : JACKDBUS_PORT_FLAG_INPUT;
+      sprintf(name, "%s_%u", j % 2 == 0 ? "out" : "in", j / 2 + 1);
+      if (!ladish_graph_add_port(jgraph, jclient, g_ports[i][j], name, JACKDBUS_PORT_TYPE_AUDIO, flags, false) ||
+          !ladish_graph_add_port(vgraph, vclient, g_ports[i][j], name, JACKDBUS_PORT_TYPE_AUDIO, flags, false))
+      {
+        return false;
+      }
+    }
+  }
+
+  /* chain the clients: every output feeds the matching input of the next client */
+  for (i = 0; i + 1 < CLIENTS; i++)
+  {
+    for (j = 0; j < PORTS_PER_CLIENT; j += 2)
+    {
+      if (!ladish_graph_add_connection(jgraph, g_ports[i][j], g_ports[i + 1][j + 1], false) ||
+          !ladish_graph_add_connection(vgraph, g_ports[i][j], g_ports[i + 1][j + 1], false))
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool save(const char * path, ladish_graph_handle jgraph, ladish_graph_handle vgraph, ladish_app_supervisor_handle supervisor, bool sync)
+{
+  int fd;
+
+  if (!ladish_write_open(path, &fd))
+  {
+    return false;
+  }
+
+  if (!ladish_write_string(fd, "<?xml version=\"1.0\"?>\n<studio>\n  <jack>\n") ||
+      !ladish_write_jgraph(fd, 2, jgraph, supervisor) ||
+      !ladish_write_string(fd, "  </jack>\n") ||
+      !ladish_write_vgraph(fd, 1, vgraph, supervisor) ||
+      !ladish_write_string(fd, "</studio>\n"))
+  {
+    ladish_write_close(fd, false, false);
+    return false;
+  }
+
+  return ladish_write_close(fd, true, sync);
+}
+
+int main(int argc, char ** argv)
+{
+  const char * path;
+  ladish_graph_handle jgraph;
+  ladish_graph_handle vgraph;
+  ladish_app_supervisor_handle supervisor;
+  struct stat st;
+  unsigned int run;
+  double start;
+  double best;
+  double elapsed;
+  bool sync;
+
+  path = argc > 1 ? argv[1] : "/tmp/ladish_bench_studio.xml";
+
+  /* app supervisor uses the reactor for autorun */
+  if (!ladish_reactor_init())
+  {
+    return 1;
+  }
+
+  if (!ladish_graph_create(&jgraph, NULL) ||
+      !ladish_graph_create(&vgraph, NULL) ||
+      !ladish_app_supervisor_create(&supervisor, "/bench", "bench", NULL, NULL, NULL) ||
+      !populate(jgraph, vgraph))
+  {
+    fprintf(stderr, "failed to create the synthetic studio\n");
+    return 1;
+  }
+
+  /* the jack graph is written from the studio object */
+  g_studio.jack_graph = jgraph;
+
+  printf("%u clients, %u ports, %u connections\n", CLIENTS, CLIENTS * PORTS_PER_CLIENT, (CLIENTS - 1) * PORTS_PER_CLIENT / 2);
+
+  for (sync = false; ; sync = true)
+  {
+    best = 0.0;
+    for (run = 0; run < RUNS; run++)
+    {
+      start = now();
+      if (!save(path, jgraph, vgraph, supervisor, sync))
+      {
+        fprintf(stderr, "save to %s failed\n", path);
+        return 1;
+      }
+
+      elapsed = now() - start;
+      if (run == 0 || elapsed < best)
+      {
+        best = elapsed;
+      }
+    }
+
+    printf("save %s fdatasync: %8.3f ms (best of %u)\n", sync ? "with   " : "without", best * 1000.0, RUNS);
+
+    if (sync)
+    {
+      break;
+    }
+  }
+
+  if (stat(path, &st) == 0)
+  {
+    printf("studio file size: %lld bytes\n", (long long)st.st_size);
+  }
+
+  unlink(path);
+
+  g_studio.jack_graph = NULL;
+  ladish_graph_destroy(vgraph);
+  ladish_graph_destroy(jgraph);
+  ladish_app_supervisor_destroy(supervisor);
+  ladish_reactor_uninit();
+
+  return 0;
+}
@@ -569,6 +569,7 @@ fail:
 
 struct cdbus_async_call_context
 {
+  DBusPendingCall * pending_call_ptr;
   void * context;
   void (* callback)(void * context, void * cookie, DBusMessage * reply_ptr);
   dbus_uint64_t cookie[0];
@@ -579,17 +580,29 @@ struct cdbus_async_call_context
 static void cdbus_async_call_reply_handler(DBusPendingCall * pending_call_ptr, void * user_data)
 {
 	DBusMessage * reply_ptr;
+  void (* callback)(void * context, void * cookie, DBusMessage * reply_ptr);
 
   reply_ptr = dbus_pending_call_steal_reply(pending_call_ptr);
   if (reply_ptr == NULL)
   {
     log_error("pending call notify called but reply is NULL");
   }
-  else
+
+  /* The call handle is not valid anymore once the callback is called,
+     mark that callback is already called and release the reference held by the handle.
+     The connection keeps the pending call alive until the notify returns. */
+  callback = ctx_ptr->callback;
+  ctx_ptr->callback = NULL;
+  if (ctx_ptr->pending_call_ptr != NULL)
   {
-    ctx_ptr->callback(ctx_ptr->context, ctx_ptr->cookie, reply_ptr);
-    ctx_ptr->callback = NULL;   /* mark that callback is already called */
+    dbus_pending_call_unref(ctx_ptr->pending_call_ptr);
+    ctx_ptr->pending_call_ptr = NULL;
+  }
 
+  callback(ctx_ptr->context, ctx_ptr->cookie, reply_ptr);
+
+  if (reply_ptr != NULL)
+  {
     dbus_message_unref(reply_ptr);
   }
 }
@@ -607,12 +620,14 @@ static void cdbus_async_call_reply_context_free(void * user_data)
 #undef ctx_ptr
 
 bool
-cdbus_call_async(
+cdbus_call_async_start(
+  unsigned int timeout,
   DBusMessage * request_ptr,
   void * context,
   void * cookie,
   size_t cookie_size,
-  void (* callback)(void * context, void * cookie, DBusMessage * reply_ptr))
+  void (* callback)(void * context, void * cookie, DBusMessage * reply_ptr),
+  cdbus_pending_call_handle * call_ptr)
 {
   bool ret;
   DBusPendingCall * pending_call_ptr;
@@ -620,7 +635,16 @@ cdbus_call_async(
 
   ret = false;
 
-  if (!dbus_connection_send_with_reply(cdbus_g_dbus_connection, request_ptr, &pending_call_ptr, DBUS_TIMEOUT_INFINITE))
+  if (timeout == 0)
+  {
+    timeout = DBUS_CALL_DEFAULT_TIMEOUT;
+  }
+
+  if (!dbus_connection_send_with_reply(
+        cdbus_g_dbus_connection,
+        request_ptr,
+        &pending_call_ptr,
+        timeout == CDBUS_CALL_NO_TIMEOUT ? DBUS_TIMEOUT_INFINITE : (int)timeout))
   {
     log_error("dbus_connection_send_with_reply() failed.");
     goto exit;
@@ -636,30 +660,122 @@ cdbus_call_async(
   if (ctx_ptr == NULL)
   {
     log_error("malloc() failed to allocate cdbus_async_call_context struct with cookie size of %zu", cookie_size);
-    goto unref;
+    goto cancel;
   }
 
+  ctx_ptr->pending_call_ptr = call_ptr != NULL ? pending_call_ptr : NULL;
   ctx_ptr->context = context;
   ctx_ptr->callback = callback;
   memcpy(ctx_ptr->cookie, cookie, cookie_size);
 
-  ret = dbus_pending_call_set_notify(pending_call_ptr, cdbus_async_call_reply_handler, ctx_ptr, cdbus_async_call_reply_context_free);
-  if (!ret)
+  if (!dbus_pending_call_set_notify(pending_call_ptr, cdbus_async_call_reply_handler, ctx_ptr, cdbus_async_call_reply_context_free))
   {
     log_error("dbus_pending_call_set_notify() failed.");
-    goto free;
+    free(ctx_ptr);
+    goto cancel;
+  }
+
+  if (call_ptr != NULL)
+  {
+    /* the pending call reference is kept by the handle */
+    *call_ptr = (cdbus_pending_call_handle)ctx_ptr;
+    ret = true;
+    goto exit;
   }
 
+  ret = true;
   goto unref;
 
-free:
-  free(ctx_ptr);
+cancel:
+  dbus_pending_call_cancel(pending_call_ptr);
 unref:
   dbus_pending_call_unref(pending_call_ptr);
 exit:
   return ret;
 }
 
+bool
+cdbus_call_async(
+  DBusMessage * request_ptr,
+  void * context,
+  void * cookie,
+  size_t cookie_size,
+  void (* callback)(void * context, void * cookie, DBusMessage * reply_ptr))
+{
+  return cdbus_call_async_start(CDBUS_CALL_NO_TIMEOUT, request_ptr, context, cookie, cookie_size, callback, NULL);
+}
+
+#define ctx_ptr ((struct cdbus_async_call_context *)call)
+
+void cdbus_call_async_cancel(cdbus_pending_call_handle call)
+{
+  DBusPendingCall * pending_call_ptr;
+
+  pending_call_ptr = ctx_ptr->pending_call_ptr;
+  ASSERT(pending_call_ptr != NULL);
+
+  /* the callback must not be called for cancelled calls */
+  ctx_ptr->callback = NULL;
+  ctx_ptr->pending_call_ptr = NULL;
+
+  /* releasing the last reference frees the context */
+  dbus_pending_call_cancel(pending_call_ptr);
+  dbus_pending_call_unref(pending_call_ptr);
+}
+
+#undef ctx_ptr
+
+bool
+cdbus_call_async_get_reply_args(
+  DBusMessage * reply_ptr,
+  const char * method,
+  const char * output_signature,
+  ...)
+{
+  DBusMessageIter iter;
+  const char * reply_signature;
+  va_list ap;
+  void * parameter_ptr;
+
+  if (reply_ptr == NULL)
+  {
+    log_error("%s() reply not received", method);
+    return false;
+  }
+
+  if (dbus_message_get_type(reply_ptr) == DBUS_MESSAGE_TYPE_ERROR)
+  {
+    dbus_set_error_from_message(&cdbus_g_dbus_error, reply_ptr);
+    cdbus_call_last_error_set();
+    log_error("%s() failed: %s", method, cdbus_call_last_error_get_message());
+    dbus_error_free(&cdbus_g_dbus_error);
+    return false;
+  }
+
+  reply_signature = dbus_message_get_signature(reply_ptr);
+  if (strcmp(reply_signature, output_signature) != 0)
+  {
+    log_error("%s() reply signature is '%s' but expected signature is '%s'", method, reply_signature, output_signature);
+    return false;
+  }
+
+  va_start(ap, output_signature);
+
+  dbus_message_iter_init(reply_ptr, &iter);
+
+  while (*output_signature++ != '\0')
+  {
+    ASSERT(dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_INVALID); /* we've checked the signature, this should not happen */
+    parameter_ptr = va_arg(ap, void *);
+    dbus_message_iter_get_basic(&iter, parameter_ptr);
+    dbus_message_iter_next(&iter);
+  }
+
+  va_end(ap);
+
+  return true;
+}
+
 static
 const char *
 cdbus_compose_signal_match(
@@ -58,6 +58,31 @@ cdbus_call(
   const char * input_signature,
   ...);
 
+typedef struct cdbus_pending_call_tag { int unused; } * cdbus_pending_call_handle;
+
+#define CDBUS_CALL_NO_TIMEOUT ((unsigned int)-1)
+
+/* Send the request without waiting for the reply.
+ *
+ * The callback is called exactly once, unless the call is cancelled.
+ * reply_ptr is the method return or an error message (including the
+ * NoReply error generated when the timeout expires). reply_ptr is NULL
+ * when the reply could not be received at all.
+ *
+ * timeout is in milliseconds, zero means the default timeout.
+ * If call_ptr is not NULL, the returned handle can be used to cancel
+ * the call and stays valid until the callback is called or the call is cancelled. */
+bool
+cdbus_call_async_start(
+  unsigned int timeout,
+  DBusMessage * request_ptr,
+  void * context,
+  void * cookie,
+  size_t cookie_size,
+  void (* callback)(void * context, void * cookie, DBusMessage * reply_ptr),
+  cdbus_pending_call_handle * call_ptr);
+
+/* Same as cdbus_call_async_start() without timeout and handle */
 bool
 cdbus_call_async(
   DBusMessage * request_ptr,
@@ -66,6 +91,18 @@ cdbus_call_async(
   size_t cookie_size,
   void (* callback)(void * context, void * cookie, DBusMessage * reply_ptr));
 
+/* Drop the pending call, the callback will not be called */
+void cdbus_call_async_cancel(cdbus_pending_call_handle call);
+
+/* To be used in async call callbacks, handles NULL and error replies.
+ * output_signature is string of basic types, one pointer argument is expected for each. */
+bool
+cdbus_call_async_get_reply_args(
+  DBusMessage * reply_ptr,
+  const char * method,
+  const char * output_signature,
+  ...);
+
 DBusMessage *
 cdbus_new_method_call_message(
   const char * service,
@@ -159,7 +159,7 @@ void cdbus_method_return_send(struct cdbus_method_call * call_ptr)
       log_error("Ran out of memory trying to queue "
                  "method return");
     else
-      dbus_connection_flush(call_ptr->connection);
+      cdbus_flush(call_ptr->connection);
 
     dbus_message_unref(call_ptr->reply);
     call_ptr->reply = NULL;
@@ -31,6 +31,64 @@
 #include <stdarg.h>
 #include "helpers.h"
 
+#define CDBUS_BATCH_MAX_CONNECTIONS 4
+
+static unsigned int g_batch_depth;
+static DBusConnection * g_batch_connections[CDBUS_BATCH_MAX_CONNECTIONS];
+static unsigned int g_batch_connections_count;
+
+void cdbus_batch_begin(void)
+{
+  g_batch_depth++;
+}
+
+void cdbus_batch_end(void)
+{
+  unsigned int i;
+
+  ASSERT(g_batch_depth > 0);
+  g_batch_depth--;
+  if (g_batch_depth > 0)
+  {
+    return;
+  }
+
+  for (i = 0; i < g_batch_connections_count; i++)
+  {
+    dbus_connection_flush(g_batch_connections[i]);
+    dbus_connection_unref(g_batch_connections[i]);
+  }
+
+  g_batch_connections_count = 0;
+}
+
+void cdbus_flush(DBusConnection * connection_ptr)
+{
+  unsigned int i;
+
+  if (g_batch_depth == 0)
+  {
+    dbus_connection_flush(connection_ptr);
+    return;
+  }
+
+  for (i = 0; i < g_batch_connections_count; i++)
+  {
+    if (g_batch_connections[i] == connection_ptr)
+    {
+      return;
+    }
+  }
+
+  if (g_batch_connections_count == CDBUS_BATCH_MAX_CONNECTIONS)
+  {
+    dbus_connection_flush(connection_ptr);
+    return;
+  }
+
+  g_batch_connections[g_batch_connections_count++] = dbus_connection_ref(connection_ptr);
+}
+
 void cdbus_signal_send(DBusConnection * connection_ptr, DBusMessage * message_ptr)
 {
   if (!dbus_connection_send(connection_ptr, message_ptr, NULL))
@@ -38,7 +96,7 @@ void cdbus_signal_send(DBusConnection * connection_ptr, DBusMessage * message_pt
     log_error("Ran out of memory trying to queue signal");
   }
 
-  dbus_connection_flush(connection_ptr);
+  cdbus_flush(connection_ptr);
 }
 
 void
@@ -42,6 +42,15 @@ struct cdbus_signal_descriptor
   const struct cdbus_signal_arg_descriptor * args;
 };
 
+/* Outgoing message batching. Messages sent while a batch is open are
+ * only queued in the connection. The connections are flushed once, when
+ * the outermost batch ends. Batches nest. */
+void cdbus_batch_begin(void);
+void cdbus_batch_end(void);
+
+/* Flush now or, if a batch is open, when it ends */
+void cdbus_flush(DBusConnection * connection_ptr);
+
 void cdbus_signal_send(DBusConnection * connection_ptr, DBusMessage * message_ptr);
 
 void
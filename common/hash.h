@@ -0,0 +1,74 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2026 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains hash functions used by the in-memory indexes
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef HASH_H__7E0C2A64_0B9F_4D55_9A1E_2C7B5D1F6A83__INCLUDED
+#define HASH_H__7E0C2A64_0B9F_4D55_9A1E_2C7B5D1F6A83__INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Fibonacci hashing, the upper half of the product is well mixed */
+static inline uint32_t ladish_hash_u64(uint64_t value)
+{
+  return (uint32_t)((value * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+static inline uint32_t ladish_hash_ptr(const void * ptr)
+{
+  return ladish_hash_u64((uint64_t)(uintptr_t)ptr);
+}
+
+/* FNV-1a */
+static inline uint32_t ladish_hash_data(const void * data, size_t size)
+{
+  const unsigned char * ptr;
+  uint32_t hash;
+
+  hash = 2166136261U;
+  for (ptr = data; size > 0; ptr++, size--)
+  {
+    hash ^= *ptr;
+    hash *= 16777619U;
+  }
+
+  return hash;
+}
+
+static inline uint32_t ladish_hash_str(const char * str)
+{
+  uint32_t hash;
+
+  hash = 2166136261U;
+  while (*str != 0)
+  {
+    hash ^= (unsigned char)*str++;
+    hash *= 16777619U;
+  }
+
+  return hash;
+}
+
+#endif /* #ifndef HASH_H__7E0C2A64_0B9F_4D55_9A1E_2C7B5D1F6A83__INCLUDED */
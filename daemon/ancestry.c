@@ -0,0 +1,177 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2026 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the process ancestry cache
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "ancestry.h"
+#include "procfs.h"
+#include "../common/hash.h"
+
+/* Parent pids of processes, so that resolving a pid to an app does not
+ * read procfs for every ancestor again and again. A cached process is
+ * identified by its pid and start time: the start time of the looked up
+ * process is always read, ancestors are trusted unless they appear to
+ * have started after their child, which means that the pid was reused. */
+
+#define ANCESTRY_HASH_BUCKETS 256
+#define ANCESTRY_MAX_ENTRIES 1024
+
+struct ancestry_entry
+{
+  struct hlist_node pid_siblings;
+  struct list_head lru_siblings; /* most recently used first */
+  pid_t pid;
+  pid_t ppid;
+  unsigned long long starttime;
+};
+
+static struct hlist_head g_ancestry_hash[ANCESTRY_HASH_BUCKETS];
+static LIST_HEAD(g_ancestry_lru);
+static unsigned int g_ancestry_count;
+
+static struct hlist_head * ancestry_bucket(pid_t pid)
+{
+  return g_ancestry_hash + (ladish_hash_u64((uint64_t)pid) % ANCESTRY_HASH_BUCKETS);
+}
+
+static struct ancestry_entry * ancestry_find(pid_t pid)
+{
+  struct ancestry_entry * entry_ptr;
+  struct hlist_node * node_ptr;
+
+  hlist_for_each_entry(entry_ptr, node_ptr, ancestry_bucket(pid), pid_siblings)
+  {
+    if (entry_ptr->pid == pid)
+    {
+      return entry_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+static void ancestry_drop(struct ancestry_entry * entry_ptr)
+{
+  hlist_del(&entry_ptr->pid_siblings);
+  list_del(&entry_ptr->lru_siblings);
+  g_ancestry_count--;
+  free(entry_ptr);
+}
+
+/* read process info from procfs and update or create its cache entry */
+static struct ancestry_entry * ancestry_read(pid_t pid, struct ancestry_entry * entry_ptr)
+{
+  unsigned long long ppid;
+  unsigned long long starttime;
+
+  if (!procfs_get_process_stat(pid, &ppid, &starttime))
+  {
+    /* the process does not exist anymore */
+    if (entry_ptr != NULL)
+    {
+      ancestry_drop(entry_ptr);
+    }
+
+    return NULL;
+  }
+
+  if (entry_ptr == NULL)
+  {
+    if (g_ancestry_count >= ANCESTRY_MAX_ENTRIES)
+    {
+      ancestry_drop(list_entry(g_ancestry_lru.prev, struct ancestry_entry, lru_siblings));
+    }
+
+    entry_ptr = malloc(sizeof(struct ancestry_entry));
+    if (entry_ptr == NULL)
+    {
+      log_error("malloc() failed to allocate struct ancestry_entry");
+      return NULL;
+    }
+
+    entry_ptr->pid = pid;
+    hlist_add_head(&entry_ptr->pid_siblings, ancestry_bucket(pid));
+    list_add(&entry_ptr->lru_siblings, &g_ancestry_lru);
+    g_ancestry_count++;
+  }
+
+  entry_ptr->ppid = (pid_t)ppid;
+  entry_ptr->starttime = starttime;
+
+  return entry_ptr;
+}
+
+unsigned int ladish_ancestry_get(pid_t pid, pid_t chain[LADISH_ANCESTRY_MAX_DEPTH])
+{
+  struct ancestry_entry * entry_ptr;
+  unsigned long long child_starttime;
+  unsigned int count;
+
+  chain[0] = pid;
+  count = 1;
+
+  entry_ptr = ancestry_read(pid, ancestry_find(pid));
+
+  while (entry_ptr != NULL)
+  {
+    list_move(&entry_ptr->lru_siblings, &g_ancestry_lru);
+
+    pid = entry_ptr->ppid;
+    if (pid == 0 || count == LADISH_ANCESTRY_MAX_DEPTH)
+    {
+      break;
+    }
+
+    chain[count++] = pid;
+
+    child_starttime = entry_ptr->starttime;
+    entry_ptr = ancestry_find(pid);
+    if (entry_ptr == NULL || entry_ptr->starttime > child_starttime)
+    {
+      entry_ptr = ancestry_read(pid, entry_ptr);
+    }
+  }
+
+  return count;
+}
+
+void ladish_ancestry_forget(pid_t pid)
+{
+  struct ancestry_entry * entry_ptr;
+
+  entry_ptr = ancestry_find(pid);
+  if (entry_ptr != NULL)
+  {
+    ancestry_drop(entry_ptr);
+  }
+}
+
+void ladish_ancestry_uninit(void)
+{
+  while (!list_empty(&g_ancestry_lru))
+  {
+    ancestry_drop(list_entry(g_ancestry_lru.next, struct ancestry_entry, lru_siblings));
+  }
+}
@@ -0,0 +1,44 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2026 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains interface to the process ancestry cache
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef ANCESTRY_H__2F7A9C31_5D84_4E0B_B6A2_8C13E49D07F5__INCLUDED
+#define ANCESTRY_H__2F7A9C31_5D84_4E0B_B6A2_8C13E49D07F5__INCLUDED
+
+#include "common.h"
+
+#define LADISH_ANCESTRY_MAX_DEPTH 32
+
+/* Fill chain with pid and its ancestors, closest first.
+ * Returns the number of pids stored, at least one (the pid itself). */
+unsigned int ladish_ancestry_get(pid_t pid, pid_t chain[LADISH_ANCESTRY_MAX_DEPTH]);
+
+/* To be called when a process is known to have exited */
+void ladish_ancestry_forget(pid_t pid);
+
+void ladish_ancestry_uninit(void);
+
+#endif /* #ifndef ANCESTRY_H__2F7A9C31_5D84_4E0B_B6A2_8C13E49D07F5__INCLUDED */
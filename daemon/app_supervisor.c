@@ -40,6 +40,13 @@
 #include "../common/catdup.h"
 #include "../common/dirhelpers.h"
 #include "jack_session.h"
+#include "reactor.h"
+#include "conf.h"
+#include "../proxies/conf_proxy.h"
+
+/* How long to wait for a started autorun app to register its JACK client
+ * before starting the next ones anyway (apps that have no JACK client at all) */
+#define LADISH_AUTORUN_READY_TIMEOUT 10000 /* milliseconds */
 
 struct ladish_app
 {
@@ -52,14 +59,18 @@ struct ladish_app
   bool terminal;
   char level[MAX_LEVEL_CHARCOUNT];
   pid_t pid;
+  pid_t last_pid;               /* pid of the last started process, its output is available after exit */
   pid_t pgrp;
   pid_t firstborn_pid;
   pid_t firstborn_pgrp;
   int firstborn_refcount;
   bool zombie;                  /* if true, remove when stopped */
   bool autorun;
+  bool autorun_pending;         /* started by autorun, waiting for its JACK client */
+  uint8_t start_priority;       /* autorun starts apps with lower priority first */
   unsigned int state;
   char * dbus_name;
+  ladish_js_save_handle js_save; /* pending JACK session save */
   struct ladish_app_supervisor * supervisor;
 };
 
@@ -79,8 +90,12 @@ struct ladish_app_supervisor
   uint64_t version;
   uint64_t next_id;
   struct list_head applist;
+  bool autorun_active;
+  unsigned int autorun_pending_count;
+  uint8_t autorun_priority;     /* priority of the apps being started */
   void * on_app_renamed_context;
   ladish_app_supervisor_on_app_renamed_callback on_app_renamed;
+  ladish_app_supervisor_on_autorun_complete_callback on_autorun_complete;
 };
 
 bool ladish_check_app_level_validity(const char * level, size_t * len_ptr)
@@ -134,7 +149,8 @@ ladish_app_supervisor_create(
   const char * opath,
   const char * name,
   void * context,
-  ladish_app_supervisor_on_app_renamed_callback on_app_renamed)
+  ladish_app_supervisor_on_app_renamed_callback on_app_renamed,
+  ladish_app_supervisor_on_autorun_complete_callback on_autorun_complete)
 {
   struct ladish_app_supervisor * supervisor_ptr;
 
@@ -177,8 +193,13 @@ ladish_app_supervisor_create(
 
   INIT_LIST_HEAD(&supervisor_ptr->applist);
 
+  supervisor_ptr->autorun_active = false;
+  supervisor_ptr->autorun_pending_count = 0;
+  supervisor_ptr->autorun_priority = 0;
+
   supervisor_ptr->on_app_renamed_context = context;
   supervisor_ptr->on_app_renamed = on_app_renamed;
+  supervisor_ptr->on_autorun_complete = on_autorun_complete;
 
   *supervisor_handle_ptr = (ladish_app_supervisor_handle)supervisor_ptr;
 
@@ -202,10 +223,17 @@ struct ladish_app * ladish_app_supervisor_find_app_by_id_internal(struct ladish_
   return NULL;
 }
 
+static void ladish_app_autorun_ready(struct ladish_app * app_ptr);
+static void ladish_app_supervisor_autorun_abort(ladish_app_supervisor_handle supervisor_handle);
+static void ladish_app_supervisor_autorun_step(void * context);
+static void ladish_app_supervisor_autorun_timeout(void * context);
+
 void remove_app_internal(struct ladish_app_supervisor * supervisor_ptr, struct ladish_app * app_ptr)
 {
   ASSERT(app_ptr->pid == 0);    /* Removing not-stoped app? Zombies will make a rebellion! */
 
+  ladish_app_autorun_ready(app_ptr);
+
   list_del(&app_ptr->siblings);
 
   supervisor_ptr->version++;
@@ -456,6 +484,7 @@ ladish_app_supervisor_add(
   app_ptr->terminal = terminal;
   memcpy(app_ptr->level, level, len + 1);
   app_ptr->pid = 0;
+  app_ptr->last_pid = 0;
   app_ptr->pgrp = 0;
   app_ptr->firstborn_pid = 0;
   app_ptr->firstborn_pgrp = 0;
@@ -474,6 +503,9 @@ ladish_app_supervisor_add(
   app_ptr->zombie = false;
   app_ptr->state = LADISH_APP_STATE_STOPPED;
   app_ptr->autorun = autorun;
+  app_ptr->autorun_pending = false;
+  app_ptr->start_priority = 0;
+  app_ptr->js_save = NULL;
   app_ptr->supervisor = supervisor_ptr;
   list_add_tail(&app_ptr->siblings, &supervisor_ptr->applist);
 
@@ -727,6 +759,11 @@ exit:
 
 static void ladish_js_app_save_complete(void * context, const char * commandline)
 {
+  dbus_bool_t success;
+  dbus_uint32_t pending;
+
+  app_ptr->js_save = NULL;
+
   if (commandline != NULL)
   {
     log_info("JS app saved, commandline '%s'", commandline);
@@ -745,6 +782,19 @@ static void ladish_js_app_save_complete(void * context, const char * commandline
     log_error("JACK session save failed for JS app '%s'", app_ptr->name);
   }
 
+  success = app_ptr->js_commandline != NULL;
+  ASSERT(app_ptr->supervisor->pending_js_saves > 0);
+  pending = app_ptr->supervisor->pending_js_saves - 1;
+  cdbus_signal_emit(
+    cdbus_g_dbus_connection,
+    app_ptr->supervisor->opath,
+    IFACE_APP_SUPERVISOR,
+    "AppSaved",
+    "tbu",
+    &app_ptr->id,
+    &success,
+    &pending);
+
   if (app_ptr->supervisor->pending_js_saves != 1)
   {
     ASSERT(app_ptr->supervisor->pending_js_saves > 1);
@@ -761,7 +811,7 @@ static void ladish_js_app_save_complete(void * context, const char * commandline
 
 #undef app_ptr
 
-static inline void ladish_app_initiate_save(struct ladish_app * app_ptr)
+static inline void ladish_app_initiate_save(struct ladish_app * app_ptr, ladish_js_clients_handle js_clients)
 {
   if (strcmp(app_ptr->level, LADISH_APP_LEVEL_LASH) == 0 &&
       app_ptr->dbus_name != NULL)
@@ -771,7 +821,8 @@ static inline void ladish_app_initiate_save(struct ladish_app * app_ptr)
   else if (strcmp(app_ptr->level, LADISH_APP_LEVEL_JACKSESSION) == 0)
   {
     log_info("Initiating JACK session save for '%s'", app_ptr->name);
-    if (!ladish_js_save_app(app_ptr->uuid, app_ptr->supervisor->js_temp_dir, app_ptr, ladish_js_app_save_complete))
+    if (js_clients == NULL ||
+        !ladish_js_save_app(js_clients, app_ptr->uuid, app_ptr->supervisor->js_temp_dir, app_ptr, ladish_js_app_save_complete, &app_ptr->js_save))
     {
       ladish_js_app_save_complete(app_ptr, NULL);
     }
@@ -805,6 +856,35 @@ bool ladish_app_supervisor_clear(ladish_app_supervisor_handle supervisor_handle)
   struct ladish_app * app_ptr;
   bool lifeless;
 
+  ladish_app_supervisor_autorun_abort(supervisor_handle);
+
+  if (supervisor_ptr->pending_js_saves > 0)
+  {
+    log_info("abandoning %u pending JS app saves", supervisor_ptr->pending_js_saves);
+
+    list_for_each(node_ptr, &supervisor_ptr->applist)
+    {
+      app_ptr = list_entry(node_ptr, struct ladish_app, siblings);
+      if (app_ptr->js_save != NULL)
+      {
+        ladish_js_save_app_cancel(app_ptr->js_save);
+        app_ptr->js_save = NULL;
+      }
+
+      free(app_ptr->js_commandline);
+      app_ptr->js_commandline = NULL;
+    }
+
+    supervisor_ptr->pending_js_saves = 0;
+    supervisor_ptr->save_callback = NULL;
+    supervisor_ptr->save_callback_context = NULL;
+
+    if (!ladish_rmdir_recursive(supervisor_ptr->js_temp_dir))
+    {
+      log_error("Cannot remove JS temp dir '%s'", supervisor_ptr->js_temp_dir);
+    }
+  }
+
   free(supervisor_ptr->js_temp_dir);
   supervisor_ptr->js_temp_dir = NULL;
   free(supervisor_ptr->js_dir);
@@ -926,6 +1006,9 @@ bool ladish_app_supervisor_child_exit(ladish_app_supervisor_handle supervisor_ha
       /* firstborn pid and pgrp is not reset here because it is refcounted
          and managed independently through the add/del_pid() methods */
 
+      /* don't wait for JACK client of app that is gone */
+      ladish_app_autorun_ready(app_ptr);
+
       if (app_ptr->zombie)
       {
         remove_app_internal(supervisor_ptr, app_ptr);
@@ -1016,6 +1099,7 @@ bool ladish_app_supervisor_start_app(ladish_app_supervisor_handle supervisor_han
   }
 
   ASSERT(app_ptr->pid != 0);
+  app_ptr->last_pid = app_ptr->pid;
   app_ptr->state = LADISH_APP_STATE_STARTED;
 
   emit_app_state_changed(supervisor_ptr, app_ptr);
@@ -1083,6 +1167,9 @@ void ladish_app_add_pid(ladish_app_handle app_handle, pid_t pid)
     return;
   }
 
+  /* the app has JACK client now */
+  ladish_app_autorun_ready(app_ptr);
+
   if (app_ptr->pid == pid)
   { /* The top level process that is already known */
     return;
@@ -1136,18 +1223,131 @@ bool ladish_app_set_dbus_name(ladish_app_handle app_handle, const char * name)
   return true;
 }
 
+void ladish_app_set_start_priority(ladish_app_handle app_handle, uint8_t priority)
+{
+  app_ptr->start_priority = priority;
+}
+
+uint8_t ladish_app_get_start_priority(ladish_app_handle app_handle)
+{
+  return app_ptr->start_priority;
+}
+
 #undef app_ptr
 
-void ladish_app_supervisor_autorun(ladish_app_supervisor_handle supervisor_handle)
+static void ladish_app_autorun_ready(struct ladish_app * app_ptr)
+{
+  if (!app_ptr->autorun_pending)
+  {
+    return;
+  }
+
+  app_ptr->autorun_pending = false;
+  ASSERT(app_ptr->supervisor->autorun_pending_count > 0);
+  app_ptr->supervisor->autorun_pending_count--;
+
+  /* don't start apps from within the virtualizer or child exit handling */
+  if (app_ptr->supervisor->autorun_active)
+  {
+    ladish_reactor_post(app_ptr->supervisor, ladish_app_supervisor_autorun_step);
+  }
+}
+
+static void ladish_app_supervisor_autorun_abort(ladish_app_supervisor_handle supervisor_handle)
+{
+  struct list_head * node_ptr;
+  struct ladish_app * app_ptr;
+
+  list_for_each(node_ptr, &supervisor_ptr->applist)
+  {
+    app_ptr = list_entry(node_ptr, struct ladish_app, siblings);
+    app_ptr->autorun_pending = false;
+  }
+
+  supervisor_ptr->autorun_pending_count = 0;
+  ladish_reactor_cancel(supervisor_ptr, ladish_app_supervisor_autorun_step);
+  ladish_reactor_cancel(supervisor_ptr, ladish_app_supervisor_autorun_timeout);
+
+  if (supervisor_ptr->autorun_active)
+  {
+    supervisor_ptr->autorun_active = false;
+    if (supervisor_ptr->on_autorun_complete != NULL)
+    {
+      supervisor_ptr->on_autorun_complete(supervisor_ptr->on_app_renamed_context);
+    }
+  }
+}
+
+/* Apps are started in stages of same start priority, lowest first.
+ * The next stage starts after all apps of the current one have JACK clients
+ * (or exited), within a stage at most "autorun window" apps are waited for at a time. */
+static void ladish_app_supervisor_autorun_step(void * context)
 {
+  ladish_app_supervisor_handle supervisor_handle;
   struct list_head * node_ptr;
   struct ladish_app * app_ptr;
+  unsigned int window;
+  bool found;
+  uint8_t priority;
+
+  supervisor_handle = context;
+
+  if (!supervisor_ptr->autorun_active)
+  {
+    return;
+  }
 
+  found = false;
+  priority = 0;
   list_for_each(node_ptr, &supervisor_ptr->applist)
   {
     app_ptr = list_entry(node_ptr, struct ladish_app, siblings);
+    if (app_ptr->autorun && (!found || app_ptr->start_priority < priority))
+    {
+      found = true;
+      priority = app_ptr->start_priority;
+    }
+  }
 
-    if (!app_ptr->autorun)
+  if (!found)
+  {
+    if (supervisor_ptr->autorun_pending_count == 0)
+    {
+      log_info("autorun of '%s' apps complete", supervisor_ptr->name);
+      ladish_app_supervisor_autorun_abort(supervisor_handle);
+    }
+
+    return;
+  }
+
+  if (supervisor_ptr->autorun_pending_count > 0 && priority != supervisor_ptr->autorun_priority)
+  {
+    /* wait for the current stage to settle */
+    return;
+  }
+
+  if (supervisor_ptr->autorun_pending_count == 0 && priority != supervisor_ptr->autorun_priority)
+  {
+    log_info("autorun of '%s' apps with start priority %u", supervisor_ptr->name, (unsigned int)priority);
+  }
+
+  supervisor_ptr->autorun_priority = priority;
+
+  if (!conf_get_uint(LADISH_CONF_KEY_DAEMON_AUTORUN_WINDOW, &window))
+  {
+    window = LADISH_CONF_KEY_DAEMON_AUTORUN_WINDOW_DEFAULT;
+  }
+
+  list_for_each(node_ptr, &supervisor_ptr->applist)
+  {
+    if (window != 0 && supervisor_ptr->autorun_pending_count >= window)
+    {
+      break;
+    }
+
+    app_ptr = list_entry(node_ptr, struct ladish_app, siblings);
+
+    if (!app_ptr->autorun || app_ptr->start_priority != priority)
     {
       continue;
     }
@@ -1159,9 +1359,52 @@ void ladish_app_supervisor_autorun(ladish_app_supervisor_handle supervisor_handl
     if (!ladish_app_supervisor_start_app((ladish_app_supervisor_handle)supervisor_ptr, (ladish_app_handle)app_ptr))
     {
       log_error("Execution of '%s' failed",  app_ptr->commandline);
+      ladish_app_supervisor_autorun_abort(supervisor_handle);
       return;
     }
+
+    app_ptr->autorun_pending = true;
+    supervisor_ptr->autorun_pending_count++;
+  }
+
+  /* restart the timeout, it is for lack of progress */
+  ladish_reactor_cancel(supervisor_ptr, ladish_app_supervisor_autorun_timeout);
+  if (supervisor_ptr->autorun_pending_count > 0)
+  {
+    ladish_reactor_post_delayed(supervisor_ptr, ladish_app_supervisor_autorun_timeout, LADISH_AUTORUN_READY_TIMEOUT);
+  }
+}
+
+static void ladish_app_supervisor_autorun_timeout(void * context)
+{
+  ladish_app_supervisor_handle supervisor_handle;
+  struct list_head * node_ptr;
+  struct ladish_app * app_ptr;
+
+  supervisor_handle = context;
+
+  list_for_each(node_ptr, &supervisor_ptr->applist)
+  {
+    app_ptr = list_entry(node_ptr, struct ladish_app, siblings);
+    if (app_ptr->autorun_pending)
+    {
+      log_info("app '%s' did not register JACK client in time, not waiting for it", app_ptr->name);
+      ladish_app_autorun_ready(app_ptr);
+    }
+  }
+}
+
+void ladish_app_supervisor_autorun(ladish_app_supervisor_handle supervisor_handle)
+{
+  if (supervisor_ptr->autorun_active)
+  {
+    return;
   }
+
+  supervisor_ptr->autorun_active = true;
+  supervisor_ptr->autorun_priority = 0;
+  ASSERT(supervisor_ptr->autorun_pending_count == 0);
+  ladish_app_supervisor_autorun_step(supervisor_ptr);
 }
 
 void ladish_app_supervisor_stop(ladish_app_supervisor_handle supervisor_handle)
@@ -1169,6 +1412,8 @@ void ladish_app_supervisor_stop(ladish_app_supervisor_handle supervisor_handle)
   struct list_head * node_ptr;
   struct ladish_app * app_ptr;
 
+  ladish_app_supervisor_autorun_abort(supervisor_handle);
+
   list_for_each(node_ptr, &supervisor_ptr->applist)
   {
     app_ptr = list_entry(node_ptr, struct ladish_app, siblings);
@@ -1189,10 +1434,13 @@ ladish_app_supervisor_save(
 {
   struct list_head * node_ptr;
   struct ladish_app * app_ptr;
+  ladish_js_clients_handle js_clients;
   bool success;
 
   ASSERT(callback != NULL);
 
+  js_clients = NULL;
+
   ASSERT(supervisor_ptr->js_temp_dir == NULL);
   ASSERT(supervisor_ptr->pending_js_saves == 0);
   list_for_each(node_ptr, &supervisor_ptr->applist)
@@ -1226,6 +1474,13 @@ ladish_app_supervisor_save(
     }
 
     log_info("saving %u JACK session apps to '%s'", supervisor_ptr->pending_js_saves, supervisor_ptr->js_temp_dir);
+
+    /* resolve app clients once, all saves are initiated without waiting for each other */
+    if (!ladish_js_clients_create(&js_clients))
+    {
+      log_error("Cannot index JACK session app clients");
+      js_clients = NULL;
+    }
   }
 
   list_for_each(node_ptr, &supervisor_ptr->applist)
@@ -1242,7 +1497,12 @@ ladish_app_supervisor_save(
       continue;
     }
 
-    ladish_app_initiate_save(app_ptr);
+    ladish_app_initiate_save(app_ptr, js_clients);
+  }
+
+  if (js_clients != NULL)
+  {
+    ladish_js_clients_destroy(js_clients);
   }
 
   success = true;
@@ -1877,6 +2137,82 @@ static void is_app_running(struct cdbus_method_call * call_ptr)
   cdbus_method_return_new_single(call_ptr, DBUS_TYPE_BOOLEAN, &running);
 }
 
+static void get_app_output(struct cdbus_method_call * call_ptr)
+{
+  uint64_t id;
+  uint32_t max_size;
+  struct ladish_app * app_ptr;
+  const char * part1;
+  const char * part2;
+  size_t part1_size;
+  size_t part2_size;
+  DBusMessageIter iter, array_iter;
+
+  if (!dbus_message_get_args(
+        call_ptr->message,
+        &cdbus_g_dbus_error,
+        DBUS_TYPE_UINT64, &id,
+        DBUS_TYPE_UINT32, &max_size,
+        DBUS_TYPE_INVALID))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": %s",  call_ptr->method_name, cdbus_g_dbus_error.message);
+    dbus_error_free(&cdbus_g_dbus_error);
+    return;
+  }
+
+  app_ptr = ladish_app_supervisor_find_app_by_id_internal(supervisor_ptr, id);
+  if (app_ptr == NULL)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "App with ID %"PRIu64" not found", id);
+    return;
+  }
+
+  if (app_ptr->last_pid == 0 ||
+      !loader_get_output(app_ptr->last_pid, max_size, &part1, &part1_size, &part2, &part2_size))
+  {
+    /* never started or output of the last run is no longer kept */
+    part1 = part2 = NULL;
+    part1_size = part2_size = 0;
+  }
+
+  call_ptr->reply = dbus_message_new_method_return(call_ptr->message);
+  if (call_ptr->reply == NULL)
+  {
+    goto fail;
+  }
+
+  dbus_message_iter_init_append(call_ptr->reply, &iter);
+
+  if (!dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE_AS_STRING, &array_iter))
+  {
+    goto fail_unref;
+  }
+
+  if (part1_size > 0 && !dbus_message_iter_append_fixed_array(&array_iter, DBUS_TYPE_BYTE, &part1, part1_size))
+  {
+    goto fail_unref;
+  }
+
+  if (part2_size > 0 && !dbus_message_iter_append_fixed_array(&array_iter, DBUS_TYPE_BYTE, &part2, part2_size))
+  {
+    goto fail_unref;
+  }
+
+  if (!dbus_message_iter_close_container(&iter, &array_iter))
+  {
+    goto fail_unref;
+  }
+
+  return;
+
+fail_unref:
+  dbus_message_unref(call_ptr->reply);
+  call_ptr->reply = NULL;
+
+fail:
+  log_error("Ran out of memory trying to construct method return");
+}
+
 #undef supervisor_ptr
 
 CDBUS_METHOD_ARGS_BEGIN(GetInterfaceVersion, "Get version of this D-Bus interface")
@@ -1962,6 +2298,12 @@ CDBUS_METHOD_ARGS_BEGIN(IsAppRunning, "Check whether application is running")
   CDBUS_METHOD_ARG_DESCRIBE_OUT("running", DBUS_TYPE_BOOLEAN_AS_STRING, "Whether app is running")
 CDBUS_METHOD_ARGS_END
 
+CDBUS_METHOD_ARGS_BEGIN(GetAppOutput, "Get the last captured stdout/stderr output of an application")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("id", DBUS_TYPE_UINT64_AS_STRING, "id of app")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("max_size", DBUS_TYPE_UINT32_AS_STRING, "Max number of bytes to return")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("output", DBUS_TYPE_ARRAY_AS_STRING DBUS_TYPE_BYTE_AS_STRING, "Raw output, not necessarily valid UTF-8")
+CDBUS_METHOD_ARGS_END
+
 
 CDBUS_METHODS_BEGIN
   CDBUS_METHOD_DESCRIBE(GetInterfaceVersion, get_version)     /* sync */
@@ -1978,6 +2320,7 @@ CDBUS_METHODS_BEGIN
   CDBUS_METHOD_DESCRIBE(SetAppProperties2, set_app_properties2) /* sync */
   CDBUS_METHOD_DESCRIBE(RemoveApp, remove_app)                /* sync */
   CDBUS_METHOD_DESCRIBE(IsAppRunning, is_app_running)         /* sync */
+  CDBUS_METHOD_DESCRIBE(GetAppOutput, get_app_output)         /* sync */
 CDBUS_METHODS_END
 
 CDBUS_SIGNAL_ARGS_BEGIN(AppAdded, "")
@@ -2021,12 +2364,19 @@ CDBUS_SIGNAL_ARGS_BEGIN(AppStateChanged2, "")
   CDBUS_SIGNAL_ARG_DESCRIBE("level", DBUS_TYPE_STRING_AS_STRING, "Level")
 CDBUS_SIGNAL_ARGS_END
 
+CDBUS_SIGNAL_ARGS_BEGIN(AppSaved, "JACK session save of app is complete")
+  CDBUS_SIGNAL_ARG_DESCRIBE("id", DBUS_TYPE_UINT64_AS_STRING, "")
+  CDBUS_SIGNAL_ARG_DESCRIBE("success", DBUS_TYPE_BOOLEAN_AS_STRING, "")
+  CDBUS_SIGNAL_ARG_DESCRIBE("pending", DBUS_TYPE_UINT32_AS_STRING, "Number of apps that are still saving")
+CDBUS_SIGNAL_ARGS_END
+
 CDBUS_SIGNALS_BEGIN
   CDBUS_SIGNAL_DESCRIBE(AppAdded)
   CDBUS_SIGNAL_DESCRIBE(AppAdded2)
   CDBUS_SIGNAL_DESCRIBE(AppRemoved)
   CDBUS_SIGNAL_DESCRIBE(AppStateChanged)
   CDBUS_SIGNAL_DESCRIBE(AppStateChanged2)
+  CDBUS_SIGNAL_DESCRIBE(AppSaved)
 CDBUS_SIGNALS_END
 
 CDBUS_INTERFACE_DEFAULT_HANDLER_METHODS_AND_SIGNALS(g_iface_app_supervisor, IFACE_APP_SUPERVISOR)
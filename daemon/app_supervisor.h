@@ -63,6 +63,13 @@ typedef void (* ladish_app_supervisor_on_app_renamed_callback)(
   const char * old_name,
   const char * new_app_name);
 
+/**
+ * Type of function that is called when autorun of the apps is complete or aborted
+ *
+ * @param[in] context User defined context that was supplied to ladish_app_supervisor_create()
+ */
+typedef void (* ladish_app_supervisor_on_autorun_complete_callback)(void * context);
+
 /**
  * Type of function that is called during app enumeration
  *
@@ -114,8 +121,9 @@ ladish_check_app_level_validity(
  * @param[out] supervisor_handle_ptr Pointer to variable that will receive supervisor handle
  * @param[in] opath Unique D-Bus object path for supervisor being created
  * @param[in] name Name of the supervisor
- * @param[in] context User defined context to be supplied when the callback suppiled through the @c on_app_renamed parameter is called
+ * @param[in] context User defined context to be supplied when the callbacks suppiled through the @c on_app_renamed and @c on_autorun_complete parameters are called
  * @param[in] on_app_renamed Callback to call when app is renamed
+ * @param[in] on_autorun_complete Callback to call when autorun of the apps is complete or aborted
  *
  * @return success status
  */
@@ -125,7 +133,8 @@ ladish_app_supervisor_create(
   const char * opath,
   const char * name,
   void * context,
-  ladish_app_supervisor_on_app_renamed_callback on_app_renamed);
+  ladish_app_supervisor_on_app_renamed_callback on_app_renamed,
+  ladish_app_supervisor_on_autorun_complete_callback on_autorun_complete);
 
 /**
  * Destroy app supervisor object
@@ -255,7 +264,11 @@ ladish_app_supervisor_stop(
   ladish_app_supervisor_handle supervisor_handle);
 
 /**
- * Start all apps that were added with autorun enabled
+ * Start all apps that were added with autorun enabled.
+ * Apps are started asynchronously, in order of their start priority.
+ * Apps with higher priority are started after the JACK clients of the
+ * previous ones appear; the number of apps being waited for is limited by
+ * the autorun window setting.
  *
  * @param[in] supervisor_handle supervisor object handle
  */
@@ -444,7 +457,7 @@ void ladish_app_kill(ladish_app_handle app_handle);
 void ladish_app_restore(ladish_app_handle app_handle);
 
 /**
- * Associate pid with app.
+ * Associate pid with app. This is called when a JACK client of the app appears.
  *
  * @param[in] app_handle Handle of app
  * @param[in] pid PID to associate with the app
@@ -469,6 +482,23 @@ void ladish_app_del_pid(ladish_app_handle app_handle, pid_t pid);
  */
 bool ladish_app_set_dbus_name(ladish_app_handle app_handle, const char * name);
 
+/**
+ * Set the start priority of the app. Autorun starts apps with lower priority first.
+ *
+ * @param[in] app_handle Handle of app
+ * @param[in] priority Start priority, zero by default
+ */
+void ladish_app_set_start_priority(ladish_app_handle app_handle, uint8_t priority);
+
+/**
+ * Get the start priority of the app.
+ *
+ * @param[in] app_handle Handle of app
+ *
+ * @return Start priority
+ */
+uint8_t ladish_app_get_start_priority(ladish_app_handle app_handle);
+
 /**
  * D-Bus interface descriptor for the app supervisor interface. The call context must be a ::ladish_app_supervisor_handle
  */
@@ -28,12 +28,20 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/inotify.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "appdb.h"
 #include "../log.h"
 #include "../common/catdup.h"
+#include "../common/hash.h"
 #include "../assert.h"
+#include "reactor.h"
+#include "save.h"
 
 void
 lash_appdb_free_entry(
@@ -342,10 +350,12 @@ lash_appdb_find_key(
   return NULL;
 }
 
+/* entry_ptr_ptr is set to NULL if the file is not a LASH application desktop entry */
+static
 bool
-lash_appdb_load_file(
-  struct list_head * appdb,
-  const char * file_path)
+lash_appdb_parse_file(
+  const char * file_path,
+  struct lash_appdb_entry ** entry_ptr_ptr)
 {
   char * data;
   bool ret;
@@ -354,7 +364,6 @@ lash_appdb_load_file(
   const char * value;
   const char * name;
   const char * xlash;
-  struct list_head * node_ptr;
   struct lash_appdb_entry * entry_ptr;
   struct map * map_ptr;
   char ** str_ptr_ptr;
@@ -363,6 +372,7 @@ lash_appdb_load_file(
   //log_info("Desktop entry '%s'", file_path);
 
   ret = true;
+  *entry_ptr_ptr = NULL;
 
   if (!load_file_data(file_path, &data))
   {
@@ -403,17 +413,6 @@ lash_appdb_load_file(
     goto exit_free_data;
   }
 
-  /* check whether entry already exists (first found entries have priority according to XDG Base Directory Specification) */
-  list_for_each(node_ptr, appdb)
-  {
-    entry_ptr = list_entry(node_ptr, struct lash_appdb_entry, siblings);
-
-    if (strcmp(entry_ptr->name, name) == 0)
-    {
-      goto exit_free_data;
-    }
-  }
-
   //log_info("Application '%s' found", name);
 
   /* allocate new entry */
@@ -475,8 +474,7 @@ lash_appdb_load_file(
     map_ptr++;
   }
 
-  /* add entry to appdb list */
-  list_add_tail(&entry_ptr->siblings, appdb);
+  *entry_ptr_ptr = entry_ptr;
 
   goto exit_free_data;
 
@@ -493,6 +491,43 @@ exit:
   return ret;
 }
 
+bool
+lash_appdb_load_file(
+  struct list_head * appdb,
+  const char * file_path)
+{
+  struct list_head * node_ptr;
+  struct lash_appdb_entry * entry_ptr;
+  struct lash_appdb_entry * new_entry_ptr;
+
+  if (!lash_appdb_parse_file(file_path, &new_entry_ptr))
+  {
+    return false;
+  }
+
+  if (new_entry_ptr == NULL)
+  {
+    return true;
+  }
+
+  /* check whether entry already exists (first found entries have priority according to XDG Base Directory Specification) */
+  list_for_each(node_ptr, appdb)
+  {
+    entry_ptr = list_entry(node_ptr, struct lash_appdb_entry, siblings);
+
+    if (strcmp(entry_ptr->name, new_entry_ptr->name) == 0)
+    {
+      lash_appdb_free_entry(new_entry_ptr);
+      return true;
+    }
+  }
+
+  /* add entry to appdb list */
+  list_add_tail(&new_entry_ptr->siblings, appdb);
+
+  return true;
+}
+
 bool
 lash_appdb_load_dir(
   struct list_head * appdb,
@@ -724,3 +759,1139 @@ lash_appdb_free(
     lash_appdb_free_entry(entry_ptr);
   }
 }
+
+/***************************************************************************/
+/* Application database index, loaded on first use and kept up to date
+ * through inotify. The parsed LASH entries of the application directories
+ * are cached on disk, directories with unchanged mtime are not rescanned
+ * and files with unchanged mtime and size are not parsed again. */
+
+#define LADISH_APPDB_CACHE_FILENAME "/appdb.cache"
+#define LADISH_APPDB_CACHE_MAGIC "LADAPDB2"
+#define LADISH_APPDB_CACHE_SAVE_DELAY 2000 /* milliseconds */
+#define LADISH_APPDB_NAME_HASH_SIZE 64
+#define LADISH_APPDB_INOTIFY_MASK (IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)
+
+#define LADISH_APPDB_CACHE_NULL_STRING ((uint32_t)-1)
+
+/* the string members of struct lash_appdb_entry, in cache order */
+static const size_t g_appdb_cache_strings[] =
+{
+  offsetof(struct lash_appdb_entry, name),
+  offsetof(struct lash_appdb_entry, generic_name),
+  offsetof(struct lash_appdb_entry, comment),
+  offsetof(struct lash_appdb_entry, icon),
+  offsetof(struct lash_appdb_entry, exec),
+  offsetof(struct lash_appdb_entry, path),
+};
+
+struct ladish_appdb_file
+{
+  struct list_head siblings;       /* in ladish_appdb_dir::files */
+  struct hlist_node name_siblings; /* in g_appdb.names, if not shadowed by other entry with same name */
+  char * filename;
+  struct timespec mtime;
+  uint64_t size;
+  struct lash_appdb_entry * entry; /* NULL if the file is not a LASH application */
+};
+
+struct ladish_appdb_dir
+{
+  struct list_head siblings;
+  char * path;
+  struct timespec mtime;        /* zero if the directory does not exist */
+  int wd;                       /* inotify watch descriptor, -1 if not watched */
+  bool scanned;
+  struct list_head files;
+};
+
+static struct
+{
+  bool loaded;
+  bool loading;                 /* directories are being scanned by ladish_appdb_load_task() */
+  bool dirty;                   /* cache is to be saved when loading is complete */
+  bool index_valid;
+  int inotify_fd;
+  char * cache_path;
+  struct list_head dirs;        /* in XDG priority order */
+  struct hlist_head names[LADISH_APPDB_NAME_HASH_SIZE];
+} g_appdb;
+
+static void ladish_appdb_file_destroy(struct ladish_appdb_file * file_ptr)
+{
+  list_del(&file_ptr->siblings);
+  hlist_del_init(&file_ptr->name_siblings);
+  if (file_ptr->entry != NULL)
+  {
+    lash_appdb_free_entry(file_ptr->entry);
+  }
+
+  free(file_ptr->filename);
+  free(file_ptr);
+}
+
+static
+struct ladish_appdb_file *
+ladish_appdb_file_create(
+  struct ladish_appdb_dir * dir_ptr,
+  const char * filename,
+  const struct timespec * mtime_ptr,
+  uint64_t size,
+  struct lash_appdb_entry * entry_ptr)
+{
+  struct ladish_appdb_file * file_ptr;
+
+  file_ptr = malloc(sizeof(struct ladish_appdb_file));
+  if (file_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate struct ladish_appdb_file");
+    return NULL;
+  }
+
+  file_ptr->filename = strdup(filename);
+  if (file_ptr->filename == NULL)
+  {
+    log_error("strdup() failed for appdb filename '%s'", filename);
+    free(file_ptr);
+    return NULL;
+  }
+
+  file_ptr->mtime = *mtime_ptr;
+  file_ptr->size = size;
+  file_ptr->entry = entry_ptr;
+  INIT_HLIST_NODE(&file_ptr->name_siblings);
+  list_add_tail(&file_ptr->siblings, &dir_ptr->files);
+  g_appdb.index_valid = false;
+
+  return file_ptr;
+}
+
+static void ladish_appdb_dir_clear(struct ladish_appdb_dir * dir_ptr)
+{
+  while (!list_empty(&dir_ptr->files))
+  {
+    ladish_appdb_file_destroy(list_entry(dir_ptr->files.next, struct ladish_appdb_file, siblings));
+  }
+
+  dir_ptr->scanned = false;
+  g_appdb.index_valid = false;
+}
+
+static void ladish_appdb_dir_stat(struct ladish_appdb_dir * dir_ptr)
+{
+  struct stat st;
+
+  if (stat(dir_ptr->path, &st) != 0 || !S_ISDIR(st.st_mode))
+  {
+    dir_ptr->mtime.tv_sec = 0;
+    dir_ptr->mtime.tv_nsec = 0;
+    return;
+  }
+
+  dir_ptr->mtime = st.st_mtim;
+}
+
+static void ladish_appdb_dir_remove_file(struct ladish_appdb_dir * dir_ptr, const char * filename)
+{
+  struct list_head * node_ptr;
+  struct ladish_appdb_file * file_ptr;
+
+  list_for_each(node_ptr, &dir_ptr->files)
+  {
+    file_ptr = list_entry(node_ptr, struct ladish_appdb_file, siblings);
+    if (strcmp(file_ptr->filename, filename) == 0)
+    {
+      ladish_appdb_file_destroy(file_ptr);
+      return;
+    }
+  }
+}
+
+/* stat the file in the appdb dir, returns false if it is not a regular file */
+static bool ladish_appdb_dir_stat_file(struct ladish_appdb_dir * dir_ptr, const char * filename, struct stat * st_ptr)
+{
+  char * file_path;
+  bool ret;
+
+  file_path = catdup3(dir_ptr->path, "/", filename);
+  if (file_path == NULL)
+  {
+    log_error("catdup3() failed to compose the appdb file path");
+    return false;
+  }
+
+  ret = stat(file_path, st_ptr) == 0 && S_ISREG(st_ptr->st_mode);
+
+  free(file_path);
+  return ret;
+}
+
+/* Files that are not LASH applications are remembered too,
+ * so the cache knows they don't need to be parsed again */
+static bool ladish_appdb_dir_load_file(struct ladish_appdb_dir * dir_ptr, const char * filename)
+{
+  char * file_path;
+  struct stat st;
+  struct lash_appdb_entry * entry_ptr;
+  bool ret;
+
+  file_path = catdup3(dir_ptr->path, "/", filename);
+  if (file_path == NULL)
+  {
+    log_error("catdup3() failed to compose the appdb file path");
+    return false;
+  }
+
+  /* stat before parsing, a change made meanwhile will come through inotify */
+  ret = stat(file_path, &st) == 0 && lash_appdb_parse_file(file_path, &entry_ptr);
+  if (ret && ladish_appdb_file_create(dir_ptr, filename, &st.st_mtim, st.st_size, entry_ptr) == NULL)
+  {
+    if (entry_ptr != NULL)
+    {
+      lash_appdb_free_entry(entry_ptr);
+    }
+
+    ret = false;
+  }
+
+  free(file_path);
+  return ret;
+}
+
+static void ladish_appdb_dir_scan(struct ladish_appdb_dir * dir_ptr)
+{
+  DIR * dir;
+  struct dirent * dentry_ptr;
+
+  ladish_appdb_dir_clear(dir_ptr);
+  dir_ptr->scanned = true;
+
+  //log_info("Scanning directory '%s'", dir_ptr->path);
+
+  dir = opendir(dir_ptr->path);
+  if (dir == NULL)
+  {
+    return;
+  }
+
+  while ((dentry_ptr = readdir(dir)) != NULL)
+  {
+    if (dentry_ptr->d_type != DT_REG)
+    {
+      continue;
+    }
+
+    if (!suffix_match(dentry_ptr->d_name, ".desktop"))
+    {
+      continue;
+    }
+
+    ladish_appdb_dir_load_file(dir_ptr, dentry_ptr->d_name);
+  }
+
+  closedir(dir);
+}
+
+static bool ladish_appdb_add_dir(const char * base_directory, size_t len)
+{
+  struct ladish_appdb_dir * dir_ptr;
+  struct list_head * node_ptr;
+
+  /* strip trailing slashes */
+  while (len > 1 && base_directory[len - 1] == '/')
+  {
+    len--;
+  }
+
+  if (len == 0)
+  {
+    return true;
+  }
+
+  dir_ptr = malloc(sizeof(struct ladish_appdb_dir));
+  if (dir_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate struct ladish_appdb_dir");
+    return false;
+  }
+
+  dir_ptr->path = malloc(len + sizeof("/applications"));
+  if (dir_ptr->path == NULL)
+  {
+    log_error("malloc() failed to allocate appdb dir path");
+    free(dir_ptr);
+    return false;
+  }
+
+  memcpy(dir_ptr->path, base_directory, len);
+  strcpy(dir_ptr->path + len, "/applications");
+
+  /* same directory listed twice */
+  list_for_each(node_ptr, &g_appdb.dirs)
+  {
+    if (strcmp(list_entry(node_ptr, struct ladish_appdb_dir, siblings)->path, dir_ptr->path) == 0)
+    {
+      free(dir_ptr->path);
+      free(dir_ptr);
+      return true;
+    }
+  }
+
+  INIT_LIST_HEAD(&dir_ptr->files);
+  dir_ptr->scanned = false;
+
+  /* watch before stat and scan, so no change is missed */
+  dir_ptr->wd = inotify_add_watch(g_appdb.inotify_fd, dir_ptr->path, LADISH_APPDB_INOTIFY_MASK | IN_ONLYDIR);
+  ladish_appdb_dir_stat(dir_ptr);
+
+  list_add_tail(&dir_ptr->siblings, &g_appdb.dirs);
+  return true;
+}
+
+static bool ladish_appdb_add_dirs(void)
+{
+  const char * home_dir;
+  const char * data_home;
+  const char * data_dirs;
+  const char * limiter;
+  char * data_home_default;
+  bool ret;
+
+  home_dir = getenv("HOME");
+  if (home_dir == NULL)
+  {
+    log_error("HOME environment variable is not set.");
+    return false;
+  }
+
+  data_home_default = catdup(home_dir, "/.local/share");
+  if (data_home_default == NULL)
+  {
+    log_error("catdup failed to compose data_home_default");
+    return false;
+  }
+
+  data_home = get_xdg_var("XDG_DATA_HOME", data_home_default);
+  ret = ladish_appdb_add_dir(data_home, strlen(data_home));
+
+  data_dirs = get_xdg_var("XDG_DATA_DIRS", "/usr/local/share/:/usr/share/");
+  while (ret)
+  {
+    limiter = strchr(data_dirs, ':');
+    if (limiter == NULL)
+    {
+      ret = ladish_appdb_add_dir(data_dirs, strlen(data_dirs));
+      break;
+    }
+
+    ret = ladish_appdb_add_dir(data_dirs, limiter - data_dirs);
+    data_dirs = limiter + 1;
+  }
+
+  free(data_home_default);
+  return ret;
+}
+
+static struct ladish_appdb_dir * ladish_appdb_find_dir_by_path(const char * path, size_t len)
+{
+  struct list_head * node_ptr;
+  struct ladish_appdb_dir * dir_ptr;
+
+  list_for_each(node_ptr, &g_appdb.dirs)
+  {
+    dir_ptr = list_entry(node_ptr, struct ladish_appdb_dir, siblings);
+    if (strlen(dir_ptr->path) == len && memcmp(dir_ptr->path, path, len) == 0)
+    {
+      return dir_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+static struct ladish_appdb_dir * ladish_appdb_find_dir_by_wd(int wd)
+{
+  struct list_head * node_ptr;
+  struct ladish_appdb_dir * dir_ptr;
+
+  list_for_each(node_ptr, &g_appdb.dirs)
+  {
+    dir_ptr = list_entry(node_ptr, struct ladish_appdb_dir, siblings);
+    if (dir_ptr->wd == wd)
+    {
+      return dir_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+/***************************************************************************/
+/* on-disk cache
+ *
+ * magic, then for each directory:
+ *   string path, u64 mtime seconds, u64 mtime nanoseconds, u32 file count
+ *   and for each file: string filename, u64 mtime seconds, u64 mtime nanoseconds, u64 size,
+ *   then the entry strings and u8 terminal; files that are not LASH
+ *   applications have a missing name string and nothing after it
+ * strings are u32 length followed by the bytes without terminating nul,
+ * missing strings have length LADISH_APPDB_CACHE_NULL_STRING.
+ * Numbers are in native byte order, the cache is not meant to be portable. */
+
+struct ladish_appdb_cache_reader
+{
+  const char * ptr;
+  size_t left;
+  bool stale;                   /* some of the files were parsed again */
+};
+
+static bool ladish_appdb_cache_read(struct ladish_appdb_cache_reader * reader_ptr, void * data, size_t size)
+{
+  if (reader_ptr->left < size)
+  {
+    return false;
+  }
+
+  memcpy(data, reader_ptr->ptr, size);
+  reader_ptr->ptr += size;
+  reader_ptr->left -= size;
+  return true;
+}
+
+/* the string points into the mapping and is not nul terminated */
+static bool ladish_appdb_cache_read_string(struct ladish_appdb_cache_reader * reader_ptr, const char ** str_ptr, uint32_t * len_ptr)
+{
+  if (!ladish_appdb_cache_read(reader_ptr, len_ptr, sizeof(uint32_t)))
+  {
+    return false;
+  }
+
+  if (*len_ptr == LADISH_APPDB_CACHE_NULL_STRING)
+  {
+    *str_ptr = NULL;
+    return true;
+  }
+
+  if (reader_ptr->left < *len_ptr)
+  {
+    return false;
+  }
+
+  *str_ptr = reader_ptr->ptr;
+  reader_ptr->ptr += *len_ptr;
+  reader_ptr->left -= *len_ptr;
+  return true;
+}
+
+static bool ladish_appdb_cache_read_strdup(struct ladish_appdb_cache_reader * reader_ptr, char ** str_ptr)
+{
+  const char * str;
+  uint32_t len;
+
+  if (!ladish_appdb_cache_read_string(reader_ptr, &str, &len))
+  {
+    return false;
+  }
+
+  if (str == NULL)
+  {
+    *str_ptr = NULL;
+    return true;
+  }
+
+  *str_ptr = strndup(str, len);
+  if (*str_ptr == NULL)
+  {
+    log_error("strndup() failed for appdb cache string");
+    return false;
+  }
+
+  return true;
+}
+
+/* When check is true, the file is parsed again if its mtime or size changed since the cache was written */
+static
+bool
+ladish_appdb_cache_read_file(
+  struct ladish_appdb_cache_reader * reader_ptr,
+  struct ladish_appdb_dir * dir_ptr,
+  bool check)
+{
+  struct lash_appdb_entry * entry_ptr;
+  char * filename;
+  uint64_t mtime_sec;
+  uint64_t mtime_nsec;
+  uint64_t size;
+  struct timespec mtime;
+  struct stat st;
+  uint8_t terminal;
+  size_t i;
+
+  if (!ladish_appdb_cache_read_strdup(reader_ptr, &filename) || filename == NULL)
+  {
+    return false;
+  }
+
+  if (!ladish_appdb_cache_read(reader_ptr, &mtime_sec, sizeof(mtime_sec)) ||
+      !ladish_appdb_cache_read(reader_ptr, &mtime_nsec, sizeof(mtime_nsec)) ||
+      !ladish_appdb_cache_read(reader_ptr, &size, sizeof(size)))
+  {
+    goto free_filename;
+  }
+
+  entry_ptr = calloc(1, sizeof(struct lash_appdb_entry));
+  if (entry_ptr == NULL)
+  {
+    log_error("calloc() failed to allocate struct lash_appdb_entry");
+    goto free_filename;
+  }
+
+  for (i = 0; i < sizeof(g_appdb_cache_strings) / sizeof(g_appdb_cache_strings[0]); i++)
+  {
+    if (!ladish_appdb_cache_read_strdup(reader_ptr, (char **)((char *)entry_ptr + g_appdb_cache_strings[i])))
+    {
+      goto free_entry;
+    }
+
+    if (i == 0 && entry_ptr->name == NULL)
+    {
+      /* not a LASH application */
+      lash_appdb_free_entry(entry_ptr);
+      entry_ptr = NULL;
+      break;
+    }
+  }
+
+  if (entry_ptr != NULL)
+  {
+    if (!ladish_appdb_cache_read(reader_ptr, &terminal, sizeof(terminal)))
+    {
+      goto free_entry;
+    }
+
+    entry_ptr->terminal = terminal != 0;
+  }
+
+  if (check &&
+      (!ladish_appdb_dir_stat_file(dir_ptr, filename, &st) ||
+       (uint64_t)st.st_mtim.tv_sec != mtime_sec ||
+       (uint64_t)st.st_mtim.tv_nsec != mtime_nsec ||
+       (uint64_t)st.st_size != size))
+  {
+    if (entry_ptr != NULL)
+    {
+      lash_appdb_free_entry(entry_ptr);
+    }
+
+    /* modified in place, the directory mtime does not change for this */
+    ladish_appdb_dir_load_file(dir_ptr, filename);
+    reader_ptr->stale = true;
+    free(filename);
+    return true;
+  }
+
+  mtime.tv_sec = mtime_sec;
+  mtime.tv_nsec = mtime_nsec;
+
+  if (ladish_appdb_file_create(dir_ptr, filename, &mtime, size, entry_ptr) == NULL)
+  {
+    goto free_entry;
+  }
+
+  free(filename);
+  return true;
+
+free_entry:
+  if (entry_ptr != NULL)
+  {
+    lash_appdb_free_entry(entry_ptr);
+  }
+free_filename:
+  free(filename);
+  return false;
+}
+
+/* returns true if the cache is out of date and needs to be written again */
+static bool ladish_appdb_cache_load(void)
+{
+  int fd;
+  struct stat st;
+  void * map;
+  struct ladish_appdb_cache_reader reader;
+  struct ladish_appdb_dir * dir_ptr;
+  struct ladish_appdb_dir skipped_dir;
+  const char * path;
+  uint32_t path_len;
+  uint64_t mtime_sec;
+  uint64_t mtime_nsec;
+  uint32_t count;
+  char magic[sizeof(LADISH_APPDB_CACHE_MAGIC) - 1];
+  struct list_head * node_ptr;
+
+  fd = open(g_appdb.cache_path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1)
+  {
+    return false;
+  }
+
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+  {
+    log_error("mmap() failed for appdb cache '%s'. errno = %d (%s)", g_appdb.cache_path, errno, strerror(errno));
+    return false;
+  }
+
+  reader.ptr = map;
+  reader.left = st.st_size;
+  reader.stale = false;
+
+  if (!ladish_appdb_cache_read(&reader, magic, sizeof(magic)) ||
+      memcmp(magic, LADISH_APPDB_CACHE_MAGIC, sizeof(magic)) != 0)
+  {
+    log_info("ignoring appdb cache with unknown format");
+    goto unmap;
+  }
+
+  /* entries of directories that changed since the cache was written are read in a dummy dir */
+  INIT_LIST_HEAD(&skipped_dir.files);
+
+  while (reader.left > 0)
+  {
+    if (!ladish_appdb_cache_read_string(&reader, &path, &path_len) || path == NULL ||
+        !ladish_appdb_cache_read(&reader, &mtime_sec, sizeof(mtime_sec)) ||
+        !ladish_appdb_cache_read(&reader, &mtime_nsec, sizeof(mtime_nsec)) ||
+        !ladish_appdb_cache_read(&reader, &count, sizeof(count)))
+    {
+      goto corrupt;
+    }
+
+    dir_ptr = ladish_appdb_find_dir_by_path(path, path_len);
+    if (dir_ptr == NULL ||
+        dir_ptr->scanned ||
+        dir_ptr->mtime.tv_sec == 0 ||
+        (uint64_t)dir_ptr->mtime.tv_sec != mtime_sec ||
+        (uint64_t)dir_ptr->mtime.tv_nsec != mtime_nsec)
+    {
+      dir_ptr = &skipped_dir;
+    }
+    else
+    {
+      dir_ptr->scanned = true;
+    }
+
+    while (count > 0)
+    {
+      if (!ladish_appdb_cache_read_file(&reader, dir_ptr, dir_ptr != &skipped_dir))
+      {
+        goto corrupt;
+      }
+
+      count--;
+    }
+
+    ladish_appdb_dir_clear(&skipped_dir);
+  }
+
+  goto unmap;
+
+corrupt:
+  log_error("appdb cache '%s' is corrupt, ignoring it", g_appdb.cache_path);
+  ladish_appdb_dir_clear(&skipped_dir);
+  list_for_each(node_ptr, &g_appdb.dirs)
+  {
+    ladish_appdb_dir_clear(list_entry(node_ptr, struct ladish_appdb_dir, siblings));
+  }
+
+unmap:
+  munmap(map, st.st_size);
+  return reader.stale;
+}
+
+static bool ladish_appdb_cache_write_string(int fd, const char * str)
+{
+  uint32_t len;
+
+  len = str != NULL ? strlen(str) : LADISH_APPDB_CACHE_NULL_STRING;
+
+  return
+    ladish_write_data(fd, &len, sizeof(len)) &&
+    (str == NULL || ladish_write_data(fd, str, len));
+}
+
+static bool ladish_appdb_cache_write_dir(int fd, struct ladish_appdb_dir * dir_ptr)
+{
+  struct list_head * node_ptr;
+  struct ladish_appdb_file * file_ptr;
+  uint64_t mtime_sec;
+  uint64_t mtime_nsec;
+  uint32_t count;
+  uint8_t terminal;
+  size_t i;
+
+  mtime_sec = dir_ptr->mtime.tv_sec;
+  mtime_nsec = dir_ptr->mtime.tv_nsec;
+
+  count = 0;
+  list_for_each(node_ptr, &dir_ptr->files)
+  {
+    count++;
+  }
+
+  if (!ladish_appdb_cache_write_string(fd, dir_ptr->path) ||
+      !ladish_write_data(fd, &mtime_sec, sizeof(mtime_sec)) ||
+      !ladish_write_data(fd, &mtime_nsec, sizeof(mtime_nsec)) ||
+      !ladish_write_data(fd, &count, sizeof(count)))
+  {
+    return false;
+  }
+
+  list_for_each(node_ptr, &dir_ptr->files)
+  {
+    file_ptr = list_entry(node_ptr, struct ladish_appdb_file, siblings);
+
+    mtime_sec = file_ptr->mtime.tv_sec;
+    mtime_nsec = file_ptr->mtime.tv_nsec;
+
+    if (!ladish_appdb_cache_write_string(fd, file_ptr->filename) ||
+        !ladish_write_data(fd, &mtime_sec, sizeof(mtime_sec)) ||
+        !ladish_write_data(fd, &mtime_nsec, sizeof(mtime_nsec)) ||
+        !ladish_write_data(fd, &file_ptr->size, sizeof(file_ptr->size)))
+    {
+      return false;
+    }
+
+    if (file_ptr->entry == NULL)
+    {
+      if (!ladish_appdb_cache_write_string(fd, NULL))
+      {
+        return false;
+      }
+
+      continue;
+    }
+
+    for (i = 0; i < sizeof(g_appdb_cache_strings) / sizeof(g_appdb_cache_strings[0]); i++)
+    {
+      if (!ladish_appdb_cache_write_string(fd, *(char **)((char *)file_ptr->entry + g_appdb_cache_strings[i])))
+      {
+        return false;
+      }
+    }
+
+    terminal = file_ptr->entry->terminal ? 1 : 0;
+    if (!ladish_write_data(fd, &terminal, sizeof(terminal)))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void ladish_appdb_cache_save(void * UNUSED(context))
+{
+  struct list_head * node_ptr;
+  struct ladish_appdb_dir * dir_ptr;
+  int fd;
+  bool success;
+
+  if (!ladish_write_open(g_appdb.cache_path, &fd))
+  {
+    return;
+  }
+
+  success = ladish_write_data(fd, LADISH_APPDB_CACHE_MAGIC, sizeof(LADISH_APPDB_CACHE_MAGIC) - 1);
+
+  list_for_each(node_ptr, &g_appdb.dirs)
+  {
+    dir_ptr = list_entry(node_ptr, struct ladish_appdb_dir, siblings);
+
+    /* the mtime must describe the entries being written */
+    ladish_appdb_dir_stat(dir_ptr);
+
+    /* don't cache missing dirs, they have no mtime */
+    if (success && dir_ptr->mtime.tv_sec != 0)
+    {
+      success = ladish_appdb_cache_write_dir(fd, dir_ptr);
+    }
+  }
+
+  ladish_write_close(fd, success, false);
+}
+
+static void ladish_appdb_cache_schedule_save(void)
+{
+  /* restart the delay, a merged post would keep the earlier deadline */
+  ladish_reactor_cancel(NULL, ladish_appdb_cache_save);
+  ladish_reactor_post_delayed(NULL, ladish_appdb_cache_save, LADISH_APPDB_CACHE_SAVE_DELAY);
+}
+
+/***************************************************************************/
+
+static struct ladish_appdb_file * ladish_appdb_find_indexed(const char * name)
+{
+  struct ladish_appdb_file * file_ptr;
+  struct hlist_node * node_ptr;
+
+  hlist_for_each_entry(file_ptr, node_ptr, g_appdb.names + ladish_hash_str(name) % LADISH_APPDB_NAME_HASH_SIZE, name_siblings)
+  {
+    if (strcmp(file_ptr->entry->name, name) == 0)
+    {
+      return file_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+static void ladish_appdb_build_index(void)
+{
+  struct list_head * dir_node_ptr;
+  struct list_head * file_node_ptr;
+  struct ladish_appdb_dir * dir_ptr;
+  struct ladish_appdb_file * file_ptr;
+  unsigned int i;
+
+  if (g_appdb.index_valid)
+  {
+    return;
+  }
+
+  for (i = 0; i < LADISH_APPDB_NAME_HASH_SIZE; i++)
+  {
+    while (!hlist_empty(g_appdb.names + i))
+    {
+      hlist_del_init(g_appdb.names[i].first);
+    }
+  }
+
+  /* first found entries have priority according to XDG Base Directory Specification */
+  list_for_each(dir_node_ptr, &g_appdb.dirs)
+  {
+    dir_ptr = list_entry(dir_node_ptr, struct ladish_appdb_dir, siblings);
+    list_for_each(file_node_ptr, &dir_ptr->files)
+    {
+      file_ptr = list_entry(file_node_ptr, struct ladish_appdb_file, siblings);
+      if (file_ptr->entry != NULL && ladish_appdb_find_indexed(file_ptr->entry->name) == NULL)
+      {
+        hlist_add_head(
+          &file_ptr->name_siblings,
+          g_appdb.names + ladish_hash_str(file_ptr->entry->name) % LADISH_APPDB_NAME_HASH_SIZE);
+      }
+    }
+  }
+
+  g_appdb.index_valid = true;
+}
+
+static void ladish_appdb_on_inotify(void * UNUSED(context), int fd, uint32_t UNUSED(events))
+{
+  char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  const struct inotify_event * event_ptr;
+  struct ladish_appdb_dir * dir_ptr;
+  struct list_head * node_ptr;
+  ssize_t size;
+  char * ptr;
+  bool changed;
+
+  changed = false;
+
+  while ((size = read(fd, buffer, sizeof(buffer))) > 0)
+  {
+    for (ptr = buffer; ptr < buffer + size; ptr += sizeof(struct inotify_event) + event_ptr->len)
+    {
+      event_ptr = (const struct inotify_event *)ptr;
+
+      if ((event_ptr->mask & IN_Q_OVERFLOW) != 0)
+      {
+        log_info("appdb inotify queue overflow, rescanning");
+        list_for_each(node_ptr, &g_appdb.dirs)
+        {
+          ladish_appdb_dir_scan(list_entry(node_ptr, struct ladish_appdb_dir, siblings));
+        }
+
+        changed = true;
+        continue;
+      }
+
+      dir_ptr = ladish_appdb_find_dir_by_wd(event_ptr->wd);
+      if (dir_ptr == NULL)
+      {
+        continue;
+      }
+
+      if ((event_ptr->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) != 0)
+      {
+        log_info("appdb directory '%s' is gone", dir_ptr->path);
+        if ((event_ptr->mask & IN_IGNORED) == 0)
+        {
+          inotify_rm_watch(fd, dir_ptr->wd);
+        }
+
+        dir_ptr->wd = -1;
+        ladish_appdb_dir_clear(dir_ptr);
+        changed = true;
+        continue;
+      }
+
+      if (event_ptr->len == 0 || !suffix_match(event_ptr->name, ".desktop"))
+      {
+        continue;
+      }
+
+      //log_info("appdb file '%s/%s' changed (0x%"PRIx32")", dir_ptr->path, event_ptr->name, event_ptr->mask);
+
+      ladish_appdb_dir_remove_file(dir_ptr, event_ptr->name);
+      if ((event_ptr->mask & (IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO)) != 0)
+      {
+        ladish_appdb_dir_load_file(dir_ptr, event_ptr->name);
+      }
+
+      changed = true;
+    }
+  }
+
+  if (changed)
+  {
+    g_appdb.index_valid = false;
+    ladish_appdb_cache_schedule_save();
+  }
+}
+
+static void ladish_appdb_unload(void)
+{
+  struct ladish_appdb_dir * dir_ptr;
+
+  ladish_reactor_cancel(NULL, ladish_appdb_cache_save);
+
+  while (!list_empty(&g_appdb.dirs))
+  {
+    dir_ptr = list_entry(g_appdb.dirs.next, struct ladish_appdb_dir, siblings);
+    list_del(&dir_ptr->siblings);
+    ladish_appdb_dir_clear(dir_ptr);
+    free(dir_ptr->path);
+    free(dir_ptr);
+  }
+
+  if (g_appdb.inotify_fd != -1)
+  {
+    ladish_reactor_remove_fd(g_appdb.inotify_fd);
+    close(g_appdb.inotify_fd);
+    g_appdb.inotify_fd = -1;
+  }
+
+  g_appdb.index_valid = false;
+  g_appdb.loading = false;
+  g_appdb.loaded = false;
+}
+
+/* watch the directories and read the cache, directories not valid in the cache are scanned later */
+static bool ladish_appdb_load_begin(void)
+{
+  g_appdb.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (g_appdb.inotify_fd == -1)
+  {
+    log_error("inotify_init1() failed. errno = %d (%s)", errno, strerror(errno));
+    return false;
+  }
+
+  if (!ladish_reactor_add_fd(g_appdb.inotify_fd, EPOLLIN, NULL, ladish_appdb_on_inotify))
+  {
+    goto close_fd;
+  }
+
+  if (!ladish_appdb_add_dirs())
+  {
+    goto uninit;
+  }
+
+  g_appdb.dirty = ladish_appdb_cache_load();
+  g_appdb.loading = true;
+  return true;
+
+uninit:
+  ladish_appdb_unload();
+  return false;
+
+close_fd:
+  close(g_appdb.inotify_fd);
+  g_appdb.inotify_fd = -1;
+  return false;
+}
+
+/* scan one directory that was not valid in the cache, returns false when there are no more */
+static bool ladish_appdb_load_step(void)
+{
+  struct list_head * node_ptr;
+  struct ladish_appdb_dir * dir_ptr;
+
+  list_for_each(node_ptr, &g_appdb.dirs)
+  {
+    dir_ptr = list_entry(node_ptr, struct ladish_appdb_dir, siblings);
+    if (!dir_ptr->scanned)
+    {
+      ladish_appdb_dir_scan(dir_ptr);
+      g_appdb.dirty = g_appdb.dirty || dir_ptr->mtime.tv_sec != 0;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static void ladish_appdb_load_end(void)
+{
+  if (g_appdb.dirty)
+  {
+    ladish_appdb_cache_save(NULL);
+    g_appdb.dirty = false;
+  }
+
+  g_appdb.index_valid = false;
+  g_appdb.loading = false;
+  g_appdb.loaded = true;
+}
+
+/* Load in the background, one directory per main loop iteration */
+static void ladish_appdb_load_task(void * UNUSED(context))
+{
+  if (g_appdb.loaded)
+  {
+    return;
+  }
+
+  if (!g_appdb.loading && !ladish_appdb_load_begin())
+  {
+    log_error("appdb load failed, it will be retried on first use");
+    return;
+  }
+
+  if (ladish_appdb_load_step())
+  {
+    ladish_reactor_post(NULL, ladish_appdb_load_task);
+    return;
+  }
+
+  ladish_appdb_load_end();
+  log_info("appdb loaded");
+}
+
+/* finish the background load synchronously, if it is not complete yet */
+static bool ladish_appdb_ensure_loaded(void)
+{
+  if (g_appdb.loaded)
+  {
+    return true;
+  }
+
+  ladish_reactor_cancel(NULL, ladish_appdb_load_task);
+
+  if (!g_appdb.loading && !ladish_appdb_load_begin())
+  {
+    return false;
+  }
+
+  while (ladish_appdb_load_step());
+
+  ladish_appdb_load_end();
+  return true;
+}
+
+bool ladish_appdb_init(void)
+{
+  unsigned int i;
+
+  g_appdb.loaded = false;
+  g_appdb.loading = false;
+  g_appdb.dirty = false;
+  g_appdb.index_valid = false;
+  g_appdb.inotify_fd = -1;
+  INIT_LIST_HEAD(&g_appdb.dirs);
+  for (i = 0; i < LADISH_APPDB_NAME_HASH_SIZE; i++)
+  {
+    INIT_HLIST_HEAD(g_appdb.names + i);
+  }
+
+  g_appdb.cache_path = catdup(g_base_dir, LADISH_APPDB_CACHE_FILENAME);
+  if (g_appdb.cache_path == NULL)
+  {
+    log_error("catdup() failed to compose appdb cache path");
+    return false;
+  }
+
+  if (!ladish_reactor_post(NULL, ladish_appdb_load_task))
+  {
+    log_error("appdb will be loaded on first use");
+  }
+
+  return true;
+}
+
+void ladish_appdb_uninit(void)
+{
+  ladish_reactor_cancel(NULL, ladish_appdb_load_task);
+  ladish_appdb_unload();
+  free(g_appdb.cache_path);
+  g_appdb.cache_path = NULL;
+}
+
+bool
+ladish_appdb_iterate(
+  void * context,
+  bool (* callback)(void * context, const struct lash_appdb_entry * entry_ptr))
+{
+  struct list_head * dir_node_ptr;
+  struct list_head * file_node_ptr;
+  struct ladish_appdb_file * file_ptr;
+
+  if (!ladish_appdb_ensure_loaded())
+  {
+    return false;
+  }
+
+  ladish_appdb_build_index();
+
+  list_for_each(dir_node_ptr, &g_appdb.dirs)
+  {
+    list_for_each(file_node_ptr, &list_entry(dir_node_ptr, struct ladish_appdb_dir, siblings)->files)
+    {
+      file_ptr = list_entry(file_node_ptr, struct ladish_appdb_file, siblings);
+
+      /* skip shadowed entries */
+      if (hlist_unhashed(&file_ptr->name_siblings))
+      {
+        continue;
+      }
+
+      if (!callback(context, file_ptr->entry))
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+const struct lash_appdb_entry * ladish_appdb_find(const char * name)
+{
+  struct ladish_appdb_file * file_ptr;
+
+  /* never block the caller with the load */
+  if (!g_appdb.loaded)
+  {
+    return NULL;
+  }
+
+  ladish_appdb_build_index();
+
+  file_ptr = ladish_appdb_find_indexed(name);
+  return file_ptr != NULL ? file_ptr->entry : NULL;
+}
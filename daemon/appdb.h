@@ -54,4 +54,23 @@ void
 lash_appdb_free(
   struct list_head * appdb);
 
+/* Application database kept loaded in the daemon. Init schedules the load,
+ * the cache is read and the XDG directories that are not valid in it are
+ * scanned from the main loop, one directory per iteration. Afterwards the
+ * database is kept up to date through inotify. */
+bool ladish_appdb_init(void);
+void ladish_appdb_uninit(void);
+
+/* Iterate entries, skipping ones shadowed by same-named entries in higher priority directories.
+ * Returns false if callback returned false or the database could not be loaded. */
+bool
+ladish_appdb_iterate(
+  void * context,
+  bool (* callback)(void * context, const struct lash_appdb_entry * entry_ptr));
+
+/* Find the entry with the given name through the name index.
+ * Returns NULL if not found or if the database is not loaded yet.
+ * The entry is valid until the next main loop iteration. */
+const struct lash_appdb_entry * ladish_appdb_find(const char * name);
+
 #endif /* #ifndef APPDB_H__4839D031_68EF_43F5_BDE2_2317C6B956A9__INCLUDED */
@@ -25,12 +25,41 @@
  */
 
 #include <unistd.h>             /* usleep() */
+#include "check_integrity.h"
 #include "studio.h"
 #include "../proxies/notify_proxy.h"
+#include "../common/hash.h"
+
+#define LADISH_CHECK_INTEGRITY_DIRTY_BUCKETS 64
+
+/* uuid of a port that was added, removed or moved between vgraphs since the last check.
+ * Ports are refcounted and may be gone by the time of the check, so only the uuid is kept. */
+struct ladish_check_integrity_dirty_port
+{
+  struct list_head siblings;
+  struct hlist_node hash_siblings;
+  uuid_t uuid;
+};
+
+struct ladish_check_integrity
+{
+  bool full_sweep;
+  bool sweep_pending;           /* dirty set is not reliable, do a full sweep on next check */
+  struct list_head dirty_ports;
+  struct hlist_head dirty_ports_hash[LADISH_CHECK_INTEGRITY_DIRTY_BUCKETS];
+};
+
+static struct ladish_check_integrity g_check_integrity =
+{
+  .full_sweep = false,
+  .sweep_pending = true,
+  .dirty_ports = LIST_HEAD_INIT(g_check_integrity.dirty_ports),
+};
 
 struct ladish_check_vgraph_integrity_context
 {
   ladish_graph_handle jack_graph;
+  const unsigned char * uuid;   /* when not NULL, check only the port with this uuid */
 };
 
 static void ladish_check_integrity_fail(const char * message)
@@ -73,18 +102,18 @@ ladish_check_vgraph_integrity_port_callback(
   char uuid_str[37];
   bool link;
 
-  ladish_port_get_uuid(vport, uuid);
-  uuid_unparse(uuid, uuid_str);
-
   link = ladish_port_is_link(vport);
   if (link)
   {
     return true;
   }
 
+  ladish_port_get_uuid(vport, uuid);
+
   jport = ladish_graph_find_port_by_uuid(ctx_ptr->jack_graph, uuid, false, vgraph);
   if (jport == NULL)
   {
+    uuid_unparse(uuid, uuid_str);
     log_error("vgraph: %s", ladish_graph_get_description(vgraph));
     log_error("client name: %s", client_name);
     log_error("port name: %s", port_name);
@@ -110,36 +139,151 @@ ladish_check_vgraph_integrity_client_end_callback(
   return true;
 }
 
-#undef ctx_ptr
-
 bool
 ladish_check_vgraph_integrity(
   void * context,
   ladish_graph_handle graph,
   ladish_app_supervisor_handle UNUSED(app_supervisor))
 {
-  ladish_graph_iterate_nodes(
-    graph,
+  ladish_port_handle vport;
+  ladish_client_handle vclient;
+
+  if (ctx_ptr->uuid == NULL)
+  {
+    ladish_graph_iterate_nodes(
+      graph,
+      context,
+      ladish_check_vgraph_integrity_client_begin_callback,
+      ladish_check_vgraph_integrity_port_callback,
+      ladish_check_vgraph_integrity_client_end_callback);
+    return true;
+  }
+
+  vport = ladish_graph_find_port_by_uuid(graph, ctx_ptr->uuid, false, NULL);
+  if (vport == NULL)
+  {
+    return true;
+  }
+
+  vclient = ladish_graph_get_port_client(graph, vport);
+  ladish_check_vgraph_integrity_port_callback(
     context,
-    ladish_check_vgraph_integrity_client_begin_callback,
-    ladish_check_vgraph_integrity_port_callback,
-    ladish_check_vgraph_integrity_client_end_callback);
+    graph,
+    false,
+    NULL,
+    vclient,
+    ladish_graph_get_client_name(graph, vclient),
+    vport,
+    ladish_graph_get_port_name(graph, vport),
+    ladish_graph_get_port_type(graph, vport),
+    ladish_graph_get_port_flags(graph, vport));
 
   return true;
 }
 
+#undef ctx_ptr
+
+static void ladish_check_integrity_clear_dirty(void)
+{
+  struct ladish_check_integrity_dirty_port * dirty_ptr;
+
+  while (!list_empty(&g_check_integrity.dirty_ports))
+  {
+    dirty_ptr = list_entry(g_check_integrity.dirty_ports.next, struct ladish_check_integrity_dirty_port, siblings);
+    list_del(&dirty_ptr->siblings);
+    hlist_del(&dirty_ptr->hash_siblings);
+    free(dirty_ptr);
+  }
+}
+
+void ladish_check_integrity_mark_port(ladish_port_handle port_handle)
+{
+  struct ladish_check_integrity_dirty_port * dirty_ptr;
+  struct hlist_node * node_ptr;
+  struct hlist_head * bucket_ptr;
+  uuid_t uuid;
+
+  if (g_check_integrity.full_sweep || g_check_integrity.sweep_pending)
+  {
+    return;
+  }
+
+  ladish_port_get_uuid(port_handle, uuid);
+  bucket_ptr = g_check_integrity.dirty_ports_hash + ladish_hash_data(uuid, sizeof(uuid_t)) % LADISH_CHECK_INTEGRITY_DIRTY_BUCKETS;
+
+  hlist_for_each_entry(dirty_ptr, node_ptr, bucket_ptr, hash_siblings)
+  {
+    if (uuid_compare(dirty_ptr->uuid, uuid) == 0)
+    {
+      return;
+    }
+  }
+
+  dirty_ptr = malloc(sizeof(struct ladish_check_integrity_dirty_port));
+  if (dirty_ptr == NULL)
+  {
+    log_error("malloc() failed for struct ladish_check_integrity_dirty_port, falling back to full integrity sweep");
+    ladish_check_integrity_clear_dirty();
+    g_check_integrity.sweep_pending = true;
+    return;
+  }
+
+  uuid_copy(dirty_ptr->uuid, uuid);
+  list_add_tail(&dirty_ptr->siblings, &g_check_integrity.dirty_ports);
+  hlist_add_head(&dirty_ptr->hash_siblings, bucket_ptr);
+}
+
+void ladish_check_integrity_set_full_sweep(bool full_sweep)
+{
+  if (g_check_integrity.full_sweep == full_sweep)
+  {
+    return;
+  }
+
+  log_info("Integrity check mode: %s", full_sweep ? "full sweep" : "incremental");
+
+  g_check_integrity.full_sweep = full_sweep;
+  ladish_check_integrity_clear_dirty();
+  g_check_integrity.sweep_pending = true;
+}
+
+void ladish_check_integrity_uninit(void)
+{
+  ladish_check_integrity_clear_dirty();
+}
+
 void ladish_check_integrity(void)
 {
   struct ladish_check_vgraph_integrity_context ctx;
+  struct ladish_check_integrity_dirty_port * dirty_ptr;
 
   //ladish_check_integrity_fail("test");
 
   if (!ladish_studio_is_loaded())
   {
+    /* vgraphs are populated before the studio is marked as loaded */
+    ladish_check_integrity_clear_dirty();
+    g_check_integrity.sweep_pending = true;
     return;
   }
 
   ctx.jack_graph = ladish_studio_get_jack_graph();
 
-  ladish_studio_iterate_virtual_graphs(&ctx, ladish_check_vgraph_integrity);
+  if (g_check_integrity.full_sweep || g_check_integrity.sweep_pending)
+  {
+    ctx.uuid = NULL;
+    ladish_studio_iterate_virtual_graphs(&ctx, ladish_check_vgraph_integrity);
+    g_check_integrity.sweep_pending = false;
+    return;
+  }
+
+  while (!list_empty(&g_check_integrity.dirty_ports))
+  {
+    dirty_ptr = list_entry(g_check_integrity.dirty_ports.next, struct ladish_check_integrity_dirty_port, siblings);
+    ctx.uuid = dirty_ptr->uuid;
+    ladish_studio_iterate_virtual_graphs(&ctx, ladish_check_vgraph_integrity);
+    list_del(&dirty_ptr->siblings);
+    hlist_del(&dirty_ptr->hash_siblings);
+    free(dirty_ptr);
+  }
 }
@@ -0,0 +1,41 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2026 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains interface to the code that checks data integrity
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef CHECK_INTEGRITY_H__A3F1C7D2_5E84_4B19_8C6D_0F2E9B7A4D51__INCLUDED
+#define CHECK_INTEGRITY_H__A3F1C7D2_5E84_4B19_8C6D_0F2E9B7A4D51__INCLUDED
+
+#include "port.h"
+
+void ladish_check_integrity_uninit(void);
+
+/* In full sweep mode every vgraph port is verified on each main loop iteration.
+ * Otherwise only the ports marked dirty since the previous check are verified. */
+void ladish_check_integrity_set_full_sweep(bool full_sweep);
+
+/* Called by graphs and ports on mutations that can break the vgraph/JACK graph consistency */
+void ladish_check_integrity_mark_port(ladish_port_handle port_handle);
+
+#endif /* #ifndef CHECK_INTEGRITY_H__A3F1C7D2_5E84_4B19_8C6D_0F2E9B7A4D51__INCLUDED */
@@ -38,6 +38,7 @@ struct ladish_client
   bool has_js_callback;                    /* Whether the client has set jack session callback */
   ladish_dict_handle dict;
   void * vgraph;                /* virtual graph */
+  struct list_head hooks;                  /* struct ladish_client_hook list */
 };
 
 bool
@@ -78,6 +79,7 @@ ladish_client_create(
   client_ptr->pid = 0;
   client_ptr->has_js_callback = false;
   client_ptr->vgraph = NULL;
+  INIT_LIST_HEAD(&client_ptr->hooks);
 
 #if 0
   {
@@ -107,6 +109,7 @@ ladish_client_destroy(
   ladish_client_handle client_handle)
 {
   log_info("client %p destroy", client_ptr);
+  ASSERT(list_empty(&client_ptr->hooks));
 
   ladish_dict_destroy(client_ptr->dict);
   free(client_ptr->jack_name);
@@ -123,10 +126,29 @@ void ladish_client_get_uuid(ladish_client_handle client_handle, uuid_t uuid)
   uuid_copy(uuid, client_ptr->uuid);
 }
 
+void ladish_client_add_hook(ladish_client_handle client_handle, struct ladish_client_hook * hook_ptr)
+{
+  list_add_tail(&hook_ptr->siblings, &client_ptr->hooks);
+}
+
+void ladish_client_del_hook(struct ladish_client_hook * hook_ptr)
+{
+  list_del(&hook_ptr->siblings);
+}
+
 void ladish_client_set_jack_id(ladish_client_handle client_handle, uint64_t jack_id)
 {
+  struct list_head * node_ptr;
+  struct ladish_client_hook * hook_ptr;
+
   log_info("client jack id set to %"PRIu64, jack_id);
   client_ptr->jack_id = jack_id;
+
+  list_for_each(node_ptr, &client_ptr->hooks)
+  {
+    hook_ptr = list_entry(node_ptr, struct ladish_client_hook, siblings);
+    hook_ptr->jack_id_changed(hook_ptr);
+  }
 }
 
 uint64_t ladish_client_get_jack_id(ladish_client_handle client_handle)
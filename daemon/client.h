@@ -31,6 +31,13 @@
 
 typedef struct ladish_client_tag { int unused; } * ladish_client_handle;
 
+/* Hooks let containers that index clients by JACK id (graphs) rehash them when the id changes */
+struct ladish_client_hook
+{
+  struct list_head siblings;
+  void (* jack_id_changed)(struct ladish_client_hook * hook_ptr);
+};
+
 bool
 ladish_client_create(
   const uuid_t uuid_ptr,
@@ -49,6 +56,9 @@ ladish_dict_handle ladish_client_get_dict(ladish_client_handle client_handle);
 
 void ladish_client_get_uuid(ladish_client_handle client_handle, uuid_t uuid);
 
+void ladish_client_add_hook(ladish_client_handle client_handle, struct ladish_client_hook * hook_ptr);
+void ladish_client_del_hook(struct ladish_client_hook * hook_ptr);
+
 void ladish_client_set_jack_id(ladish_client_handle client_handle, uint64_t jack_id);
 uint64_t ladish_client_get_jack_id(ladish_client_handle client_handle);
 
@@ -553,6 +553,18 @@ static void callback_elstart(void * data, const char * el, const char ** attr)
       goto free;
     }
 
+    /* optional, missing in files saved by older versions */
+    if (ladish_get_string_attribute(attr, "start_priority") == NULL)
+    {
+      context_ptr->start_priority = 0;
+    }
+    else if (ladish_get_byte_attribute(attr, "start_priority", &context_ptr->start_priority) == NULL)
+    {
+      log_error("application \"start_priority\" attribute has invalid value. name=\"%s\"", name);
+      context_ptr->error = XML_TRUE;
+      goto free;
+    }
+
     level = ladish_get_string_attribute(attr, "level");
     if (level == NULL)
     {
@@ -674,6 +686,7 @@ free:
 
 static void callback_elend(void * data, const char * UNUSED(el))
 {
+  ladish_app_handle app;
   char * src;
   char * dst;
   char * sep;
@@ -849,18 +862,23 @@ static void callback_elend(void * data, const char * UNUSED(el))
 
     log_info("application '%s' (%s, %s, level '%s') with commandline '%s'", context_ptr->str, context_ptr->terminal ? "terminal" : "shell", context_ptr->autorun ? "autorun" : "stopped", context_ptr->level, context_ptr->data);
 
-    if (ladish_app_supervisor_add(
-          g_studio.app_supervisor,
-          context_ptr->str,
-          context_ptr->uuid,
-          context_ptr->autorun,
-          context_ptr->data,
-          context_ptr->terminal,
-          context_ptr->level) == NULL)
+    app = ladish_app_supervisor_add(
+      g_studio.app_supervisor,
+      context_ptr->str,
+      context_ptr->uuid,
+      context_ptr->autorun,
+      context_ptr->data,
+      context_ptr->terminal,
+      context_ptr->level);
+    if (app == NULL)
     {
       log_error("ladish_app_supervisor_add() failed.");
       context_ptr->error = XML_TRUE;
     }
+    else
+    {
+      ladish_app_set_start_priority(app, context_ptr->start_priority);
+    }
   }
 
   context_ptr->depth--;
@@ -894,10 +912,6 @@ static bool run(void * command_context)
   char * path;
   struct stat st;
   XML_Parser parser;
-  int bytes_read;
-  void * buffer;
-  int fd;
-  enum XML_Status xmls;
   struct ladish_parse_context parse_context;
 
   ASSERT(cmd_ptr->command.state == LADISH_COMMAND_STATE_PENDING);
@@ -928,40 +942,10 @@ static bool run(void * command_context)
     return false;
   }
 
-  fd = open(path, O_RDONLY);
-  if (fd == -1)
-  {
-    log_error("failed to open '%s': %d (%s)", path, errno, strerror(errno));
-    return false;
-  }
-
   parser = XML_ParserCreate(NULL);
   if (parser == NULL)
   {
     log_error("XML_ParserCreate() failed to create parser object.");
-    close(fd);
-    return false;
-  }
-
-  //log_info("conf file size is %llu bytes", (unsigned long long)st.st_size);
-
-  /* we are expecting that conf file has small enough size to fit in memory */
-
-  buffer = XML_GetBuffer(parser, st.st_size);
-  if (buffer == NULL)
-  {
-    log_error("XML_GetBuffer() failed.");
-    XML_ParserFree(parser);
-    close(fd);
-    return false;
-  }
-
-  bytes_read = read(fd, buffer, st.st_size);
-  if (bytes_read != st.st_size)
-  {
-    log_error("read() returned unexpected result.");
-    XML_ParserFree(parser);
-    close(fd);
     return false;
   }
 
@@ -981,27 +965,18 @@ static bool run(void * command_context)
   {
     log_error("ladish_studio_show() failed.");
     XML_ParserFree(parser);
-    close(fd);
     return false;
   }
 
-  xmls = XML_ParseBuffer(parser, bytes_read, XML_TRUE);
-  if (xmls == XML_STATUS_ERROR)
+  if (!ladish_parse_file(parser, path))
   {
-    if (!parse_context.error)
-    {
-      log_error("XML_ParseBuffer() failed.");
-    }
-
     ladish_notify_simple(LADISH_NOTIFY_URGENCY_HIGH, "Studio load failed", LADISH_CHECK_LOG_TEXT);
     ladish_studio_clear();
     XML_ParserFree(parser);
-    close(fd);
     return false;
   }
 
   XML_ParserFree(parser);
-  close(fd);
 
   if (parse_context.error)
   {
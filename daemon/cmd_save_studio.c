@@ -199,7 +199,7 @@ static bool ladish_save_studio_xml(struct ladish_command_save_studio * cmd_ptr)
   char * filename;              /* filename */
   char * bak_filename;          /* filename of the backup file */
   char * old_filename;          /* filename where studio was persisted before save */
-  struct stat st;
+  bool backup_exists;
   struct ladish_write_context save_context;
   bool renaming;
 
@@ -252,15 +252,14 @@ static bool ladish_save_studio_xml(struct ladish_command_save_studio * cmd_ptr)
   {
     ASSERT(old_filename != NULL);
 
-    if (stat(old_filename, &st) == 0) /* if old filename does not exist, rename with fail */
+    /* the old file stays in place until the new one atomically replaces it,
+       so a failed save leaves both the studio file and its backup intact */
+    if (!ladish_write_backup(old_filename, bak_filename, &backup_exists))
     {
-      if (rename(old_filename, bak_filename) != 0)
-      {
-        log_error("rename(%s, %s) failed: %d (%s)", old_filename, bak_filename, errno, strerror(errno));
-        goto free_filenames;
-      }
+      goto free_filenames;
     }
-    else
+
+    if (!backup_exists)
     {
       /* mark that there is no backup file */
       free(bak_filename);
@@ -270,11 +269,9 @@ static bool ladish_save_studio_xml(struct ladish_command_save_studio * cmd_ptr)
 
   log_info("saving studio... (%s)", g_studio.filename);
 
-  fd = open(g_studio.filename, O_WRONLY | O_TRUNC | O_CREAT, 0666);
-  if (fd == -1)
+  if (!ladish_write_open(g_studio.filename, &fd))
   {
-    log_error("open(%s) failed: %d (%s)", g_studio.filename, errno, strerror(errno));
-    goto rename_back;
+    goto free_filenames;
   }
 
   if (!ladish_write_string(fd, "<?xml version=\"1.0\"?>\n"))
@@ -391,6 +388,20 @@ static bool ladish_save_studio_xml(struct ladish_command_save_studio * cmd_ptr)
     goto close;
   }
 
+  if (!ladish_write_close(fd, true, true))
+  {
+    goto free_filenames;
+  }
+
+  /* the studio was renamed, the file with old name is now the backup */
+  if (bak_filename != NULL && old_filename != g_studio.filename && strcmp(old_filename, g_studio.filename) != 0)
+  {
+    if (unlink(old_filename) != 0)
+    {
+      log_error("unlink(%s) failed: %d (%s)", old_filename, errno, strerror(errno));
+    }
+  }
+
   log_info("studio saved. (%s)", g_studio.filename);
   g_studio.persisted = true;
   g_studio.automatic = false;   /* even if it was automatic, it is not anymore because it is saved */
@@ -405,19 +416,10 @@ static bool ladish_save_studio_xml(struct ladish_command_save_studio * cmd_ptr)
     ladish_studio_emit_renamed(); /* uses g_studio.name */
   }
 
-close:
-  close(fd);
+  goto free_filenames;
 
-rename_back:
-  if (!ret && bak_filename != NULL)
-  {
-    /* save failed - try to rename the backup file back */
-    ASSERT(old_filename != NULL);
-    if (rename(bak_filename, old_filename) != 0)
-    {
-      log_error("rename(%s, %s) failed: %d (%s)", bak_filename, g_studio.filename, errno, strerror(errno));
-    }
-  }
+close:
+  ladish_write_close(fd, false, false);
 
 free_filenames:
   if (bak_filename != NULL)
@@ -32,11 +32,15 @@
 #define LADISH_CONF_KEY_DAEMON_TERMINAL           "/org/ladish/daemon/terminal"
 #define LADISH_CONF_KEY_DAEMON_STUDIO_AUTOSTART   "/org/ladish/daemon/studio_autostart"
 #define LADISH_CONF_KEY_DAEMON_JS_SAVE_DELAY      "/org/ladish/daemon/js_save_delay"
+#define LADISH_CONF_KEY_DAEMON_INTEGRITY_FULL_SWEEP "/org/ladish/daemon/integrity_full_sweep"
+#define LADISH_CONF_KEY_DAEMON_AUTORUN_WINDOW     "/org/ladish/daemon/autorun_window"
 
 #define LADISH_CONF_KEY_DAEMON_NOTIFY_DEFAULT             true
 #define LADISH_CONF_KEY_DAEMON_SHELL_DEFAULT              "sh"
 #define LADISH_CONF_KEY_DAEMON_TERMINAL_DEFAULT           "xterm"
 #define LADISH_CONF_KEY_DAEMON_STUDIO_AUTOSTART_DEFAULT   true
 #define LADISH_CONF_KEY_DAEMON_JS_SAVE_DELAY_DEFAULT      0
+#define LADISH_CONF_KEY_DAEMON_INTEGRITY_FULL_SWEEP_DEFAULT false
+#define LADISH_CONF_KEY_DAEMON_AUTORUN_WINDOW_DEFAULT     4 /* zero means unlimited */
 
 #endif /* #ifndef CONF_H__795797BE_4EB8_44F8_BD9C_B8A9CB975228__INCLUDED */
@@ -34,6 +34,8 @@
 #include "../lib/wkports.h"
 #include "../proxies/conf_proxy.h"
 #include "conf.h"
+#include "appdb.h"
+#include "jack_status.h"
 
 #define INTERFACE_NAME IFACE_CONTROL
 
@@ -695,16 +697,44 @@ static void ladish_new_studio(struct cdbus_method_call * call_ptr)
   }
 }
 
+#define array_iter_ptr ((DBusMessageIter *)context)
+
+static bool application_list_filler(void * context, const struct lash_appdb_entry * entry_ptr)
+{
+  DBusMessageIter struct_iter;
+  DBusMessageIter dict_iter;
+
+  if (!dbus_message_iter_open_container(array_iter_ptr, DBUS_TYPE_STRUCT, NULL, &struct_iter))
+    return false;
+
+  if (!dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, &entry_ptr->name))
+    return false;
+
+  if (!dbus_message_iter_open_container(&struct_iter, DBUS_TYPE_ARRAY, "{sv}", &dict_iter))
+    return false;
+
+  if (!cdbus_maybe_add_dict_entry_string(&dict_iter, "GenericName", entry_ptr->generic_name))
+    return false;
+
+  if (!cdbus_maybe_add_dict_entry_string(&dict_iter, "Comment", entry_ptr->comment))
+    return false;
+
+  if (!cdbus_maybe_add_dict_entry_string(&dict_iter, "Icon", entry_ptr->icon))
+    return false;
+
+  if (!dbus_message_iter_close_container(&struct_iter, &dict_iter))
+    return false;
+
+  if (!dbus_message_iter_close_container(array_iter_ptr, &struct_iter))
+    return false;
+
+  return true;
+}
+
 static void ladish_get_application_list(struct cdbus_method_call * call_ptr)
 {
   DBusMessageIter iter;
   DBusMessageIter array_iter;
-#if 0
-  DBusMessageIter struct_iter;
-  DBusMessageIter dict_iter;
-  struct list_head * node_ptr;
-  struct lash_appdb_entry * entry_ptr;
-#endif
 
   log_info("Getting applications list");
 
@@ -721,39 +751,10 @@ static void ladish_get_application_list(struct cdbus_method_call * call_ptr)
     goto fail_unref;
   }
 
-#if 0
-  list_for_each(node_ptr, &g_server->appdb)
+  if (!ladish_appdb_iterate(&array_iter, application_list_filler))
   {
-    entry_ptr = list_entry(node_ptr, struct lash_appdb_entry, siblings);
-
-    if (!dbus_message_iter_open_container(&array_iter, DBUS_TYPE_STRUCT, NULL, &struct_iter))
-      goto fail_unref;
-
-    if (!dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, (const void *) &entry_ptr->name))
-    {
-      dbus_message_iter_close_container(&iter, &array_iter);
-      goto fail_unref;
-    }
-
-    if (!dbus_message_iter_open_container(&struct_iter, DBUS_TYPE_ARRAY, "{sv}", &dict_iter))
-      goto fail_unref;
-
-    if (!maybe_add_dict_entry_string(&dict_iter, "GenericName", entry_ptr->generic_name))
-      goto fail_unref;
-
-    if (!maybe_add_dict_entry_string(&dict_iter, "Comment", entry_ptr->comment))
-      goto fail_unref;
-
-    if (!maybe_add_dict_entry_string(&dict_iter, "Icon", entry_ptr->icon))
-      goto fail_unref;
-
-    if (!dbus_message_iter_close_container(&struct_iter, &dict_iter))
-      goto fail_unref;
-
-    if (!dbus_message_iter_close_container(&array_iter, &struct_iter))
-      goto fail_unref;
+    goto fail_unref;
   }
-#endif
 
   if (!dbus_message_iter_close_container(&iter, &array_iter))
   {
@@ -890,6 +891,23 @@ static void ladish_exit(struct cdbus_method_call * call_ptr)
   cdbus_method_return_new_void(call_ptr);
 }
 
+static void ladish_subscribe_jack_status(struct cdbus_method_call * call_ptr)
+{
+  if (!ladish_jack_status_subscribe(dbus_message_get_sender(call_ptr->message)))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Subscribing for JACK status failed");
+    return;
+  }
+
+  cdbus_method_return_new_void(call_ptr);
+}
+
+static void ladish_unsubscribe_jack_status(struct cdbus_method_call * call_ptr)
+{
+  ladish_jack_status_unsubscribe(dbus_message_get_sender(call_ptr->message));
+  cdbus_method_return_new_void(call_ptr);
+}
+
 void emit_studio_appeared(void)
 {
   cdbus_signal_emit(cdbus_g_dbus_connection, CONTROL_OBJECT_PATH, INTERFACE_NAME, "StudioAppeared", "");
@@ -950,6 +968,12 @@ CDBUS_METHOD_ARGS_END
 CDBUS_METHOD_ARGS_BEGIN(Exit, "Tell ladish D-Bus service to exit")
 CDBUS_METHOD_ARGS_END
 
+CDBUS_METHOD_ARGS_BEGIN(SubscribeJackStatus, "Receive JackStatusChanged signals while JACK server is started")
+CDBUS_METHOD_ARGS_END
+
+CDBUS_METHOD_ARGS_BEGIN(UnsubscribeJackStatus, "Stop receiving JackStatusChanged signals")
+CDBUS_METHOD_ARGS_END
+
 CDBUS_METHODS_BEGIN
   CDBUS_METHOD_DESCRIBE(IsStudioLoaded, ladish_is_studio_loaded)
   CDBUS_METHOD_DESCRIBE(GetStudioList, ladish_get_studio_list)
@@ -961,6 +985,8 @@ CDBUS_METHODS_BEGIN
   CDBUS_METHOD_DESCRIBE(CreateRoomTemplate, ladish_create_room_template)
   CDBUS_METHOD_DESCRIBE(DeleteRoomTemplate, ladish_delete_room_template)
   CDBUS_METHOD_DESCRIBE(Exit, ladish_exit)
+  CDBUS_METHOD_DESCRIBE(SubscribeJackStatus, ladish_subscribe_jack_status)
+  CDBUS_METHOD_DESCRIBE(UnsubscribeJackStatus, ladish_unsubscribe_jack_status)
 CDBUS_METHODS_END
 
 CDBUS_SIGNAL_ARGS_BEGIN(StudioAppeared, "Studio D-Bus object appeared")
@@ -975,11 +1001,18 @@ CDBUS_SIGNAL_ARGS_END
 CDBUS_SIGNAL_ARGS_BEGIN(CleanExit, "Exit was requested")
 CDBUS_SIGNAL_ARGS_END
 
+CDBUS_SIGNAL_ARGS_BEGIN(JackStatusChanged, "JACK server status changed, sent only when there are subscribers")
+  CDBUS_SIGNAL_ARG_DESCRIBE("xruns", "u", "Number of xruns")
+  CDBUS_SIGNAL_ARG_DESCRIBE("buffer_size", "u", "Buffer size, in samples")
+  CDBUS_SIGNAL_ARG_DESCRIBE("dsp_load", "u", "DSP load, in percents rounded to a multiple of 5")
+CDBUS_SIGNAL_ARGS_END
+
 CDBUS_SIGNALS_BEGIN
   CDBUS_SIGNAL_DESCRIBE(StudioAppeared)
   CDBUS_SIGNAL_DESCRIBE(StudioDisappeared)
   CDBUS_SIGNAL_DESCRIBE(QueueExecutionHalted)
   CDBUS_SIGNAL_DESCRIBE(CleanExit)
+  CDBUS_SIGNAL_DESCRIBE(JackStatusChanged)
 CDBUS_SIGNALS_END
 
 /*
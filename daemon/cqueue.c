@@ -26,6 +26,16 @@
 
 #include "cmd.h"
 #include "control.h"
+#include "reactor.h"
+
+/* Waiting commands can wait for a deadline or for state that is polled,
+ * so they are rerun periodically, not only on main loop events */
+#define LADISH_CQUEUE_WAIT_POLL_INTERVAL 50 /* milliseconds */
+
+static void ladish_cqueue_run_task(void * context)
+{
+  ladish_cqueue_run(context);
+}
 
 void ladish_cqueue_init(struct ladish_cqueue * queue_ptr)
 {
@@ -67,6 +77,7 @@ loop:
   case LADISH_COMMAND_STATE_DONE:
     break;
   case LADISH_COMMAND_STATE_WAITING:
+    ladish_reactor_post_delayed(queue_ptr, ladish_cqueue_run_task, LADISH_CQUEUE_WAIT_POLL_INTERVAL);
     return;
   default:
     log_error("unexpected cmd state %u after run()", cmd_ptr->state);
@@ -144,6 +155,10 @@ bool ladish_cqueue_add_command(struct ladish_cqueue * queue_ptr, struct ladish_c
   cmd_ptr->state = LADISH_COMMAND_STATE_PENDING;
 
   list_add_tail(&cmd_ptr->siblings, &queue_ptr->queue);
+
+  /* start executing the command without waiting for other main loop events */
+  ladish_reactor_post(queue_ptr, ladish_cqueue_run_task);
+
   return true;
 }
 
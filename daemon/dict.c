@@ -25,60 +25,192 @@
  */
 
 #include "dict.h"
+#include "../common/hash.h"
+
+/* Dictionaries keep their entries in an array, in insertion order.
+ * Small dictionaries (most ports and clients have few keys) are scanned
+ * linearly. Bigger ones get an
+ * open-addressing (linear probing) index of entry positions.
+ * Keys are interned in a shared, reference counted, string pool. */
+
+#define LADISH_DICT_INDEX_THRESHOLD 8
+#define LADISH_DICT_KEY_POOL_BUCKETS 256
+
+struct ladish_dict_key
+{
+  struct hlist_node siblings;
+  unsigned int refcount;
+  uint32_t hash;
+  char str[0];
+};
 
 struct ladish_dict_entry
 {
-  struct list_head siblings;
-  char * key;
+  struct ladish_dict_key * key;
   char * value;
 };
 
 struct ladish_dict
 {
-  struct list_head entries;
+  struct ladish_dict_entry * entries;
+  uint32_t count;
+  uint32_t size;                /* allocated entries */
+  uint32_t * index;             /* entry position + 1, zero for empty slot; NULL for small dicts */
+  uint32_t index_mask;
 };
 
-bool ladish_dict_create(ladish_dict_handle * dict_handle_ptr)
+static struct hlist_head g_key_pool[LADISH_DICT_KEY_POOL_BUCKETS];
+
+static struct ladish_dict_key * ladish_dict_key_get(const char * str, uint32_t hash)
 {
-  struct ladish_dict * dict_ptr;
+  struct hlist_head * bucket_ptr;
+  struct hlist_node * node_ptr;
+  struct ladish_dict_key * key_ptr;
+  size_t len;
 
-  dict_ptr = malloc(sizeof(struct ladish_dict));
-  if (dict_ptr == NULL)
+  bucket_ptr = g_key_pool + (hash % LADISH_DICT_KEY_POOL_BUCKETS);
+
+  hlist_for_each_entry(key_ptr, node_ptr, bucket_ptr, siblings)
   {
-    log_error("malloc() failed to allocate struct ladish_dict");
-    return false;
+    if (key_ptr->hash == hash && strcmp(key_ptr->str, str) == 0)
+    {
+      key_ptr->refcount++;
+      return key_ptr;
+    }
   }
 
-  INIT_LIST_HEAD(&dict_ptr->entries);
+  len = strlen(str) + 1;
+  key_ptr = malloc(sizeof(struct ladish_dict_key) + len);
+  if (key_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate dict key");
+    return NULL;
+  }
 
-  *dict_handle_ptr = (ladish_dict_handle)dict_ptr;
+  key_ptr->refcount = 1;
+  key_ptr->hash = hash;
+  memcpy(key_ptr->str, str, len);
+  hlist_add_head(&key_ptr->siblings, bucket_ptr);
 
-  return true;
+  return key_ptr;
 }
 
-static struct ladish_dict_entry * ladish_dict_find_key(struct ladish_dict * dict_ptr, const char * key)
+static void ladish_dict_key_put(struct ladish_dict_key * key_ptr)
 {
-  struct list_head * node_ptr;
-  struct ladish_dict_entry * entry_ptr;
+  ASSERT(key_ptr->refcount > 0);
+  key_ptr->refcount--;
+  if (key_ptr->refcount == 0)
+  {
+    hlist_del(&key_ptr->siblings);
+    free(key_ptr);
+  }
+}
+
+/* returns position of the entry in the entries array or -1 */
+static int32_t ladish_dict_find_key(struct ladish_dict * dict_ptr, const char * key)
+{
+  uint32_t i;
+  uint32_t hash;
+  uint32_t slot;
+  struct ladish_dict_key * key_ptr;
 
-  list_for_each(node_ptr, &dict_ptr->entries)
+  if (dict_ptr->index == NULL)
   {
-    entry_ptr = list_entry(node_ptr, struct ladish_dict_entry, siblings);
-    if (strcmp(entry_ptr->key, key) == 0)
+    /* for few entries, hashing the key costs about as much as the scan */
+    for (i = 0; i < dict_ptr->count; i++)
     {
-      return entry_ptr;
+      if (strcmp(dict_ptr->entries[i].key->str, key) == 0)
+      {
+        return i;
+      }
     }
+
+    return -1;
+  }
+
+  hash = ladish_hash_str(key);
+
+  for (slot = hash & dict_ptr->index_mask; dict_ptr->index[slot] != 0; slot = (slot + 1) & dict_ptr->index_mask)
+  {
+    key_ptr = dict_ptr->entries[dict_ptr->index[slot] - 1].key;
+    if (key_ptr->hash == hash && strcmp(key_ptr->str, key) == 0)
+    {
+      return dict_ptr->index[slot] - 1;
+    }
+  }
+
+  return -1;
+}
+
+static void ladish_dict_index_insert(struct ladish_dict * dict_ptr, uint32_t position)
+{
+  uint32_t slot;
+
+  slot = dict_ptr->entries[position].key->hash & dict_ptr->index_mask;
+  while (dict_ptr->index[slot] != 0)
+  {
+    slot = (slot + 1) & dict_ptr->index_mask;
+  }
+
+  dict_ptr->index[slot] = position + 1;
+}
+
+/* (re)build the index so that it can hold the allocated entries at load factor of at most 1/2 */
+static bool ladish_dict_rebuild_index(struct ladish_dict * dict_ptr)
+{
+  uint32_t size;
+  uint32_t * index;
+  uint32_t i;
+
+  free(dict_ptr->index);
+  dict_ptr->index = NULL;
+
+  if (dict_ptr->size <= LADISH_DICT_INDEX_THRESHOLD)
+  {
+    return true;
+  }
+
+  for (size = 16; size < dict_ptr->size * 2; size *= 2);
+
+  index = calloc(size, sizeof(uint32_t));
+  if (index == NULL)
+  {
+    /* lookups fall back to linear scan */
+    log_error("calloc() failed to allocate dict index of %"PRIu32" slots", size);
+    return false;
   }
 
-  return NULL;
+  dict_ptr->index = index;
+  dict_ptr->index_mask = size - 1;
+
+  for (i = 0; i < dict_ptr->count; i++)
+  {
+    ladish_dict_index_insert(dict_ptr, i);
+  }
+
+  return true;
 }
 
-static void ladish_dict_drop_entry(struct ladish_dict_entry * entry_ptr)
+bool ladish_dict_create(ladish_dict_handle * dict_handle_ptr)
 {
-  list_del(&entry_ptr->siblings);
-  free(entry_ptr->key);
-  free(entry_ptr->value);
-  free(entry_ptr);
+  struct ladish_dict * dict_ptr;
+
+  dict_ptr = malloc(sizeof(struct ladish_dict));
+  if (dict_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate struct ladish_dict");
+    return false;
+  }
+
+  dict_ptr->entries = NULL;
+  dict_ptr->count = 0;
+  dict_ptr->size = 0;
+  dict_ptr->index = NULL;
+  dict_ptr->index_mask = 0;
+
+  *dict_handle_ptr = (ladish_dict_handle)dict_ptr;
+
+  return true;
 }
 
 #define dict_ptr ((struct ladish_dict *)dict_handle)
@@ -91,12 +223,21 @@ void ladish_dict_destroy(ladish_dict_handle dict_handle)
 
 bool ladish_dict_set(ladish_dict_handle dict_handle, const char * key, const char * value)
 {
+  int32_t position;
   struct ladish_dict_entry * entry_ptr;
   char * new_value;
+  uint32_t new_size;
 
-  entry_ptr = ladish_dict_find_key(dict_ptr, key);
-  if (entry_ptr != NULL)
+  position = ladish_dict_find_key(dict_ptr, key);
+  if (position >= 0)
   {
+    entry_ptr = dict_ptr->entries + position;
+
+    if (strcmp(entry_ptr->value, value) == 0)
+    {
+      return true;
+    }
+
     new_value = strdup(value);
     if (new_value == NULL)
     {
@@ -109,80 +250,123 @@ bool ladish_dict_set(ladish_dict_handle dict_handle, const char * key, const cha
     return true;
   }
 
-  entry_ptr = malloc(sizeof(struct ladish_dict_entry));
-  if (entry_ptr == NULL)
+  new_value = strdup(value);
+  if (new_value == NULL)
   {
-    log_error("malloc() failed to allocate struct ladish_dict_entry");
+    log_error("strdup() failed to duplicate dict value");
     return false;
   }
 
-  entry_ptr->key = strdup(key);
+  if (dict_ptr->count == dict_ptr->size)
+  {
+    new_size = dict_ptr->size == 0 ? 2 : dict_ptr->size * 2;
+
+    entry_ptr = realloc(dict_ptr->entries, new_size * sizeof(struct ladish_dict_entry));
+    if (entry_ptr == NULL)
+    {
+      log_error("realloc() failed to grow dict to %"PRIu32" entries", new_size);
+      free(new_value);
+      return false;
+    }
+
+    dict_ptr->entries = entry_ptr;
+    dict_ptr->size = new_size;
+
+    if (new_size > LADISH_DICT_INDEX_THRESHOLD)
+    {
+      /* this will not index the new entry because count is not incremented yet */
+      ladish_dict_rebuild_index(dict_ptr);
+    }
+  }
+
+  entry_ptr = dict_ptr->entries + dict_ptr->count;
+
+  entry_ptr->key = ladish_dict_key_get(key, ladish_hash_str(key));
   if (entry_ptr->key == NULL)
   {
-    log_error("strdup() failed to duplicate dict key");
-    free(entry_ptr);
+    free(new_value);
     return false;
   }
 
-  entry_ptr->value = strdup(value);
-  if (entry_ptr->value == NULL)
+  entry_ptr->value = new_value;
+
+  if (dict_ptr->index != NULL)
   {
-    log_error("strdup() failed to duplicate dict value");
-    free(entry_ptr->key);
-    free(entry_ptr);
-    return false;
+    ladish_dict_index_insert(dict_ptr, dict_ptr->count);
   }
 
-  list_add_tail(&entry_ptr->siblings, &dict_ptr->entries);
+  dict_ptr->count++;
 
   return true;
 }
 
 const char * ladish_dict_get(ladish_dict_handle dict_handle, const char * key)
 {
-  struct ladish_dict_entry * entry_ptr;
+  int32_t position;
 
-  entry_ptr = ladish_dict_find_key(dict_ptr, key);
-  if (entry_ptr == NULL)
+  position = ladish_dict_find_key(dict_ptr, key);
+  if (position < 0)
   {
     return NULL;
   }
 
-  ASSERT(entry_ptr->value != NULL);
-  return entry_ptr->value;
+  ASSERT(dict_ptr->entries[position].value != NULL);
+  return dict_ptr->entries[position].value;
 }
 
 void ladish_dict_drop(ladish_dict_handle dict_handle, const char * key)
 {
-  struct ladish_dict_entry * entry_ptr;
+  int32_t position;
 
-  entry_ptr = ladish_dict_find_key(dict_ptr, key);
-  if (entry_ptr != NULL)
+  position = ladish_dict_find_key(dict_ptr, key);
+  if (position < 0)
   {
-    ladish_dict_drop_entry(entry_ptr);
+    return;
+  }
+
+  ladish_dict_key_put(dict_ptr->entries[position].key);
+  free(dict_ptr->entries[position].value);
+
+  /* keep the insertion order */
+  dict_ptr->count--;
+  memmove(
+    dict_ptr->entries + position,
+    dict_ptr->entries + position + 1,
+    (dict_ptr->count - position) * sizeof(struct ladish_dict_entry));
+
+  if (dict_ptr->index != NULL)
+  {
+    ladish_dict_rebuild_index(dict_ptr);
   }
 }
 
 void ladish_dict_clear(ladish_dict_handle dict_handle)
 {
-  struct ladish_dict_entry * entry_ptr;
+  uint32_t i;
 
-  while (!list_empty(&dict_ptr->entries))
+  for (i = 0; i < dict_ptr->count; i++)
   {
-    entry_ptr = list_entry(dict_ptr->entries.next, struct ladish_dict_entry, siblings);
-    ladish_dict_drop_entry(entry_ptr);
+    ladish_dict_key_put(dict_ptr->entries[i].key);
+    free(dict_ptr->entries[i].value);
   }
+
+  free(dict_ptr->entries);
+  free(dict_ptr->index);
+
+  dict_ptr->entries = NULL;
+  dict_ptr->count = 0;
+  dict_ptr->size = 0;
+  dict_ptr->index = NULL;
+  dict_ptr->index_mask = 0;
 }
 
 bool ladish_dict_iterate(ladish_dict_handle dict_handle, void * context, bool (* callback)(void * context, const char * key, const char * value))
 {
-  struct list_head * node_ptr;
-  struct ladish_dict_entry * entry_ptr;
+  uint32_t i;
 
-  list_for_each(node_ptr, &dict_ptr->entries)
+  for (i = 0; i < dict_ptr->count; i++)
   {
-    entry_ptr = list_entry(node_ptr, struct ladish_dict_entry, siblings);
-    if (!callback(context, entry_ptr->key, entry_ptr->value))
+    if (!callback(context, dict_ptr->entries[i].key->str, dict_ptr->entries[i].value))
     {
       return false;
     }
@@ -193,7 +377,7 @@ bool ladish_dict_iterate(ladish_dict_handle dict_handle, void * context, bool (*
 
 bool ladish_dict_is_empty(ladish_dict_handle dict_handle)
 {
-  return list_empty(&dict_ptr->entries);
+  return dict_ptr->count == 0;
 }
 
 #undef dict_ptr
@@ -28,12 +28,53 @@
 #include "common.h"
 #include "graph.h"
 #include "../dbus_constants.h"
+#include "../common/hash.h"
 #include "virtualizer.h"
+#include "check_integrity.h"
+#include "reactor.h"
+
+/* auto connect of hidden connection is retried this many times */
+#define LADISH_GRAPH_CONNECT_RETRIES 3
+
+/* milliseconds, doubled on each retry round */
+#define LADISH_GRAPH_CONNECT_RETRY_DELAY 250
+
+/* milliseconds without restore progress after which ConnectionsRestored is emitted anyway */
+#define LADISH_GRAPH_RESTORE_TIMEOUT 60000
+
+/* initial number of buckets in each graph index, must be power of two.
+ * The index doubles when it holds more objects than buckets. */
+#define LADISH_GRAPH_INDEX_MIN_SIZE 4
+
+struct ladish_graph_index_node
+{
+  struct hlist_node siblings;
+  uint32_t hash;                /* kept for rehashing when the index grows */
+};
+
+struct ladish_graph_index
+{
+  struct hlist_head * buckets;  /* inline_buckets until the index grows */
+  uint32_t mask;
+  uint32_t count;
+  struct hlist_head inline_buckets[LADISH_GRAPH_INDEX_MIN_SIZE];
+};
+
+#define LADISH_GRAPH_INDEX_BUCKET(index, hash) (&(index).buckets[(hash) & (index).mask])
 
 struct ladish_graph_port
 {
   struct list_head siblings_client;
   struct list_head siblings_graph;
+  struct ladish_graph_index_node hash_id;            /* link for the graph::ports_by_id index */
+  struct ladish_graph_index_node hash_handle;        /* link for the graph::ports_by_handle index */
+  struct ladish_graph_index_node hash_uuid;          /* link for the graph::ports_by_uuid index */
+  struct ladish_graph_index_node hash_link_uuid;     /* link for the graph::ports_by_link_uuid index, link ports only */
+  struct ladish_graph_index_node hash_jack_id;       /* link for the graph::ports_by_jack_id index, unhashed when JACK id is 0 */
+  struct ladish_graph_index_node hash_jack_id_room;  /* link for the graph::ports_by_jack_id_room index, link ports only */
+  struct ladish_port_hook port_hook;                 /* keeps the JACK id indexes in sync */
+  struct list_head connections;                      /* struct ladish_graph_connection_end list, connections of this port */
+  struct ladish_graph * owner_ptr;
   struct ladish_graph_client * client_ptr;
   char * name;
   uint32_t type;
@@ -48,6 +89,13 @@ struct ladish_graph_port
 struct ladish_graph_client
 {
   struct list_head siblings;
+  struct ladish_graph_index_node hash_id;            /* link for the graph::clients_by_id index */
+  struct ladish_graph_index_node hash_handle;        /* link for the graph::clients_by_handle index */
+  struct ladish_graph_index_node hash_uuid;          /* link for the graph::clients_by_uuid index */
+  struct ladish_graph_index_node hash_name;          /* link for the graph::clients_by_name index */
+  struct ladish_graph_index_node hash_jack_id;       /* link for the graph::clients_by_jack_id index, unhashed when JACK id is 0 */
+  struct ladish_client_hook client_hook;             /* keeps the JACK id index in sync */
+  struct ladish_graph * owner_ptr;
   char * name;
   uint64_t id;
   ladish_client_handle client;
@@ -55,9 +103,19 @@ struct ladish_graph_client
   bool hidden;
 };
 
+/* connection as seen from one of its ports */
+struct ladish_graph_connection_end
+{
+  struct list_head siblings;               /* link for the port::connections list */
+  struct ladish_graph_connection * connection_ptr;
+};
+
 struct ladish_graph_connection
 {
   struct list_head siblings;
+  struct ladish_graph_index_node hash_id;            /* link for the graph::connections_by_id index */
+  struct ladish_graph_connection_end port1_end;
+  struct ladish_graph_connection_end port2_end;
   uint64_t id;
   bool hidden;
   struct ladish_graph_port * port1_ptr;
@@ -66,6 +124,23 @@ struct ladish_graph_connection
   bool changing;
 };
 
+#define LADISH_GRAPH_JOURNAL_SIZE 1024
+
+/* A change as it was announced through the patchbay signals, kept for GetGraphChanges() */
+struct ladish_graph_change
+{
+  uint64_t version;
+  uint32_t type;                /* one of GRAPH_CHANGE_* */
+  uint64_t client1_id;
+  uint64_t port1_id;
+  uint64_t client2_id;
+  uint64_t port2_id;
+  char * name;                  /* client or port name; new name for renames */
+  char * old_name;              /* old name for renames */
+  uint32_t port_flags;
+  uint32_t port_type;
+};
+
 struct ladish_graph
 {
   char * opath;
@@ -82,12 +157,373 @@ struct ladish_graph
   void * context;
   ladish_graph_connect_request_handler connect_handler;
   ladish_graph_disconnect_request_handler disconnect_handler;
+  ladish_graph_connect_async_request_handler connect_async_handler;
+
+  /* Pipelined auto connect of hidden connections. Requests waiting for reply
+   * are in connect_pending. Failed requests wait in connect_retry until all
+   * pending requests are answered and the retry delay expires. */
+  struct list_head connect_pending;
+  struct list_head connect_retry;
+  unsigned int connect_retry_round;
+  bool restoring;               /* between ladish_graph_restore_begin() and ConnectionsRestored */
+  bool restore_autorun;         /* apps are still being started, more connections may become connectable */
+  uint32_t restored_count;
+  uint32_t restore_failed_count;
+
+  /* Lookup indexes. The lists above define the order, the indexes make finds O(1).
+   * Keys are not unique (same uuid in different vgraphs, same client names),
+   * so lookups pick the matching object that comes first in the list.
+   * Objects are appended with increasing ids so "first in list" is "lowest id". */
+  struct ladish_graph_index clients_by_id;
+  struct ladish_graph_index clients_by_handle;
+  struct ladish_graph_index clients_by_uuid;
+  struct ladish_graph_index clients_by_name;
+  struct ladish_graph_index clients_by_jack_id;
+  struct ladish_graph_index ports_by_id;
+  struct ladish_graph_index ports_by_handle;
+  struct ladish_graph_index ports_by_uuid;
+  struct ladish_graph_index ports_by_link_uuid;
+  struct ladish_graph_index ports_by_jack_id;
+  struct ladish_graph_index ports_by_jack_id_room;
+  struct ladish_graph_index connections_by_id;
+
+  /* Change journal, ring buffer allocated on first change. Changes
+   * with version <= journal_base_version are no longer available. */
+  struct ladish_graph_change * journal;
+  unsigned int journal_head;    /* index of the oldest change */
+  unsigned int journal_count;
+  uint64_t journal_base_version;
+
+  bool batch;                   /* between ladish_graph_batch_begin() and ladish_graph_batch_end() */
+  bool batch_changed;           /* the version of the batch is consumed */
 };
 
+static void ladish_graph_index_init(struct ladish_graph_index * index_ptr)
+{
+  unsigned int i;
+
+  for (i = 0; i < LADISH_GRAPH_INDEX_MIN_SIZE; i++)
+  {
+    INIT_HLIST_HEAD(index_ptr->inline_buckets + i);
+  }
+
+  index_ptr->buckets = index_ptr->inline_buckets;
+  index_ptr->mask = LADISH_GRAPH_INDEX_MIN_SIZE - 1;
+  index_ptr->count = 0;
+}
+
+static void ladish_graph_index_uninit(struct ladish_graph_index * index_ptr)
+{
+  ASSERT(index_ptr->count == 0);
+
+  if (index_ptr->buckets != index_ptr->inline_buckets)
+  {
+    free(index_ptr->buckets);
+  }
+
+  ladish_graph_index_init(index_ptr);
+}
+
+static void ladish_graph_index_grow(struct ladish_graph_index * index_ptr)
+{
+  uint32_t size;
+  struct hlist_head * buckets;
+  struct ladish_graph_index_node * node_ptr;
+  uint32_t i;
+
+  size = (index_ptr->mask + 1) * 2;
+
+  /* all NULL is an array of empty hlist heads */
+  buckets = calloc(size, sizeof(struct hlist_head));
+  if (buckets == NULL)
+  {
+    /* lookups still work, with longer chains */
+    log_error("calloc() failed to grow graph index to %"PRIu32" buckets", size);
+    return;
+  }
+
+  for (i = 0; i <= index_ptr->mask; i++)
+  {
+    while (!hlist_empty(index_ptr->buckets + i))
+    {
+      node_ptr = hlist_entry(index_ptr->buckets[i].first, struct ladish_graph_index_node, siblings);
+      hlist_del(&node_ptr->siblings);
+      hlist_add_head(&node_ptr->siblings, buckets + (node_ptr->hash & (size - 1)));
+    }
+  }
+
+  if (index_ptr->buckets != index_ptr->inline_buckets)
+  {
+    free(index_ptr->buckets);
+  }
+
+  index_ptr->buckets = buckets;
+  index_ptr->mask = size - 1;
+}
+
+static void ladish_graph_index_add(struct ladish_graph_index * index_ptr, struct ladish_graph_index_node * node_ptr, uint32_t hash)
+{
+  node_ptr->hash = hash;
+  hlist_add_head(&node_ptr->siblings, LADISH_GRAPH_INDEX_BUCKET(*index_ptr, hash));
+  index_ptr->count++;
+
+  if (index_ptr->count > index_ptr->mask + 1)
+  {
+    ladish_graph_index_grow(index_ptr);
+  }
+}
+
+/* the node may be unhashed */
+static void ladish_graph_index_del(struct ladish_graph_index * index_ptr, struct ladish_graph_index_node * node_ptr)
+{
+  if (hlist_unhashed(&node_ptr->siblings))
+  {
+    return;
+  }
+
+  hlist_del_init(&node_ptr->siblings);
+  ASSERT(index_ptr->count > 0);
+  index_ptr->count--;
+}
+
+static inline uint32_t ladish_graph_hash_uuid(const uuid_t uuid)
+{
+  return ladish_hash_data(uuid, sizeof(uuid_t));
+}
+
+static void ladish_graph_hash_port_jack_ids(struct ladish_graph * graph_ptr, struct ladish_graph_port * port_ptr)
+{
+  uint64_t jack_id;
+
+  jack_id = ladish_port_get_jack_id(port_ptr->port);
+  if (jack_id != 0)
+  {
+    ladish_graph_index_add(&graph_ptr->ports_by_jack_id, &port_ptr->hash_jack_id, ladish_hash_u64(jack_id));
+  }
+
+  if (port_ptr->link)
+  {
+    jack_id = ladish_port_get_jack_id_room(port_ptr->port);
+    if (jack_id != 0)
+    {
+      ladish_graph_index_add(&graph_ptr->ports_by_jack_id_room, &port_ptr->hash_jack_id_room, ladish_hash_u64(jack_id));
+    }
+  }
+}
+
+static void ladish_graph_port_jack_id_changed(struct ladish_port_hook * hook_ptr)
+{
+  struct ladish_graph_port * port_ptr;
+
+  port_ptr = container_of(hook_ptr, struct ladish_graph_port, port_hook);
+
+  ladish_graph_index_del(&port_ptr->owner_ptr->ports_by_jack_id, &port_ptr->hash_jack_id);
+  ladish_graph_index_del(&port_ptr->owner_ptr->ports_by_jack_id_room, &port_ptr->hash_jack_id_room);
+  ladish_graph_hash_port_jack_ids(port_ptr->owner_ptr, port_ptr);
+}
+
+static void ladish_graph_hash_port(struct ladish_graph * graph_ptr, struct ladish_graph_port * port_ptr)
+{
+  uuid_t uuid;
+
+  ladish_port_get_uuid(port_ptr->port, uuid);
+
+  ladish_graph_index_add(&graph_ptr->ports_by_id, &port_ptr->hash_id, ladish_hash_u64(port_ptr->id));
+  ladish_graph_index_add(&graph_ptr->ports_by_handle, &port_ptr->hash_handle, ladish_hash_ptr(port_ptr->port));
+  ladish_graph_index_add(&graph_ptr->ports_by_uuid, &port_ptr->hash_uuid, ladish_graph_hash_uuid(uuid));
+  if (port_ptr->link)
+  {
+    ladish_graph_index_add(&graph_ptr->ports_by_link_uuid, &port_ptr->hash_link_uuid, ladish_graph_hash_uuid(port_ptr->link_uuid_override));
+  }
+
+  ladish_graph_hash_port_jack_ids(graph_ptr, port_ptr);
+
+  port_ptr->owner_ptr = graph_ptr;
+  port_ptr->port_hook.jack_id_changed = ladish_graph_port_jack_id_changed;
+  ladish_port_add_hook(port_ptr->port, &port_ptr->port_hook);
+}
+
+static void ladish_graph_unhash_port(struct ladish_graph_port * port_ptr)
+{
+  ladish_port_del_hook(&port_ptr->port_hook);
+
+  ladish_graph_index_del(&port_ptr->owner_ptr->ports_by_id, &port_ptr->hash_id);
+  ladish_graph_index_del(&port_ptr->owner_ptr->ports_by_handle, &port_ptr->hash_handle);
+  ladish_graph_index_del(&port_ptr->owner_ptr->ports_by_uuid, &port_ptr->hash_uuid);
+  ladish_graph_index_del(&port_ptr->owner_ptr->ports_by_link_uuid, &port_ptr->hash_link_uuid);
+  ladish_graph_index_del(&port_ptr->owner_ptr->ports_by_jack_id, &port_ptr->hash_jack_id);
+  ladish_graph_index_del(&port_ptr->owner_ptr->ports_by_jack_id_room, &port_ptr->hash_jack_id_room);
+}
+
+static void ladish_graph_hash_client_jack_id(struct ladish_graph * graph_ptr, struct ladish_graph_client * client_ptr)
+{
+  uint64_t jack_id;
+
+  jack_id = ladish_client_get_jack_id(client_ptr->client);
+  if (jack_id != 0)
+  {
+    ladish_graph_index_add(&graph_ptr->clients_by_jack_id, &client_ptr->hash_jack_id, ladish_hash_u64(jack_id));
+  }
+}
+
+static void ladish_graph_client_jack_id_changed(struct ladish_client_hook * hook_ptr)
+{
+  struct ladish_graph_client * client_ptr;
+
+  client_ptr = container_of(hook_ptr, struct ladish_graph_client, client_hook);
+
+  ladish_graph_index_del(&client_ptr->owner_ptr->clients_by_jack_id, &client_ptr->hash_jack_id);
+  ladish_graph_hash_client_jack_id(client_ptr->owner_ptr, client_ptr);
+}
+
+static void ladish_graph_hash_client(struct ladish_graph * graph_ptr, struct ladish_graph_client * client_ptr)
+{
+  uuid_t uuid;
+
+  ladish_client_get_uuid(client_ptr->client, uuid);
+
+  ladish_graph_index_add(&graph_ptr->clients_by_id, &client_ptr->hash_id, ladish_hash_u64(client_ptr->id));
+  ladish_graph_index_add(&graph_ptr->clients_by_handle, &client_ptr->hash_handle, ladish_hash_ptr(client_ptr->client));
+  ladish_graph_index_add(&graph_ptr->clients_by_uuid, &client_ptr->hash_uuid, ladish_graph_hash_uuid(uuid));
+  ladish_graph_index_add(&graph_ptr->clients_by_name, &client_ptr->hash_name, ladish_hash_str(client_ptr->name));
+
+  ladish_graph_hash_client_jack_id(graph_ptr, client_ptr);
+
+  client_ptr->owner_ptr = graph_ptr;
+  client_ptr->client_hook.jack_id_changed = ladish_graph_client_jack_id_changed;
+  ladish_client_add_hook(client_ptr->client, &client_ptr->client_hook);
+}
+
+static void ladish_graph_unhash_client(struct ladish_graph_client * client_ptr)
+{
+  ladish_client_del_hook(&client_ptr->client_hook);
+
+  ladish_graph_index_del(&client_ptr->owner_ptr->clients_by_id, &client_ptr->hash_id);
+  ladish_graph_index_del(&client_ptr->owner_ptr->clients_by_handle, &client_ptr->hash_handle);
+  ladish_graph_index_del(&client_ptr->owner_ptr->clients_by_uuid, &client_ptr->hash_uuid);
+  ladish_graph_index_del(&client_ptr->owner_ptr->clients_by_name, &client_ptr->hash_name);
+  ladish_graph_index_del(&client_ptr->owner_ptr->clients_by_jack_id, &client_ptr->hash_jack_id);
+}
+
+static void ladish_graph_change_free(struct ladish_graph_change * change_ptr)
+{
+  free(change_ptr->name);
+  free(change_ptr->old_name);
+}
+
+static void ladish_graph_journal_truncate(struct ladish_graph * graph_ptr)
+{
+  while (graph_ptr->journal_count > 0)
+  {
+    ladish_graph_change_free(graph_ptr->journal + graph_ptr->journal_head);
+    graph_ptr->journal_head = (graph_ptr->journal_head + 1) % LADISH_GRAPH_JOURNAL_SIZE;
+    graph_ptr->journal_count--;
+  }
+
+  graph_ptr->journal_base_version = graph_ptr->graph_version;
+}
+
+static
+void
+ladish_graph_journal_record(
+  struct ladish_graph * graph_ptr,
+  uint32_t type,
+  uint64_t client1_id,
+  uint64_t port1_id,
+  uint64_t client2_id,
+  uint64_t port2_id,
+  const char * name,
+  const char * old_name,
+  uint32_t port_flags,
+  uint32_t port_type)
+{
+  struct ladish_graph_change * change_ptr;
+
+  /* Every change that is announced with a signal gets its own version,
+   * except that changes made in one batch share version. Changes of hidden
+   * objects get none, so a gap in the versions seen by a client really
+   * means a missed signal. */
+  if (!graph_ptr->batch_changed)
+  {
+    graph_ptr->graph_version++;
+    graph_ptr->batch_changed = graph_ptr->batch;
+  }
+
+  if (graph_ptr->journal == NULL)
+  {
+    graph_ptr->journal = malloc(LADISH_GRAPH_JOURNAL_SIZE * sizeof(struct ladish_graph_change));
+    if (graph_ptr->journal == NULL)
+    {
+      log_error("malloc() failed for graph change journal");
+      graph_ptr->journal_base_version = graph_ptr->graph_version;
+      return;
+    }
+
+    graph_ptr->journal_head = 0;
+    graph_ptr->journal_count = 0;
+  }
+
+  if (graph_ptr->journal_count == LADISH_GRAPH_JOURNAL_SIZE)
+  {
+    change_ptr = graph_ptr->journal + graph_ptr->journal_head;
+    graph_ptr->journal_base_version = change_ptr->version;
+    ladish_graph_change_free(change_ptr);
+    graph_ptr->journal_head = (graph_ptr->journal_head + 1) % LADISH_GRAPH_JOURNAL_SIZE;
+    graph_ptr->journal_count--;
+  }
+
+  change_ptr = graph_ptr->journal + (graph_ptr->journal_head + graph_ptr->journal_count) % LADISH_GRAPH_JOURNAL_SIZE;
+
+  change_ptr->name = NULL;
+  change_ptr->old_name = NULL;
+
+  if ((name != NULL && (change_ptr->name = strdup(name)) == NULL) ||
+      (old_name != NULL && (change_ptr->old_name = strdup(old_name)) == NULL))
+  {
+    log_error("strdup() failed for graph change name");
+    ladish_graph_change_free(change_ptr);
+    ladish_graph_journal_truncate(graph_ptr);
+    return;
+  }
+
+  change_ptr->version = graph_ptr->graph_version;
+  change_ptr->type = type;
+  change_ptr->client1_id = client1_id;
+  change_ptr->port1_id = port1_id;
+  change_ptr->client2_id = client2_id;
+  change_ptr->port2_id = port2_id;
+  change_ptr->port_flags = port_flags;
+  change_ptr->port_type = port_type;
+
+  graph_ptr->journal_count++;
+}
+
+static
+void
+ladish_graph_journal_record_connection(
+  struct ladish_graph * graph_ptr,
+  uint32_t type,
+  struct ladish_graph_connection * connection_ptr)
+{
+  ladish_graph_journal_record(
+    graph_ptr,
+    type,
+    connection_ptr->port1_ptr->client_ptr->id,
+    connection_ptr->port1_ptr->id,
+    connection_ptr->port2_ptr->client_ptr->id,
+    connection_ptr->port2_ptr->id,
+    NULL,
+    NULL,
+    0,
+    0);
+}
+
 static void ladish_graph_emit_ports_disconnected(struct ladish_graph * graph_ptr, struct ladish_graph_connection * connection_ptr)
 {
   ASSERT(graph_ptr->opath != NULL);
 
+  ladish_graph_journal_record_connection(graph_ptr, GRAPH_CHANGE_PORTS_DISCONNECTED, connection_ptr);
+
   cdbus_signal_emit(
     cdbus_g_dbus_connection,
     graph_ptr->opath,
@@ -110,6 +546,8 @@ static void ladish_graph_emit_ports_connected(struct ladish_graph * graph_ptr, s
 {
   ASSERT(graph_ptr->opath != NULL);
 
+  ladish_graph_journal_record_connection(graph_ptr, GRAPH_CHANGE_PORTS_CONNECTED, connection_ptr);
+
   cdbus_signal_emit(
     cdbus_g_dbus_connection,
     graph_ptr->opath,
@@ -132,6 +570,8 @@ static void ladish_graph_emit_client_appeared(struct ladish_graph * graph_ptr, s
 {
   ASSERT(graph_ptr->opath != NULL);
 
+  ladish_graph_journal_record(graph_ptr, GRAPH_CHANGE_CLIENT_APPEARED, client_ptr->id, 0, 0, 0, client_ptr->name, NULL, 0, 0);
+
   cdbus_signal_emit(
     cdbus_g_dbus_connection,
     graph_ptr->opath,
@@ -147,6 +587,8 @@ static void ladish_graph_emit_client_disappeared(struct ladish_graph * graph_ptr
 {
   ASSERT(graph_ptr->opath != NULL);
 
+  ladish_graph_journal_record(graph_ptr, GRAPH_CHANGE_CLIENT_DISAPPEARED, client_ptr->id, 0, 0, 0, client_ptr->name, NULL, 0, 0);
+
   cdbus_signal_emit(
     cdbus_g_dbus_connection,
     graph_ptr->opath,
@@ -162,6 +604,18 @@ static void ladish_graph_emit_port_appeared(struct ladish_graph * graph_ptr, str
 {
   ASSERT(graph_ptr->opath != NULL);
 
+  ladish_graph_journal_record(
+    graph_ptr,
+    GRAPH_CHANGE_PORT_APPEARED,
+    port_ptr->client_ptr->id,
+    port_ptr->id,
+    0,
+    0,
+    port_ptr->name,
+    NULL,
+    port_ptr->flags,
+    port_ptr->type);
+
   cdbus_signal_emit(
     cdbus_g_dbus_connection,
     graph_ptr->opath,
@@ -181,6 +635,8 @@ static void ladish_graph_emit_port_disappeared(struct ladish_graph * graph_ptr,
 {
   ASSERT(graph_ptr->opath != NULL);
 
+  ladish_graph_journal_record(graph_ptr, GRAPH_CHANGE_PORT_DISAPPEARED, port_ptr->client_ptr->id, port_ptr->id, 0, 0, port_ptr->name, NULL, 0, 0);
+
   cdbus_signal_emit(
     cdbus_g_dbus_connection,
     graph_ptr->opath,
@@ -302,12 +758,11 @@ ladish_graph_find_connection_ports_by_name(
 
 static struct ladish_graph_port * ladish_graph_find_port_by_id_internal(struct ladish_graph * graph_ptr, uint64_t port_id)
 {
-  struct list_head * node_ptr;
+  struct hlist_node * node_ptr;
   struct ladish_graph_port * port_ptr;
 
-  list_for_each(node_ptr, &graph_ptr->ports)
+  hlist_for_each_entry(port_ptr, node_ptr, LADISH_GRAPH_INDEX_BUCKET(graph_ptr->ports_by_id, ladish_hash_u64(port_id)), hash_id.siblings)
   {
-    port_ptr = list_entry(node_ptr, struct ladish_graph_port, siblings_graph);
     if (port_ptr->id == port_id)
     {
       return port_ptr;
@@ -319,6 +774,56 @@ static struct ladish_graph_port * ladish_graph_find_port_by_id_internal(struct l
 
 //#define LOG_PORT_LOOKUP
 
+/* Of two matching ports, the one that comes first in the graph port list wins */
+static inline
+struct ladish_graph_port *
+ladish_graph_first_port(
+  struct ladish_graph_port * port1_ptr,
+  struct ladish_graph_port * port2_ptr)
+{
+  if (port1_ptr == NULL || (port2_ptr != NULL && port2_ptr->id < port1_ptr->id))
+  {
+    return port2_ptr;
+  }
+
+  return port1_ptr;
+}
+
+/* Of two matching clients, the one that comes first in the graph client list wins */
+static inline
+struct ladish_graph_client *
+ladish_graph_first_client(
+  struct ladish_graph_client * client1_ptr,
+  struct ladish_graph_client * client2_ptr)
+{
+  if (client1_ptr == NULL || (client2_ptr != NULL && client2_ptr->id < client1_ptr->id))
+  {
+    return client2_ptr;
+  }
+
+  return client1_ptr;
+}
+
+static inline
+bool
+ladish_graph_port_filter(
+  struct ladish_graph_port * port_ptr,
+  struct ladish_graph_client * client_ptr,
+  void * vgraph_filter)
+{
+  if (client_ptr != NULL && port_ptr->client_ptr != client_ptr)
+  {
+    return false;
+  }
+
+  if (vgraph_filter != NULL && ladish_port_get_vgraph(port_ptr->port) != vgraph_filter)
+  {
+    return false;
+  }
+
+  return true;
+}
+
 static struct ladish_graph_port *
 ladish_graph_find_port_by_uuid_internal(
   struct ladish_graph * graph_ptr,
@@ -327,72 +832,60 @@ ladish_graph_find_port_by_uuid_internal(
   bool use_link_override_uuids,
   void * vgraph_filter)
 {
-  struct list_head * node_ptr;
+  struct hlist_node * node_ptr;
   struct ladish_graph_port * port_ptr;
+  struct ladish_graph_port * found_port_ptr;
   uuid_t current_uuid;
+  uint32_t hash;
 #if defined(LOG_PORT_LOOKUP)
-  char uuid1_str[37];
-  char uuid2_str[37];
+  char uuid_str[37];
 
-  log_info("searching by uuid for port in graph %s", ladish_graph_get_description((ladish_graph_handle)graph_ptr));
-  uuid_unparse(uuid, uuid1_str);
+  uuid_unparse(uuid, uuid_str);
+  log_info("searching by uuid %s for port in graph %s", uuid_str, ladish_graph_get_description((ladish_graph_handle)graph_ptr));
 #endif
 
-  list_for_each(node_ptr, &graph_ptr->ports)
-  {
-    port_ptr = list_entry(node_ptr, struct ladish_graph_port, siblings_graph);
-
-    if (client_ptr != NULL && port_ptr->client_ptr != client_ptr)
-    {
-      continue;
-    }
-
-    if (vgraph_filter != NULL && ladish_port_get_vgraph(port_ptr->port) != vgraph_filter)
-    {
-      continue;
-    }
+  found_port_ptr = NULL;
+  hash = ladish_graph_hash_uuid(uuid);
 
-#if defined(LOG_PORT_LOOKUP)
-    if (port_ptr->link)
+  if (use_link_override_uuids)
+  {
+    hlist_for_each_entry(port_ptr, node_ptr, LADISH_GRAPH_INDEX_BUCKET(graph_ptr->ports_by_link_uuid, hash), hash_link_uuid.siblings)
     {
-      uuid_unparse(port_ptr->link_uuid_override, uuid2_str);
-      log_info("comparing link uuid %s with %s", uuid2_str, uuid1_str);
+      if (uuid_compare(port_ptr->link_uuid_override, uuid) == 0 &&
+          ladish_graph_port_filter(port_ptr, client_ptr, vgraph_filter))
+      {
+        found_port_ptr = ladish_graph_first_port(found_port_ptr, port_ptr);
+      }
     }
-#endif
+  }
 
-    if (use_link_override_uuids && port_ptr->link && uuid_compare(port_ptr->link_uuid_override, uuid) == 0)
+  hlist_for_each_entry(port_ptr, node_ptr, LADISH_GRAPH_INDEX_BUCKET(graph_ptr->ports_by_uuid, hash), hash_uuid.siblings)
+  {
+    ladish_port_get_uuid(port_ptr->port, current_uuid);
+    if (uuid_compare(current_uuid, uuid) == 0 &&
+        ladish_graph_port_filter(port_ptr, client_ptr, vgraph_filter))
     {
-#if defined(LOG_PORT_LOOKUP)
-      log_info("found link port %p of client '%s'", port_ptr->port, port_ptr->client_ptr->name);
-#endif
-      return port_ptr;
+      found_port_ptr = ladish_graph_first_port(found_port_ptr, port_ptr);
     }
+  }
 
-    ladish_port_get_uuid(port_ptr->port, current_uuid);
-#if defined(LOG_PORT_LOOKUP)
-    uuid_unparse(current_uuid, uuid2_str);
-    log_info("comparing port uuid %s with %s", uuid2_str, uuid1_str);
-#endif
-    if (uuid_compare(current_uuid, uuid) == 0)
-    {
 #if defined(LOG_PORT_LOOKUP)
-      log_info("found port %p of client '%s'", port_ptr->port, port_ptr->client_ptr->name);
-#endif
-      return port_ptr;
-    }
+  if (found_port_ptr != NULL)
+  {
+    log_info("found port %p of client '%s'", found_port_ptr->port, found_port_ptr->client_ptr->name);
   }
+#endif
 
-  return NULL;
+  return found_port_ptr;
 }
 
 static struct ladish_graph_connection * ladish_graph_find_connection_by_id(struct ladish_graph * graph_ptr, uint64_t connection_id)
 {
-  struct list_head * node_ptr;
+  struct hlist_node * node_ptr;
   struct ladish_graph_connection * connection_ptr;
 
-  list_for_each(node_ptr, &graph_ptr->connections)
+  hlist_for_each_entry(connection_ptr, node_ptr, LADISH_GRAPH_INDEX_BUCKET(graph_ptr->connections_by_id, ladish_hash_u64(connection_id)), hash_id.siblings)
   {
-    connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
     if (connection_ptr->id == connection_id)
     {
       return connection_ptr;
@@ -402,19 +895,21 @@ static struct ladish_graph_connection * ladish_graph_find_connection_by_id(struc
   return NULL;
 }
 
+#define ladish_graph_connection_end_entry(node_ptr) (list_entry(node_ptr, struct ladish_graph_connection_end, siblings)->connection_ptr)
+
 static
 struct ladish_graph_connection *
 ladish_graph_find_connection_by_ports(
-  struct ladish_graph * graph_ptr,
+  struct ladish_graph * UNUSED(graph_ptr),
   struct ladish_graph_port * port1_ptr,
   struct ladish_graph_port * port2_ptr)
 {
   struct list_head * node_ptr;
   struct ladish_graph_connection * connection_ptr;
 
-  list_for_each(node_ptr, &graph_ptr->connections)
+  list_for_each(node_ptr, &port1_ptr->connections)
   {
-    connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
+    connection_ptr = ladish_graph_connection_end_entry(node_ptr);
     if ((connection_ptr->port1_ptr == port1_ptr && connection_ptr->port2_ptr == port2_ptr) ||
         (connection_ptr->port1_ptr == port2_ptr && connection_ptr->port2_ptr == port1_ptr))
     {
@@ -425,13 +920,32 @@ ladish_graph_find_connection_by_ports(
   return NULL;
 }
 
-#define graph_ptr ((struct ladish_graph *)call_ptr->iface_context)
-
-static void get_all_ports(struct cdbus_method_call * call_ptr)
+static bool ladish_graph_request_disconnect_internal(struct ladish_graph * graph_ptr, struct ladish_graph_connection * connection_ptr)
 {
-  DBusMessageIter iter, sub_iter;
-
-  call_ptr->reply = dbus_message_new_method_return(call_ptr->message);
+  log_info(
+    "disconnecting '%s':'%s' from '%s':'%s'",
+    connection_ptr->port1_ptr->client_ptr->name,
+    connection_ptr->port1_ptr->name,
+    connection_ptr->port2_ptr->client_ptr->name,
+    connection_ptr->port2_ptr->name);
+
+  connection_ptr->changing = true;
+  if (!graph_ptr->disconnect_handler(graph_ptr->context, (ladish_graph_handle)graph_ptr, connection_ptr->id))
+  {
+    connection_ptr->changing = false;
+    return false;
+  }
+
+  return true;
+}
+
+#define graph_ptr ((struct ladish_graph *)call_ptr->iface_context)
+
+static void get_all_ports(struct cdbus_method_call * call_ptr)
+{
+  DBusMessageIter iter, sub_iter;
+
+  call_ptr->reply = dbus_message_new_method_return(call_ptr->message);
   if (call_ptr->reply == NULL)
   {
     goto fail;
@@ -716,6 +1230,115 @@ exit:
   return;
 }
 
+static void get_graph_changes(struct cdbus_method_call * call_ptr)
+{
+  dbus_uint64_t known_version;
+  dbus_uint64_t current_version;
+  dbus_bool_t complete;
+  DBusMessageIter iter;
+  DBusMessageIter changes_array_iter;
+  DBusMessageIter change_struct_iter;
+  struct ladish_graph_change * change_ptr;
+  unsigned int i;
+  const char * name;
+  const char * old_name;
+
+  if (!dbus_message_get_args(call_ptr->message, &cdbus_g_dbus_error, DBUS_TYPE_UINT64, &known_version, DBUS_TYPE_INVALID))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": %s",  call_ptr->method_name, cdbus_g_dbus_error.message);
+    dbus_error_free(&cdbus_g_dbus_error);
+    return;
+  }
+
+  current_version = graph_ptr->graph_version;
+  if (known_version > current_version)
+  {
+    cdbus_error(
+      call_ptr,
+      DBUS_ERROR_INVALID_ARGS,
+      "known graph version %" PRIu64 " is newer than actual version %" PRIu64,
+      known_version,
+      current_version);
+    return;
+  }
+
+  /* when the journal was truncated past the known version, the caller has to fetch the whole graph */
+  complete = known_version >= graph_ptr->journal_base_version;
+
+  call_ptr->reply = dbus_message_new_method_return(call_ptr->message);
+  if (call_ptr->reply == NULL)
+  {
+    goto fail;
+  }
+
+  dbus_message_iter_init_append(call_ptr->reply, &iter);
+
+  if (!dbus_message_iter_append_basic(&iter, DBUS_TYPE_UINT64, &current_version) ||
+      !dbus_message_iter_append_basic(&iter, DBUS_TYPE_BOOLEAN, &complete))
+  {
+    goto fail_unref;
+  }
+
+  if (!dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "(tuttttssuu)", &changes_array_iter))
+  {
+    goto fail_unref;
+  }
+
+  for (i = 0; complete && i < graph_ptr->journal_count; i++)
+  {
+    change_ptr = graph_ptr->journal + (graph_ptr->journal_head + i) % LADISH_GRAPH_JOURNAL_SIZE;
+    if (change_ptr->version <= known_version)
+    {
+      continue;
+    }
+
+    name = change_ptr->name != NULL ? change_ptr->name : "";
+    old_name = change_ptr->old_name != NULL ? change_ptr->old_name : "";
+
+    if (!dbus_message_iter_open_container(&changes_array_iter, DBUS_TYPE_STRUCT, NULL, &change_struct_iter))
+    {
+      goto fail_close_changes_array;
+    }
+
+    if (!dbus_message_iter_append_basic(&change_struct_iter, DBUS_TYPE_UINT64, &change_ptr->version) ||
+        !dbus_message_iter_append_basic(&change_struct_iter, DBUS_TYPE_UINT32, &change_ptr->type) ||
+        !dbus_message_iter_append_basic(&change_struct_iter, DBUS_TYPE_UINT64, &change_ptr->client1_id) ||
+        !dbus_message_iter_append_basic(&change_struct_iter, DBUS_TYPE_UINT64, &change_ptr->port1_id) ||
+        !dbus_message_iter_append_basic(&change_struct_iter, DBUS_TYPE_UINT64, &change_ptr->client2_id) ||
+        !dbus_message_iter_append_basic(&change_struct_iter, DBUS_TYPE_UINT64, &change_ptr->port2_id) ||
+        !dbus_message_iter_append_basic(&change_struct_iter, DBUS_TYPE_STRING, &name) ||
+        !dbus_message_iter_append_basic(&change_struct_iter, DBUS_TYPE_STRING, &old_name) ||
+        !dbus_message_iter_append_basic(&change_struct_iter, DBUS_TYPE_UINT32, &change_ptr->port_flags) ||
+        !dbus_message_iter_append_basic(&change_struct_iter, DBUS_TYPE_UINT32, &change_ptr->port_type))
+    {
+      dbus_message_iter_close_container(&changes_array_iter, &change_struct_iter);
+      goto fail_close_changes_array;
+    }
+
+    if (!dbus_message_iter_close_container(&changes_array_iter, &change_struct_iter))
+    {
+      goto fail_close_changes_array;
+    }
+  }
+
+  if (!dbus_message_iter_close_container(&iter, &changes_array_iter))
+  {
+    goto fail_unref;
+  }
+
+  return;
+
+fail_close_changes_array:
+  dbus_message_iter_close_container(&iter, &changes_array_iter);
+
+fail_unref:
+  dbus_message_unref(call_ptr->reply);
+  call_ptr->reply = NULL;
+
+fail:
+  log_error("Ran out of memory trying to construct method return");
+}
+
 static void connect_ports_by_name(struct cdbus_method_call * call_ptr)
 {
   const char * client1_name;
@@ -807,21 +1430,12 @@ static void connect_ports_by_id(struct cdbus_method_call * call_ptr)
 
 static void disconnect_ports(struct cdbus_method_call * call_ptr, struct ladish_graph_connection * connection_ptr)
 {
-  log_info(
-    "disconnecting '%s':'%s' from '%s':'%s'",
-    connection_ptr->port1_ptr->client_ptr->name,
-    connection_ptr->port1_ptr->name,
-    connection_ptr->port2_ptr->client_ptr->name,
-    connection_ptr->port2_ptr->name);
-
-  connection_ptr->changing = true;
-  if (graph_ptr->disconnect_handler(graph_ptr->context, (ladish_graph_handle)graph_ptr, connection_ptr->id))
+  if (ladish_graph_request_disconnect_internal(graph_ptr, connection_ptr))
   {
     cdbus_method_return_new_void(call_ptr);
   }
   else
   {
-    connection_ptr->changing = false;
     cdbus_error(call_ptr, DBUS_ERROR_FAILED, "disconnect failed");
   }
 }
@@ -988,6 +1602,19 @@ bool ladish_graph_create(ladish_graph_handle * graph_handle_ptr, const char * op
   INIT_LIST_HEAD(&graph_ptr->ports);
   INIT_LIST_HEAD(&graph_ptr->connections);
 
+  ladish_graph_index_init(&graph_ptr->clients_by_id);
+  ladish_graph_index_init(&graph_ptr->clients_by_handle);
+  ladish_graph_index_init(&graph_ptr->clients_by_uuid);
+  ladish_graph_index_init(&graph_ptr->clients_by_name);
+  ladish_graph_index_init(&graph_ptr->clients_by_jack_id);
+  ladish_graph_index_init(&graph_ptr->ports_by_id);
+  ladish_graph_index_init(&graph_ptr->ports_by_handle);
+  ladish_graph_index_init(&graph_ptr->ports_by_uuid);
+  ladish_graph_index_init(&graph_ptr->ports_by_link_uuid);
+  ladish_graph_index_init(&graph_ptr->ports_by_jack_id);
+  ladish_graph_index_init(&graph_ptr->ports_by_jack_id_room);
+  ladish_graph_index_init(&graph_ptr->connections_by_id);
+
   graph_ptr->graph_version = 1;
   graph_ptr->next_client_id = 1;
   graph_ptr->next_port_id = 1;
@@ -999,6 +1626,21 @@ bool ladish_graph_create(ladish_graph_handle * graph_handle_ptr, const char * op
 
   graph_ptr->persist = true;
 
+  graph_ptr->journal = NULL;
+  graph_ptr->journal_head = 0;
+  graph_ptr->journal_count = 0;
+  graph_ptr->journal_base_version = graph_ptr->graph_version;
+  graph_ptr->batch = false;
+  graph_ptr->batch_changed = false;
+  graph_ptr->connect_async_handler = NULL;
+  INIT_LIST_HEAD(&graph_ptr->connect_pending);
+  INIT_LIST_HEAD(&graph_ptr->connect_retry);
+  graph_ptr->connect_retry_round = 0;
+  graph_ptr->restoring = false;
+  graph_ptr->restore_autorun = false;
+  graph_ptr->restored_count = 0;
+  graph_ptr->restore_failed_count = 0;
+
   *graph_handle_ptr = (ladish_graph_handle)graph_ptr;
   return true;
 }
@@ -1009,12 +1651,11 @@ ladish_graph_find_client(
   struct ladish_graph * graph_ptr,
   ladish_client_handle client)
 {
-  struct list_head * node_ptr;
+  struct hlist_node * node_ptr;
   struct ladish_graph_client * client_ptr;
 
-  list_for_each(node_ptr, &graph_ptr->clients)
+  hlist_for_each_entry(client_ptr, node_ptr, LADISH_GRAPH_INDEX_BUCKET(graph_ptr->clients_by_handle, ladish_hash_ptr(client)), hash_handle.siblings)
   {
-    client_ptr = list_entry(node_ptr, struct ladish_graph_client, siblings);
     if (client_ptr->client == client)
     {
       return client_ptr;
@@ -1030,14 +1671,13 @@ ladish_graph_find_port(
   struct ladish_graph * graph_ptr,
   ladish_port_handle port)
 {
-  struct list_head * node_ptr;
+  struct hlist_node * node_ptr;
   struct ladish_graph_port * port_ptr;
 
   //log_info("searching port %p", port);
 
-  list_for_each(node_ptr, &graph_ptr->ports)
+  hlist_for_each_entry(port_ptr, node_ptr, LADISH_GRAPH_INDEX_BUCKET(graph_ptr->ports_by_handle, ladish_hash_ptr(port)), hash_handle.siblings)
   {
-    port_ptr = list_entry(node_ptr, struct ladish_graph_port, siblings_graph);
     //log_info("checking port %s:%s, %p", port_ptr->client_ptr->name, port_ptr->name, port_ptr->port);
     if (port_ptr->port == port)
     {
@@ -1062,7 +1702,9 @@ ladish_graph_find_port_by_jack_id_internal(
   bool studio)
 {
   struct list_head * node_ptr;
+  struct hlist_node * hnode_ptr;
   struct ladish_graph_port * port_ptr;
+  struct ladish_graph_port * found_port_ptr;
 
   ASSERT(room || studio);
 
@@ -1075,61 +1717,460 @@ ladish_graph_find_port_by_jack_id_internal(
     ladish_graph_get_description((ladish_graph_handle)graph_ptr));
 #endif
 
-  list_for_each(node_ptr, &graph_ptr->ports)
-  {
-    port_ptr = list_entry(node_ptr, struct ladish_graph_port, siblings_graph);
-#if defined(LOG_PORT_LOOKUP)
-    log_info(
-      "checking jack port id of port %s:%s, %p; studio id %"PRIu64", room id %"PRIu64,
-      port_ptr->client_ptr->name,
-      port_ptr->name, port_ptr->port,
-      ladish_port_get_jack_id(port_ptr->port),
-      ladish_port_get_jack_id_room(port_ptr->port));
-#endif
-    if ((studio && ladish_port_get_jack_id(port_ptr->port) == port_id) ||
-        (room && port_ptr->link && ladish_port_get_jack_id_room(port_ptr->port) == port_id))
+  if (port_id == 0)
+  {
+    /* ports without JACK id are not indexed */
+    list_for_each(node_ptr, &graph_ptr->ports)
+    {
+      port_ptr = list_entry(node_ptr, struct ladish_graph_port, siblings_graph);
+      if ((studio && ladish_port_get_jack_id(port_ptr->port) == port_id) ||
+          (room && port_ptr->link && ladish_port_get_jack_id_room(port_ptr->port) == port_id))
+      {
+        return port_ptr;
+      }
+    }
+
+    return NULL;
+  }
+
+  found_port_ptr = NULL;
+
+  if (studio)
+  {
+    hlist_for_each_entry(port_ptr, hnode_ptr, LADISH_GRAPH_INDEX_BUCKET(graph_ptr->ports_by_jack_id, ladish_hash_u64(port_id)), hash_jack_id.siblings)
+    {
+      if (ladish_port_get_jack_id(port_ptr->port) == port_id)
+      {
+        found_port_ptr = ladish_graph_first_port(found_port_ptr, port_ptr);
+      }
+    }
+  }
+
+  if (room)
+  {
+    hlist_for_each_entry(port_ptr, hnode_ptr, LADISH_GRAPH_INDEX_BUCKET(graph_ptr->ports_by_jack_id_room, ladish_hash_u64(port_id)), hash_jack_id_room.siblings)
+    {
+      if (ladish_port_get_jack_id_room(port_ptr->port) == port_id)
+      {
+        found_port_ptr = ladish_graph_first_port(found_port_ptr, port_ptr);
+      }
+    }
+  }
+
+#if defined(LOG_PORT_LOOKUP)
+  if (found_port_ptr != NULL)
+  {
+    log_info("found port %s:%s, %p", found_port_ptr->client_ptr->name, found_port_ptr->name, found_port_ptr->port);
+  }
+#endif
+
+  return found_port_ptr;
+}
+
+#if 0
+static
+struct ladish_graph_port *
+ladish_graph_find_client_port(
+  struct ladish_graph * graph_ptr,
+  struct ladish_graph_client * client_ptr,
+  ladish_port_handle port)
+{
+  struct list_head * node_ptr;
+  struct ladish_graph_port * port_ptr;
+
+  list_for_each(node_ptr, &client_ptr->ports)
+  {
+    port_ptr = list_entry(node_ptr, struct ladish_graph_port, siblings_client);
+    if (port_ptr->port == port)
+    {
+      return port_ptr;
+    }
+  }
+
+  return NULL;
+}
+#endif
+
+static void ladish_graph_hide_connection_internal(struct ladish_graph * graph_ptr, struct ladish_graph_connection * connection_ptr)
+{
+  ASSERT(!connection_ptr->hidden);
+  connection_ptr->hidden = true;
+
+  if (graph_ptr->opath != NULL)
+  {
+    ladish_graph_emit_ports_disconnected(graph_ptr, connection_ptr);
+  }
+}
+
+struct ladish_graph_connect_request
+{
+  struct list_head siblings;            /* link in ladish_graph::connect_pending or ladish_graph::connect_retry */
+  struct ladish_graph * graph_ptr;      /* NULL when the graph dropped the request that waits for reply */
+  uint64_t connection_id;
+  unsigned int attempts;
+};
+
+static void ladish_graph_connect_retry(void * context);
+static void ladish_graph_restore_timeout(void * context);
+
+static void ladish_graph_restore_complete(struct ladish_graph * graph_ptr)
+{
+  graph_ptr->restoring = false;
+  graph_ptr->restore_autorun = false;
+  ladish_reactor_cancel(graph_ptr, ladish_graph_restore_timeout);
+
+  log_info(
+    "graph %s: %"PRIu32" hidden connection(s) restored, %"PRIu32" failed",
+    graph_ptr->opath,
+    graph_ptr->restored_count,
+    graph_ptr->restore_failed_count);
+
+  cdbus_signal_emit(
+    cdbus_g_dbus_connection,
+    graph_ptr->opath,
+    IFACE_GRAPH_MANAGER,
+    "ConnectionsRestored",
+    "uu",
+    &graph_ptr->restored_count,
+    &graph_ptr->restore_failed_count);
+}
+
+static void ladish_graph_restore_progress(struct ladish_graph * graph_ptr)
+{
+  ladish_reactor_cancel(graph_ptr, ladish_graph_restore_timeout);
+  if (!ladish_reactor_post_delayed(graph_ptr, ladish_graph_restore_timeout, LADISH_GRAPH_RESTORE_TIMEOUT))
+  {
+    log_error("cannot schedule timeout of hidden connections restore");
+  }
+}
+
+static void ladish_graph_connect_check_done(struct ladish_graph * graph_ptr)
+{
+  struct ladish_graph_connect_request * request_ptr;
+  unsigned int round;
+
+  if (graph_ptr->restoring)
+  {
+    ladish_graph_restore_progress(graph_ptr);
+  }
+
+  if (!list_empty(&graph_ptr->connect_pending))
+  {
+    return;
+  }
+
+  if (!list_empty(&graph_ptr->connect_retry))
+  {
+    round = graph_ptr->connect_retry_round;
+    if (round > LADISH_GRAPH_CONNECT_RETRIES)
+    {
+      round = LADISH_GRAPH_CONNECT_RETRIES;
+    }
+
+    if (ladish_reactor_post_delayed(graph_ptr, ladish_graph_connect_retry, LADISH_GRAPH_CONNECT_RETRY_DELAY << round))
+    {
+      graph_ptr->connect_retry_round++;
+      return;
+    }
+
+    log_error("cannot schedule retry of failed auto connects");
+
+    while (!list_empty(&graph_ptr->connect_retry))
+    {
+      request_ptr = list_entry(graph_ptr->connect_retry.next, struct ladish_graph_connect_request, siblings);
+      list_del(&request_ptr->siblings);
+      free(request_ptr);
+      graph_ptr->restore_failed_count++;
+    }
+  }
+
+  graph_ptr->connect_retry_round = 0;
+
+  /* apps started later may make more of the saved connections connectable */
+  if (!graph_ptr->restoring || graph_ptr->restore_autorun)
+  {
+    return;
+  }
+
+  ladish_graph_restore_complete(graph_ptr);
+}
+
+static
+void
+ladish_graph_connect_failed(
+  struct ladish_graph * graph_ptr,
+  struct ladish_graph_connect_request * request_ptr)
+{
+  if (request_ptr->attempts <= LADISH_GRAPH_CONNECT_RETRIES)
+  {
+    list_add_tail(&request_ptr->siblings, &graph_ptr->connect_retry);
+    return;
+  }
+
+  log_error("giving up auto connect of connection %"PRIu64" after %u attempts", request_ptr->connection_id, request_ptr->attempts);
+
+  if (graph_ptr->restoring)
+  {
+    graph_ptr->restore_failed_count++;
+  }
+
+  free(request_ptr);
+}
+
+#define request_ptr ((struct ladish_graph_connect_request *)context)
+
+static void ladish_graph_on_connect_reply(void * context, bool success)
+{
+  struct ladish_graph * graph_ptr;
+  struct ladish_graph_connection * connection_ptr;
+
+  graph_ptr = request_ptr->graph_ptr;
+  if (graph_ptr == NULL)
+  {
+    free(request_ptr);
+    return;
+  }
+
+  list_del(&request_ptr->siblings);
+
+  connection_ptr = ladish_graph_find_connection_by_id(graph_ptr, request_ptr->connection_id);
+
+  if (success)
+  {
+    /* the connection will be shown when the connect notification is received */
+    if (graph_ptr->restoring)
+    {
+      graph_ptr->restored_count++;
+    }
+
+    free(request_ptr);
+  }
+  else if (connection_ptr == NULL)
+  {
+    free(request_ptr);
+  }
+  else
+  {
+    log_error("auto connect of connection %"PRIu64" failed.", request_ptr->connection_id);
+
+    if (connection_ptr->hidden)
+    {
+      connection_ptr->changing = false;
+    }
+
+    ladish_graph_connect_failed(graph_ptr, request_ptr);
+  }
+
+  ladish_graph_connect_check_done(graph_ptr);
+}
+
+#undef request_ptr
+
+static
+void
+ladish_graph_connect_send(
+  struct ladish_graph * graph_ptr,
+  struct ladish_graph_connect_request * request_ptr)
+{
+  struct ladish_graph_connection * connection_ptr;
+
+  connection_ptr = ladish_graph_find_connection_by_id(graph_ptr, request_ptr->connection_id);
+  if (connection_ptr == NULL ||
+      !connection_ptr->hidden ||
+      connection_ptr->changing ||
+      connection_ptr->port1_ptr->hidden ||
+      connection_ptr->port2_ptr->hidden)
+  {
+    /* removed or already connected, or one of the ports disappeared meanwhile */
+    free(request_ptr);
+    return;
+  }
+
+  request_ptr->attempts++;
+  connection_ptr->changing = true;
+  list_add_tail(&request_ptr->siblings, &graph_ptr->connect_pending);
+
+  if (!graph_ptr->connect_async_handler(
+        graph_ptr->context,
+        (ladish_graph_handle)graph_ptr,
+        connection_ptr->port1_ptr->port,
+        connection_ptr->port2_ptr->port,
+        request_ptr,
+        ladish_graph_on_connect_reply))
+  {
+    list_del(&request_ptr->siblings);
+    connection_ptr->changing = false;
+    ladish_graph_connect_failed(graph_ptr, request_ptr);
+  }
+}
+
+#define graph_ptr ((struct ladish_graph *)context)
+
+static void ladish_graph_connect_retry(void * context)
+{
+  struct list_head requests;
+  struct ladish_graph_connect_request * request_ptr;
+
+  INIT_LIST_HEAD(&requests);
+  list_splice_init(&graph_ptr->connect_retry, &requests);
+
+  log_info("retrying auto connect of hidden connections in graph %s", graph_ptr->opath);
+
+  while (!list_empty(&requests))
+  {
+    request_ptr = list_entry(requests.next, struct ladish_graph_connect_request, siblings);
+    list_del(&request_ptr->siblings);
+    ladish_graph_connect_send(graph_ptr, request_ptr);
+  }
+
+  ladish_graph_connect_check_done(graph_ptr);
+}
+
+static void ladish_graph_restore_timeout(void * context)
+{
+  struct list_head * node_ptr;
+
+  if (!graph_ptr->restoring)
+  {
+    return;
+  }
+
+  /* requests still in flight are reported as failed, they may complete later */
+  list_for_each(node_ptr, &graph_ptr->connect_pending)
+  {
+    graph_ptr->restore_failed_count++;
+  }
+
+  list_for_each(node_ptr, &graph_ptr->connect_retry)
+  {
+    graph_ptr->restore_failed_count++;
+  }
+
+  log_error("restore of hidden connections in graph %s timed out", graph_ptr->opath);
+  ladish_graph_restore_complete(graph_ptr);
+}
+
+#undef graph_ptr
+
+/* Forget all auto connect requests, replies for the pending ones will be ignored */
+static void ladish_graph_connect_drop(struct ladish_graph * graph_ptr)
+{
+  struct ladish_graph_connect_request * request_ptr;
+  struct ladish_graph_connection * connection_ptr;
+
+  /* the retry task is scheduled only while there are requests to retry */
+  if (!list_empty(&graph_ptr->connect_retry))
+  {
+    ladish_reactor_cancel(graph_ptr, ladish_graph_connect_retry);
+  }
+
+  while (!list_empty(&graph_ptr->connect_pending))
+  {
+    request_ptr = list_entry(graph_ptr->connect_pending.next, struct ladish_graph_connect_request, siblings);
+    list_del(&request_ptr->siblings);
+
+    connection_ptr = ladish_graph_find_connection_by_id(graph_ptr, request_ptr->connection_id);
+    if (connection_ptr != NULL && connection_ptr->hidden)
+    {
+      connection_ptr->changing = false;
+    }
+
+    /* freed when the reply is received */
+    request_ptr->graph_ptr = NULL;
+  }
+
+  while (!list_empty(&graph_ptr->connect_retry))
+  {
+    request_ptr = list_entry(graph_ptr->connect_retry.next, struct ladish_graph_connect_request, siblings);
+    list_del(&request_ptr->siblings);
+    free(request_ptr);
+  }
+
+  graph_ptr->connect_retry_round = 0;
+
+  if (graph_ptr->restoring)
+  {
+    ladish_reactor_cancel(graph_ptr, ladish_graph_restore_timeout);
+    graph_ptr->restoring = false;
+    graph_ptr->restore_autorun = false;
+  }
+}
+
+static void ladish_graph_try_connect_hidden_connection(struct ladish_graph * graph_ptr, struct ladish_graph_connection * connection_ptr)
+{
+  struct ladish_graph_connect_request * request_ptr;
+
+  log_debug(
+    "checking connection (%s, %s) '%s':'%s' (%s) to '%s':'%s' (%s)",
+    connection_ptr->hidden ? "hidden" : "visible",
+    connection_ptr->changing ? "changing" : "not changing",
+    connection_ptr->port1_ptr->client_ptr->name,
+    connection_ptr->port1_ptr->name,
+    connection_ptr->port1_ptr->hidden ? "hidden" : "visible",
+    connection_ptr->port2_ptr->client_ptr->name,
+    connection_ptr->port2_ptr->name,
+    connection_ptr->port2_ptr->hidden ? "hidden" : "visible");
+  if (connection_ptr->hidden &&
+      !connection_ptr->changing &&
+      !connection_ptr->port1_ptr->hidden &&
+      !connection_ptr->port2_ptr->hidden)
+  {
+    log_info(
+      "auto connecting '%s':'%s' to '%s':'%s'",
+      connection_ptr->port1_ptr->client_ptr->name,
+      connection_ptr->port1_ptr->name,
+      connection_ptr->port2_ptr->client_ptr->name,
+      connection_ptr->port2_ptr->name);
+
+    if (graph_ptr->connect_async_handler != NULL)
+    {
+      request_ptr = malloc(sizeof(struct ladish_graph_connect_request));
+      if (request_ptr == NULL)
+      {
+        log_error("malloc() failed to allocate struct ladish_graph_connect_request");
+        return;
+      }
+
+      request_ptr->graph_ptr = graph_ptr;
+      request_ptr->connection_id = connection_ptr->id;
+      request_ptr->attempts = 0;
+
+      ladish_graph_connect_send(graph_ptr, request_ptr);
+      return;
+    }
+
+    connection_ptr->changing = true;
+    if (!graph_ptr->connect_handler(graph_ptr->context, (ladish_graph_handle)graph_ptr, connection_ptr->port1_ptr->port, connection_ptr->port2_ptr->port))
     {
-      //log_info("found");
-      return port_ptr;
+      connection_ptr->changing = false;
+      log_error("auto connect failed.");
+      if (graph_ptr->restoring)
+      {
+        graph_ptr->restore_failed_count++;
+      }
+    }
+    else if (graph_ptr->restoring)
+    {
+      graph_ptr->restored_count++;
     }
   }
-
-  return NULL;
 }
 
-#if 0
-static
-struct ladish_graph_port *
-ladish_graph_find_client_port(
-  struct ladish_graph * graph_ptr,
-  struct ladish_graph_client * client_ptr,
-  ladish_port_handle port)
+static void ladish_graph_try_connect_port_hidden_connections(struct ladish_graph * graph_ptr, struct ladish_graph_port * port_ptr)
 {
   struct list_head * node_ptr;
-  struct ladish_graph_port * port_ptr;
 
-  list_for_each(node_ptr, &client_ptr->ports)
+  if (!list_empty(&port_ptr->connections) && graph_ptr->connect_handler == NULL)
   {
-    port_ptr = list_entry(node_ptr, struct ladish_graph_port, siblings_client);
-    if (port_ptr->port == port)
-    {
-      return port_ptr;
-    }
+    ASSERT_NO_PASS;
+    return;
   }
 
-  return NULL;
-}
-#endif
-
-static void ladish_graph_hide_connection_internal(struct ladish_graph * graph_ptr, struct ladish_graph_connection * connection_ptr)
-{
-  ASSERT(!connection_ptr->hidden);
-  connection_ptr->hidden = true;
-  graph_ptr->graph_version++;
+  ASSERT(graph_ptr->opath != NULL);
 
-  if (graph_ptr->opath != NULL)
+  list_for_each(node_ptr, &port_ptr->connections)
   {
-    ladish_graph_emit_ports_disconnected(graph_ptr, connection_ptr);
+    ladish_graph_try_connect_hidden_connection(graph_ptr, ladish_graph_connection_end_entry(node_ptr));
   }
 }
 
@@ -1138,7 +2179,6 @@ static void ladish_graph_show_port_internal(struct ladish_graph * graph_ptr, str
   if (port_ptr->client_ptr->hidden)
   {
     port_ptr->client_ptr->hidden = false;
-    graph_ptr->graph_version++;
     if (graph_ptr->opath != NULL)
     {
       ladish_graph_emit_client_appeared(graph_ptr, port_ptr->client_ptr);
@@ -1147,11 +2187,12 @@ static void ladish_graph_show_port_internal(struct ladish_graph * graph_ptr, str
 
   ASSERT(port_ptr->hidden);
   port_ptr->hidden = false;
-  graph_ptr->graph_version++;
   if (graph_ptr->opath != NULL)
   {
     ladish_graph_emit_port_appeared(graph_ptr, port_ptr);
-    ladish_try_connect_hidden_connections((ladish_graph_handle)graph_ptr);
+
+    /* only connections of the port that just appeared can become connectable */
+    ladish_graph_try_connect_port_hidden_connections(graph_ptr, port_ptr);
   }
 }
 
@@ -1159,7 +2200,6 @@ static void ladish_graph_hide_port_internal(struct ladish_graph * graph_ptr, str
 {
   ASSERT(!port_ptr->hidden);
   port_ptr->hidden = true;
-  graph_ptr->graph_version++;
 
   if (graph_ptr->opath != NULL)
   {
@@ -1171,7 +2211,6 @@ static void ladish_graph_hide_client_internal(struct ladish_graph * graph_ptr, s
 {
   ASSERT(!client_ptr->hidden);
   client_ptr->hidden = true;
-  graph_ptr->graph_version++;
 
   if (graph_ptr->opath != NULL)
   {
@@ -1188,10 +2227,10 @@ static void ladish_hide_connections(struct ladish_graph * graph_ptr, struct ladi
 
   ASSERT(graph_ptr->opath != NULL);
 
-  list_for_each(node_ptr, &graph_ptr->connections)
+  list_for_each(node_ptr, &port_ptr->connections)
   {
-    connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
-    if (!connection_ptr->hidden && (connection_ptr->port1_ptr == port_ptr || connection_ptr->port2_ptr == port_ptr))
+    connection_ptr = ladish_graph_connection_end_entry(node_ptr);
+    if (!connection_ptr->hidden)
     {
       log_info("hidding connection between ports %"PRIu64" and %"PRIu64, connection_ptr->port1_ptr->id, connection_ptr->port2_ptr->id);
       ladish_graph_hide_connection_internal(graph_ptr, connection_ptr);
@@ -1202,7 +2241,9 @@ static void ladish_hide_connections(struct ladish_graph * graph_ptr, struct ladi
 static void ladish_graph_remove_connection_internal(struct ladish_graph * graph_ptr, struct ladish_graph_connection * connection_ptr)
 {
   list_del(&connection_ptr->siblings);
-  graph_ptr->graph_version++;
+  list_del(&connection_ptr->port1_end.siblings);
+  list_del(&connection_ptr->port2_end.siblings);
+  ladish_graph_index_del(&graph_ptr->connections_by_id, &connection_ptr->hash_id);
 
   if (!connection_ptr->hidden && graph_ptr->opath != NULL)
   {
@@ -1215,18 +2256,13 @@ static void ladish_graph_remove_connection_internal(struct ladish_graph * graph_
 
 static void ladish_graph_remove_port_connections(struct ladish_graph * graph_ptr, struct ladish_graph_port * port_ptr)
 {
-  struct list_head * node_ptr;
-  struct list_head * temp_node_ptr;
   struct ladish_graph_connection * connection_ptr;
 
-  list_for_each_safe(node_ptr, temp_node_ptr, &graph_ptr->connections)
+  while (!list_empty(&port_ptr->connections))
   {
-    connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
-    if (connection_ptr->port1_ptr == port_ptr || connection_ptr->port2_ptr == port_ptr)
-    {
-      log_info("removing connection between ports %"PRIu64" and %"PRIu64, connection_ptr->port1_ptr->id, connection_ptr->port2_ptr->id);
-      ladish_graph_remove_connection_internal(graph_ptr, connection_ptr);
-    }
+    connection_ptr = ladish_graph_connection_end_entry(port_ptr->connections.next);
+    log_info("removing connection between ports %"PRIu64" and %"PRIu64, connection_ptr->port1_ptr->id, connection_ptr->port2_ptr->id);
+    ladish_graph_remove_connection_internal(graph_ptr, connection_ptr);
   }
 }
 
@@ -1239,6 +2275,8 @@ ladish_graph_remove_port_internal(
 {
   ladish_graph_remove_port_connections(graph_ptr, port_ptr);
 
+  ladish_graph_unhash_port(port_ptr);
+  ladish_check_integrity_mark_port(port_ptr->port);
   ladish_port_del_ref(port_ptr->port);
 
   list_del(&port_ptr->siblings_client);
@@ -1275,8 +2313,8 @@ ladish_graph_remove_client_internal(
     ladish_graph_remove_port_internal(graph_ptr, client_ptr, port_ptr);
   }
 
-  graph_ptr->graph_version++;
   list_del(&client_ptr->siblings);
+  ladish_graph_unhash_client(client_ptr);
   log_info("removing client '%s' (%"PRIu64") from graph %s", client_ptr->name, client_ptr->id, graph_ptr->opath != NULL ? graph_ptr->opath : "JACK");
   if (graph_ptr->opath != NULL && !client_ptr->hidden)
   {
@@ -1320,8 +2358,14 @@ bool ladish_graph_client_looks_empty_internal(struct ladish_graph * graph_ptr, s
 
 void ladish_graph_destroy(ladish_graph_handle graph_handle)
 {
+  ladish_graph_connect_drop(graph_ptr);
   ladish_graph_clear(graph_handle, NULL);
   ladish_dict_destroy(graph_ptr->dict);
+  if (graph_ptr->journal != NULL)
+  {
+    ladish_graph_journal_truncate(graph_ptr);
+    free(graph_ptr->journal);
+  }
   if (graph_ptr->opath != NULL)
   {
     free(graph_ptr->opath);
@@ -1339,6 +2383,84 @@ const char * ladish_graph_get_description(ladish_graph_handle graph_handle)
   return graph_ptr->opath != NULL ? graph_ptr->opath : "JACK";
 }
 
+uint64_t ladish_graph_get_version(ladish_graph_handle graph_handle)
+{
+  return graph_ptr->graph_version;
+}
+
+void ladish_graph_batch_begin(ladish_graph_handle graph_handle)
+{
+  ASSERT(!graph_ptr->batch);
+  graph_ptr->batch = true;
+  graph_ptr->batch_changed = false;
+}
+
+void ladish_graph_batch_end(ladish_graph_handle graph_handle)
+{
+  ASSERT(graph_ptr->batch);
+  graph_ptr->batch = false;
+
+  if (!graph_ptr->batch_changed)
+  {
+    return;
+  }
+
+  graph_ptr->batch_changed = false;
+
+  /* the signals of the batch changes are complete */
+  cdbus_signal_emit(
+    cdbus_g_dbus_connection,
+    graph_ptr->opath,
+    JACKDBUS_IFACE_PATCHBAY,
+    "GraphChanged",
+    "t",
+    &graph_ptr->graph_version);
+}
+
+bool ladish_graph_request_connect(ladish_graph_handle graph_handle, ladish_port_handle port1_handle, ladish_port_handle port2_handle)
+{
+  struct ladish_graph_port * port1_ptr;
+  struct ladish_graph_port * port2_ptr;
+
+  if (graph_ptr->connect_handler == NULL)
+  {
+    log_error("connect requests on graph %s cannot be handled", ladish_graph_get_description(graph_handle));
+    return false;
+  }
+
+  port1_ptr = ladish_graph_find_port(graph_ptr, port1_handle);
+  port2_ptr = ladish_graph_find_port(graph_ptr, port2_handle);
+  if (port1_ptr == NULL || port2_ptr == NULL)
+  {
+    ASSERT_NO_PASS;
+    return false;
+  }
+
+  log_info("connecting '%s':'%s' to '%s':'%s'", port1_ptr->client_ptr->name, port1_ptr->name, port2_ptr->client_ptr->name, port2_ptr->name);
+
+  return graph_ptr->connect_handler(graph_ptr->context, graph_handle, port1_handle, port2_handle);
+}
+
+bool ladish_graph_request_disconnect(ladish_graph_handle graph_handle, uint64_t connection_id)
+{
+  struct ladish_graph_connection * connection_ptr;
+
+  if (graph_ptr->disconnect_handler == NULL)
+  {
+    log_error("disconnect requests on graph %s cannot be handled", ladish_graph_get_description(graph_handle));
+    return false;
+  }
+
+  connection_ptr = ladish_graph_find_connection_by_id(graph_ptr, connection_id);
+  if (connection_ptr == NULL)
+  {
+    log_error("cannot disconnect unknown connection %"PRIu64, connection_id);
+    return false;
+  }
+
+  return ladish_graph_request_disconnect_internal(graph_ptr, connection_ptr);
+}
+
 void
 ladish_graph_set_connection_handlers(
   ladish_graph_handle graph_handle,
@@ -1347,9 +2469,20 @@ ladish_graph_set_connection_handlers(
   ladish_graph_disconnect_request_handler disconnect_handler)
 {
   log_info("setting connection handlers for graph '%s'", graph_ptr->opath != NULL ? graph_ptr->opath : "JACK");
+  ladish_graph_connect_drop(graph_ptr);
   graph_ptr->context = graph_context;
   graph_ptr->connect_handler = connect_handler;
   graph_ptr->disconnect_handler = disconnect_handler;
+  graph_ptr->connect_async_handler = NULL;
+}
+
+void
+ladish_graph_set_connect_async_handler(
+  ladish_graph_handle graph_handle,
+  ladish_graph_connect_async_request_handler connect_async_handler)
+{
+  ASSERT(graph_ptr->connect_handler != NULL || connect_async_handler == NULL);
+  graph_ptr->connect_async_handler = connect_async_handler;
 }
 
 void ladish_graph_clear(ladish_graph_handle graph_handle, ladish_graph_simple_port_callback port_callback)
@@ -1370,6 +2503,20 @@ void ladish_graph_clear(ladish_graph_handle graph_handle, ladish_graph_simple_po
     client_ptr = list_entry(graph_ptr->clients.next, struct ladish_graph_client, siblings);
     ladish_graph_remove_client_internal(graph_ptr, client_ptr, true, port_callback);
   }
+
+  /* shrink the indexes back to the initial size */
+  ladish_graph_index_uninit(&graph_ptr->clients_by_id);
+  ladish_graph_index_uninit(&graph_ptr->clients_by_handle);
+  ladish_graph_index_uninit(&graph_ptr->clients_by_uuid);
+  ladish_graph_index_uninit(&graph_ptr->clients_by_name);
+  ladish_graph_index_uninit(&graph_ptr->clients_by_jack_id);
+  ladish_graph_index_uninit(&graph_ptr->ports_by_id);
+  ladish_graph_index_uninit(&graph_ptr->ports_by_handle);
+  ladish_graph_index_uninit(&graph_ptr->ports_by_uuid);
+  ladish_graph_index_uninit(&graph_ptr->ports_by_link_uuid);
+  ladish_graph_index_uninit(&graph_ptr->ports_by_jack_id);
+  ladish_graph_index_uninit(&graph_ptr->ports_by_jack_id_room);
+  ladish_graph_index_uninit(&graph_ptr->connections_by_id);
 }
 
 void * ladish_graph_get_dbus_context(ladish_graph_handle graph_handle)
@@ -1399,7 +2546,6 @@ void ladish_graph_show_connection(ladish_graph_handle graph_handle, uint64_t con
   ASSERT(connection_ptr->hidden);
   connection_ptr->hidden = false;
   connection_ptr->changing = false;
-  graph_ptr->graph_version++;
 
   ladish_graph_emit_ports_connected(graph_ptr, connection_ptr);
 }
@@ -1478,7 +2624,6 @@ void ladish_graph_show_client(ladish_graph_handle graph_handle, ladish_client_ha
 
   ASSERT(client_ptr->hidden);
   client_ptr->hidden = false;
-  graph_ptr->graph_version++;
 
   if (graph_ptr->opath != NULL)
   {
@@ -1527,11 +2672,13 @@ bool ladish_graph_add_client(ladish_graph_handle graph_handle, ladish_client_han
   client_ptr->id = graph_ptr->next_client_id++;
   client_ptr->client = client_handle;
   client_ptr->hidden = hidden;
-  graph_ptr->graph_version++;
 
   INIT_LIST_HEAD(&client_ptr->ports);
 
+  INIT_HLIST_NODE(&client_ptr->hash_jack_id.siblings);
+
   list_add_tail(&client_ptr->siblings, &graph_ptr->clients);
+  ladish_graph_hash_client(graph_ptr, client_ptr);
 
   if (!hidden && graph_ptr->opath != NULL)
   {
@@ -1634,9 +2781,19 @@ ladish_graph_add_port(
     uuid_generate(port_ptr->link_uuid_override);
   }
 
+  INIT_LIST_HEAD(&port_ptr->connections);
+
+  INIT_HLIST_NODE(&port_ptr->hash_link_uuid.siblings);
+  INIT_HLIST_NODE(&port_ptr->hash_jack_id.siblings);
+  INIT_HLIST_NODE(&port_ptr->hash_jack_id_room.siblings);
+
   port_ptr->client_ptr = client_ptr;
   list_add_tail(&port_ptr->siblings_client, &client_ptr->ports);
   list_add_tail(&port_ptr->siblings_graph, &graph_ptr->ports);
+  ladish_graph_hash_port(graph_ptr, port_ptr);
+
+  /* the vgraph of the port is set before it is added to the JACK graph */
+  ladish_check_integrity_mark_port(port_handle);
 
   if (!hidden)
   {
@@ -1681,9 +2838,13 @@ ladish_graph_add_connection(
   connection_ptr->port2_ptr = port2_ptr;
   connection_ptr->hidden = hidden;
   connection_ptr->changing = false;
-  graph_ptr->graph_version++;
 
   list_add_tail(&connection_ptr->siblings, &graph_ptr->connections);
+  connection_ptr->port1_end.connection_ptr = connection_ptr;
+  list_add_tail(&connection_ptr->port1_end.siblings, &port1_ptr->connections);
+  connection_ptr->port2_end.connection_ptr = connection_ptr;
+  list_add_tail(&connection_ptr->port2_end.siblings, &port2_ptr->connections);
+  ladish_graph_index_add(&graph_ptr->connections_by_id, &connection_ptr->hash_id, ladish_hash_u64(connection_ptr->id));
 
   /* log_info( */
   /*   "new connection %"PRIu64" between '%s':'%s' and '%s':'%s'", */
@@ -1792,7 +2953,7 @@ ladish_graph_find_connection(
   }
      
   port2_ptr = ladish_graph_find_port(graph_ptr, port2_handle);
-  if (port1_ptr == NULL)
+  if (port2_ptr == NULL)
   {
     return false;
   }
@@ -1810,20 +2971,22 @@ ladish_graph_find_connection(
 
 ladish_client_handle ladish_graph_find_client_by_name(ladish_graph_handle graph_handle, const char * name, bool appless)
 {
-  struct list_head * node_ptr;
+  struct hlist_node * node_ptr;
   struct ladish_graph_client * client_ptr;
+  struct ladish_graph_client * found_client_ptr;
 
-  list_for_each(node_ptr, &graph_ptr->clients)
+  found_client_ptr = NULL;
+
+  hlist_for_each_entry(client_ptr, node_ptr, LADISH_GRAPH_INDEX_BUCKET(graph_ptr->clients_by_name, ladish_hash_str(name)), hash_name.siblings)
   {
-    client_ptr = list_entry(node_ptr, struct ladish_graph_client, siblings);
     if (strcmp(client_ptr->name, name) == 0 &&
         (!appless || !ladish_client_has_app(client_ptr->client))) /* if appless is true, then an appless client is being searched */
     {
-      return client_ptr->client;
+      found_client_ptr = ladish_graph_first_client(found_client_ptr, client_ptr);
     }
   }
 
-  return NULL;
+  return found_client_ptr != NULL ? found_client_ptr->client : NULL;
 }
 
 ladish_client_handle ladish_graph_find_client_by_app(ladish_graph_handle graph_handle, const uuid_t app_uuid)
@@ -1886,21 +3049,23 @@ ladish_graph_find_port_by_name(
 
 ladish_client_handle ladish_graph_find_client_by_uuid(ladish_graph_handle graph_handle, const uuid_t uuid)
 {
-  struct list_head * node_ptr;
+  struct hlist_node * node_ptr;
   struct ladish_graph_client * client_ptr;
+  struct ladish_graph_client * found_client_ptr;
   uuid_t current_uuid;
 
-  list_for_each(node_ptr, &graph_ptr->clients)
+  found_client_ptr = NULL;
+
+  hlist_for_each_entry(client_ptr, node_ptr, LADISH_GRAPH_INDEX_BUCKET(graph_ptr->clients_by_uuid, ladish_graph_hash_uuid(uuid)), hash_uuid.siblings)
   {
-    client_ptr = list_entry(node_ptr, struct ladish_graph_client, siblings);
     ladish_client_get_uuid(client_ptr->client, current_uuid);
     if (uuid_compare(current_uuid, uuid) == 0)
     {
-      return client_ptr->client;
+      found_client_ptr = ladish_graph_first_client(found_client_ptr, client_ptr);
     }
   }
 
-  return NULL;
+  return found_client_ptr != NULL ? found_client_ptr->client : NULL;
 }
 
 ladish_port_handle ladish_graph_find_port_by_uuid(ladish_graph_handle graph_handle, const uuid_t uuid, bool use_link_override_uuids, void * vgraph_filter)
@@ -1936,12 +3101,11 @@ bool ladish_graph_is_port_present(ladish_graph_handle graph_handle, ladish_port_
 
 ladish_client_handle ladish_graph_find_client_by_id(ladish_graph_handle graph_handle, uint64_t client_id)
 {
-  struct list_head * node_ptr;
+  struct hlist_node * node_ptr;
   struct ladish_graph_client * client_ptr;
 
-  list_for_each(node_ptr, &graph_ptr->clients)
+  hlist_for_each_entry(client_ptr, node_ptr, LADISH_GRAPH_INDEX_BUCKET(graph_ptr->clients_by_id, ladish_hash_u64(client_id)), hash_id.siblings)
   {
-    client_ptr = list_entry(node_ptr, struct ladish_graph_client, siblings);
     if (client_ptr->id == client_id)
     {
       return client_ptr->client;
@@ -1967,18 +3131,36 @@ ladish_port_handle ladish_graph_find_port_by_id(ladish_graph_handle graph_handle
 ladish_client_handle ladish_graph_find_client_by_jack_id(ladish_graph_handle graph_handle, uint64_t client_id)
 {
   struct list_head * node_ptr;
+  struct hlist_node * hnode_ptr;
   struct ladish_graph_client * client_ptr;
+  struct ladish_graph_client * found_client_ptr;
 
-  list_for_each(node_ptr, &graph_ptr->clients)
+  if (client_id == 0)
+  {
+    /* clients without JACK id are not indexed */
+    list_for_each(node_ptr, &graph_ptr->clients)
+    {
+      client_ptr = list_entry(node_ptr, struct ladish_graph_client, siblings);
+      if (ladish_client_get_jack_id(client_ptr->client) == client_id)
+      {
+        return client_ptr->client;
+      }
+    }
+
+    return NULL;
+  }
+
+  found_client_ptr = NULL;
+
+  hlist_for_each_entry(client_ptr, hnode_ptr, LADISH_GRAPH_INDEX_BUCKET(graph_ptr->clients_by_jack_id, ladish_hash_u64(client_id)), hash_jack_id.siblings)
   {
-    client_ptr = list_entry(node_ptr, struct ladish_graph_client, siblings);
     if (ladish_client_get_jack_id(client_ptr->client) == client_id)
     {
-      return client_ptr->client;
+      found_client_ptr = ladish_graph_first_client(found_client_ptr, client_ptr);
     }
   }
 
-  return NULL;
+  return found_client_ptr != NULL ? found_client_ptr->client : NULL;
 }
 
 ladish_port_handle ladish_graph_find_port_by_jack_id(ladish_graph_handle graph_handle, uint64_t port_id, bool room, bool studio)
@@ -2117,17 +3299,15 @@ ladish_graph_move_port(
 
   list_del(&port_ptr->siblings_client);
   list_del(&port_ptr->siblings_graph);
-  graph_ptr->graph_version++;
 
   if (graph_ptr->opath != NULL && !port_ptr->hidden)
   {
-    list_for_each(node_ptr, &graph_ptr->connections)
+    list_for_each(node_ptr, &port_ptr->connections)
     {
-      connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
-      if (!connection_ptr->hidden && (connection_ptr->port1_ptr == port_ptr || connection_ptr->port2_ptr == port_ptr))
+      connection_ptr = ladish_graph_connection_end_entry(node_ptr);
+      if (!connection_ptr->hidden)
       {
         ladish_graph_emit_ports_disconnected(graph_ptr, connection_ptr);
-        graph_ptr->graph_version++;
       }
     }
 
@@ -2138,19 +3318,19 @@ ladish_graph_move_port(
   port_ptr->client_ptr = client_ptr;
   list_add_tail(&port_ptr->siblings_client, &client_ptr->ports);
   list_add_tail(&port_ptr->siblings_graph, &graph_ptr->ports);
-  graph_ptr->graph_version++;
+  ladish_graph_index_del(&graph_ptr->ports_by_id, &port_ptr->hash_id);
+  ladish_graph_index_add(&graph_ptr->ports_by_id, &port_ptr->hash_id, ladish_hash_u64(port_ptr->id));
 
   if (graph_ptr->opath != NULL && !port_ptr->hidden)
   {
     ladish_graph_emit_port_appeared(graph_ptr, port_ptr);
 
-    list_for_each(node_ptr, &graph_ptr->connections)
+    list_for_each(node_ptr, &port_ptr->connections)
     {
-      connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
-      if (!connection_ptr->hidden && (connection_ptr->port1_ptr == port_ptr || connection_ptr->port2_ptr == port_ptr))
+      connection_ptr = ladish_graph_connection_end_entry(node_ptr);
+      if (!connection_ptr->hidden)
       {
         graph_ptr->next_connection_id++;
-        graph_ptr->graph_version++;
         ladish_graph_emit_ports_connected(graph_ptr, connection_ptr);
       }
     }
@@ -2185,10 +3365,13 @@ ladish_graph_rename_client(
   old_name = client_ptr->name;
   client_ptr->name = name;
 
-  graph_ptr->graph_version++;
+  ladish_graph_index_del(&graph_ptr->clients_by_name, &client_ptr->hash_name);
+  ladish_graph_index_add(&graph_ptr->clients_by_name, &client_ptr->hash_name, ladish_hash_str(client_ptr->name));
 
   if (!client_ptr->hidden && graph_ptr->opath != NULL)
   {
+    ladish_graph_journal_record(graph_ptr, GRAPH_CHANGE_CLIENT_RENAMED, client_ptr->id, 0, 0, 0, client_ptr->name, old_name, 0, 0);
+
     cdbus_signal_emit(
       cdbus_g_dbus_connection,
       graph_ptr->opath,
@@ -2234,10 +3417,20 @@ ladish_graph_rename_port(
   old_name = port_ptr->name;
   port_ptr->name = name;
 
-  graph_ptr->graph_version++;
-
   if (!port_ptr->hidden && graph_ptr->opath != NULL)
   {
+    ladish_graph_journal_record(
+      graph_ptr,
+      GRAPH_CHANGE_PORT_RENAMED,
+      port_ptr->client_ptr->id,
+      port_ptr->id,
+      0,
+      0,
+      port_ptr->name,
+      old_name,
+      0,
+      0);
+
     cdbus_signal_emit(
       cdbus_g_dbus_connection,
       graph_ptr->opath,
@@ -2322,7 +3515,6 @@ bool ladish_graph_client_is_hidden(ladish_graph_handle graph_handle, ladish_clie
 void ladish_try_connect_hidden_connections(ladish_graph_handle graph_handle)
 {
   struct list_head * node_ptr;
-  struct ladish_graph_connection * connection_ptr;
 
   if (!list_empty(&graph_ptr->connections) && graph_ptr->connect_handler == NULL)
   {
@@ -2334,37 +3526,35 @@ void ladish_try_connect_hidden_connections(ladish_graph_handle graph_handle)
 
   list_for_each(node_ptr, &graph_ptr->connections)
   {
-    connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
-    log_debug(
-      "checking connection (%s, %s) '%s':'%s' (%s) to '%s':'%s' (%s)",
-      connection_ptr->hidden ? "hidden" : "visible",
-      connection_ptr->changing ? "changing" : "not changing",
-      connection_ptr->port1_ptr->client_ptr->name,
-      connection_ptr->port1_ptr->name,
-      connection_ptr->port1_ptr->hidden ? "hidden" : "visible",
-      connection_ptr->port2_ptr->client_ptr->name,
-      connection_ptr->port2_ptr->name,
-      connection_ptr->port2_ptr->hidden ? "hidden" : "visible");
-    if (connection_ptr->hidden &&
-        !connection_ptr->changing &&
-        !connection_ptr->port1_ptr->hidden &&
-        !connection_ptr->port2_ptr->hidden)
-    {
-      log_info(
-        "auto connecting '%s':'%s' to '%s':'%s'",
-        connection_ptr->port1_ptr->client_ptr->name,
-        connection_ptr->port1_ptr->name,
-        connection_ptr->port2_ptr->client_ptr->name,
-        connection_ptr->port2_ptr->name);
+    ladish_graph_try_connect_hidden_connection(graph_ptr, list_entry(node_ptr, struct ladish_graph_connection, siblings));
+  }
 
-      connection_ptr->changing = true;
-      if (!graph_ptr->connect_handler(graph_ptr->context, graph_handle, connection_ptr->port1_ptr->port, connection_ptr->port2_ptr->port))
-      {
-        connection_ptr->changing = false;
-        log_error("auto connect failed.");
-      }
-    }
+  ladish_graph_connect_check_done(graph_ptr);
+}
+
+void ladish_graph_restore_begin(ladish_graph_handle graph_handle)
+{
+  if (graph_ptr->opath == NULL)
+  {
+    return;
+  }
+
+  graph_ptr->restoring = true;
+  graph_ptr->restore_autorun = true;
+  graph_ptr->restored_count = 0;
+  graph_ptr->restore_failed_count = 0;
+  ladish_graph_restore_progress(graph_ptr);
+}
+
+void ladish_graph_restore_autorun_complete(ladish_graph_handle graph_handle)
+{
+  if (!graph_ptr->restoring)
+  {
+    return;
   }
+
+  graph_ptr->restore_autorun = false;
+  ladish_graph_connect_check_done(graph_ptr);
 }
 
 bool ladish_disconnect_visible_connections(ladish_graph_handle graph_handle)
@@ -2481,6 +3671,26 @@ const char * ladish_graph_get_port_name(ladish_graph_handle graph_handle, ladish
   return port_ptr->name;
 }
 
+uint32_t ladish_graph_get_port_type(ladish_graph_handle graph_handle, ladish_port_handle port)
+{
+  struct ladish_graph_port * port_ptr;
+
+  port_ptr = ladish_graph_find_port(graph_ptr, port);
+  ASSERT(port_ptr != NULL);
+
+  return port_ptr->type;
+}
+
+uint32_t ladish_graph_get_port_flags(ladish_graph_handle graph_handle, ladish_port_handle port)
+{
+  struct ladish_graph_port * port_ptr;
+
+  port_ptr = ladish_graph_find_port(graph_ptr, port);
+  ASSERT(port_ptr != NULL);
+
+  return port_ptr->flags;
+}
+
 ladish_port_handle
 ladish_graph_find_client_port_by_uuid(
   ladish_graph_handle graph_handle,
@@ -2515,6 +3725,9 @@ ladish_graph_set_link_port_override_uuid(
   ASSERT(port_ptr != NULL && ladish_port_is_link(port_ptr->port));
 
   uuid_copy(port_ptr->link_uuid_override, override_uuid);
+
+  ladish_graph_index_del(&graph_ptr->ports_by_link_uuid, &port_ptr->hash_link_uuid);
+  ladish_graph_index_add(&graph_ptr->ports_by_link_uuid, &port_ptr->hash_link_uuid, ladish_graph_hash_uuid(port_ptr->link_uuid_override));
 }
 
 bool
@@ -2652,6 +3865,55 @@ ladish_graph_iterate_connections(
   return true;
 }
 
+bool
+ladish_graph_iterate_dicts(
+  ladish_graph_handle graph_handle,
+  void * callback_context,
+  bool (* callback)(void * context, uint32_t object_type, uint64_t object_id, ladish_dict_handle dict))
+{
+  struct list_head * node_ptr;
+  struct ladish_graph_client * client_ptr;
+  struct ladish_graph_port * port_ptr;
+  struct ladish_graph_connection * connection_ptr;
+
+  if (!callback(callback_context, GRAPH_DICT_OBJECT_TYPE_GRAPH, 0, graph_ptr->dict))
+  {
+    return false;
+  }
+
+  list_for_each(node_ptr, &graph_ptr->clients)
+  {
+    client_ptr = list_entry(node_ptr, struct ladish_graph_client, siblings);
+    if (!client_ptr->hidden &&
+        !callback(callback_context, GRAPH_DICT_OBJECT_TYPE_CLIENT, client_ptr->id, ladish_client_get_dict(client_ptr->client)))
+    {
+      return false;
+    }
+  }
+
+  list_for_each(node_ptr, &graph_ptr->ports)
+  {
+    port_ptr = list_entry(node_ptr, struct ladish_graph_port, siblings_graph);
+    if (!port_ptr->hidden &&
+        !callback(callback_context, GRAPH_DICT_OBJECT_TYPE_PORT, port_ptr->id, ladish_port_get_dict(port_ptr->port)))
+    {
+      return false;
+    }
+  }
+
+  list_for_each(node_ptr, &graph_ptr->connections)
+  {
+    connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
+    if (!connection_ptr->hidden &&
+        !callback(callback_context, GRAPH_DICT_OBJECT_TYPE_CONNECTION, connection_ptr->id, connection_ptr->dict))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 bool
 ladish_graph_interate_client_ports(
   ladish_graph_handle graph_handle,
@@ -2918,7 +4180,6 @@ void ladish_graph_trick_dicts(ladish_graph_handle graph_handle)
     connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
     if (!connection_ptr->hidden)
     {
-      graph_ptr->graph_version++;
       ladish_graph_emit_ports_disconnected(graph_ptr, connection_ptr);
     }
   }
@@ -2929,7 +4190,6 @@ void ladish_graph_trick_dicts(ladish_graph_handle graph_handle)
 
     if (!port_ptr->hidden)
     {
-      graph_ptr->graph_version++;
       ladish_graph_emit_port_disappeared(graph_ptr, port_ptr);
     }
   }
@@ -2940,9 +4200,7 @@ void ladish_graph_trick_dicts(ladish_graph_handle graph_handle)
 
     if (!client_ptr->hidden)
     {
-      graph_ptr->graph_version++;
       ladish_graph_emit_client_disappeared(graph_ptr, client_ptr);
-      graph_ptr->graph_version++;
       ladish_graph_emit_client_appeared(graph_ptr, client_ptr);
     }
   }
@@ -2953,7 +4211,6 @@ void ladish_graph_trick_dicts(ladish_graph_handle graph_handle)
 
     if (!port_ptr->hidden)
     {
-      graph_ptr->graph_version++;
       ladish_graph_emit_port_appeared(graph_ptr, port_ptr);
     }
   }
@@ -2963,7 +4220,6 @@ void ladish_graph_trick_dicts(ladish_graph_handle graph_handle)
     connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
     if (!connection_ptr->hidden)
     {
-      graph_ptr->graph_version++;
       ladish_graph_emit_ports_connected(graph_ptr, connection_ptr);
     }
   }
@@ -3053,6 +4309,13 @@ CDBUS_METHOD_ARG_DESCRIBE_IN("known_graph_version", DBUS_TYPE_UINT64_AS_STRING,
   CDBUS_METHOD_ARG_DESCRIBE_OUT("connections", "a(tstststst)", "Connections array")
 CDBUS_METHOD_ARGS_END
 
+CDBUS_METHOD_ARGS_BEGIN(GetGraphChanges, "Get graph changes since known version")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("known_graph_version", DBUS_TYPE_UINT64_AS_STRING, "Known graph version")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("current_graph_version", DBUS_TYPE_UINT64_AS_STRING, "Current graph version")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("complete", DBUS_TYPE_BOOLEAN_AS_STRING, "Whether changes since known version are available, if not, GetGraph() must be used")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("changes", "a(tuttttssuu)", "Changes array (version, type, client1_id, port1_id, client2_id, port2_id, name, old_name, port_flags, port_type)")
+CDBUS_METHOD_ARGS_END
+
 CDBUS_METHOD_ARGS_BEGIN(ConnectPortsByName, "Connect ports")
   CDBUS_METHOD_ARG_DESCRIBE_IN("client1_name", DBUS_TYPE_STRING_AS_STRING, "name first port client")
   CDBUS_METHOD_ARG_DESCRIBE_IN("port1_name", DBUS_TYPE_STRING_AS_STRING, "name of first port")
@@ -3089,6 +4352,7 @@ CDBUS_METHOD_ARGS_END
 CDBUS_METHODS_BEGIN
   CDBUS_METHOD_DESCRIBE(GetAllPorts, get_all_ports)
   CDBUS_METHOD_DESCRIBE(GetGraph, get_graph)
+  CDBUS_METHOD_DESCRIBE(GetGraphChanges, get_graph_changes)
   CDBUS_METHOD_DESCRIBE(ConnectPortsByName, connect_ports_by_name)
   CDBUS_METHOD_DESCRIBE(ConnectPortsByID, connect_ports_by_id)
   CDBUS_METHOD_DESCRIBE(DisconnectPortsByName, disconnect_ports_by_name)
@@ -3097,7 +4361,7 @@ CDBUS_METHODS_BEGIN
   CDBUS_METHOD_DESCRIBE(GetClientPID, get_client_pid)
 CDBUS_METHODS_END
 
-CDBUS_SIGNAL_ARGS_BEGIN(GraphChanged, "")
+CDBUS_SIGNAL_ARGS_BEGIN(GraphChanged, "Emitted after the signals of changes made in one batch, they share the version")
   CDBUS_SIGNAL_ARG_DESCRIBE("new_graph_version", DBUS_TYPE_UINT64_AS_STRING, "")
 CDBUS_SIGNAL_ARGS_END
 
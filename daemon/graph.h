@@ -40,6 +40,18 @@ bool
   ladish_port_handle port1,
   ladish_port_handle port2);
 
+/* Send connect request without waiting for the reply. Unless false is returned,
+ * callback must be called exactly once, after the handler returns. */
+typedef
+bool
+(* ladish_graph_connect_async_request_handler)(
+  void * context,
+  ladish_graph_handle graph_handle,
+  ladish_port_handle port1,
+  ladish_port_handle port2,
+  void * callback_context,
+  void (* callback)(void * callback_context, bool success));
+
 typedef
 bool
 (* ladish_graph_disconnect_request_handler)(
@@ -55,6 +67,15 @@ void ladish_graph_destroy(ladish_graph_handle graph_handle);
 
 const char * ladish_graph_get_opath(ladish_graph_handle graph_handle);
 const char * ladish_graph_get_description(ladish_graph_handle graph_handle);
+uint64_t ladish_graph_get_version(ladish_graph_handle graph_handle);
+
+/* Changes made between begin and end share one version, GraphChanged is emitted at end if there were any */
+void ladish_graph_batch_begin(ladish_graph_handle graph_handle);
+void ladish_graph_batch_end(ladish_graph_handle graph_handle);
+
+/* Pass (dis)connect requests to the graph connection handlers, as if they came through D-Bus */
+bool ladish_graph_request_connect(ladish_graph_handle graph_handle, ladish_port_handle port1_handle, ladish_port_handle port2_handle);
+bool ladish_graph_request_disconnect(ladish_graph_handle graph_handle, uint64_t connection_id);
 
 void
 ladish_graph_set_connection_handlers(
@@ -63,6 +84,13 @@ ladish_graph_set_connection_handlers(
   ladish_graph_connect_request_handler connect_handler,
   ladish_graph_disconnect_request_handler disconnect_handler);
 
+/* When set, hidden connections are auto connected through this handler, without
+ * waiting for each reply. To be called after ladish_graph_set_connection_handlers(). */
+void
+ladish_graph_set_connect_async_handler(
+  ladish_graph_handle graph_handle,
+  ladish_graph_connect_async_request_handler connect_async_handler);
+
 void ladish_graph_clear(ladish_graph_handle graph_handle, ladish_graph_simple_port_callback port_callback);
 void * ladish_graph_get_dbus_context(ladish_graph_handle graph_handle);
 ladish_dict_handle ladish_graph_get_dict(ladish_graph_handle graph_handle);
@@ -168,6 +196,8 @@ ladish_client_handle ladish_graph_get_port_client(ladish_graph_handle graph_hand
 uint64_t ladish_graph_get_client_id(ladish_graph_handle graph_handle, ladish_client_handle client_handle);
 const char * ladish_graph_get_client_name(ladish_graph_handle graph_handle, ladish_client_handle client_handle);
 const char * ladish_graph_get_port_name(ladish_graph_handle graph, ladish_port_handle port);
+uint32_t ladish_graph_get_port_type(ladish_graph_handle graph, ladish_port_handle port);
+uint32_t ladish_graph_get_port_flags(ladish_graph_handle graph, ladish_port_handle port);
 bool ladish_graph_client_is_empty(ladish_graph_handle graph_handle, ladish_client_handle client_handle);
 bool ladish_graph_client_looks_empty(ladish_graph_handle graph_handle, ladish_client_handle client_handle);
 bool ladish_graph_client_is_hidden(ladish_graph_handle graph_handle, ladish_client_handle client_handle);
@@ -178,7 +208,16 @@ void ladish_graph_show_client(ladish_graph_handle graph_handle, ladish_client_ha
 void ladish_graph_hide_client(ladish_graph_handle graph_handle, ladish_client_handle client_handle);
 void ladish_graph_adjust_port(ladish_graph_handle graph_handle, ladish_port_handle port_handle, uint32_t type, uint32_t flags);
 void ladish_graph_show_connection(ladish_graph_handle graph_handle, uint64_t connection_id);
+/* Failed connects are retried with increasing delay. Within the restore window
+ * (see below) the results are reported with the ConnectionsRestored signal. */
 void ladish_try_connect_hidden_connections(ladish_graph_handle graph_handle);
+/* Open the restore window before the apps of a studio or room are started.
+ * Connections auto connected until the autorun completes (including the ones
+ * of ports that appear meanwhile) are counted and ConnectionsRestored is emitted
+ * once the autorun is complete and all auto connect requests are done,
+ * or when there is no progress for a while. */
+void ladish_graph_restore_begin(ladish_graph_handle graph_handle);
+void ladish_graph_restore_autorun_complete(ladish_graph_handle graph_handle);
 bool ladish_disconnect_visible_connections(ladish_graph_handle graph_handle);
 void ladish_graph_hide_non_virtual(ladish_graph_handle graph_handle);
 void ladish_graph_get_port_uuid(ladish_graph_handle graph, ladish_port_handle port, uuid_t uuid_ptr);
@@ -220,6 +259,14 @@ ladish_graph_iterate_nodes(
     const char * client_name,
     void * client_iteration_context_ptr));
 
+/* Iterate the dicts of the graph and of its visible clients, ports and connections.
+ * object_type is one of GRAPH_DICT_OBJECT_TYPE_XXX, object_id is zero for the graph itself. */
+bool
+ladish_graph_iterate_dicts(
+  ladish_graph_handle graph_handle,
+  void * callback_context,
+  bool (* callback)(void * context, uint32_t object_type, uint64_t object_id, ladish_dict_handle dict));
+
 bool
 ladish_graph_iterate_connections(
   ladish_graph_handle graph_handle,
@@ -29,50 +29,51 @@
 #include "graph.h"
 #include "dict.h"
 
-#define graph_handle ((ladish_graph_handle)call_ptr->iface_context)
-
-bool find_dict(struct cdbus_method_call * call_ptr, uint32_t object_type, uint64_t object_id, ladish_dict_handle * dict_handle_ptr)
+static
+ladish_dict_handle
+lookup_dict(
+  ladish_graph_handle graph_handle,
+  uint32_t object_type,
+  uint64_t object_id)
 {
   ladish_client_handle client;
   ladish_port_handle port;
-  ladish_dict_handle dict;
 
   switch (object_type)
   {
   case GRAPH_DICT_OBJECT_TYPE_GRAPH:
-    *dict_handle_ptr = ladish_graph_get_dict(graph_handle);
-    return true;
+    return ladish_graph_get_dict(graph_handle);
   case GRAPH_DICT_OBJECT_TYPE_CLIENT:
     client = ladish_graph_find_client_by_id(graph_handle, object_id);
-    if (client == NULL)
-    {
-      cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "cannot find client %"PRIu64".", object_id);
-      return false;
-    }
-    *dict_handle_ptr = ladish_client_get_dict(client);
-    return true;
+    return client != NULL ? ladish_client_get_dict(client) : NULL;
   case GRAPH_DICT_OBJECT_TYPE_PORT:
     port = ladish_graph_find_port_by_id(graph_handle, object_id);
-    if (port == NULL)
-    {
-      cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "cannot find port %"PRIu64".", object_id);
-      return false;
-    }
-    *dict_handle_ptr = ladish_port_get_dict(port);
-    return true;
+    return port != NULL ? ladish_port_get_dict(port) : NULL;
   case GRAPH_DICT_OBJECT_TYPE_CONNECTION:
-    dict = ladish_graph_get_connection_dict(graph_handle, object_id);
-    if (dict == NULL)
-    {
-      cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "cannot find connection %"PRIu64".", object_id);
-    }
+    return ladish_graph_get_connection_dict(graph_handle, object_id);
+  }
 
-    *dict_handle_ptr = dict;
+  return NULL;
+}
+
+#define graph_handle ((ladish_graph_handle)call_ptr->iface_context)
+
+bool find_dict(struct cdbus_method_call * call_ptr, uint32_t object_type, uint64_t object_id, ladish_dict_handle * dict_handle_ptr)
+{
+  if (object_type > GRAPH_DICT_OBJECT_TYPE_CONNECTION)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "find_dict() not implemented for object type %"PRIu32".", object_type);
     return false;
   }
 
-  cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "find_dict() not implemented for object type %"PRIu32".", object_type);
-  return false;
+  *dict_handle_ptr = lookup_dict(graph_handle, object_type, object_id);
+  if (*dict_handle_ptr == NULL)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "cannot find object %"PRIu64" of type %"PRIu32".", object_id, object_type);
+    return false;
+  }
+
+  return true;
 }
 
 #undef graph_handle
@@ -181,6 +182,159 @@ void ladish_dict_drop_dbus(struct cdbus_method_call * call_ptr)
   cdbus_method_return_new_void(call_ptr);
 }
 
+struct get_many_context
+{
+  char ** keys;
+  int keys_count;
+  DBusMessageIter * array_iter_ptr;
+};
+
+#define ctx_ptr ((struct get_many_context *)context)
+
+static bool get_many_append(void * context, uint32_t object_type, uint64_t object_id, ladish_dict_handle dict)
+{
+  DBusMessageIter struct_iter;
+  const char * value;
+  int i;
+
+  for (i = 0; i < ctx_ptr->keys_count; i++)
+  {
+    value = ladish_dict_get(dict, ctx_ptr->keys[i]);
+    if (value == NULL)
+    {
+      continue;
+    }
+
+    if (!dbus_message_iter_open_container(ctx_ptr->array_iter_ptr, DBUS_TYPE_STRUCT, NULL, &struct_iter) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_UINT32, &object_type) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_UINT64, &object_id) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, ctx_ptr->keys + i) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, &value) ||
+        !dbus_message_iter_close_container(ctx_ptr->array_iter_ptr, &struct_iter))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+#undef ctx_ptr
+
+#define graph_handle ((ladish_graph_handle)call_ptr->iface_context)
+
+static void ladish_dict_get_many_dbus(struct cdbus_method_call * call_ptr)
+{
+  struct get_many_context ctx;
+  DBusMessageIter iter;
+  DBusMessageIter array_iter;
+
+  if (!dbus_message_get_args(
+        call_ptr->message,
+        &cdbus_g_dbus_error,
+        DBUS_TYPE_ARRAY, DBUS_TYPE_STRING, &ctx.keys, &ctx.keys_count,
+        DBUS_TYPE_INVALID))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": %s",  call_ptr->method_name, cdbus_g_dbus_error.message);
+    dbus_error_free(&cdbus_g_dbus_error);
+    return;
+  }
+
+  ctx.array_iter_ptr = &array_iter;
+
+  call_ptr->reply = dbus_message_new_method_return(call_ptr->message);
+  if (call_ptr->reply == NULL)
+  {
+    goto fail;
+  }
+
+  dbus_message_iter_init_append(call_ptr->reply, &iter);
+
+  if (!dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "(utss)", &array_iter))
+  {
+    goto fail_unref;
+  }
+
+  if (!ladish_graph_iterate_dicts(graph_handle, &ctx, get_many_append))
+  {
+    goto fail_unref;
+  }
+
+  if (!dbus_message_iter_close_container(&iter, &array_iter))
+  {
+    goto fail_unref;
+  }
+
+  dbus_free_string_array(ctx.keys);
+  return;
+
+fail_unref:
+  dbus_message_unref(call_ptr->reply);
+  call_ptr->reply = NULL;
+fail:
+  log_error("Ran out of memory trying to construct method return");
+  dbus_free_string_array(ctx.keys);
+}
+
+/* Entries of objects that are not found are skipped, the objects may disappear
+ * while the client collects the entries to set */
+static void ladish_dict_set_many_dbus(struct cdbus_method_call * call_ptr)
+{
+  DBusMessageIter iter;
+  DBusMessageIter array_iter;
+  DBusMessageIter struct_iter;
+  uint32_t object_type;
+  uint64_t object_id;
+  const char * key;
+  const char * value;
+  ladish_dict_handle dict;
+
+  if (strcmp(dbus_message_get_signature(call_ptr->message), "a(utss)") != 0)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": signature is not \"a(utss)\"",  call_ptr->method_name);
+    return;
+  }
+
+  dbus_message_iter_init(call_ptr->message, &iter);
+
+  for (dbus_message_iter_recurse(&iter, &array_iter);
+       dbus_message_iter_get_arg_type(&array_iter) != DBUS_TYPE_INVALID;
+       dbus_message_iter_next(&array_iter))
+  {
+    dbus_message_iter_recurse(&array_iter, &struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &object_type);
+    dbus_message_iter_next(&struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &object_id);
+    dbus_message_iter_next(&struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &key);
+    dbus_message_iter_next(&struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &value);
+
+    dict = lookup_dict(graph_handle, object_type, object_id);
+    if (dict == NULL)
+    {
+      log_error("cannot find object %"PRIu64" of type %"PRIu32", not setting %s", object_id, object_type, key);
+      continue;
+    }
+
+    log_info("%s <- %s", key, value);
+
+    if (!ladish_dict_set(dict, key, value))
+    {
+      cdbus_error(call_ptr, DBUS_ERROR_FAILED, "ladish_dict_set(\"%s\", \"%s\") failed.", key, value);
+      return;
+    }
+  }
+
+  cdbus_method_return_new_void(call_ptr);
+}
+
+#undef graph_handle
+
 CDBUS_METHOD_ARGS_BEGIN(Set, "Set value for specified key")
   CDBUS_METHOD_ARG_DESCRIBE_IN("object_type", "u", "Type of object, 0 - graph, 1 - client, 2 - port, 3 - connection")
   CDBUS_METHOD_ARG_DESCRIBE_IN("object_id", "t", "ID of the object")
@@ -201,10 +355,21 @@ CDBUS_METHOD_ARGS_BEGIN(Drop, "Drop entry, if key exists")
   CDBUS_METHOD_ARG_DESCRIBE_IN("key", "s", "Key of the entry to drop")
 CDBUS_METHOD_ARGS_END
 
+CDBUS_METHOD_ARGS_BEGIN(GetMany, "Get values of the specified keys for the graph and all its objects")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("keys", "as", "Keys to query")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("entries", "a(utss)", "Entries that exist (object type, object id, key, value)")
+CDBUS_METHOD_ARGS_END
+
+CDBUS_METHOD_ARGS_BEGIN(SetMany, "Set multiple values, entries for unknown objects are ignored")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("entries", "a(utss)", "Entries to set (object type, object id, key, value)")
+CDBUS_METHOD_ARGS_END
+
 CDBUS_METHODS_BEGIN
   CDBUS_METHOD_DESCRIBE(Set, ladish_dict_set_dbus)
   CDBUS_METHOD_DESCRIBE(Get, ladish_dict_get_dbus)
   CDBUS_METHOD_DESCRIBE(Drop, ladish_dict_drop_dbus)
+  CDBUS_METHOD_DESCRIBE(GetMany, ladish_dict_get_many_dbus)
+  CDBUS_METHOD_DESCRIBE(SetMany, ladish_dict_set_many_dbus)
 CDBUS_METHODS_END
 
 CDBUS_INTERFACE_DEFAULT_HANDLER_METHODS_ONLY(g_iface_graph_dict, IFACE_GRAPH_DICT)
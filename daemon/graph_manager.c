@@ -278,6 +278,382 @@ static void ladish_graph_manager_dbus_remove_client(struct cdbus_method_call * c
   cdbus_method_return_new_void(call_ptr);
 }
 
+struct ladish_graph_manager_op
+{
+  dbus_uint32_t type;
+  dbus_uint64_t id1;
+  dbus_uint64_t id2;
+  const char * name;
+  ladish_port_handle port1;
+  ladish_port_handle port2;
+  ladish_client_handle client;
+  uint64_t connection_id;
+  char * old_name;                /* for rollback of renames */
+  ladish_client_handle old_client; /* for rollback of moves */
+  dbus_bool_t success;
+  const char * error;
+};
+
+/* resolve the ids in the graph state before the batch, returns error string or NULL */
+static const char * ladish_graph_manager_validate_op(ladish_graph_handle graph_handle, struct ladish_graph_manager_op * op_ptr)
+{
+  switch (op_ptr->type)
+  {
+  case GRAPH_MANAGER_OP_CONNECT:
+  case GRAPH_MANAGER_OP_DISCONNECT:
+    op_ptr->port1 = ladish_graph_find_port_by_id(graph_handle, op_ptr->id1);
+    op_ptr->port2 = ladish_graph_find_port_by_id(graph_handle, op_ptr->id2);
+    if (op_ptr->port1 == NULL || op_ptr->port2 == NULL)
+    {
+      return "unknown port";
+    }
+
+    if (ladish_graph_find_connection(graph_handle, op_ptr->port1, op_ptr->port2, &op_ptr->connection_id))
+    {
+      return op_ptr->type == GRAPH_MANAGER_OP_CONNECT ? "ports are already connected" : NULL;
+    }
+
+    return op_ptr->type == GRAPH_MANAGER_OP_DISCONNECT ? "ports are not connected" : NULL;
+  case GRAPH_MANAGER_OP_RENAME_CLIENT:
+    op_ptr->client = ladish_graph_find_client_by_id(graph_handle, op_ptr->id1);
+    if (op_ptr->client == NULL)
+    {
+      return "unknown client";
+    }
+
+    return *op_ptr->name == 0 ? "empty name" : NULL;
+  case GRAPH_MANAGER_OP_RENAME_PORT:
+    op_ptr->port1 = ladish_graph_find_port_by_id(graph_handle, op_ptr->id1);
+    if (op_ptr->port1 == NULL)
+    {
+      return "unknown port";
+    }
+
+    return *op_ptr->name == 0 ? "empty name" : NULL;
+  case GRAPH_MANAGER_OP_MOVE_PORT:
+    op_ptr->port1 = ladish_graph_find_port_by_id(graph_handle, op_ptr->id1);
+    if (op_ptr->port1 == NULL)
+    {
+      return "unknown port";
+    }
+
+    op_ptr->client = ladish_graph_find_client_by_id(graph_handle, op_ptr->id2);
+    if (op_ptr->client == NULL)
+    {
+      return "unknown client";
+    }
+
+    return NULL;
+  }
+
+  return "unknown operation";
+}
+
+/* same (dis)connection, or same object renamed or moved twice */
+static bool ladish_graph_manager_ops_duplicate(struct ladish_graph_manager_op * op1_ptr, struct ladish_graph_manager_op * op2_ptr)
+{
+  if (op1_ptr->type != op2_ptr->type)
+  {
+    return false;
+  }
+
+  switch (op1_ptr->type)
+  {
+  case GRAPH_MANAGER_OP_CONNECT:
+  case GRAPH_MANAGER_OP_DISCONNECT:
+    return
+      (op1_ptr->port1 == op2_ptr->port1 && op1_ptr->port2 == op2_ptr->port2) ||
+      (op1_ptr->port1 == op2_ptr->port2 && op1_ptr->port2 == op2_ptr->port1);
+  }
+
+  return op1_ptr->id1 == op2_ptr->id1;
+}
+
+static bool ladish_graph_manager_op_is_local(struct ladish_graph_manager_op * op_ptr)
+{
+  return op_ptr->type != GRAPH_MANAGER_OP_CONNECT && op_ptr->type != GRAPH_MANAGER_OP_DISCONNECT;
+}
+
+/* apply rename or move, remembering what is needed to undo it */
+static bool ladish_graph_manager_apply_local_op(ladish_graph_handle graph_handle, struct ladish_graph_manager_op * op_ptr)
+{
+  const char * old_name;
+
+  switch (op_ptr->type)
+  {
+  case GRAPH_MANAGER_OP_RENAME_CLIENT:
+  case GRAPH_MANAGER_OP_RENAME_PORT:
+    old_name =
+      op_ptr->type == GRAPH_MANAGER_OP_RENAME_CLIENT ?
+      ladish_graph_get_client_name(graph_handle, op_ptr->client) :
+      ladish_graph_get_port_name(graph_handle, op_ptr->port1);
+
+    op_ptr->old_name = strdup(old_name);
+    if (op_ptr->old_name == NULL)
+    {
+      log_error("strdup() failed for old name '%s'", old_name);
+      return false;
+    }
+
+    if (op_ptr->type == GRAPH_MANAGER_OP_RENAME_CLIENT ?
+        ladish_graph_rename_client(graph_handle, op_ptr->client, op_ptr->name) :
+        ladish_graph_rename_port(graph_handle, op_ptr->port1, op_ptr->name))
+    {
+      return true;
+    }
+
+    free(op_ptr->old_name);
+    op_ptr->old_name = NULL;
+    return false;
+  case GRAPH_MANAGER_OP_MOVE_PORT:
+    op_ptr->old_client = ladish_graph_get_port_client(graph_handle, op_ptr->port1);
+    ladish_graph_move_port(graph_handle, op_ptr->port1, op_ptr->client);
+    return true;
+  }
+
+  ASSERT_NO_PASS;
+  return false;
+}
+
+static void ladish_graph_manager_rollback_local_op(ladish_graph_handle graph_handle, struct ladish_graph_manager_op * op_ptr)
+{
+  switch (op_ptr->type)
+  {
+  case GRAPH_MANAGER_OP_RENAME_CLIENT:
+    if (!ladish_graph_rename_client(graph_handle, op_ptr->client, op_ptr->old_name))
+    {
+      log_error("cannot rollback rename of client to '%s'", op_ptr->old_name);
+    }
+    return;
+  case GRAPH_MANAGER_OP_RENAME_PORT:
+    if (!ladish_graph_rename_port(graph_handle, op_ptr->port1, op_ptr->old_name))
+    {
+      log_error("cannot rollback rename of port to '%s'", op_ptr->old_name);
+    }
+    return;
+  case GRAPH_MANAGER_OP_MOVE_PORT:
+    ladish_graph_move_port(graph_handle, op_ptr->port1, op_ptr->old_client);
+    return;
+  }
+
+  ASSERT_NO_PASS;
+}
+
+/* Renames and moves are applied first. If one of them fails, the ones
+ * already applied are rolled back and the (dis)connect requests are not
+ * made. (Dis)connect requests are passed to the graph connection handlers
+ * and are not rolled back, the connections change when JACK reports them. */
+static void ladish_graph_manager_apply_ops(ladish_graph_handle graph_handle, struct ladish_graph_manager_op * ops, unsigned int count)
+{
+  unsigned int i;
+  unsigned int j;
+
+  for (i = 0; i < count; i++)
+  {
+    if (!ladish_graph_manager_op_is_local(ops + i))
+    {
+      continue;
+    }
+
+    ops[i].success = ladish_graph_manager_apply_local_op(graph_handle, ops + i);
+    if (ops[i].success)
+    {
+      ops[i].error = "";
+      continue;
+    }
+
+    ops[i].error = "failed";
+
+    j = i;
+    while (j > 0)
+    {
+      j--;
+      if (ladish_graph_manager_op_is_local(ops + j))
+      {
+        ladish_graph_manager_rollback_local_op(graph_handle, ops + j);
+        ops[j].success = false;
+        ops[j].error = "rolled back";
+      }
+    }
+
+    for (j = 0; j < count; j++)
+    {
+      if (j != i && ops[j].error == NULL)
+      {
+        ops[j].error = "not applied";
+      }
+    }
+
+    return;
+  }
+
+  for (i = 0; i < count; i++)
+  {
+    switch (ops[i].type)
+    {
+    case GRAPH_MANAGER_OP_CONNECT:
+      ops[i].success = ladish_graph_request_connect(graph_handle, ops[i].port1, ops[i].port2);
+      break;
+    case GRAPH_MANAGER_OP_DISCONNECT:
+      ops[i].success = ladish_graph_request_disconnect(graph_handle, ops[i].connection_id);
+      break;
+    default:
+      continue;
+    }
+
+    ops[i].error = ops[i].success ? "" : "failed";
+  }
+}
+
+static void ladish_graph_manager_dbus_apply_batch(struct cdbus_method_call * call_ptr)
+{
+  DBusMessageIter iter;
+  DBusMessageIter array_iter;
+  DBusMessageIter struct_iter;
+  struct ladish_graph_manager_op * ops;
+  unsigned int count;
+  unsigned int i;
+  unsigned int j;
+  bool valid;
+  dbus_uint64_t version;
+
+  if (strcmp(dbus_message_get_signature(call_ptr->message), "a(utts)") != 0)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": signature is not \"a(utts)\"",  call_ptr->method_name);
+    return;
+  }
+
+  dbus_message_iter_init(call_ptr->message, &iter);
+
+  count = 0;
+  for (dbus_message_iter_recurse(&iter, &array_iter);
+       dbus_message_iter_get_arg_type(&array_iter) != DBUS_TYPE_INVALID;
+       dbus_message_iter_next(&array_iter))
+  {
+    count++;
+  }
+
+  log_info("batch request, graph '%s', %u operations", ladish_graph_get_description(graph), count);
+
+  ops = calloc(count > 0 ? count : 1, sizeof(struct ladish_graph_manager_op));
+  if (ops == NULL)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "calloc() failed.");
+    return;
+  }
+
+  /* all operations are validated before any of them is applied */
+  valid = true;
+  for (dbus_message_iter_recurse(&iter, &array_iter), i = 0;
+       dbus_message_iter_get_arg_type(&array_iter) != DBUS_TYPE_INVALID;
+       dbus_message_iter_next(&array_iter), i++)
+  {
+    dbus_message_iter_recurse(&array_iter, &struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &ops[i].type);
+    dbus_message_iter_next(&struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &ops[i].id1);
+    dbus_message_iter_next(&struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &ops[i].id2);
+    dbus_message_iter_next(&struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &ops[i].name);
+
+    ops[i].error = ladish_graph_manager_validate_op(graph, ops + i);
+    for (j = 0; ops[i].error == NULL && j < i; j++)
+    {
+      if (ops[j].error == NULL && ladish_graph_manager_ops_duplicate(ops + j, ops + i))
+      {
+        ops[i].error = "duplicate operation";
+      }
+    }
+
+    if (ops[i].error != NULL)
+    {
+      log_error("batch operation #%u (type %"PRIu32") is invalid: %s", i, ops[i].type, ops[i].error);
+      valid = false;
+    }
+  }
+
+  if (valid)
+  {
+    ladish_graph_batch_begin(graph);
+    ladish_graph_manager_apply_ops(graph, ops, count);
+    ladish_graph_batch_end(graph);
+  }
+  else
+  {
+    for (i = 0; i < count; i++)
+    {
+      if (ops[i].error == NULL)
+      {
+        ops[i].error = "not applied";
+      }
+    }
+  }
+
+  version = ladish_graph_get_version(graph);
+
+  call_ptr->reply = dbus_message_new_method_return(call_ptr->message);
+  if (call_ptr->reply == NULL)
+  {
+    goto fail;
+  }
+
+  dbus_message_iter_init_append(call_ptr->reply, &iter);
+
+  if (!dbus_message_iter_append_basic(&iter, DBUS_TYPE_UINT64, &version))
+  {
+    goto fail_unref;
+  }
+
+  if (!dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "(bs)", &array_iter))
+  {
+    goto fail_unref;
+  }
+
+  for (i = 0; i < count; i++)
+  {
+    if (!dbus_message_iter_open_container(&array_iter, DBUS_TYPE_STRUCT, NULL, &struct_iter))
+    {
+      goto fail_unref;
+    }
+
+    if (!dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_BOOLEAN, &ops[i].success) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, &ops[i].error))
+    {
+      goto fail_unref;
+    }
+
+    if (!dbus_message_iter_close_container(&array_iter, &struct_iter))
+    {
+      goto fail_unref;
+    }
+  }
+
+  if (!dbus_message_iter_close_container(&iter, &array_iter))
+  {
+    goto fail_unref;
+  }
+
+  goto free_ops;
+
+fail_unref:
+  dbus_message_unref(call_ptr->reply);
+  call_ptr->reply = NULL;
+fail:
+  log_error("Ran out of memory trying to construct method return");
+free_ops:
+  for (i = 0; i < count; i++)
+  {
+    free(ops[i].old_name);
+  }
+
+  free(ops);
+}
+
 #undef graph_ptr
 
 CDBUS_METHOD_ARGS_BEGIN(Split, "Split client")
@@ -313,6 +689,12 @@ CDBUS_METHOD_ARGS_BEGIN(RemoveClient, "Remove empty client")
   CDBUS_METHOD_ARG_DESCRIBE_IN("client_id", "t", "ID of the client to remove")
 CDBUS_METHOD_ARGS_END
 
+CDBUS_METHOD_ARGS_BEGIN(ApplyBatch, "Apply multiple changes with single call. Nothing is applied if an operation is invalid or duplicate. Renames and moves are rolled back if one of them fails, otherwise (dis)connects are then requested one by one and are not rolled back. Changes made during the call share one graph version and are followed by single GraphChanged signal")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("operations", "a(utts)", "Operations (type, id1, id2, name), ids refer to the graph before the batch")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("graph_version", "t", "Graph version after the call, connections made by JACK after the call get own versions")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("results", "a(bs)", "Result of each operation (success, error message)")
+CDBUS_METHOD_ARGS_END
+
 CDBUS_METHODS_BEGIN
   CDBUS_METHOD_DESCRIBE(Split, ladish_graph_manager_dbus_split)
   CDBUS_METHOD_DESCRIBE(Join, ladish_graph_manager_dbus_join)
@@ -321,7 +703,17 @@ CDBUS_METHODS_BEGIN
   CDBUS_METHOD_DESCRIBE(MovePort, ladish_graph_manager_dbus_move_port)
   CDBUS_METHOD_DESCRIBE(NewClient, ladish_graph_manager_dbus_new_client)
   CDBUS_METHOD_DESCRIBE(RemoveClient, ladish_graph_manager_dbus_remove_client)
+  CDBUS_METHOD_DESCRIBE(ApplyBatch, ladish_graph_manager_dbus_apply_batch)
 CDBUS_METHODS_END
 
-CDBUS_INTERFACE_DEFAULT_HANDLER_METHODS_ONLY(g_iface_graph_manager, IFACE_GRAPH_MANAGER)
+CDBUS_SIGNAL_ARGS_BEGIN(ConnectionsRestored, "Auto connect of the saved connections is complete")
+  CDBUS_SIGNAL_ARG_DESCRIBE("restored", DBUS_TYPE_UINT32_AS_STRING, "Number of connections that were connected")
+  CDBUS_SIGNAL_ARG_DESCRIBE("failed", DBUS_TYPE_UINT32_AS_STRING, "Number of connections that failed to connect after all retries")
+CDBUS_SIGNAL_ARGS_END
+
+CDBUS_SIGNALS_BEGIN
+  CDBUS_SIGNAL_DESCRIBE(ConnectionsRestored)
+CDBUS_SIGNALS_END
+
+CDBUS_INTERFACE_DEFAULT_HANDLER_METHODS_AND_SIGNALS(g_iface_graph_manager, IFACE_GRAPH_MANAGER)
 
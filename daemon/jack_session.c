@@ -33,17 +33,30 @@
 #include "../proxies/conf_proxy.h"
 #include "conf.h"
 
-struct ladish_js_find_app_client_context
+/* Deadline for the JACK session save of single app */
+#define LADISH_JS_SAVE_TIMEOUT 60000 /* milliseconds */
+
+struct ladish_js_client
 {
   uuid_t app_uuid;
-  bool query;
-  const char * client_name;
+  uint64_t jack_id;
+  char * jack_name;
+  bool js;
+  size_t order;                 /* position in the graph */
 };
 
-#define ctx_ptr ((struct ladish_js_find_app_client_context *)context)
+struct ladish_js_clients
+{
+  struct ladish_js_client * clients; /* sorted by app uuid */
+  size_t count;
+  size_t allocated;
+};
 
+#define clients_ptr ((struct ladish_js_clients *)context)
+
+static
 bool
-ladish_js_find_app_client_callback(
+ladish_js_clients_add_callback(
   void * context,
   ladish_graph_handle UNUSED(graph_handle),
   bool hidden,
@@ -51,12 +64,12 @@ ladish_js_find_app_client_callback(
   const char * client_name,
   void ** UNUSED(client_iteration_context_ptr_ptr))
 {
-  bool has_callback;
+  struct ladish_js_client * client_ptr;
   const char * jack_name;
+  uuid_t app_uuid;
+  size_t allocated;
 
-  //log_info("checking client '%s'", client_name);
-
-  if (hidden)
+  if (hidden || !ladish_client_get_app(client_handle, app_uuid))
   {
     return true;              /* continue iteration */
   }
@@ -69,65 +82,134 @@ ladish_js_find_app_client_callback(
     return true;              /* continue iteration */
   }
 
-  if (ctx_ptr->query)
+  if (clients_ptr->count == clients_ptr->allocated)
   {
-    if (!jack_proxy_session_has_callback(jack_name, &has_callback))
+    allocated = clients_ptr->allocated != 0 ? clients_ptr->allocated * 2 : 16;
+    client_ptr = realloc(clients_ptr->clients, allocated * sizeof(struct ladish_js_client));
+    if (client_ptr == NULL)
     {
-      return true;              /* continue iteration */
+      log_error("realloc() failed to allocate JS client index with %zu entries", allocated);
+      return false;
     }
 
-    //log_info("client '%s' %s session callback", jack_name, has_callback ? "has" : "hasn't");
-    ladish_client_set_js(client_handle, has_callback);
-
-    if (!has_callback)
-    {
-      return true;              /* continue iteration */
-    }
+    clients_ptr->clients = client_ptr;
+    clients_ptr->allocated = allocated;
   }
-  else
+
+  client_ptr = clients_ptr->clients + clients_ptr->count;
+
+  client_ptr->jack_name = strdup(jack_name);
+  if (client_ptr->jack_name == NULL)
   {
-    if (!ladish_client_is_js(client_handle))
-    {
-      return true;              /* continue iteration */
-    }
+    log_error("strdup() failed for JS client name '%s'", jack_name);
+    return false;
   }
 
-  log_info("client '%s' has session callback", jack_name);
+  uuid_copy(client_ptr->app_uuid, app_uuid);
+  client_ptr->jack_id = ladish_client_get_jack_id(client_handle);
+  client_ptr->js = ladish_client_is_js(client_handle);
+  client_ptr->order = clients_ptr->count++;
+
+  return true;
+}
+
+#undef clients_ptr
+
+static int ladish_js_client_compare(const void * a, const void * b)
+{
+  int ret;
 
-  if (!ladish_client_is_app(client_handle, ctx_ptr->app_uuid))
+  ret = uuid_compare(((const struct ladish_js_client *)a)->app_uuid, ((const struct ladish_js_client *)b)->app_uuid);
+  if (ret != 0)
   {
-    return true;                /* continue iteration */
+    return ret;
   }
 
-  ctx_ptr->client_name = jack_name;
-  return false;                 /* stop iteration */
+  /* keep the graph order of the clients of same app */
+  return ((const struct ladish_js_client *)a)->order < ((const struct ladish_js_client *)b)->order ? -1 : 1;
 }
 
-#undef ctx_ptr
+#define clients_ptr ((struct ladish_js_clients *)clients_handle)
 
-static
-const char *
-ladish_js_find_app_client(
-  uuid_t app_uuid)
+bool ladish_js_clients_create(ladish_js_clients_handle * clients_handle_ptr)
+{
+  struct ladish_js_clients * ptr;
+
+  ptr = malloc(sizeof(struct ladish_js_clients));
+  if (ptr == NULL)
+  {
+    log_error("malloc() failed to allocate struct ladish_js_clients");
+    return false;
+  }
+
+  ptr->clients = NULL;
+  ptr->count = 0;
+  ptr->allocated = 0;
+
+  if (!ladish_graph_iterate_nodes(ladish_studio_get_jack_graph(), ptr, ladish_js_clients_add_callback, NULL, NULL))
+  {
+    ladish_js_clients_destroy((ladish_js_clients_handle)ptr);
+    return false;
+  }
+
+  if (ptr->count > 1)
+  {
+    qsort(ptr->clients, ptr->count, sizeof(struct ladish_js_client), ladish_js_client_compare);
+  }
+
+  *clients_handle_ptr = (ladish_js_clients_handle)ptr;
+  return true;
+}
+
+void ladish_js_clients_destroy(ladish_js_clients_handle clients_handle)
 {
-  struct ladish_js_find_app_client_context ctx;
+  size_t i;
 
-  ctx.client_name = NULL;
-  ctx.query = false;
+  for (i = 0; i < clients_ptr->count; i++)
+  {
+    free(clients_ptr->clients[i].jack_name);
+  }
 
-  uuid_copy(ctx.app_uuid, app_uuid);
-  ladish_graph_iterate_nodes(ladish_studio_get_jack_graph(), &ctx, ladish_js_find_app_client_callback, NULL, NULL);
+  free(clients_ptr->clients);
+  free(clients_ptr);
+}
 
-  /* app registered the callback after the client activation, try harder */
-  if (ctx.client_name == NULL)
+/* Get the range of clients of the app */
+static
+struct ladish_js_client *
+ladish_js_clients_find(
+  ladish_js_clients_handle clients_handle,
+  const uuid_t app_uuid,
+  size_t * count_ptr)
+{
+  size_t low;
+  size_t high;
+  size_t mid;
+  size_t end;
+
+  low = 0;
+  high = clients_ptr->count;
+  while (low < high)
   {
-    ctx.query = true;
-    ladish_graph_iterate_nodes(ladish_studio_get_jack_graph(), &ctx, ladish_js_find_app_client_callback, NULL, NULL);
+    mid = low + (high - low) / 2;
+    if (uuid_compare(clients_ptr->clients[mid].app_uuid, app_uuid) < 0)
+    {
+      low = mid + 1;
+    }
+    else
+    {
+      high = mid;
+    }
   }
 
-  return ctx.client_name;
+  for (end = low; end < clients_ptr->count && uuid_compare(clients_ptr->clients[end].app_uuid, app_uuid) == 0; end++);
+
+  *count_ptr = end - low;
+  return clients_ptr->clients + low;
 }
 
+#undef clients_ptr
+
 struct ladish_js_save_app_context
 {
   void * context;
@@ -138,17 +220,52 @@ struct ladish_js_save_app_context
   char * target_dir;            /* the dir supplied as parameter to ladish_js_save_app() */
   char * temp_dir;              /* temp dir that is passed to jack session notify */
   char * client_dir;            /* client dir within the temp dir */
+
+  /* clients of the app that are queried for session callback,
+     when none of them is known to have one */
+  struct ladish_js_client * candidates;
+  size_t candidates_count;
+  size_t candidate;
+
+  cdbus_pending_call_handle call;
 };
 
+static void ladish_js_save_app_free(struct ladish_js_save_app_context * ctx_ptr)
+{
+  size_t i;
+
+  for (i = 0; i < ctx_ptr->candidates_count; i++)
+  {
+    free(ctx_ptr->candidates[i].jack_name);
+  }
+
+  free(ctx_ptr->candidates);
+  free(ctx_ptr->client_dir);
+  free(ctx_ptr->temp_dir);
+  free(ctx_ptr->target_dir);
+  free(ctx_ptr);
+}
+
+static void ladish_js_save_app_remove_temp_dir(struct ladish_js_save_app_context * ctx_ptr)
+{
+  if (rmdir(ctx_ptr->temp_dir) < 0)
+  {
+    log_error("rmdir('%s') failed. errno = %d (%s)", ctx_ptr->temp_dir, errno, strerror(errno));
+  }
+}
+
 #define ctx_ptr ((struct ladish_js_save_app_context *)context)
 
-void ladish_js_save_app_complete(void * context, const char * commandline)
+static void ladish_js_save_app_complete(void * context, const char * commandline)
 {
   int iret;
   unsigned int delay;
 
+  ctx_ptr->call = NULL;
+
   if (commandline == NULL)
   {
+    ladish_js_save_app_remove_temp_dir(ctx_ptr);
     goto call;
   }
 
@@ -183,32 +300,120 @@ void ladish_js_save_app_complete(void * context, const char * commandline)
 
 call:
   ctx_ptr->callback(ctx_ptr->context, commandline);
+  ladish_js_save_app_free(ctx_ptr);
+}
 
-  free(ctx_ptr->client_dir);
-  free(ctx_ptr->temp_dir);
-  free(ctx_ptr->target_dir);
-  free(ctx_ptr);
+static bool ladish_js_save_app_notify(struct ladish_js_save_app_context * context, const char * js_client)
+{
+  ctx_ptr->client_dir = catdup(ctx_ptr->temp_dir, js_client);
+  if (ctx_ptr->client_dir == NULL)
+  {
+    log_error("catdup() failed to compose js client dir path");
+    return false;
+  }
+
+  if (!jack_proxy_session_save_one_async(
+        true,
+        js_client,
+        ctx_ptr->temp_dir,
+        LADISH_JS_SAVE_TIMEOUT,
+        ctx_ptr,
+        ladish_js_save_app_complete,
+        &ctx_ptr->call))
+  {
+    log_error("jack session failed to initiate save of '%s' app state to '%s'", js_client, ctx_ptr->temp_dir);
+    return false;
+  }
+
+  log_info("JS app save initiated for client '%s'", js_client);
+  return true;
+}
+
+static bool ladish_js_save_app_query(struct ladish_js_save_app_context * context);
+
+static void ladish_js_save_app_query_complete(void * context, bool success, bool has_callback)
+{
+  struct ladish_js_client * candidate_ptr;
+  ladish_client_handle client;
+
+  ctx_ptr->call = NULL;
+  candidate_ptr = ctx_ptr->candidates + ctx_ptr->candidate;
+
+  if (success)
+  {
+    /* remember the answer, if the client is still there */
+    client = ladish_graph_find_client_by_jack_id(ladish_studio_get_jack_graph(), candidate_ptr->jack_id);
+    if (client != NULL)
+    {
+      ladish_client_set_js(client, has_callback);
+    }
+
+    if (has_callback)
+    {
+      log_info("client '%s' has session callback", candidate_ptr->jack_name);
+
+      if (ladish_js_save_app_notify(ctx_ptr, candidate_ptr->jack_name))
+      {
+        return;
+      }
+
+      goto fail;
+    }
+  }
+
+  ctx_ptr->candidate++;
+  if (ladish_js_save_app_query(ctx_ptr))
+  {
+    return;
+  }
+
+fail:
+  ladish_js_save_app_remove_temp_dir(ctx_ptr);
+  ctx_ptr->callback(ctx_ptr->context, NULL);
+  ladish_js_save_app_free(ctx_ptr);
+}
+
+/* app registered the callback after the client activation, ask JACK */
+static bool ladish_js_save_app_query(struct ladish_js_save_app_context * context)
+{
+  for (; ctx_ptr->candidate < ctx_ptr->candidates_count; ctx_ptr->candidate++)
+  {
+    if (jack_proxy_session_has_callback_async(
+          ctx_ptr->candidates[ctx_ptr->candidate].jack_name,
+          ctx_ptr,
+          ladish_js_save_app_query_complete,
+          &ctx_ptr->call))
+    {
+      return true;
+    }
+  }
+
+  log_error("cannot find js app client");
+  return false;
 }
 
 #undef ctx_ptr
 
 bool
 ladish_js_save_app(
+  ladish_js_clients_handle clients,
   uuid_t app_uuid,
   const char * parent_dir,
   void * completion_context,
   void (* completion_callback)(
     void * completion_context,
-    const char * commandline))
+    const char * commandline),
+  ladish_js_save_handle * save_handle_ptr)
 {
   struct ladish_js_save_app_context * ctx_ptr;
   char app_uuid_str[37];
-  int ret;
-  const char * js_client;
+  struct ladish_js_client * clients_ptr;
+  size_t clients_count;
+  size_t i;
   size_t ofs;
 
-  js_client = ladish_js_find_app_client(app_uuid);
-  if (js_client == NULL)
+  clients_ptr = ladish_js_clients_find(clients, app_uuid, &clients_count);
+  if (clients_count == 0)
   {
     log_error("cannot find js app client");
     goto fail;
@@ -221,12 +426,21 @@ ladish_js_save_app(
     goto fail;
   }
 
+  ctx_ptr->callback = completion_callback;
+  ctx_ptr->context = completion_context;
+  ctx_ptr->temp_dir = NULL;
+  ctx_ptr->client_dir = NULL;
+  ctx_ptr->candidates = NULL;
+  ctx_ptr->candidates_count = 0;
+  ctx_ptr->candidate = 0;
+  ctx_ptr->call = NULL;
+
   uuid_unparse(app_uuid, app_uuid_str);
   ctx_ptr->target_dir = catdup3(parent_dir, "/", app_uuid_str);
   if (ctx_ptr->target_dir == NULL)
   {
     log_error("strdup3(\"%s\", \"/\", \"%s\") failed for compose js target app dir", parent_dir, app_uuid_str);
-    goto fail_free_struct;
+    goto fail_free;
   }
 
   log_info("JS target app dir is '%s'", ctx_ptr->target_dir);
@@ -235,7 +449,7 @@ ladish_js_save_app(
   if (ctx_ptr->temp_dir == NULL)
   {
     log_error("catdup() failed to compose app js temp dir path template");
-    goto fail_free_target_dir;
+    goto fail_free;
   }
 
   ofs = strlen(ctx_ptr->temp_dir) - 1;
@@ -244,47 +458,76 @@ ladish_js_save_app(
   if (mkdtemp(ctx_ptr->temp_dir) == NULL)
   {
     log_error("mkdtemp('%s') failed. errno = %d (%s)", ctx_ptr->temp_dir, errno, strerror(errno));
-    goto fail_free_temp_dir;
+    goto fail_free;
   }
 
   ctx_ptr->temp_dir[ofs] = '/';   /* jack session wants last char to be / */
 
   log_info("JS temp app dir is '%s'", ctx_ptr->temp_dir);
 
-  ctx_ptr->client_dir = catdup(ctx_ptr->temp_dir, js_client);
-  if (ctx_ptr->client_dir == NULL)
+  for (i = 0; i < clients_count; i++)
   {
-    log_error("catdup3() failed to compose js client dir path");
+    if (clients_ptr[i].js)
+    {
+      log_info("client '%s' has session callback", clients_ptr[i].jack_name);
+
+      if (!ladish_js_save_app_notify(ctx_ptr, clients_ptr[i].jack_name))
+      {
+        goto fail_rm_temp_dir;
+      }
+
+      goto started;
+    }
+  }
+
+  ctx_ptr->candidates = malloc(clients_count * sizeof(struct ladish_js_client));
+  if (ctx_ptr->candidates == NULL)
+  {
+    log_error("malloc() failed to allocate JS client candidates");
     goto fail_rm_temp_dir;
   }
 
-  ctx_ptr->callback = completion_callback;
-  ctx_ptr->context = completion_context;
+  for (i = 0; i < clients_count; i++)
+  {
+    ctx_ptr->candidates[i] = clients_ptr[i];
+    ctx_ptr->candidates[i].jack_name = strdup(clients_ptr[i].jack_name);
+    if (ctx_ptr->candidates[i].jack_name == NULL)
+    {
+      log_error("strdup() failed for JS client name");
+      goto fail_rm_temp_dir;
+    }
+
+    ctx_ptr->candidates_count++;
+  }
 
-  if (!jack_proxy_session_save_one(true, js_client, ctx_ptr->temp_dir, ctx_ptr, ladish_js_save_app_complete))
+  if (!ladish_js_save_app_query(ctx_ptr))
   {
-    log_error("jack session failed to initiate save of '%s' app state to '%s'", js_client, ctx_ptr->temp_dir);
     goto fail_rm_temp_dir;
   }
 
-  log_info("JS app save initiated");
-
+started:
+  *save_handle_ptr = (ladish_js_save_handle)ctx_ptr;
   return true;
 
 fail_rm_temp_dir:
-  ret = rmdir(ctx_ptr->temp_dir);
-  if (ret < 0)
-  {
-    log_error("rmdir('%s') failed. errno = %d (%s)", ctx_ptr->temp_dir, errno, strerror(errno));
-  }
-//fail_free_client_dir:
-  free(ctx_ptr->client_dir);
-fail_free_temp_dir:
-  free(ctx_ptr->temp_dir);
-fail_free_target_dir:
-  free(ctx_ptr->target_dir);
-fail_free_struct:
-  free(ctx_ptr);
+  ladish_js_save_app_remove_temp_dir(ctx_ptr);
+fail_free:
+  ladish_js_save_app_free(ctx_ptr);
 fail:
   return false;
 }
+
+void ladish_js_save_app_cancel(ladish_js_save_handle save_handle)
+{
+  struct ladish_js_save_app_context * ctx_ptr;
+
+  ctx_ptr = (struct ladish_js_save_app_context *)save_handle;
+
+  if (ctx_ptr->call != NULL)
+  {
+    cdbus_call_async_cancel(ctx_ptr->call);
+  }
+
+  ladish_js_save_app_remove_temp_dir(ctx_ptr);
+  ladish_js_save_app_free(ctx_ptr);
+}
@@ -29,13 +29,28 @@
 
 #include "common.h"
 
+typedef struct ladish_js_clients_tag { int unused; } * ladish_js_clients_handle;
+typedef struct ladish_js_save_tag { int unused; } * ladish_js_save_handle;
+
+/* Index of the visible app clients in the JACK graph, built in single pass.
+ * To be used for saving multiple apps at once. */
+bool ladish_js_clients_create(ladish_js_clients_handle * clients_handle_ptr);
+void ladish_js_clients_destroy(ladish_js_clients_handle clients_handle);
+
+/* Initiate JACK session save of app. The clients index is not used after the call returns.
+ * On success, the completion callback is called once, with NULL commandline on failure
+ * or when the app did not save within the deadline, unless the save is cancelled. */
 bool
 ladish_js_save_app(
+  ladish_js_clients_handle clients,
   uuid_t app_uuid,
   const char * parent_dir,
   void * completion_context,
   void (* completion_callback)(
     void * completion_context,
-    const char * commandline));
+    const char * commandline),
+  ladish_js_save_handle * save_handle_ptr);
+
+void ladish_js_save_app_cancel(ladish_js_save_handle save_handle);
 
 #endif /* #ifndef JACK_SESSION_H__3C0F2ED2_7FAB_460F_A34F_4E3CAB6AC552__INCLUDED */
@@ -0,0 +1,433 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2026 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the JACK status publisher
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "jack_status.h"
+#include "reactor.h"
+#include "studio.h"
+#include "../dbus_constants.h"
+
+/* JACK sampling period while there are subscribers, in milliseconds */
+#define LADISH_JACK_STATUS_INTERVAL 250
+
+/* DSP load is reported in steps of this many percents and only after it moved
+   by at least a step, so load jitter alone does not cause a signal every sample */
+#define LADISH_JACK_STATUS_DSP_LOAD_STEP 5
+
+/* jackdbus control methods queried for each sample, all calls are made without waiting for replies */
+#define LADISH_JACK_STATUS_QUERY_XRUNS       0
+#define LADISH_JACK_STATUS_QUERY_DSP_LOAD    1
+#define LADISH_JACK_STATUS_QUERY_BUFFER_SIZE 2
+#define LADISH_JACK_STATUS_QUERY_COUNT       3
+
+static const char * g_ladish_jack_status_query_methods[LADISH_JACK_STATUS_QUERY_COUNT] =
+{
+  "GetXruns",
+  "GetLoad",
+  "GetBufferSize",
+};
+
+struct ladish_jack_status_subscriber
+{
+  struct list_head siblings;
+  char * name;
+};
+
+static struct
+{
+  struct list_head subscribers;
+  bool valid;                   /* false when the next sample must be emitted even if nothing changed */
+  uint32_t xruns;
+  uint32_t buffer_size;
+  uint32_t dsp_load;            /* percents, multiple of LADISH_JACK_STATUS_DSP_LOAD_STEP */
+
+  /* sample in progress */
+  cdbus_pending_call_handle calls[LADISH_JACK_STATUS_QUERY_COUNT]; /* NULL when the reply was received */
+  unsigned int pending;         /* number of calls waiting for reply */
+  bool failed;                  /* some of the queries failed, the sample is dropped */
+  uint32_t sample_xruns;
+  uint32_t sample_buffer_size;
+  double sample_load;
+} g_jack_status;
+
+static void ladish_jack_status_sample(void * context);
+
+static void ladish_jack_status_sample_complete(void)
+{
+  uint32_t dsp_load;
+  double load;
+
+  if (g_jack_status.failed)
+  {
+    goto next;
+  }
+
+  load = g_jack_status.sample_load;
+  dsp_load = load > 0.0 ? (uint32_t)(load / LADISH_JACK_STATUS_DSP_LOAD_STEP + 0.5) * LADISH_JACK_STATUS_DSP_LOAD_STEP : 0;
+  if (g_jack_status.valid &&
+      load > (double)g_jack_status.dsp_load - LADISH_JACK_STATUS_DSP_LOAD_STEP &&
+      load < (double)g_jack_status.dsp_load + LADISH_JACK_STATUS_DSP_LOAD_STEP)
+  {
+    dsp_load = g_jack_status.dsp_load;
+  }
+
+  if (!g_jack_status.valid ||
+      g_jack_status.sample_xruns != g_jack_status.xruns ||
+      g_jack_status.sample_buffer_size != g_jack_status.buffer_size ||
+      dsp_load != g_jack_status.dsp_load)
+  {
+    g_jack_status.valid = true;
+    g_jack_status.xruns = g_jack_status.sample_xruns;
+    g_jack_status.buffer_size = g_jack_status.sample_buffer_size;
+    g_jack_status.dsp_load = dsp_load;
+
+    cdbus_signal_emit(
+      cdbus_g_dbus_connection,
+      CONTROL_OBJECT_PATH,
+      IFACE_CONTROL,
+      "JackStatusChanged",
+      "uuu",
+      &g_jack_status.xruns,
+      &g_jack_status.buffer_size,
+      &g_jack_status.dsp_load);
+  }
+
+next:
+  ladish_reactor_post_delayed(&g_jack_status, ladish_jack_status_sample, LADISH_JACK_STATUS_INTERVAL);
+}
+
+#define query_ptr ((unsigned int *)cookie)
+
+static void ladish_jack_status_handle_reply(void * UNUSED(context), void * cookie, DBusMessage * reply_ptr)
+{
+  const char * method;
+  bool success;
+
+  g_jack_status.calls[*query_ptr] = NULL;
+  method = g_ladish_jack_status_query_methods[*query_ptr];
+
+  switch (*query_ptr)
+  {
+  case LADISH_JACK_STATUS_QUERY_XRUNS:
+    success = cdbus_call_async_get_reply_args(reply_ptr, method, "u", &g_jack_status.sample_xruns);
+    break;
+  case LADISH_JACK_STATUS_QUERY_DSP_LOAD:
+    success = cdbus_call_async_get_reply_args(reply_ptr, method, "d", &g_jack_status.sample_load);
+    break;
+  case LADISH_JACK_STATUS_QUERY_BUFFER_SIZE:
+    success = cdbus_call_async_get_reply_args(reply_ptr, method, "u", &g_jack_status.sample_buffer_size);
+    break;
+  default:
+    ASSERT_NO_PASS;
+    success = false;
+  }
+
+  g_jack_status.failed = g_jack_status.failed || !success;
+
+  ASSERT(g_jack_status.pending > 0);
+  g_jack_status.pending--;
+  if (g_jack_status.pending == 0)
+  {
+    ladish_jack_status_sample_complete();
+  }
+}
+
+#undef query_ptr
+
+static void ladish_jack_status_sample(void * UNUSED(context))
+{
+  DBusMessage * request_ptr;
+  unsigned int query;
+
+  if (list_empty(&g_jack_status.subscribers) || !ladish_studio_is_started())
+  {
+    /* sampling is restarted by next subscription or by JACK server start */
+    return;
+  }
+
+  ASSERT(g_jack_status.pending == 0);
+  g_jack_status.failed = false;
+
+  for (query = 0; query < LADISH_JACK_STATUS_QUERY_COUNT; query++)
+  {
+    request_ptr = cdbus_new_method_call_message(
+      JACKDBUS_SERVICE_NAME,
+      JACKDBUS_OBJECT_PATH,
+      JACKDBUS_IFACE_CONTROL,
+      g_ladish_jack_status_query_methods[query],
+      "",
+      NULL);
+    if (request_ptr == NULL)
+    {
+      g_jack_status.failed = true;
+      continue;
+    }
+
+    if (cdbus_call_async_start(
+          0,
+          request_ptr,
+          NULL,
+          &query,
+          sizeof(query),
+          ladish_jack_status_handle_reply,
+          g_jack_status.calls + query))
+    {
+      g_jack_status.pending++;
+    }
+    else
+    {
+      log_error("%s() failed.", g_ladish_jack_status_query_methods[query]);
+      g_jack_status.calls[query] = NULL;
+      g_jack_status.failed = true;
+    }
+
+    dbus_message_unref(request_ptr);
+  }
+
+  if (g_jack_status.pending == 0)
+  {
+    ladish_jack_status_sample_complete();
+  }
+}
+
+/* drop the sample in progress and the scheduled one */
+static void ladish_jack_status_stop(void)
+{
+  unsigned int query;
+
+  ladish_reactor_cancel(&g_jack_status, ladish_jack_status_sample);
+
+  for (query = 0; query < LADISH_JACK_STATUS_QUERY_COUNT; query++)
+  {
+    if (g_jack_status.calls[query] != NULL)
+    {
+      cdbus_call_async_cancel(g_jack_status.calls[query]);
+      g_jack_status.calls[query] = NULL;
+    }
+  }
+
+  g_jack_status.pending = 0;
+}
+
+static bool ladish_jack_status_name_owner_match(const char * name, bool add)
+{
+  char rule[512];
+  int ret;
+
+  ret = snprintf(
+    rule,
+    sizeof(rule),
+    "type='signal',sender='" DBUS_SERVICE_DBUS "',interface='" DBUS_INTERFACE_DBUS "',member='NameOwnerChanged',arg0='%s'",
+    name);
+  if (ret < 0 || (size_t)ret >= sizeof(rule))
+  {
+    log_error("Cannot compose NameOwnerChanged match rule for '%s'", name);
+    return false;
+  }
+
+  /* no error is requested so the bus daemon reply is not waited for */
+  if (add)
+  {
+    dbus_bus_add_match(cdbus_g_dbus_connection, rule, NULL);
+  }
+  else
+  {
+    dbus_bus_remove_match(cdbus_g_dbus_connection, rule, NULL);
+  }
+
+  return true;
+}
+
+static struct ladish_jack_status_subscriber * ladish_jack_status_find_subscriber(const char * name)
+{
+  struct list_head * node_ptr;
+  struct ladish_jack_status_subscriber * subscriber_ptr;
+
+  list_for_each(node_ptr, &g_jack_status.subscribers)
+  {
+    subscriber_ptr = list_entry(node_ptr, struct ladish_jack_status_subscriber, siblings);
+    if (strcmp(subscriber_ptr->name, name) == 0)
+    {
+      return subscriber_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+static void ladish_jack_status_remove_subscriber(struct ladish_jack_status_subscriber * subscriber_ptr)
+{
+  log_info("JACK status subscriber '%s' removed", subscriber_ptr->name);
+
+  list_del(&subscriber_ptr->siblings);
+  ladish_jack_status_name_owner_match(subscriber_ptr->name, false);
+  free(subscriber_ptr->name);
+  free(subscriber_ptr);
+
+  if (list_empty(&g_jack_status.subscribers))
+  {
+    ladish_jack_status_stop();
+  }
+}
+
+static
+DBusHandlerResult
+ladish_jack_status_name_owner_filter(
+  DBusConnection * UNUSED(connection_ptr),
+  DBusMessage * message_ptr,
+  void * UNUSED(data))
+{
+  const char * name;
+  const char * old_owner;
+  const char * new_owner;
+  struct ladish_jack_status_subscriber * subscriber_ptr;
+
+  if (list_empty(&g_jack_status.subscribers) ||
+      !dbus_message_is_signal(message_ptr, DBUS_INTERFACE_DBUS, "NameOwnerChanged") ||
+      !dbus_message_get_args(
+        message_ptr,
+        NULL,
+        DBUS_TYPE_STRING, &name,
+        DBUS_TYPE_STRING, &old_owner,
+        DBUS_TYPE_STRING, &new_owner,
+        DBUS_TYPE_INVALID))
+  {
+    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+  }
+
+  if (new_owner[0] == '\0')
+  {
+    subscriber_ptr = ladish_jack_status_find_subscriber(name);
+    if (subscriber_ptr != NULL)
+    {
+      ladish_jack_status_remove_subscriber(subscriber_ptr);
+    }
+  }
+
+  /* other filters (service lifetime hooks) may be interested too */
+  return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
+bool ladish_jack_status_init(void)
+{
+  unsigned int query;
+
+  INIT_LIST_HEAD(&g_jack_status.subscribers);
+  g_jack_status.valid = false;
+
+  for (query = 0; query < LADISH_JACK_STATUS_QUERY_COUNT; query++)
+  {
+    g_jack_status.calls[query] = NULL;
+  }
+
+  g_jack_status.pending = 0;
+
+  if (!dbus_connection_add_filter(cdbus_g_dbus_connection, ladish_jack_status_name_owner_filter, NULL, NULL))
+  {
+    log_error("Failed to add D-Bus filter for JACK status subscribers");
+    return false;
+  }
+
+  return true;
+}
+
+void ladish_jack_status_uninit(void)
+{
+  while (!list_empty(&g_jack_status.subscribers))
+  {
+    ladish_jack_status_remove_subscriber(list_entry(g_jack_status.subscribers.next, struct ladish_jack_status_subscriber, siblings));
+  }
+
+  dbus_connection_remove_filter(cdbus_g_dbus_connection, ladish_jack_status_name_owner_filter, NULL);
+}
+
+bool ladish_jack_status_subscribe(const char * name)
+{
+  struct ladish_jack_status_subscriber * subscriber_ptr;
+
+  subscriber_ptr = ladish_jack_status_find_subscriber(name);
+  if (subscriber_ptr == NULL)
+  {
+    subscriber_ptr = malloc(sizeof(struct ladish_jack_status_subscriber));
+    if (subscriber_ptr == NULL)
+    {
+      log_error("malloc() failed to allocate struct ladish_jack_status_subscriber");
+      goto fail;
+    }
+
+    subscriber_ptr->name = strdup(name);
+    if (subscriber_ptr->name == NULL)
+    {
+      log_error("strdup() failed for JACK status subscriber name");
+      goto free_subscriber;
+    }
+
+    if (!ladish_jack_status_name_owner_match(name, true))
+    {
+      goto free_name;
+    }
+
+    list_add_tail(&subscriber_ptr->siblings, &g_jack_status.subscribers);
+    log_info("JACK status subscriber '%s' added", name);
+  }
+
+  /* the (new) subscriber needs the current status */
+  ladish_jack_status_on_jack_started();
+  return true;
+
+free_name:
+  free(subscriber_ptr->name);
+free_subscriber:
+  free(subscriber_ptr);
+fail:
+  return false;
+}
+
+void ladish_jack_status_unsubscribe(const char * name)
+{
+  struct ladish_jack_status_subscriber * subscriber_ptr;
+
+  subscriber_ptr = ladish_jack_status_find_subscriber(name);
+  if (subscriber_ptr != NULL)
+  {
+    ladish_jack_status_remove_subscriber(subscriber_ptr);
+  }
+}
+
+void ladish_jack_status_on_jack_started(void)
+{
+  g_jack_status.valid = false;
+
+  if (!list_empty(&g_jack_status.subscribers) && ladish_studio_is_started())
+  {
+    /* The reactor merges posts of the same task only within the immediate
+       or the delayed queue. The scheduled sample is delayed and replies of
+       the sample in progress would schedule another one, so both are
+       dropped to keep only one sampling chain running. */
+    ladish_jack_status_stop();
+    ladish_reactor_post(&g_jack_status, ladish_jack_status_sample);
+  }
+}
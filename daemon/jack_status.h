@@ -0,0 +1,45 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2026 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains interface to the JACK status publisher
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef JACK_STATUS_H__3F0D8C52_7A1E_4B69_9E24_D5C81A0B6F37__INCLUDED
+#define JACK_STATUS_H__3F0D8C52_7A1E_4B69_9E24_D5C81A0B6F37__INCLUDED
+
+#include "common.h"
+
+bool ladish_jack_status_init(void);
+void ladish_jack_status_uninit(void);
+
+/* Subscribers get JackStatusChanged signals while JACK is started,
+ * the current status is sent right after subscription.
+ * Subscriptions of bus names that disappear are dropped automatically. */
+bool ladish_jack_status_subscribe(const char * name);
+void ladish_jack_status_unsubscribe(const char * name);
+
+/* To be called when JACK server start is detected */
+void ladish_jack_status_on_jack_started(void);
+
+#endif /* #ifndef JACK_STATUS_H__3F0D8C52_7A1E_4B69_9E24_D5C81A0B6F37__INCLUDED */
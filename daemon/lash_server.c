@@ -27,6 +27,7 @@
 #include "lash_server.h"
 #include "../dbus_constants.h"
 #include "virtualizer.h"
+#include "appdb.h"
 
 static cdbus_object_path ladishd_g_lash_server_dbus_object;
 extern const struct cdbus_interface_descriptor g_iface_lash_server;
@@ -67,6 +68,7 @@ static void lash_server_register_client(struct cdbus_method_call * call_ptr)
   dbus_uint64_t pid;
   dbus_uint32_t flags;
   ladish_app_handle app;
+  const struct lash_appdb_entry * appdb_entry_ptr;
 
   if (!dbus_message_get_args(
         call_ptr->message,
@@ -85,6 +87,12 @@ static void lash_server_register_client(struct cdbus_method_call * call_ptr)
 
   log_info("LASH client registered. pid=%"PRIu64" dbusname='%s' class='%s' flags=0x%"PRIu32")", pid, sender, class, flags);
 
+  appdb_entry_ptr = ladish_appdb_find(class);
+  if (appdb_entry_ptr != NULL)
+  {
+    log_info("LASH client class '%s' is known application, exec='%s'", class, appdb_entry_ptr->exec != NULL ? appdb_entry_ptr->exec : "");
+  }
+
   app = ladish_find_app_by_pid((pid_t)pid, NULL);
   if (app == NULL)
   {
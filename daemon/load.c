@@ -24,11 +24,94 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "load.h"
 #include "limits.h"
 #include "studio.h"
 #include "../proxies/jmcore_proxy.h"
 
+#define LADISH_PARSE_CHUNK_SIZE (64 * 1024)
+
+bool ladish_parse_file(XML_Parser parser, const char * path)
+{
+  int fd;
+  void * buffer;
+  ssize_t bytes_read;
+  enum XML_Status xmls;
+  XML_ParsingStatus status;
+  bool ret;
+
+  ret = false;
+
+  fd = open(path, O_RDONLY);
+  if (fd == -1)
+  {
+    log_error("failed to open '%s': %d (%s)", path, errno, strerror(errno));
+    goto exit;
+  }
+
+  do
+  {
+    /* read directly into the parser buffer, only one chunk is in memory at a time */
+    buffer = XML_GetBuffer(parser, LADISH_PARSE_CHUNK_SIZE);
+    if (buffer == NULL)
+    {
+      log_error("XML_GetBuffer() failed.");
+      goto close;
+    }
+
+    bytes_read = read(fd, buffer, LADISH_PARSE_CHUNK_SIZE);
+    if (bytes_read == -1)
+    {
+      if (errno == EINTR)
+      {
+        status.parsing = XML_PARSING;
+        continue;
+      }
+
+      log_error("failed to read '%s': %d (%s)", path, errno, strerror(errno));
+      goto close;
+    }
+
+    xmls = XML_ParseBuffer(parser, bytes_read, bytes_read == 0);
+    if (xmls == XML_STATUS_SUSPENDED)
+    {
+      /* resumable stop requested by a callback, the rest of the document is not needed */
+      break;
+    }
+
+    if (xmls == XML_STATUS_ERROR)
+    {
+      if (XML_GetErrorCode(parser) == XML_ERROR_ABORTED)
+      {
+        /* non-resumable stop requested by a callback */
+        break;
+      }
+
+      log_error(
+        "XML_ParseBuffer() failed for '%s' at line %lu: %s",
+        path,
+        (unsigned long)XML_GetCurrentLineNumber(parser),
+        XML_ErrorString(XML_GetErrorCode(parser)));
+      goto close;
+    }
+
+    XML_GetParsingStatus(parser, &status);
+  }
+  while (status.parsing != XML_FINISHED);
+
+  ret = true;
+
+close:
+  close(fd);
+exit:
+  return ret;
+}
+
 void ladish_dump_element_stack(struct ladish_parse_context * context_ptr)
 {
   signed int depth;
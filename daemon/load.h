@@ -73,11 +73,16 @@ struct ladish_parse_context
   uint64_t connection_id;
   bool terminal;
   bool autorun;
+  uint8_t start_priority;
   char level[MAX_LEVEL_CHARCOUNT];
   void * parser;
 };
 
 void ladish_dump_element_stack(struct ladish_parse_context * context_ptr);
+
+/* Feed the file to the parser in fixed size chunks.
+ * Callbacks can end the parsing early with XML_StopParser(), this is not a failure. */
+bool ladish_parse_file(XML_Parser parser, const char * path);
 const char * ladish_get_string_attribute(const char * const * attr, const char * key);
 const char * ladish_get_uuid_attribute(const char * const * attr, const char * key, uuid_t uuid, bool optional);
 const char * ladish_get_bool_attribute(const char * const * attr, const char * key, bool * bool_value_ptr);
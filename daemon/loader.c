@@ -36,24 +36,57 @@
 #include <sys/resource.h>
 
 #include "loader.h"
+#include "reactor.h"
 #include "../proxies/conf_proxy.h"
 #include "conf.h"
 #include "../common/catdup.h"
+#include "../common/hash.h"
+#include "../common/time.h"
 
 #define XTERM_COMMAND_EXTENSION "&& sh || sh"
 
 #define CLIENT_OUTPUT_BUFFER_SIZE 2048
 
+#define LOADER_CHILDS_HASH_SIZE 64
+
+/* Raw output of each child is kept in a ring buffer so it can be fetched through D-Bus */
+#define LOADER_OUTPUT_RING_SIZE (32 * 1024)
+
+/* Output of that many recently exited childs is kept */
+#define LOADER_DEAD_OUTPUTS_MAX 16
+
+/* Max number of read() calls per fd readiness notification,
+ * a child that floods the pipe must not stall the main loop */
+#define LOADER_READ_BUDGET 8
+
+/* Token bucket for logging child output lines. Lines above the rate
+ * are not logged but are still captured in the output ring buffer. */
+#define LOADER_LOG_LINES_PER_SECOND 50
+#define LOADER_LOG_LINES_BURST 200
+
+struct loader_output_ring
+{
+  char * data;                  /* allocated on first output */
+  size_t head;                  /* offset where next byte will be written */
+  size_t used;
+};
+
+struct loader_dead_output
+{
+  struct list_head siblings;
+  pid_t pid;
+  struct loader_output_ring ring;
+};
+
 struct loader_child
 {
   struct list_head  siblings;
+  struct hlist_node pid_siblings; /* link in g_childs_hash */
 
   char * vgraph_name;
   char * app_name;
   char * project_name;
 
-  bool dead;
-  int exit_status;
   pid_t pid;
 
   bool terminal;
@@ -69,20 +102,36 @@ struct loader_child
   char stderr_last_line[CLIENT_OUTPUT_BUFFER_SIZE];
   unsigned int stderr_last_line_repeat_count;
   char * stderr_buffer_ptr;
+
+  struct loader_output_ring output;
+
+  unsigned int log_tokens;
+  uint64_t log_tokens_timestamp;
+  unsigned int log_suppressed_count;
 };
 
 static void (* g_on_child_exit)(pid_t pid, int exit_status);
 static struct list_head g_childs_list;
+static struct hlist_head g_childs_hash[LOADER_CHILDS_HASH_SIZE];
+static unsigned int g_childs_count;
+static struct list_head g_dead_outputs;
+static unsigned int g_dead_outputs_count;
+
+static void loader_close_child_output(struct loader_child * child_ptr);
+
+static struct hlist_head * loader_child_bucket(pid_t pid)
+{
+  return g_childs_hash + ladish_hash_u64((uint64_t)pid) % LOADER_CHILDS_HASH_SIZE;
+}
 
 static struct loader_child *
 loader_child_find(pid_t pid)
 {
-  struct list_head *node_ptr;
+  struct hlist_node *node_ptr;
   struct loader_child *child_ptr;
 
-  list_for_each (node_ptr, &g_childs_list)
+  hlist_for_each_entry(child_ptr, node_ptr, loader_child_bucket(pid), pid_siblings)
   {
-    child_ptr = list_entry(node_ptr, struct loader_child, siblings);
     if (child_ptr->pid == pid)
     {
       return child_ptr;
@@ -92,6 +141,136 @@ loader_child_find(pid_t pid)
   return NULL;
 }
 
+static void loader_output_ring_append(struct loader_output_ring * ring_ptr, const char * data, size_t size)
+{
+  size_t chunk;
+
+  if (ring_ptr->data == NULL)
+  {
+    ring_ptr->data = malloc(LOADER_OUTPUT_RING_SIZE);
+    if (ring_ptr->data == NULL)
+    {
+      return;
+    }
+  }
+
+  if (size > LOADER_OUTPUT_RING_SIZE)
+  {
+    data += size - LOADER_OUTPUT_RING_SIZE;
+    size = LOADER_OUTPUT_RING_SIZE;
+  }
+
+  while (size > 0)
+  {
+    chunk = LOADER_OUTPUT_RING_SIZE - ring_ptr->head;
+    if (chunk > size)
+    {
+      chunk = size;
+    }
+
+    memcpy(ring_ptr->data + ring_ptr->head, data, chunk);
+    ring_ptr->head = (ring_ptr->head + chunk) % LOADER_OUTPUT_RING_SIZE;
+    ring_ptr->used += chunk;
+    data += chunk;
+    size -= chunk;
+  }
+
+  if (ring_ptr->used > LOADER_OUTPUT_RING_SIZE)
+  {
+    ring_ptr->used = LOADER_OUTPUT_RING_SIZE;
+  }
+}
+
+static void loader_dead_output_free(struct loader_dead_output * dead_ptr)
+{
+  list_del(&dead_ptr->siblings);
+  g_dead_outputs_count--;
+  free(dead_ptr->ring.data);
+  free(dead_ptr);
+}
+
+static void loader_dead_output_forget(pid_t pid)
+{
+  struct list_head * node_ptr;
+  struct list_head * next_ptr;
+  struct loader_dead_output * dead_ptr;
+
+  list_for_each_safe(node_ptr, next_ptr, &g_dead_outputs)
+  {
+    dead_ptr = list_entry(node_ptr, struct loader_dead_output, siblings);
+    if (dead_ptr->pid == pid)
+    {
+      loader_dead_output_free(dead_ptr);
+    }
+  }
+}
+
+/* takes ownership of the ring buffer data */
+static void loader_dead_output_keep(pid_t pid, struct loader_output_ring * ring_ptr)
+{
+  struct loader_dead_output * dead_ptr;
+
+  dead_ptr = malloc(sizeof(struct loader_dead_output));
+  if (dead_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate struct loader_dead_output");
+    free(ring_ptr->data);
+    return;
+  }
+
+  dead_ptr->pid = pid;
+  dead_ptr->ring = *ring_ptr;
+  list_add_tail(&dead_ptr->siblings, &g_dead_outputs);
+  g_dead_outputs_count++;
+
+  if (g_dead_outputs_count > LOADER_DEAD_OUTPUTS_MAX)
+  {
+    loader_dead_output_free(list_entry(g_dead_outputs.next, struct loader_dead_output, siblings));
+  }
+}
+
+/* returns whether an output line of the child can be logged now */
+static bool loader_child_log_allowed(struct loader_child * child_ptr)
+{
+  uint64_t now;
+  uint64_t refill;
+
+  now = ladish_get_current_microseconds();
+  if (now > child_ptr->log_tokens_timestamp)
+  {
+    refill = (now - child_ptr->log_tokens_timestamp) * LOADER_LOG_LINES_PER_SECOND / 1000000;
+    if (refill > 0)
+    {
+      child_ptr->log_tokens_timestamp += refill * 1000000 / LOADER_LOG_LINES_PER_SECOND;
+      if (refill > LOADER_LOG_LINES_BURST - child_ptr->log_tokens)
+      {
+        refill = LOADER_LOG_LINES_BURST - child_ptr->log_tokens;
+      }
+      child_ptr->log_tokens += refill;
+    }
+  }
+
+  if (child_ptr->log_tokens == 0)
+  {
+    child_ptr->log_suppressed_count++;
+    return false;
+  }
+
+  child_ptr->log_tokens--;
+
+  if (child_ptr->log_suppressed_count > 0)
+  {
+    log_error_plain(
+      "%s:%s: %u output lines not logged because of rate limiting",
+      child_ptr->vgraph_name,
+      child_ptr->app_name,
+      child_ptr->log_suppressed_count);
+    child_ptr->log_suppressed_count = 0;
+  }
+
+  return true;
+}
+
 static
 void
 loader_check_line_repeat_end(
@@ -114,58 +293,59 @@ loader_check_line_repeat_end(
 }
 
 static void
-loader_childs_bury(void)
+loader_child_bury(struct loader_child * child_ptr, int exit_status)
 {
-  struct list_head *node_ptr;
-  struct list_head *next_ptr;
-  struct loader_child *child_ptr;
+  loader_close_child_output(child_ptr);
 
-  list_for_each_safe (node_ptr, next_ptr, &g_childs_list)
-  {
-    child_ptr = list_entry(node_ptr, struct loader_child, siblings);
-    if (child_ptr->dead)
-    {
-      loader_check_line_repeat_end(
-        child_ptr->vgraph_name,
-        child_ptr->app_name,
-        false,
-        child_ptr->stdout_last_line_repeat_count);
+  loader_check_line_repeat_end(
+    child_ptr->vgraph_name,
+    child_ptr->app_name,
+    false,
+    child_ptr->stdout_last_line_repeat_count);
 
-      loader_check_line_repeat_end(
-        child_ptr->vgraph_name,
-        child_ptr->app_name,
-        true,
-        child_ptr->stderr_last_line_repeat_count);
+  loader_check_line_repeat_end(
+    child_ptr->vgraph_name,
+    child_ptr->app_name,
+    true,
+    child_ptr->stderr_last_line_repeat_count);
 
-      log_debug("Bury child '%s' with PID %llu", child_ptr->app_name, (unsigned long long)child_ptr->pid);
+  if (child_ptr->log_suppressed_count > 0)
+  {
+    log_error_plain(
+      "%s:%s: %u output lines not logged because of rate limiting",
+      child_ptr->vgraph_name,
+      child_ptr->app_name,
+      child_ptr->log_suppressed_count);
+  }
 
-      list_del(&child_ptr->siblings);
+  if (child_ptr->output.data != NULL)
+  {
+    loader_dead_output_keep(child_ptr->pid, &child_ptr->output);
+  }
 
-      free(child_ptr->project_name);
-      free(child_ptr->vgraph_name);
-      free(child_ptr->app_name);
+  log_debug("Bury child '%s' with PID %llu", child_ptr->app_name, (unsigned long long)child_ptr->pid);
 
-      if (!child_ptr->terminal)
-      {
-        close(child_ptr->stdout);
-        close(child_ptr->stderr);
-      }
+  list_del(&child_ptr->siblings);
+  hlist_del(&child_ptr->pid_siblings);
+  g_childs_count--;
 
-      g_on_child_exit(child_ptr->pid, child_ptr->exit_status);
-      free(child_ptr);
-    }
-  }
+  free(child_ptr->project_name);
+  free(child_ptr->vgraph_name);
+  free(child_ptr->app_name);
+
+  g_on_child_exit(child_ptr->pid, exit_status);
+  free(child_ptr);
 }
 
-static void loader_sigchld_handler(int signum)
+/* Called from the main loop when SIGCHLD is received through signalfd.
+ * Dead childs are delivered to the exit callback right away. */
+static void loader_reap_childs(void)
 {
   int status;
   pid_t pid;
   struct loader_child *child_ptr;
   int signal;
 
-  ASSERT(signum == SIGCHLD);
-
   while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
   {
     child_ptr = loader_child_find(pid);
@@ -177,8 +357,6 @@ static void loader_sigchld_handler(int signum)
     else
     {
       log_info("Termination of child process '%s' with PID %llu detected", child_ptr->app_name, (unsigned long long)pid);
-      child_ptr->dead = true;
-      child_ptr->exit_status = status;
     }
 
     if (WIFEXITED(status))
@@ -204,19 +382,47 @@ static void loader_sigchld_handler(int signum)
     {
       log_info("Child was stopped by signal %d", WSTOPSIG(status));
     }
+
+    if (child_ptr != NULL)
+    {
+      loader_child_bury(child_ptr, status);
+    }
   }
 }
 
-void loader_init(void (* on_child_exit)(pid_t pid, int exit_status))
+static void loader_on_sigchld(void * UNUSED(context), int signum)
+{
+  ASSERT(signum == SIGCHLD);
+  loader_reap_childs();
+}
+
+bool loader_init(void (* on_child_exit)(pid_t pid, int exit_status))
 {
+  unsigned int i;
+
   g_on_child_exit = on_child_exit;
-  signal(SIGCHLD, loader_sigchld_handler);
   INIT_LIST_HEAD(&g_childs_list);
+  for (i = 0; i < LOADER_CHILDS_HASH_SIZE; i++)
+  {
+    INIT_HLIST_HEAD(g_childs_hash + i);
+  }
+  g_childs_count = 0;
+  INIT_LIST_HEAD(&g_dead_outputs);
+  g_dead_outputs_count = 0;
+
+  /* waitpid() and logging are done in the main loop context, not in a signal handler */
+  return ladish_reactor_add_signal(SIGCHLD, NULL, loader_on_sigchld);
 }
 
 void loader_uninit(void)
 {
-  loader_childs_bury();
+  /* report childs that exited after the last main loop iteration */
+  loader_reap_childs();
+
+  while (!list_empty(&g_dead_outputs))
+  {
+    loader_dead_output_free(list_entry(g_dead_outputs.next, struct loader_dead_output, siblings));
+  }
 }
 
 #if 0
@@ -349,11 +555,11 @@ loader_exec_program(
   exit(1);
 }
 
+/* returns false when the fd is at EOF or failed */
 static
-void
+bool
 loader_read_child_output(
-  char * vgraph_name,
-  char * app_name,
+  struct loader_child * child_ptr,
   int fd,
   bool error,
   char * buffer_ptr,
@@ -366,13 +572,23 @@ loader_read_child_output(
   char *eol_ptr;
   size_t left;
   size_t max_read;
+  unsigned int reads;
+  char * vgraph_name;
+  char * app_name;
+
+  vgraph_name = child_ptr->vgraph_name;
+  app_name = child_ptr->app_name;
+  reads = 0;
 
   do
   {
     max_read = CLIENT_OUTPUT_BUFFER_SIZE - 1 - (*buffer_ptr_ptr - buffer_ptr);
     ret = read(fd, *buffer_ptr_ptr, max_read);
+    reads++;
     if (ret > 0)
     {
+      loader_output_ring_append(&child_ptr->output, *buffer_ptr_ptr, ret);
+
       (*buffer_ptr_ptr)[ret] = 0;
       char_ptr = buffer_ptr;
 
@@ -382,7 +598,7 @@ loader_read_child_output(
 
         if (*last_line_repeat_count > 0 && strcmp(last_line, char_ptr) == 0)
         {
-          if (*last_line_repeat_count == 1)
+          if (*last_line_repeat_count == 1 && loader_child_log_allowed(child_ptr))
           {
             if (error)
             {
@@ -403,7 +619,11 @@ loader_read_child_output(
           strcpy(last_line, char_ptr);
           *last_line_repeat_count = 1;
 
-          if (error)
+          if (!loader_child_log_allowed(child_ptr))
+          {
+            /* captured in the output ring only */
+          }
+          else if (error)
           {
             log_error_plain("%s:%s: %s", vgraph_name, app_name, char_ptr);
           }
@@ -426,7 +646,11 @@ loader_read_child_output(
           /* line is too long to fit in buffer */
           /* print it like it is, rest (or more) of it will be logged on next interation */
 
-          if (error)
+          if (!loader_child_log_allowed(child_ptr))
+          {
+            /* captured in the output ring only */
+          }
+          else if (error)
           {
             log_error_plain("%s:%s: %s " ANSI_RESET ANSI_COLOR_RED "(truncated) " ANSI_RESET, vgraph_name, app_name, char_ptr);
           }
@@ -446,49 +670,85 @@ loader_read_child_output(
       *buffer_ptr_ptr = buffer_ptr + left;
     }
   }
-  while ((size_t)ret == max_read);      /* if we have read everything as much as we can, then maybe there is more to read */
+  /* if we have read everything as much as we can, then maybe there is more to read */
+  /* if the read budget is exhausted, level triggered epoll will report the fd again */
+  while ((size_t)ret == max_read && reads < LOADER_READ_BUDGET);
+
+  /* EIO is what pty master returns after the slave side is closed */
+  return ret > 0 || (ret < 0 && (errno == EAGAIN || errno == EINTR));
 }
 
-static void
-loader_read_childs_output(void)
+static bool loader_read_child_stream(struct loader_child * child_ptr, bool error)
 {
-  struct list_head * node_ptr;
-  struct loader_child * child_ptr;
+  if (error)
+  {
+    return loader_read_child_output(
+      child_ptr,
+      child_ptr->stderr,
+      true,
+      child_ptr->stderr_buffer,
+      &child_ptr->stderr_buffer_ptr,
+      child_ptr->stderr_last_line,
+      &child_ptr->stderr_last_line_repeat_count);
+  }
+
+  return loader_read_child_output(
+    child_ptr,
+    child_ptr->stdout,
+    false,
+    child_ptr->stdout_buffer,
+    &child_ptr->stdout_buffer_ptr,
+    child_ptr->stdout_last_line,
+    &child_ptr->stdout_last_line_repeat_count);
+}
 
-  list_for_each (node_ptr, &g_childs_list)
+#define child_ptr ((struct loader_child *)context)
+
+static void loader_on_child_output(void * context, int fd, uint32_t events)
+{
+  bool error;
+
+  ASSERT(fd == child_ptr->stdout || fd == child_ptr->stderr);
+  error = fd == child_ptr->stderr;
+
+  if (!loader_read_child_stream(child_ptr, error) || (events & (EPOLLHUP | EPOLLERR)) != 0)
   {
-    child_ptr = list_entry(node_ptr, struct loader_child, siblings);
+    /* the fd itself is closed when child is buried */
+    ladish_reactor_remove_fd(fd);
+  }
+}
 
-    if (!child_ptr->terminal)
-    {
-      loader_read_child_output(
-        child_ptr->vgraph_name,
-        child_ptr->app_name,
-        child_ptr->stdout,
-        false,
-        child_ptr->stdout_buffer,
-        &child_ptr->stdout_buffer_ptr,
-        child_ptr->stdout_last_line,
-        &child_ptr->stdout_last_line_repeat_count);
-
-      loader_read_child_output(
-        child_ptr->vgraph_name,
-        child_ptr->app_name,
-        child_ptr->stderr,
-        true,
-        child_ptr->stderr_buffer,
-        &child_ptr->stderr_buffer_ptr,
-        child_ptr->stderr_last_line,
-        &child_ptr->stderr_last_line_repeat_count);
-    }
+#undef child_ptr
+
+static void loader_watch_child_output(struct loader_child * child_ptr)
+{
+  if (child_ptr->stdout != -1)
+  {
+    ladish_reactor_add_fd(child_ptr->stdout, EPOLLIN, child_ptr, loader_on_child_output);
+  }
+
+  if (child_ptr->stderr != -1)
+  {
+    ladish_reactor_add_fd(child_ptr->stderr, EPOLLIN, child_ptr, loader_on_child_output);
   }
 }
 
-void
-loader_run(void)
+static void loader_close_child_output(struct loader_child * child_ptr)
 {
-  loader_read_childs_output();
-  loader_childs_bury();
+  /* log what was written just before the child died */
+  if (child_ptr->stdout != -1)
+  {
+    loader_read_child_stream(child_ptr, false);
+    ladish_reactor_remove_fd(child_ptr->stdout);
+    close(child_ptr->stdout);
+  }
+
+  if (child_ptr->stderr != -1)
+  {
+    loader_read_child_stream(child_ptr, true);
+    ladish_reactor_remove_fd(child_ptr->stderr);
+    close(child_ptr->stderr);
+  }
 }
 
 #define LD_PRELOAD_ADD "libalsapid.so libasound.so.2"
@@ -572,12 +832,19 @@ loader_execute(
     goto free_project_name;
   }
 
-  child_ptr->dead = false;
   child_ptr->terminal = run_in_terminal;
   child_ptr->stdout_buffer_ptr = child_ptr->stdout_buffer;
   child_ptr->stderr_buffer_ptr = child_ptr->stderr_buffer;
   child_ptr->stdout_last_line_repeat_count = 0;
   child_ptr->stderr_last_line_repeat_count = 0;
+  child_ptr->stdout = -1;
+  child_ptr->stderr = -1;
+  child_ptr->output.data = NULL;
+  child_ptr->output.head = 0;
+  child_ptr->output.used = 0;
+  child_ptr->log_tokens = LOADER_LOG_LINES_BURST;
+  child_ptr->log_tokens_timestamp = ladish_get_current_microseconds();
+  child_ptr->log_suppressed_count = 0;
 
   if (!run_in_terminal)
   {
@@ -596,6 +863,7 @@ loader_execute(
                    strerror(errno));
         close(stderr_pipe[0]);
         close(stderr_pipe[1]);
+        child_ptr->stderr = -1;
       }
     }
   }
@@ -632,6 +900,9 @@ loader_execute(
       close(fd);
     }
 
+    /* signals that ladishd receives through signalfd are blocked */
+    ladish_reactor_reset_child_signals();
+
     if (!run_in_terminal)
     {
       /* In child, close unused reading end of pipe */
@@ -658,12 +929,19 @@ loader_execute(
                  "- pty: %s", strerror(errno));
       close(stderr_pipe[0]);
       close(child_ptr->stdout);
+      child_ptr->stdout = -1;
+      child_ptr->stderr = -1;
     }
+
+    loader_watch_child_output(child_ptr);
   }
 
   log_info("Forked to run program %s:%s pid = %llu", vgraph_name, app_name, (unsigned long long)pid);
 
   *pid_ptr = child_ptr->pid = pid;
+  loader_dead_output_forget(pid); /* pid was reused */
+  hlist_add_head(&child_ptr->pid_siblings, loader_child_bucket(pid));
+  g_childs_count++;
 
   return true;
 
@@ -682,15 +960,64 @@ fail:
 
 unsigned int loader_get_app_count(void)
 {
+  return g_childs_count;
+}
+
+bool
+loader_get_output(
+  pid_t pid,
+  size_t max_size,
+  const char ** part1_ptr,
+  size_t * part1_size_ptr,
+  const char ** part2_ptr,
+  size_t * part2_size_ptr)
+{
+  struct loader_child * child_ptr;
   struct list_head * node_ptr;
-  unsigned int count;
+  struct loader_dead_output * dead_ptr;
+  struct loader_output_ring * ring_ptr;
+  size_t size;
+  size_t start;
+
+  ring_ptr = NULL;
+
+  child_ptr = loader_child_find(pid);
+  if (child_ptr != NULL)
+  {
+    ring_ptr = &child_ptr->output;
+  }
+  else
+  {
+    list_for_each(node_ptr, &g_dead_outputs)
+    {
+      dead_ptr = list_entry(node_ptr, struct loader_dead_output, siblings);
+      if (dead_ptr->pid == pid)
+      {
+        ring_ptr = &dead_ptr->ring;
+        break;
+      }
+    }
 
-  count = 0;
+    if (ring_ptr == NULL)
+    {
+      return false;
+    }
+  }
 
-  list_for_each(node_ptr, &g_childs_list)
+  size = ring_ptr->used < max_size ? ring_ptr->used : max_size;
+  if (size == 0)
   {
-    count++;
+    *part1_ptr = *part2_ptr = NULL;
+    *part1_size_ptr = *part2_size_ptr = 0;
+    return true;
   }
 
-  return count;
+  start = (ring_ptr->head + LOADER_OUTPUT_RING_SIZE - size) % LOADER_OUTPUT_RING_SIZE;
+
+  *part1_ptr = ring_ptr->data + start;
+  *part1_size_ptr = LOADER_OUTPUT_RING_SIZE - start < size ? LOADER_OUTPUT_RING_SIZE - start : size;
+  *part2_ptr = ring_ptr->data;
+  *part2_size_ptr = size - *part1_size_ptr;
+
+  return true;
 }
@@ -27,7 +27,7 @@
 #ifndef __LASHD_LOADER_H__
 #define __LASHD_LOADER_H__
 
-void loader_init(void (* on_child_exit)(pid_t pid, int exit_status));
+bool loader_init(void (* on_child_exit)(pid_t pid, int exit_status));
 
 bool
 loader_execute(
@@ -40,10 +40,20 @@ loader_execute(
   const char * commandline,
   pid_t * pid_ptr);
 
-void loader_run(void);
-
 void loader_uninit(void);
 
 unsigned int loader_get_app_count(void);
 
+/* Get the last max_size bytes of stdout/stderr output of a running or recently exited child.
+ * The data is in a ring buffer so it is returned in two parts, part2 follows part1.
+ * The pointers are valid until the next main loop iteration. */
+bool
+loader_get_output(
+  pid_t pid,
+  size_t max_size,
+  const char ** part1_ptr,
+  size_t * part1_size_ptr,
+  const char ** part2_ptr,
+  size_t * part2_size_ptr);
+
 #endif /* __LASHD_LOADER_H__ */
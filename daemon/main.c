@@ -48,6 +48,11 @@
 #include "conf.h"
 #include "recent_projects.h"
 #include "lash_server.h"
+#include "check_integrity.h"
+#include "reactor.h"
+#include "ancestry.h"
+#include "appdb.h"
+#include "jack_status.h"
 
 bool g_quit;
 const char * g_dbus_unique_name;
@@ -188,34 +193,31 @@ fail:
 
 static void disconnect_dbus(void)
 {
+  ladish_reactor_detach_dbus(cdbus_g_dbus_connection);
   cdbus_object_path_destroy(cdbus_g_dbus_connection, g_control_object);
   dbus_connection_unref(cdbus_g_dbus_connection);
   cdbus_call_last_error_cleanup();
 }
 
-void term_signal_handler(int signum)
+static void on_term_signal(void * UNUSED(context), int signum)
 {
   log_info("Caught signal %d (%s), terminating", signum, strsignal(signum));
   g_quit = true;
 }
 
-bool install_term_signal_handler(int signum, bool ignore_if_already_ignored)
+static bool install_term_signal_handler(int signum, bool ignore_if_already_ignored)
 {
-  sig_t sigh;
+  struct sigaction action;
 
-  sigh = signal(signum, term_signal_handler);
-  if (sigh == SIG_ERR)
+  if (ignore_if_already_ignored &&
+      sigaction(signum, NULL, &action) == 0 &&
+      action.sa_handler == SIG_IGN)
   {
-    log_error("signal() failed to install handler function for signal %d.", signum);
-    return false;
-  }
-
-  if (sigh == SIG_IGN && ignore_if_already_ignored)
-  {
-    signal(SIGTERM, SIG_IGN);
+    return true;
   }
 
-  return true;
+  /* delivered through the reactor signalfd, so the main loop wakes up immediately */
+  return ladish_reactor_add_signal(signum, NULL, on_term_signal);
 }
 
 bool init_paths(void)
@@ -281,6 +283,22 @@ static void on_conf_notify_changed(void * UNUSED(context), const char * UNUSED(k
   }
 }
 
+static void on_conf_integrity_full_sweep_changed(void * UNUSED(context), const char * UNUSED(key), const char * value)
+{
+  bool full_sweep;
+
+  if (value == NULL)
+  {
+    full_sweep = LADISH_CONF_KEY_DAEMON_INTEGRITY_FULL_SWEEP_DEFAULT;
+  }
+  else
+  {
+    full_sweep = conf_string2bool(value);
+  }
+
+  ladish_check_integrity_set_full_sweep(full_sweep);
+}
+
 int main(int argc, char ** argv, char ** envp)
 {
   struct stat st;
@@ -306,7 +324,15 @@ int main(int argc, char ** argv, char ** envp)
     goto exit;
   }
 
-  loader_init(ladish_studio_on_child_exit);
+  if (!ladish_reactor_init())
+  {
+    goto uninit_paths;
+  }
+
+  if (!loader_init(ladish_studio_on_child_exit))
+  {
+    goto uninit_reactor;
+  }
 
   if (!room_templates_init())
   {
@@ -319,6 +345,11 @@ int main(int argc, char ** argv, char ** envp)
     goto uninit_room_templates;
   }
 
+  if (!ladish_reactor_attach_dbus(cdbus_g_dbus_connection))
+  {
+    goto uninit_dbus;
+  }
+
   /* install the signal handlers */
   install_term_signal_handler(SIGTERM, false);
   install_term_signal_handler(SIGINT, true);
@@ -361,6 +392,16 @@ int main(int argc, char ** argv, char ** envp)
     goto uninit_conf;
   }
 
+  if (!conf_register(LADISH_CONF_KEY_DAEMON_INTEGRITY_FULL_SWEEP, on_conf_integrity_full_sweep_changed, NULL))
+  {
+    goto uninit_conf;
+  }
+
+  if (!conf_register(LADISH_CONF_KEY_DAEMON_AUTORUN_WINDOW, NULL, NULL))
+  {
+    goto uninit_conf;
+  }
+
   if (!ladish_recent_projects_init())
   {
     goto uninit_conf;
@@ -381,19 +422,32 @@ int main(int argc, char ** argv, char ** envp)
     goto uninit_jmcore;
   }
 
-  if (!lash_server_init())
+  if (!ladish_appdb_init())
   {
     goto uninit_studio;
   }
 
+  if (!ladish_jack_status_init())
+  {
+    goto uninit_appdb;
+  }
+
+  if (!lash_server_init())
+  {
+    goto uninit_jack_status;
+  }
+
   ladish_notify_simple(LADISH_NOTIFY_URGENCY_LOW, "LADI Session Handler daemon activated", NULL);
 
   while (!g_quit)
   {
-    dbus_connection_read_write_dispatch(cdbus_g_dbus_connection, 50);
-    loader_run();
+    /* blocks until there is something to do */
+    ladish_reactor_iterate();
+
+    cdbus_batch_begin();
     ladish_studio_run();
     ladish_check_integrity();
+    cdbus_batch_end();
   }
 
   emit_clean_exit();
@@ -405,8 +459,15 @@ int main(int argc, char ** argv, char ** envp)
 
   lash_server_uninit();
 
+uninit_jack_status:
+  ladish_jack_status_uninit();
+
+uninit_appdb:
+  ladish_appdb_uninit();
+
 uninit_studio:
   ladish_studio_uninit();
+  ladish_ancestry_uninit();
 
 uninit_jmcore:
   jmcore_proxy_uninit();
@@ -424,6 +485,7 @@ uninit_conf:
   }
 
   conf_proxy_uninit();
+  ladish_check_integrity_uninit();
 
 uninit_dbus:
   disconnect_dbus();
@@ -434,6 +496,10 @@ uninit_room_templates:
 uninit_loader:
   loader_uninit();
 
+uninit_reactor:
+  ladish_reactor_uninit();
+
+uninit_paths:
   uninit_paths();
 
 exit:
@@ -41,6 +41,7 @@ struct ladish_port
   void * vgraph;                /* virtual graph */
 
   ladish_dict_handle dict;
+  struct list_head hooks;                  /* struct ladish_port_hook list */
 };
 
 bool
@@ -83,11 +84,25 @@ ladish_port_create(
 
   port_ptr->vgraph = NULL;
 
+  INIT_LIST_HEAD(&port_ptr->hooks);
+
   log_info("port %p created", port_ptr);
   *port_handle_ptr = (ladish_port_handle)port_ptr;
   return true;
 }
 
+static void ladish_port_call_hooks(struct ladish_port * port_ptr)
+{
+  struct list_head * node_ptr;
+  struct ladish_port_hook * hook_ptr;
+
+  list_for_each(node_ptr, &port_ptr->hooks)
+  {
+    hook_ptr = list_entry(node_ptr, struct ladish_port_hook, siblings);
+    hook_ptr->jack_id_changed(hook_ptr);
+  }
+}
+
 #define port_ptr ((struct ladish_port * )port_handle)
 
 bool ladish_port_create_copy(ladish_port_handle port_handle, ladish_port_handle * port_handle_ptr)
@@ -99,6 +114,7 @@ void ladish_port_destroy(ladish_port_handle port_handle)
 {
   log_info("port %p destroy", port_ptr);
   ASSERT(port_ptr->refcount == 0);
+  ASSERT(list_empty(&port_ptr->hooks));
   ladish_dict_destroy(port_ptr->dict);
   free(port_ptr);
 }
@@ -117,6 +133,7 @@ void ladish_port_set_jack_id(ladish_port_handle port_handle, uint64_t jack_id)
 {
   log_info("port %p jack id set to %"PRIu64, port_handle, jack_id);
   port_ptr->jack_id = jack_id;
+  ladish_port_call_hooks(port_ptr);
 }
 
 uint64_t ladish_port_get_jack_id(ladish_port_handle port_handle)
@@ -129,6 +146,7 @@ void ladish_port_set_jack_id_room(ladish_port_handle port_handle, uint64_t jack_
   log_info("port %p jack id (room) set to %"PRIu64, port_handle, jack_id);
   ASSERT(port_ptr->link);
   port_ptr->jack_id_room = jack_id;
+  ladish_port_call_hooks(port_ptr);
 }
 
 uint64_t ladish_port_get_jack_id_room(ladish_port_handle port_handle)
@@ -143,6 +161,16 @@ uint64_t ladish_port_get_jack_id_room(ladish_port_handle port_handle)
   }
 }
 
+void ladish_port_add_hook(ladish_port_handle port_handle, struct ladish_port_hook * hook_ptr)
+{
+  list_add_tail(&hook_ptr->siblings, &port_ptr->hooks);
+}
+
+void ladish_port_del_hook(struct ladish_port_hook * hook_ptr)
+{
+  list_del(&hook_ptr->siblings);
+}
+
 void ladish_port_add_ref(ladish_port_handle port_handle)
 {
   port_ptr->refcount++;
@@ -31,6 +31,13 @@
 
 typedef struct ladish_port_tag { int unused; } * ladish_port_handle;
 
+/* Hooks let containers that index ports by JACK id (graphs) rehash them when the id changes */
+struct ladish_port_hook
+{
+  struct list_head siblings;
+  void (* jack_id_changed)(struct ladish_port_hook * hook_ptr);
+};
+
 bool ladish_port_create(const uuid_t uuid_ptr, bool link, ladish_port_handle * port_handle_ptr);
 bool ladish_port_create_copy(ladish_port_handle port_handle, ladish_port_handle * port_handle_ptr);
 void ladish_port_destroy(ladish_port_handle port_handle);
@@ -42,6 +49,9 @@ uint64_t ladish_port_get_jack_id(ladish_port_handle port_handle);
 void ladish_port_set_jack_id_room(ladish_port_handle port_handle, uint64_t jack_id);
 uint64_t ladish_port_get_jack_id_room(ladish_port_handle port_handle);
 
+void ladish_port_add_hook(ladish_port_handle port_handle, struct ladish_port_hook * hook_ptr);
+void ladish_port_del_hook(struct ladish_port_hook * hook_ptr);
+
 void ladish_port_add_ref(ladish_port_handle port_handle);
 void ladish_port_del_ref(ladish_port_handle port_handle);
 
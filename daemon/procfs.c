@@ -36,201 +36,160 @@
 
 #include "procfs.h"
 
-#define BUFFER_SIZE 4096
+/* enough for stat and status files */
+#define PROCFS_SMALL_FILE_SIZE 4096
 
-static char g_buffer[BUFFER_SIZE];
+/* "<pid>/<filename>" relative to /proc */
+#define PROCFS_PATH_MAX 64
 
-static
-bool
-procfs_get_process_file(
-  unsigned long long pid,
-  const char * filename,
-  char ** buffer_ptr_ptr,
-  size_t * size_ptr)
+/* opened on first use, never closed; -1 means not opened yet */
+static int g_proc_dirfd = -1;
+
+static int procfs_get_dirfd(void)
 {
   int fd;
-  ssize_t ret;
-  size_t max;
-  char * buffer_ptr;
-  char * read_ptr;
-  size_t buffer_size;
-  size_t used_size;
-
-  sprintf(g_buffer, "/proc/%llu/%s", pid, filename);
+  int old;
 
-  fd = open(g_buffer, O_RDONLY);
-  if (fd == -1)
+  fd = __atomic_load_n(&g_proc_dirfd, __ATOMIC_ACQUIRE);
+  if (fd != -1)
   {
-    return false;
+    return fd;
   }
 
-  buffer_size = BUFFER_SIZE;
-  buffer_ptr = malloc(buffer_size);
-  if (buffer_ptr == NULL)
+  fd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd == -1)
   {
-    log_error("malloc failed to allocate buffer with size %zu", buffer_size);
-    close(fd);
-    return false;
+    log_error("open(\"/proc\") failed. %d (%s)", errno, strerror(errno));
+    return -1;
   }
 
-  used_size = 0;
-  read_ptr = buffer_ptr;
-loop:
-  max = buffer_size - used_size;
-  if (max < BUFFER_SIZE / 4)
+  /* another thread may have opened it meanwhile */
+  old = -1;
+  if (!__atomic_compare_exchange_n(&g_proc_dirfd, &old, fd, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
   {
-    buffer_size = used_size + BUFFER_SIZE;
-    read_ptr = realloc(buffer_ptr, buffer_size);
-    if (read_ptr == NULL)
-    {
-      log_error("realloc failed to allocate buffer with size %zu", buffer_size);
-      free(buffer_ptr);
-      close(fd);
-      return false;
-    }
-
-    buffer_ptr = read_ptr;
-    read_ptr = buffer_ptr + used_size;
-    max = BUFFER_SIZE;
+    close(fd);
+    fd = old;
   }
 
-  ret = read(fd, read_ptr, max);
-  if (ret > 0)
-  {
-    ASSERT((size_t)ret <= max);
-    read_ptr += ret;
-    used_size += ret;
-    ASSERT(used_size <= buffer_size);
-    goto loop;
-  }
+  return fd;
+}
 
-  close(fd);
+static
+int
+procfs_open_process_file(
+  unsigned long long pid,
+  const char * filename,
+  char path[PROCFS_PATH_MAX])
+{
+  int dirfd;
 
-  if (ret < 0)
+  dirfd = procfs_get_dirfd();
+  if (dirfd == -1)
   {
-    ASSERT(ret == -1);
-    free(buffer_ptr);
-    return false;
+    return -1;
   }
 
-  if (used_size == buffer_size)
-  {
-    read_ptr = realloc(buffer_ptr, buffer_size + 1);
-    if (read_ptr == NULL)
-    {
-      log_error("realloc failed to allocate buffer with size %zu", buffer_size + 1);
-      free(buffer_ptr);
-      return false;
-    }
+  snprintf(path, PROCFS_PATH_MAX, "%llu/%s", pid, filename);
 
-    buffer_ptr = read_ptr;
-  }
-
-  buffer_ptr[used_size] = 0;
-
-  *buffer_ptr_ptr = buffer_ptr;
-  *size_ptr = used_size;
-
-  return true;
+  return openat(dirfd, path, O_RDONLY | O_CLOEXEC);
 }
 
+/* Read whole file in the caller supplied buffer and nul terminate it.
+ * Fails if the file (and the terminating nul) does not fit. */
 static
-char *
-procfs_get_process_link(
+bool
+procfs_read_process_file(
   unsigned long long pid,
-  const char * filename)
+  const char * filename,
+  char * buffer,
+  size_t buffer_size,
+  size_t * size_ptr)
 {
+  char path[PROCFS_PATH_MAX];
   int fd;
   ssize_t ret;
-  char * buffer_ptr;
+  size_t used_size;
 
-  sprintf(g_buffer, "/proc/%llu/%s", pid, filename);
+  ASSERT(buffer_size > 0);
 
-  fd = open(g_buffer, O_RDONLY);
+  fd = procfs_open_process_file(pid, filename, path);
   if (fd == -1)
   {
-    return NULL;
+    return false;
   }
 
-  ret = readlink(g_buffer, g_buffer, sizeof(g_buffer));
-  if (ret != 0)
+  used_size = 0;
+  while (used_size < buffer_size)
   {
-    g_buffer[ret] = 0;
-    buffer_ptr = strdup(g_buffer);
-    log_debug("process %llu %s symlink points to \"%s\"", pid, filename, buffer_ptr);
+    ret = pread(fd, buffer + used_size, buffer_size - used_size, used_size);
+    if (ret == 0)
+    {
+      break;
+    }
+
+    if (ret < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+
+      log_error("pread(/proc/%s) failed: %d (%s)", path, errno, strerror(errno));
+      close(fd);
+      return false;
+    }
+
+    used_size += ret;
   }
-  else
+
+  close(fd);
+
+  if (used_size == buffer_size)
   {
-    ASSERT(ret == -1);
-    buffer_ptr = NULL;
+    log_error("/proc/%s does not fit in %zu bytes", path, buffer_size);
+    return false;
   }
 
-  close(fd);
+  buffer[used_size] = 0;
+
+  if (size_ptr != NULL)
+  {
+    *size_ptr = used_size;
+  }
 
-  return buffer_ptr;
+  return true;
 }
 
 bool
 procfs_get_process_cmdline(
   unsigned long long pid,
-  int * argc_ptr,
-  char *** argv_ptr)
+  char * buffer,
+  size_t buffer_size,
+  char ** argv,
+  int max_argc,
+  int * argc_ptr)
 {
-  char * cmdline_ptr;
-  char * temp_ptr;
   size_t cmdline_size;
-  int i;
+  char * temp_ptr;
   int argc;
-  char ** argv;
 
-  if (!procfs_get_process_file(pid, "cmdline", &cmdline_ptr, &cmdline_size))
+  if (!procfs_read_process_file(pid, "cmdline", buffer, buffer_size, &cmdline_size))
   {
     return false;
   }
 
   argc = 0;
-  temp_ptr = cmdline_ptr;
+  temp_ptr = buffer;
 
-  while ((size_t)(temp_ptr - cmdline_ptr) < cmdline_size)
+  while ((size_t)(temp_ptr - buffer) < cmdline_size)
   {
-    if (*temp_ptr == 0)
+    if (argc == max_argc)
     {
-      argc++;
-    }
-
-    temp_ptr++;
-  }
-
-  ASSERT(*(temp_ptr - 1) == 0); /* the last nul char */
-
-  argv = malloc((argc + 1) * sizeof(char *));
-  if (argv == NULL)
-  {
-    free(cmdline_ptr);
-    return false;
-  }
-
-  temp_ptr = cmdline_ptr;
-
-  for (i = 0; i < argc; i++)
-  {
-    ASSERT((size_t)(temp_ptr - cmdline_ptr) < cmdline_size);
-
-    argv[i] = strdup(temp_ptr);
-    if (argv[i] == NULL)
-    {
-      /* rollback */
-      while (i > 0)
-      {
-        i--;
-        free(argv[i]);
-      }
-
-      free(argv);
-      free(cmdline_ptr);
+      log_error("process %llu has more than %d arguments", pid, max_argc);
       return false;
     }
 
+    argv[argc++] = temp_ptr;
     temp_ptr += strlen(temp_ptr) + 1;
   }
 
@@ -238,81 +197,129 @@ procfs_get_process_cmdline(
   argv[argc] = NULL;
 
   *argc_ptr = argc;
-  *argv_ptr = argv;
-
-  free(cmdline_ptr);
 
   return true;
 }
 
-char *
+bool
 procfs_get_process_cwd(
-  unsigned long long pid)
+  unsigned long long pid,
+  char * buffer,
+  size_t buffer_size)
 {
-  return procfs_get_process_link(pid, "cwd");
+  char path[PROCFS_PATH_MAX];
+  int dirfd;
+  ssize_t ret;
+
+  dirfd = procfs_get_dirfd();
+  if (dirfd == -1)
+  {
+    return false;
+  }
+
+  snprintf(path, sizeof(path), "%llu/cwd", pid);
+
+  ret = readlinkat(dirfd, path, buffer, buffer_size);
+  if (ret < 0 || (size_t)ret == buffer_size)
+  {
+    return false;
+  }
+
+  buffer[ret] = 0;
+  log_debug("process %llu cwd symlink points to \"%s\"", pid, buffer);
+
+  return true;
 }
 
 unsigned long long
 procfs_get_process_parent(
   unsigned long long pid)
 {
-  char * buffer_ptr;
-  size_t buffer_size;
+  char buffer[PROCFS_SMALL_FILE_SIZE];
   char * begin;
   char * end;
   unsigned long long ppid;
 
-  if (!procfs_get_process_file(pid, "status", &buffer_ptr, &buffer_size))
+  if (!procfs_read_process_file(pid, "status", buffer, sizeof(buffer), NULL))
   {
     return 0;
   }
 
-  begin = strstr(buffer_ptr, "\nPPid:\t");
+  begin = strstr(buffer, "\nPPid:\t");
   if (begin == NULL)
   {
     log_error("parent pid not parsed for %llu", pid);
     log_error("-----------------------------");
-    log_error("%s", buffer_ptr);
+    log_error("%s", buffer);
     log_error("-----------------------------");
-    free(buffer_ptr);
     return 0;
   }
 
   begin += 7;
 
-  end = strchr(begin, '\n');
-  if (end == NULL)
+  errno = 0;
+  ppid = strtoull(begin, &end, 10);
+  if (errno != 0 || end == begin || *end != '\n')
   {
-    log_error("parent pid not parsed for %llu (end)", pid);
-    log_error("-----------------------------");
-    log_error("%s", buffer_ptr);
-    log_error("-----------------------------");
-    free(buffer_ptr);
+    log_error("parent pid not parsed for %llu (value)", pid);
     return 0;
   }
 
-  *end = 0;
-  //log_info("parent pid is %s", begin);
-
-  errno = 0;
-  ppid = strtoull(begin, &end, 10);
-  if (errno != 0)
+  /* avoid infinite cycles (should not happen because init has pid 1 and parent 0) */
+  if (ppid == pid)
   {
-    log_error("strtoull failed to convert '%s' to integer", begin);
     ppid = 0;
   }
-  else
+
+  return ppid;
+}
+
+bool
+procfs_get_process_stat(
+  unsigned long long pid,
+  unsigned long long * ppid_ptr,
+  unsigned long long * starttime_ptr)
+{
+  char buffer[PROCFS_SMALL_FILE_SIZE];
+  char * ptr;
+  unsigned int field;
+  unsigned long long ppid;
+
+  if (!procfs_read_process_file(pid, "stat", buffer, sizeof(buffer), NULL))
   {
-    //log_info("parent pid is %llu", ppid);
+    return false;
   }
 
-  /* avoid infinite cycles (should not happen because init has pid 1 and parent 0) */
-  if (ppid == pid)
+  ppid = 0;
+
+  /* the command name can contain spaces and parentheses, fields after it are separated by single space */
+  ptr = strrchr(buffer, ')');
+  if (ptr == NULL)
   {
-    ppid = 0;
+    log_error("stat of process %llu not parsed", pid);
+    return false;
   }
 
-  free(buffer_ptr);
+  /* ptr points to the space before field 3 (state) */
+  for (field = 2; field < 22; field++)
+  {
+    ptr = strchr(ptr + 1, ' ');
+    if (ptr == NULL)
+    {
+      log_error("stat of process %llu not parsed (field %u)", pid, field + 1);
+      return false;
+    }
 
-  return ppid;
+    if (field + 1 == 4)
+    {
+      ppid = strtoull(ptr + 1, NULL, 10);
+    }
+  }
+
+  *starttime_ptr = strtoull(ptr + 1, NULL, 10);
+
+  /* avoid infinite cycles (should not happen because init has pid 1 and parent 0) */
+  *ppid_ptr = ppid != pid ? ppid : 0;
+
+  return true;
 }
@@ -29,18 +29,35 @@
 
 #include "../common.h"
 
+/* The functions below do not allocate memory and are safe to call from any thread.
+ * /proc files are read through a cached /proc directory fd. */
+
+/* Read the command line in buffer. argv entries point into buffer,
+ * argv must have room for max_argc + 1 entries and is NULL terminated. */
 bool
 procfs_get_process_cmdline(
   unsigned long long pid,
-  int * argc_ptr,
-  char *** argv_ptr);
+  char * buffer,
+  size_t buffer_size,
+  char ** argv,
+  int max_argc,
+  int * argc_ptr);
 
-char *
+bool
 procfs_get_process_cwd(
-  unsigned long long pid);
+  unsigned long long pid,
+  char * buffer,
+  size_t buffer_size);
 
 unsigned long long
 procfs_get_process_parent(
   unsigned long long pid);
 
+/* starttime is in clock ticks since boot, together with pid it identifies the process */
+bool
+procfs_get_process_stat(
+  unsigned long long pid,
+  unsigned long long * ppid_ptr,
+  unsigned long long * starttime_ptr);
+
 #endif /* #ifndef PROCFS_H__604D0D94_1609_4BB4_BFA7_5DC47830011A__INCLUDED */
@@ -0,0 +1,866 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2026 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the main loop event reactor
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "reactor.h"
+
+#include <unistd.h>
+#include <limits.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/signalfd.h>
+
+#define LADISH_REACTOR_MAX_EVENTS 32
+
+struct ladish_reactor_source
+{
+  struct list_head siblings;
+  int fd;
+  void * context;
+  void (* callback)(void * context, int fd, uint32_t events); /* NULL when removed during dispatch */
+};
+
+struct ladish_reactor_task
+{
+  struct list_head siblings;
+  uint64_t deadline;            /* monotonic, in milliseconds, 0 for immediate tasks */
+  void * context;
+  void (* task)(void * context);
+};
+
+struct ladish_reactor_signal
+{
+  void * context;
+  void (* callback)(void * context, int signum);
+};
+
+/* libdbus can have separate read and write watches for same fd,
+ * epoll wants single registration per fd, so D-Bus fds are registered
+ * with the union of the enabled watch flags */
+struct ladish_reactor_dbus_watch
+{
+  struct list_head siblings;
+  DBusWatch * watch;
+  int fd;
+  unsigned int serial;
+};
+
+struct ladish_reactor_dbus_timeout
+{
+  struct list_head siblings;
+  DBusTimeout * timeout;
+  uint64_t deadline;            /* monotonic, in milliseconds */
+  unsigned int serial;
+};
+
+struct ladish_reactor
+{
+  int epoll_fd;
+
+  struct list_head sources;
+  struct list_head removed_sources;
+  bool dispatching;
+
+  struct list_head tasks;
+  struct list_head delayed_tasks;
+  struct list_head running_tasks;
+
+  int signal_fd;
+  sigset_t signal_mask;
+  sigset_t orig_signal_mask;
+  struct ladish_reactor_signal signals[NSIG];
+
+  DBusConnection * dbus_connection;
+  struct list_head dbus_watches;
+  struct list_head dbus_timeouts;
+  unsigned int dbus_serial;
+};
+
+static struct ladish_reactor g_reactor;
+
+static uint64_t ladish_reactor_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static struct ladish_reactor_source * ladish_reactor_find_source(int fd)
+{
+  struct list_head * node_ptr;
+  struct ladish_reactor_source * source_ptr;
+
+  list_for_each(node_ptr, &g_reactor.sources)
+  {
+    source_ptr = list_entry(node_ptr, struct ladish_reactor_source, siblings);
+    if (source_ptr->fd == fd)
+    {
+      return source_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+bool
+ladish_reactor_add_fd(
+  int fd,
+  uint32_t events,
+  void * context,
+  void (* callback)(void * context, int fd, uint32_t events))
+{
+  struct ladish_reactor_source * source_ptr;
+  struct epoll_event event;
+
+  ASSERT(ladish_reactor_find_source(fd) == NULL);
+
+  source_ptr = malloc(sizeof(struct ladish_reactor_source));
+  if (source_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate struct ladish_reactor_source");
+    return false;
+  }
+
+  source_ptr->fd = fd;
+  source_ptr->context = context;
+  source_ptr->callback = callback;
+
+  event.events = events;
+  event.data.ptr = source_ptr;
+  if (epoll_ctl(g_reactor.epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+  {
+    log_error("epoll_ctl(EPOLL_CTL_ADD) failed for fd %d. errno = %d (%s)", fd, errno, strerror(errno));
+    free(source_ptr);
+    return false;
+  }
+
+  list_add_tail(&source_ptr->siblings, &g_reactor.sources);
+  return true;
+}
+
+static bool ladish_reactor_modify_fd(int fd, uint32_t events)
+{
+  struct ladish_reactor_source * source_ptr;
+  struct epoll_event event;
+
+  source_ptr = ladish_reactor_find_source(fd);
+  ASSERT(source_ptr != NULL);
+
+  event.events = events;
+  event.data.ptr = source_ptr;
+  if (epoll_ctl(g_reactor.epoll_fd, EPOLL_CTL_MOD, fd, &event) != 0)
+  {
+    log_error("epoll_ctl(EPOLL_CTL_MOD) failed for fd %d. errno = %d (%s)", fd, errno, strerror(errno));
+    return false;
+  }
+
+  return true;
+}
+
+void ladish_reactor_remove_fd(int fd)
+{
+  struct ladish_reactor_source * source_ptr;
+
+  source_ptr = ladish_reactor_find_source(fd);
+  if (source_ptr == NULL)
+  {
+    return;
+  }
+
+  if (epoll_ctl(g_reactor.epoll_fd, EPOLL_CTL_DEL, fd, NULL) != 0)
+  {
+    log_error("epoll_ctl(EPOLL_CTL_DEL) failed for fd %d. errno = %d (%s)", fd, errno, strerror(errno));
+  }
+
+  list_del(&source_ptr->siblings);
+
+  if (g_reactor.dispatching)
+  {
+    /* events for this source may still be pending in the current epoll_wait() batch */
+    source_ptr->callback = NULL;
+    list_add_tail(&source_ptr->siblings, &g_reactor.removed_sources);
+  }
+  else
+  {
+    free(source_ptr);
+  }
+}
+
+static void ladish_reactor_free_sources(struct list_head * list_ptr)
+{
+  struct ladish_reactor_source * source_ptr;
+
+  while (!list_empty(list_ptr))
+  {
+    source_ptr = list_entry(list_ptr->next, struct ladish_reactor_source, siblings);
+    list_del(&source_ptr->siblings);
+    free(source_ptr);
+  }
+}
+
+/***************************************************************************/
+/* signals */
+
+static void ladish_reactor_on_signal_fd(void * UNUSED(context), int fd, uint32_t UNUSED(events))
+{
+  struct signalfd_siginfo info;
+  ssize_t ret;
+
+  while ((ret = read(fd, &info, sizeof(info))) == sizeof(info))
+  {
+    if (info.ssi_signo >= NSIG || g_reactor.signals[info.ssi_signo].callback == NULL)
+    {
+      log_error("unexpected signal %u received through signalfd", info.ssi_signo);
+      continue;
+    }
+
+    g_reactor.signals[info.ssi_signo].callback(g_reactor.signals[info.ssi_signo].context, info.ssi_signo);
+  }
+
+  if (ret < 0 && errno != EAGAIN && errno != EINTR)
+  {
+    log_error("read() from signalfd failed. errno = %d (%s)", errno, strerror(errno));
+  }
+}
+
+bool ladish_reactor_add_signal(int signum, void * context, void (* callback)(void * context, int signum))
+{
+  sigset_t mask;
+  int fd;
+
+  ASSERT(signum > 0 && signum < NSIG);
+
+  sigemptyset(&mask);
+  sigaddset(&mask, signum);
+  if (sigprocmask(SIG_BLOCK, &mask, NULL) != 0)
+  {
+    log_error("sigprocmask() failed to block signal %d. errno = %d (%s)", signum, errno, strerror(errno));
+    return false;
+  }
+
+  sigaddset(&g_reactor.signal_mask, signum);
+
+  fd = signalfd(g_reactor.signal_fd, &g_reactor.signal_mask, SFD_NONBLOCK | SFD_CLOEXEC);
+  if (fd == -1)
+  {
+    log_error("signalfd() failed. errno = %d (%s)", errno, strerror(errno));
+    sigdelset(&g_reactor.signal_mask, signum);
+    sigprocmask(SIG_UNBLOCK, &mask, NULL);
+    return false;
+  }
+
+  if (g_reactor.signal_fd == -1)
+  {
+    if (!ladish_reactor_add_fd(fd, EPOLLIN, NULL, ladish_reactor_on_signal_fd))
+    {
+      close(fd);
+      sigdelset(&g_reactor.signal_mask, signum);
+      sigprocmask(SIG_UNBLOCK, &mask, NULL);
+      return false;
+    }
+
+    g_reactor.signal_fd = fd;
+  }
+
+  g_reactor.signals[signum].context = context;
+  g_reactor.signals[signum].callback = callback;
+
+  return true;
+}
+
+void ladish_reactor_reset_child_signals(void)
+{
+  sigprocmask(SIG_SETMASK, &g_reactor.orig_signal_mask, NULL);
+}
+
+/***************************************************************************/
+/* D-Bus watches and timeouts */
+
+static void ladish_reactor_on_dbus_fd(void * UNUSED(context), int fd, uint32_t events)
+{
+  struct list_head * node_ptr;
+  struct ladish_reactor_dbus_watch * watch_ptr;
+  unsigned int flags;
+  unsigned int serial;
+
+  serial = ++g_reactor.dbus_serial;
+
+  /* dbus_watch_handle() can add and remove watches, so restart the scan after each call */
+loop:
+  list_for_each(node_ptr, &g_reactor.dbus_watches)
+  {
+    watch_ptr = list_entry(node_ptr, struct ladish_reactor_dbus_watch, siblings);
+    if (watch_ptr->fd != fd || watch_ptr->serial == serial || !dbus_watch_get_enabled(watch_ptr->watch))
+    {
+      continue;
+    }
+
+    watch_ptr->serial = serial;
+
+    flags = dbus_watch_get_flags(watch_ptr->watch) & (DBUS_WATCH_READABLE | DBUS_WATCH_WRITABLE);
+    if ((events & EPOLLIN) == 0)
+    {
+      flags &= ~DBUS_WATCH_READABLE;
+    }
+    if ((events & EPOLLOUT) == 0)
+    {
+      flags &= ~DBUS_WATCH_WRITABLE;
+    }
+    if (events & EPOLLHUP)
+    {
+      flags |= DBUS_WATCH_HANGUP;
+    }
+    if (events & EPOLLERR)
+    {
+      flags |= DBUS_WATCH_ERROR;
+    }
+
+    if (flags != 0)
+    {
+      dbus_watch_handle(watch_ptr->watch, flags);
+      goto loop;
+    }
+  }
+}
+
+static void ladish_reactor_dbus_update_fd(int fd)
+{
+  struct list_head * node_ptr;
+  struct ladish_reactor_dbus_watch * watch_ptr;
+  uint32_t events;
+  unsigned int flags;
+
+  events = 0;
+  list_for_each(node_ptr, &g_reactor.dbus_watches)
+  {
+    watch_ptr = list_entry(node_ptr, struct ladish_reactor_dbus_watch, siblings);
+    if (watch_ptr->fd != fd || !dbus_watch_get_enabled(watch_ptr->watch))
+    {
+      continue;
+    }
+
+    flags = dbus_watch_get_flags(watch_ptr->watch);
+    if (flags & DBUS_WATCH_READABLE)
+    {
+      events |= EPOLLIN;
+    }
+    if (flags & DBUS_WATCH_WRITABLE)
+    {
+      events |= EPOLLOUT;
+    }
+  }
+
+  /* fds without enabled watches are not registered at all,
+   * otherwise a hung up fd would make epoll_wait() spin */
+  if (events == 0)
+  {
+    ladish_reactor_remove_fd(fd);
+  }
+  else if (ladish_reactor_find_source(fd) == NULL)
+  {
+    ladish_reactor_add_fd(fd, events, NULL, ladish_reactor_on_dbus_fd);
+  }
+  else
+  {
+    ladish_reactor_modify_fd(fd, events);
+  }
+}
+
+static dbus_bool_t ladish_reactor_dbus_add_watch(DBusWatch * watch, void * UNUSED(data))
+{
+  struct ladish_reactor_dbus_watch * watch_ptr;
+
+  watch_ptr = malloc(sizeof(struct ladish_reactor_dbus_watch));
+  if (watch_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate struct ladish_reactor_dbus_watch");
+    return FALSE;
+  }
+
+  watch_ptr->watch = watch;
+  watch_ptr->fd = dbus_watch_get_unix_fd(watch);
+  watch_ptr->serial = g_reactor.dbus_serial;
+  list_add_tail(&watch_ptr->siblings, &g_reactor.dbus_watches);
+  dbus_watch_set_data(watch, watch_ptr, NULL);
+
+  ladish_reactor_dbus_update_fd(watch_ptr->fd);
+  return TRUE;
+}
+
+static void ladish_reactor_dbus_remove_watch(DBusWatch * watch, void * UNUSED(data))
+{
+  struct ladish_reactor_dbus_watch * watch_ptr;
+  int fd;
+
+  watch_ptr = dbus_watch_get_data(watch);
+  if (watch_ptr == NULL)
+  {
+    return;
+  }
+
+  dbus_watch_set_data(watch, NULL, NULL);
+  fd = watch_ptr->fd;
+  list_del(&watch_ptr->siblings);
+  free(watch_ptr);
+
+  ladish_reactor_dbus_update_fd(fd);
+}
+
+static void ladish_reactor_dbus_toggle_watch(DBusWatch * watch, void * UNUSED(data))
+{
+  struct ladish_reactor_dbus_watch * watch_ptr;
+
+  watch_ptr = dbus_watch_get_data(watch);
+  if (watch_ptr != NULL)
+  {
+    ladish_reactor_dbus_update_fd(watch_ptr->fd);
+  }
+}
+
+static void ladish_reactor_dbus_rearm_timeout(struct ladish_reactor_dbus_timeout * timeout_ptr)
+{
+  timeout_ptr->deadline = ladish_reactor_now() + dbus_timeout_get_interval(timeout_ptr->timeout);
+}
+
+static dbus_bool_t ladish_reactor_dbus_add_timeout(DBusTimeout * timeout, void * UNUSED(data))
+{
+  struct ladish_reactor_dbus_timeout * timeout_ptr;
+
+  timeout_ptr = malloc(sizeof(struct ladish_reactor_dbus_timeout));
+  if (timeout_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate struct ladish_reactor_dbus_timeout");
+    return FALSE;
+  }
+
+  timeout_ptr->timeout = timeout;
+  timeout_ptr->serial = g_reactor.dbus_serial;
+  ladish_reactor_dbus_rearm_timeout(timeout_ptr);
+  list_add_tail(&timeout_ptr->siblings, &g_reactor.dbus_timeouts);
+  dbus_timeout_set_data(timeout, timeout_ptr, NULL);
+
+  return TRUE;
+}
+
+static void ladish_reactor_dbus_remove_timeout(DBusTimeout * timeout, void * UNUSED(data))
+{
+  struct ladish_reactor_dbus_timeout * timeout_ptr;
+
+  timeout_ptr = dbus_timeout_get_data(timeout);
+  if (timeout_ptr == NULL)
+  {
+    return;
+  }
+
+  dbus_timeout_set_data(timeout, NULL, NULL);
+  list_del(&timeout_ptr->siblings);
+  free(timeout_ptr);
+}
+
+static void ladish_reactor_dbus_toggle_timeout(DBusTimeout * timeout, void * UNUSED(data))
+{
+  struct ladish_reactor_dbus_timeout * timeout_ptr;
+
+  timeout_ptr = dbus_timeout_get_data(timeout);
+  if (timeout_ptr != NULL && dbus_timeout_get_enabled(timeout))
+  {
+    ladish_reactor_dbus_rearm_timeout(timeout_ptr);
+  }
+}
+
+/* returns the nearest enabled timeout deadline or UINT64_MAX */
+static uint64_t ladish_reactor_dbus_next_deadline(void)
+{
+  struct list_head * node_ptr;
+  struct ladish_reactor_dbus_timeout * timeout_ptr;
+  uint64_t deadline;
+
+  deadline = UINT64_MAX;
+  list_for_each(node_ptr, &g_reactor.dbus_timeouts)
+  {
+    timeout_ptr = list_entry(node_ptr, struct ladish_reactor_dbus_timeout, siblings);
+    if (dbus_timeout_get_enabled(timeout_ptr->timeout) && timeout_ptr->deadline < deadline)
+    {
+      deadline = timeout_ptr->deadline;
+    }
+  }
+
+  return deadline;
+}
+
+static void ladish_reactor_dbus_handle_timeouts(void)
+{
+  struct list_head * node_ptr;
+  struct ladish_reactor_dbus_timeout * timeout_ptr;
+  unsigned int serial;
+  uint64_t now;
+
+  if (list_empty(&g_reactor.dbus_timeouts))
+  {
+    return;
+  }
+
+  serial = ++g_reactor.dbus_serial;
+  now = ladish_reactor_now();
+
+  /* dbus_timeout_handle() can add and remove timeouts, so restart the scan after each call */
+loop:
+  list_for_each(node_ptr, &g_reactor.dbus_timeouts)
+  {
+    timeout_ptr = list_entry(node_ptr, struct ladish_reactor_dbus_timeout, siblings);
+    if (timeout_ptr->serial == serial ||
+        !dbus_timeout_get_enabled(timeout_ptr->timeout) ||
+        timeout_ptr->deadline > now)
+    {
+      continue;
+    }
+
+    timeout_ptr->serial = serial;
+    /* D-Bus timeouts are periodic until removed or disabled */
+    ladish_reactor_dbus_rearm_timeout(timeout_ptr);
+    dbus_timeout_handle(timeout_ptr->timeout);
+    goto loop;
+  }
+}
+
+bool ladish_reactor_attach_dbus(DBusConnection * connection)
+{
+  ASSERT(g_reactor.dbus_connection == NULL);
+
+  g_reactor.dbus_connection = connection;
+
+  if (!dbus_connection_set_watch_functions(
+        connection,
+        ladish_reactor_dbus_add_watch,
+        ladish_reactor_dbus_remove_watch,
+        ladish_reactor_dbus_toggle_watch,
+        NULL,
+        NULL))
+  {
+    log_error("dbus_connection_set_watch_functions() failed");
+    goto fail;
+  }
+
+  if (!dbus_connection_set_timeout_functions(
+        connection,
+        ladish_reactor_dbus_add_timeout,
+        ladish_reactor_dbus_remove_timeout,
+        ladish_reactor_dbus_toggle_timeout,
+        NULL,
+        NULL))
+  {
+    log_error("dbus_connection_set_timeout_functions() failed");
+    goto clear_watch_functions;
+  }
+
+  return true;
+
+clear_watch_functions:
+  dbus_connection_set_watch_functions(connection, NULL, NULL, NULL, NULL, NULL);
+fail:
+  g_reactor.dbus_connection = NULL;
+  return false;
+}
+
+void ladish_reactor_detach_dbus(DBusConnection * connection)
+{
+  if (g_reactor.dbus_connection != connection)
+  {
+    return;
+  }
+
+  /* libdbus calls the remove functions for all current watches and timeouts */
+  dbus_connection_set_timeout_functions(connection, NULL, NULL, NULL, NULL, NULL);
+  dbus_connection_set_watch_functions(connection, NULL, NULL, NULL, NULL, NULL);
+  g_reactor.dbus_connection = NULL;
+}
+
+/***************************************************************************/
+/* tasks */
+
+static
+bool
+ladish_reactor_queue_task(
+  struct list_head * list_ptr,
+  uint64_t deadline,
+  void * context,
+  void (* task)(void * context))
+{
+  struct list_head * node_ptr;
+  struct ladish_reactor_task * task_ptr;
+
+  list_for_each(node_ptr, list_ptr)
+  {
+    task_ptr = list_entry(node_ptr, struct ladish_reactor_task, siblings);
+    if (task_ptr->task == task && task_ptr->context == context)
+    {
+      if (deadline < task_ptr->deadline)
+      {
+        task_ptr->deadline = deadline;
+      }
+
+      return true;
+    }
+  }
+
+  task_ptr = malloc(sizeof(struct ladish_reactor_task));
+  if (task_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate struct ladish_reactor_task");
+    return false;
+  }
+
+  task_ptr->deadline = deadline;
+  task_ptr->context = context;
+  task_ptr->task = task;
+  list_add_tail(&task_ptr->siblings, list_ptr);
+
+  return true;
+}
+
+bool ladish_reactor_post(void * context, void (* task)(void * context))
+{
+  return ladish_reactor_queue_task(&g_reactor.tasks, 0, context, task);
+}
+
+bool ladish_reactor_post_delayed(void * context, void (* task)(void * context), unsigned int delay)
+{
+  return ladish_reactor_queue_task(&g_reactor.delayed_tasks, ladish_reactor_now() + delay, context, task);
+}
+
+static void ladish_reactor_cancel_in(struct list_head * list_ptr, void * context, void (* task)(void * context))
+{
+  struct list_head * node_ptr;
+  struct ladish_reactor_task * task_ptr;
+
+  list_for_each(node_ptr, list_ptr)
+  {
+    task_ptr = list_entry(node_ptr, struct ladish_reactor_task, siblings);
+    if (task_ptr->task == task && task_ptr->context == context)
+    {
+      list_del(&task_ptr->siblings);
+      free(task_ptr);
+      return;
+    }
+  }
+}
+
+void ladish_reactor_cancel(void * context, void (* task)(void * context))
+{
+  ladish_reactor_cancel_in(&g_reactor.tasks, context, task);
+  ladish_reactor_cancel_in(&g_reactor.delayed_tasks, context, task);
+  ladish_reactor_cancel_in(&g_reactor.running_tasks, context, task);
+}
+
+static uint64_t ladish_reactor_tasks_next_deadline(void)
+{
+  struct list_head * node_ptr;
+  struct ladish_reactor_task * task_ptr;
+  uint64_t deadline;
+
+  deadline = UINT64_MAX;
+  list_for_each(node_ptr, &g_reactor.delayed_tasks)
+  {
+    task_ptr = list_entry(node_ptr, struct ladish_reactor_task, siblings);
+    if (task_ptr->deadline < deadline)
+    {
+      deadline = task_ptr->deadline;
+    }
+  }
+
+  return deadline;
+}
+
+static void ladish_reactor_free_tasks(struct list_head * list_ptr)
+{
+  struct ladish_reactor_task * task_ptr;
+
+  while (!list_empty(list_ptr))
+  {
+    task_ptr = list_entry(list_ptr->next, struct ladish_reactor_task, siblings);
+    list_del(&task_ptr->siblings);
+    free(task_ptr);
+  }
+}
+
+static void ladish_reactor_run_tasks(void)
+{
+  struct ladish_reactor_task * task_ptr;
+  struct list_head * node_ptr;
+  struct list_head * next_ptr;
+  uint64_t now;
+
+  now = ladish_reactor_now();
+  list_for_each_safe(node_ptr, next_ptr, &g_reactor.delayed_tasks)
+  {
+    task_ptr = list_entry(node_ptr, struct ladish_reactor_task, siblings);
+    if (task_ptr->deadline <= now)
+    {
+      list_move_tail(&task_ptr->siblings, &g_reactor.tasks);
+    }
+  }
+
+  /* tasks posted by the tasks being run are run on next iteration,
+   * the ones being run can still be cancelled by them */
+  list_splice_init(&g_reactor.tasks, &g_reactor.running_tasks);
+
+  while (!list_empty(&g_reactor.running_tasks))
+  {
+    task_ptr = list_entry(g_reactor.running_tasks.next, struct ladish_reactor_task, siblings);
+    list_del(&task_ptr->siblings);
+    task_ptr->task(task_ptr->context);
+    free(task_ptr);
+  }
+}
+
+/***************************************************************************/
+
+bool ladish_reactor_init(void)
+{
+  INIT_LIST_HEAD(&g_reactor.sources);
+  INIT_LIST_HEAD(&g_reactor.removed_sources);
+  INIT_LIST_HEAD(&g_reactor.tasks);
+  INIT_LIST_HEAD(&g_reactor.delayed_tasks);
+  INIT_LIST_HEAD(&g_reactor.running_tasks);
+  INIT_LIST_HEAD(&g_reactor.dbus_watches);
+  INIT_LIST_HEAD(&g_reactor.dbus_timeouts);
+  g_reactor.dispatching = false;
+  g_reactor.dbus_connection = NULL;
+  g_reactor.dbus_serial = 0;
+  g_reactor.signal_fd = -1;
+  sigemptyset(&g_reactor.signal_mask);
+  sigprocmask(SIG_SETMASK, NULL, &g_reactor.orig_signal_mask);
+  memset(g_reactor.signals, 0, sizeof(g_reactor.signals));
+
+  g_reactor.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (g_reactor.epoll_fd == -1)
+  {
+    log_error("epoll_create1() failed. errno = %d (%s)", errno, strerror(errno));
+    return false;
+  }
+
+  return true;
+}
+
+void ladish_reactor_uninit(void)
+{
+  ladish_reactor_free_tasks(&g_reactor.tasks);
+  ladish_reactor_free_tasks(&g_reactor.delayed_tasks);
+
+  if (g_reactor.signal_fd != -1)
+  {
+    ladish_reactor_remove_fd(g_reactor.signal_fd);
+    close(g_reactor.signal_fd);
+    g_reactor.signal_fd = -1;
+    sigprocmask(SIG_SETMASK, &g_reactor.orig_signal_mask, NULL);
+  }
+
+  ladish_reactor_free_sources(&g_reactor.sources);
+  close(g_reactor.epoll_fd);
+}
+
+void ladish_reactor_iterate(void)
+{
+  struct epoll_event events[LADISH_REACTOR_MAX_EVENTS];
+  struct ladish_reactor_source * source_ptr;
+  uint64_t now;
+  uint64_t deadline;
+  int timeout;
+  int count;
+  int i;
+
+  if (!list_empty(&g_reactor.tasks) ||
+      (g_reactor.dbus_connection != NULL &&
+       dbus_connection_get_dispatch_status(g_reactor.dbus_connection) != DBUS_DISPATCH_COMPLETE))
+  {
+    timeout = 0;
+  }
+  else
+  {
+    now = ladish_reactor_now();
+    deadline = ladish_reactor_dbus_next_deadline();
+    if (ladish_reactor_tasks_next_deadline() < deadline)
+    {
+      deadline = ladish_reactor_tasks_next_deadline();
+    }
+
+    if (deadline == UINT64_MAX)
+    {
+      timeout = -1;             /* nothing to do until an fd becomes ready */
+    }
+    else if (deadline <= now)
+    {
+      timeout = 0;
+    }
+    else if (deadline - now > INT_MAX)
+    {
+      timeout = INT_MAX;
+    }
+    else
+    {
+      timeout = (int)(deadline - now);
+    }
+  }
+
+  count = epoll_wait(g_reactor.epoll_fd, events, LADISH_REACTOR_MAX_EVENTS, timeout);
+  if (count == -1)
+  {
+    if (errno != EINTR)
+    {
+      log_error("epoll_wait() failed. errno = %d (%s)", errno, strerror(errno));
+    }
+
+    count = 0;
+  }
+
+  /* signals and method returns of this iteration are flushed at once */
+  cdbus_batch_begin();
+
+  g_reactor.dispatching = true;
+
+  for (i = 0; i < count; i++)
+  {
+    source_ptr = events[i].data.ptr;
+    if (source_ptr->callback != NULL) /* not removed by a previous callback */
+    {
+      source_ptr->callback(source_ptr->context, source_ptr->fd, events[i].events);
+    }
+  }
+
+  g_reactor.dispatching = false;
+  ladish_reactor_free_sources(&g_reactor.removed_sources);
+
+  ladish_reactor_dbus_handle_timeouts();
+
+  if (g_reactor.dbus_connection != NULL)
+  {
+    while (dbus_connection_dispatch(g_reactor.dbus_connection) == DBUS_DISPATCH_DATA_REMAINS);
+  }
+
+  ladish_reactor_run_tasks();
+
+  cdbus_batch_end();
+}
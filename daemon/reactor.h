@@ -0,0 +1,70 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2026 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains interface to the main loop event reactor
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef REACTOR_H__6B2E0F4A_93C1_4D7E_A5F8_1C9D3B60E27A__INCLUDED
+#define REACTOR_H__6B2E0F4A_93C1_4D7E_A5F8_1C9D3B60E27A__INCLUDED
+
+#include "common.h"
+
+#include <sys/epoll.h>
+
+bool ladish_reactor_init(void);
+void ladish_reactor_uninit(void);
+
+/* Wait until there is work (fd readiness, signal, D-Bus timeout or due task) and process it */
+void ladish_reactor_iterate(void);
+
+/* events is a mask of EPOLLIN/EPOLLOUT, EPOLLHUP and EPOLLERR are always reported */
+bool
+ladish_reactor_add_fd(
+  int fd,
+  uint32_t events,
+  void * context,
+  void (* callback)(void * context, int fd, uint32_t events));
+
+/* Safe to call from a fd callback, also for fds that are not registered */
+void ladish_reactor_remove_fd(int fd);
+
+/* The signal is blocked and delivered through signalfd, callback is called in normal (not signal) context */
+bool ladish_reactor_add_signal(int signum, void * context, void (* callback)(void * context, int signum));
+
+/* Restore the signal mask, to be called in forked children before exec() */
+void ladish_reactor_reset_child_signals(void);
+
+bool ladish_reactor_attach_dbus(DBusConnection * connection);
+void ladish_reactor_detach_dbus(DBusConnection * connection);
+
+/* Schedule task to be run on next iteration without blocking.
+ * Posting a task that is already pending (same callback and context) is a no-op. */
+bool ladish_reactor_post(void * context, void (* task)(void * context));
+
+/* Schedule task to be run after delay milliseconds */
+bool ladish_reactor_post_delayed(void * context, void (* task)(void * context), unsigned int delay);
+
+/* Remove pending (immediate or delayed) task, to be called before the context is freed */
+void ladish_reactor_cancel(void * context, void (* task)(void * context));
+
+#endif /* #ifndef REACTOR_H__6B2E0F4A_93C1_4D7E_A5F8_1C9D3B60E27A__INCLUDED */
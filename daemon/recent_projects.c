@@ -33,7 +33,124 @@
 #define RECENT_PROJECTS_STORE_FILE "recent_projects"
 #define RECENT_PROJECTS_STORE_MAX_ITEMS 50
 
+/* entries for projects that dropped out of the recent list are evicted eventually */
+#define RECENT_PROJECTS_CACHE_MAX_ITEMS (2 * RECENT_PROJECTS_STORE_MAX_ITEMS)
+
+/* project header cache, an entry is valid while the project file is not replaced or modified */
+struct recent_project_info
+{
+  struct list_head siblings;    /* most recently used first */
+  char * path;
+  dev_t dev;
+  ino_t ino;
+  off_t size;
+  struct timespec mtime;
+  char * name;
+  char * description;
+  char * notes;
+};
+
 static ladish_recent_store_handle g_recent_projects_store;
+static LIST_HEAD(g_recent_project_infos);
+static unsigned int g_recent_project_infos_count;
+
+static void recent_project_info_free(struct recent_project_info * info_ptr)
+{
+  free(info_ptr->path);
+  free(info_ptr->name);
+  free(info_ptr->description);
+  free(info_ptr->notes);
+  free(info_ptr);
+}
+
+static void recent_project_info_evict_oldest(void)
+{
+  struct recent_project_info * info_ptr;
+
+  ASSERT(!list_empty(&g_recent_project_infos));
+  info_ptr = list_entry(g_recent_project_infos.prev, struct recent_project_info, siblings);
+  list_del(&info_ptr->siblings);
+  g_recent_project_infos_count--;
+  recent_project_info_free(info_ptr);
+}
+
+static bool recent_project_info_is_valid(struct recent_project_info * info_ptr, const struct stat * st_ptr)
+{
+  return
+    info_ptr->dev == st_ptr->st_dev &&
+    info_ptr->ino == st_ptr->st_ino &&
+    info_ptr->size == st_ptr->st_size &&
+    info_ptr->mtime.tv_sec == st_ptr->st_mtim.tv_sec &&
+    info_ptr->mtime.tv_nsec == st_ptr->st_mtim.tv_nsec;
+}
+
+/* returns NULL if project file does not exist or cannot be parsed */
+static struct recent_project_info * recent_project_info_get(const char * project_path)
+{
+  struct stat st;
+  struct list_head * node_ptr;
+  struct recent_project_info * info_ptr;
+
+  if (!ladish_stat_project(project_path, &st))
+  {
+    return NULL;
+  }
+
+  list_for_each(node_ptr, &g_recent_project_infos)
+  {
+    info_ptr = list_entry(node_ptr, struct recent_project_info, siblings);
+    if (strcmp(info_ptr->path, project_path) == 0)
+    {
+      if (recent_project_info_is_valid(info_ptr, &st))
+      {
+        list_move(&info_ptr->siblings, &g_recent_project_infos);
+        return info_ptr;
+      }
+
+      /* stale */
+      list_del(&info_ptr->siblings);
+      g_recent_project_infos_count--;
+      recent_project_info_free(info_ptr);
+      break;
+    }
+  }
+
+  info_ptr = calloc(1, sizeof(struct recent_project_info));
+  if (info_ptr == NULL)
+  {
+    log_error("calloc() failed for struct recent_project_info");
+    return NULL;
+  }
+
+  info_ptr->path = strdup(project_path);
+  if (info_ptr->path == NULL)
+  {
+    log_error("strdup() failed for recent project path");
+    free(info_ptr);
+    return NULL;
+  }
+
+  if (!ladish_read_project_header(project_path, &info_ptr->name, &info_ptr->description, &info_ptr->notes))
+  {
+    recent_project_info_free(info_ptr);
+    return NULL;
+  }
+
+  info_ptr->dev = st.st_dev;
+  info_ptr->ino = st.st_ino;
+  info_ptr->size = st.st_size;
+  info_ptr->mtime = st.st_mtim;
+
+  if (g_recent_project_infos_count >= RECENT_PROJECTS_CACHE_MAX_ITEMS)
+  {
+    recent_project_info_evict_oldest();
+  }
+
+  list_add(&info_ptr->siblings, &g_recent_project_infos);
+  g_recent_project_infos_count++;
+
+  return info_ptr;
+}
 
 bool ladish_recent_projects_init(void)
 {
@@ -60,7 +177,18 @@ bool ladish_recent_projects_init(void)
 
 void ladish_recent_projects_uninit(void)
 {
+  struct recent_project_info * info_ptr;
+
   ladish_recent_store_destroy(g_recent_projects_store);
+
+  while (!list_empty(&g_recent_project_infos))
+  {
+    info_ptr = list_entry(g_recent_project_infos.next, struct recent_project_info, siblings);
+    list_del(&info_ptr->siblings);
+    recent_project_info_free(info_ptr);
+  }
+
+  g_recent_project_infos_count = 0;
 }
 
 void ladish_recent_project_use(const char * project_path)
@@ -85,11 +213,11 @@ bool recent_projects_callback(void * callback_context, const char * project_path
 {
   DBusMessageIter struct_iter;
   DBusMessageIter dict_iter;
-  char * name;
+  struct recent_project_info * info_ptr;
 
   ASSERT(ctx_ptr->max_items > 0);
 
-  name = ladish_get_project_name(project_path);
+  info_ptr = recent_project_info_get(project_path);
 
   if (!dbus_message_iter_open_container(&ctx_ptr->array_iter, DBUS_TYPE_STRUCT, NULL, &struct_iter))
   {
@@ -109,10 +237,15 @@ bool recent_projects_callback(void * callback_context, const char * project_path
     goto close_struct;
   }
 
-  if (!cdbus_maybe_add_dict_entry_string(&dict_iter, "name", name))
+  if (info_ptr != NULL)
   {
-    ctx_ptr->error = true;
-    goto close_dict;
+    if (!cdbus_maybe_add_dict_entry_string(&dict_iter, "name", info_ptr->name) ||
+        !cdbus_maybe_add_dict_entry_string(&dict_iter, "description", info_ptr->description) ||
+        !cdbus_maybe_add_dict_entry_string(&dict_iter, "notes", info_ptr->notes))
+    {
+      ctx_ptr->error = true;
+      goto close_dict;
+    }
   }
 
 close_dict:
@@ -128,8 +261,6 @@ close_struct:
   }
 
 exit:
-  free(name);                   /* safe if name is NULL */
-
   if (ctx_ptr->error)
   {
     return false;               /* stop the iteration if error occurs */
@@ -46,30 +46,33 @@ ladish_recent_store_save(
 {
   unsigned int i;
   int fd;
+  bool success;
 
-  fd = open(store_ptr->path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
-  if (fd == -1)
+  if (!ladish_write_open(store_ptr->path, &fd))
   {
-    log_error("open(%s) failed: %d (%s)", store_ptr->path, errno, strerror(errno));
     return;
   }
 
+  success = true;
+
   for (i = 0; i < store_ptr->max_items && store_ptr->items[i] != NULL; i++)
   {
     if (!ladish_write_string(fd, store_ptr->items[i]))
     {
       log_error("write to file '%s' failed", store_ptr->path);
+      success = false;
       break;
     }
 
     if (!ladish_write_string(fd, "\n"))
     {
       log_error("write to file '%s' failed", store_ptr->path);
+      success = false;
       break;
     }
   }
 
-  close(fd);
+  ladish_write_close(fd, success, false);
 }
 
 static
@@ -157,9 +157,49 @@ create_shadow_port(
   return true;
 }
 
+struct room_port_link
+{
+  bool midi;
+  char input_port[37];
+  char output_port[37];
+};
+
+struct room_port_links
+{
+  struct ladish_room * room;
+  struct room_port_link * links;
+  unsigned int count;
+  unsigned int allocated;
+};
+
+static bool room_port_links_grow(struct room_port_links * links_ptr)
+{
+  struct room_port_link * links;
+  unsigned int allocated;
+
+  if (links_ptr->count < links_ptr->allocated)
+  {
+    return true;
+  }
+
+  allocated = links_ptr->allocated == 0 ? 16 : links_ptr->allocated * 2;
+  links = realloc(links_ptr->links, allocated * sizeof(struct room_port_link));
+  if (links == NULL)
+  {
+    log_error("realloc() failed to allocate array of %u room port links", allocated);
+    return false;
+  }
+
+  links_ptr->links = links;
+  links_ptr->allocated = allocated;
+  return true;
+}
+
+#define links_ptr ((struct room_port_links *)context)
+
 static
 bool
-create_port_link(
+collect_port_link(
   void * context,
   ladish_port_handle port_handle,
   const char * UNUSED(port_name),
@@ -168,44 +208,42 @@ create_port_link(
 {
   uuid_t uuid_in_owner;
   uuid_t uuid_in_room;
-  char uuid_in_owner_str[37];
-  char uuid_in_room_str[37];
-  const char * input_port;
-  const char * output_port;
+  struct room_port_link * link_ptr;
 
   //log_info("Room port \"%s\"", port_name);
 
-  ladish_graph_get_port_uuid(room_ptr->graph, port_handle, uuid_in_room);
-  ladish_graph_get_port_uuid(room_ptr->owner, port_handle, uuid_in_owner);
+  if (!room_port_links_grow(links_ptr))
+  {
+    return false;
+  }
 
-  uuid_unparse(uuid_in_room, uuid_in_room_str);
-  uuid_unparse(uuid_in_owner, uuid_in_owner_str);
+  link_ptr = links_ptr->links + links_ptr->count;
+
+  ladish_graph_get_port_uuid(links_ptr->room->graph, port_handle, uuid_in_room);
+  ladish_graph_get_port_uuid(links_ptr->room->owner, port_handle, uuid_in_owner);
+
+  link_ptr->midi = port_type == JACKDBUS_PORT_TYPE_MIDI;
 
   if (port_is_input(port_flags))
   {
-    input_port = uuid_in_room_str;
-    output_port = uuid_in_owner_str;
-    log_info("room input port %s is linked to owner graph output port %s", input_port, output_port);
+    uuid_unparse(uuid_in_room, link_ptr->input_port);
+    uuid_unparse(uuid_in_owner, link_ptr->output_port);
+    log_info("room input port %s is linked to owner graph output port %s", link_ptr->input_port, link_ptr->output_port);
   }
   else
   {
-    input_port = uuid_in_owner_str;
-    output_port = uuid_in_room_str;
-    log_info("owner graph input port %s is linked to room output port %s", input_port, output_port);
-  }
-
-  if (!jmcore_proxy_create_link(port_type == JACKDBUS_PORT_TYPE_MIDI, input_port, output_port))
-  {
-    log_error("jmcore_proxy_create_link() failed.");
-    return false;
+    uuid_unparse(uuid_in_owner, link_ptr->input_port);
+    uuid_unparse(uuid_in_room, link_ptr->output_port);
+    log_info("owner graph input port %s is linked to room output port %s", link_ptr->input_port, link_ptr->output_port);
   }
 
+  links_ptr->count++;
   return true;
 }
 
 static
 bool
-destroy_port_link(
+collect_port_unlink(
   void * context,
   ladish_graph_handle UNUSED(graph_handle),
   bool UNUSED(hidden),
@@ -218,24 +256,30 @@ destroy_port_link(
   uint32_t UNUSED(port_flags))
 {
   uuid_t uuid_in_room;
-  char uuid_in_room_str[37];
 
-  if (ladish_port_is_link(port_handle))
+  if (!ladish_port_is_link(port_handle))
   {
-    log_info("link port %s", port_name);
-
-    ladish_graph_get_port_uuid(ladish_room_get_graph(context), port_handle, uuid_in_room);
-    uuid_unparse(uuid_in_room, uuid_in_room_str);
-    jmcore_proxy_destroy_link(uuid_in_room_str);
+    log_info("jack port %s", port_name);
+    return true;
   }
-  else
+
+  log_info("link port %s", port_name);
+
+  if (!room_port_links_grow(links_ptr))
   {
-    log_info("jack port %s", port_name);
+    return false;
   }
 
+  /* jmcore identifies the pair by either of its ports, the room one is enough */
+  ladish_graph_get_port_uuid(links_ptr->room->graph, port_handle, uuid_in_room);
+  uuid_unparse(uuid_in_room, links_ptr->links[links_ptr->count].input_port);
+  links_ptr->count++;
+
   return true;
 }
 
+#undef links_ptr
+
 #undef room_ptr
 
 static void remove_port_callback(ladish_port_handle port)
@@ -304,7 +348,7 @@ ladish_room_create(
     uuid_clear(room_ptr->template_uuid);
   }
 
-  if (!ladish_app_supervisor_create(&room_ptr->app_supervisor, object_path, room_ptr->name, room_ptr->graph, ladish_virtualizer_rename_app))
+  if (!ladish_app_supervisor_create(&room_ptr->app_supervisor, object_path, room_ptr->name, room_ptr->graph, ladish_virtualizer_rename_app, ladish_virtualizer_autorun_complete))
   {
     log_error("ladish_app_supervisor_create() failed.");
     goto destroy;
@@ -548,15 +592,64 @@ ladish_room_iterate_link_ports(
 
 bool ladish_room_start(ladish_room_handle room_handle, ladish_virtualizer_handle virtualizer)
 {
-  if (!ladish_room_iterate_link_ports(room_handle, room_ptr, create_port_link))
+  struct room_port_links links;
+  struct jmcore_proxy_link * requests;
+  unsigned int i;
+  bool ret;
+
+  links.room = room_ptr;
+  links.links = NULL;
+  links.count = 0;
+  links.allocated = 0;
+
+  ret = false;
+  requests = NULL;
+
+  if (!ladish_room_iterate_link_ports(room_handle, &links, collect_port_link))
+  {
+    log_error("Collecting of room port links failed.");
+    goto exit;
+  }
+
+  if (links.count > 0)
+  {
+    requests = malloc(links.count * sizeof(struct jmcore_proxy_link));
+    if (requests == NULL)
+    {
+      log_error("malloc() failed to allocate array of %u jmcore link requests", links.count);
+      goto exit;
+    }
+
+    for (i = 0; i < links.count; i++)
+    {
+      requests[i].midi = links.links[i].midi;
+      requests[i].input_port_name = links.links[i].input_port;
+      requests[i].output_port_name = links.links[i].output_port;
+    }
+  }
+
+  /* All links are created with single call, jmcore installs them in its process callback at once */
+  if (!jmcore_proxy_create_links(requests, links.count))
   {
     log_error("Creation of room port links failed.");
+    goto exit;
+  }
+
+  ret = true;
+
+exit:
+  free(requests);
+  free(links.links);
+
+  if (!ret)
+  {
     return false;
   }
 
   ladish_virtualizer_set_graph_connection_handlers(virtualizer, room_ptr->graph);
   room_ptr->started = true;
 
+  ladish_graph_restore_begin(room_ptr->graph);
   ladish_app_supervisor_autorun(room_ptr->app_supervisor);
 
   return true;
@@ -564,6 +657,10 @@ bool ladish_room_start(ladish_room_handle room_handle, ladish_virtualizer_handle
 
 void ladish_room_initiate_stop(ladish_room_handle room_handle, bool clear_persist)
 {
+  struct room_port_links links;
+  const char ** port_names;
+  unsigned int i;
+
   if (!room_ptr->started)
   {
     return;
@@ -576,7 +673,35 @@ void ladish_room_initiate_stop(ladish_room_handle room_handle, bool clear_persis
     ladish_graph_clear_persist(room_ptr->graph);
   }
 
-  ladish_graph_iterate_nodes(room_ptr->graph, room_ptr, NULL, destroy_port_link, NULL);
+  links.room = room_ptr;
+  links.links = NULL;
+  links.count = 0;
+  links.allocated = 0;
+  port_names = NULL;
+
+  ladish_graph_iterate_nodes(room_ptr->graph, &links, NULL, collect_port_unlink, NULL);
+
+  if (links.count > 0)
+  {
+    port_names = malloc(links.count * sizeof(const char *));
+    if (port_names == NULL)
+    {
+      log_error("malloc() failed to allocate array of %u port names", links.count);
+    }
+    else
+    {
+      for (i = 0; i < links.count; i++)
+      {
+        port_names[i] = links.links[i].input_port;
+      }
+
+      jmcore_proxy_destroy_links(port_names, links.count);
+    }
+  }
+
+  free(port_names);
+  free(links.links);
+
   ladish_app_supervisor_stop(room_ptr->app_supervisor);
 }
 
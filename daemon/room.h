@@ -27,6 +27,8 @@
 #ifndef ROOM_H__9A1CF253_0A17_402A_BDF8_9BD72B467118__INCLUDED
 #define ROOM_H__9A1CF253_0A17_402A_BDF8_9BD72B467118__INCLUDED
 
+#include <sys/stat.h>
+
 #include "common.h"
 #include "graph.h"
 #include "app_supervisor.h"
@@ -99,6 +101,15 @@ ladish_room_save_project(
 bool ladish_room_unload_project(ladish_room_handle room_handle);
 bool ladish_room_load_project(ladish_room_handle room_handle, const char * project_dir);
 
-char * ladish_get_project_name(const char * project_dir);
+bool ladish_stat_project(const char * project_dir, struct stat * st_ptr);
+
+/* Read name, description and notes without loading the project.
+ * The returned strings are NULL when not present and must be freed by the caller. */
+bool
+ladish_read_project_header(
+  const char * project_dir,
+  char ** name_ptr,
+  char ** description_ptr,
+  char ** notes_ptr);
 
 #endif /* #ifndef ROOM_H__9A1CF253_0A17_402A_BDF8_9BD72B467118__INCLUDED */
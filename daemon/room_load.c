@@ -552,6 +552,18 @@ static void callback_elstart(void * data, const char * el, const char ** attr)
       goto free;
     }
 
+    /* optional, missing in files saved by older versions */
+    if (ladish_get_string_attribute(attr, "start_priority") == NULL)
+    {
+      context_ptr->start_priority = 0;
+    }
+    else if (ladish_get_byte_attribute(attr, "start_priority", &context_ptr->start_priority) == NULL)
+    {
+      log_error("application \"start_priority\" attribute has invalid value. name=\"%s\"", name);
+      context_ptr->error = XML_TRUE;
+      goto free;
+    }
+
     level = ladish_get_string_attribute(attr, "level");
     if (level == NULL)
     {
@@ -672,6 +684,8 @@ free:
 
 static void callback_elend(void * data, const char * UNUSED(el))
 {
+  ladish_app_handle app;
+
   if (context_ptr->error)
   {
     return;
@@ -726,18 +740,23 @@ static void callback_elend(void * data, const char * UNUSED(el))
 
     log_info("application '%s' (%s, %s, level '%s') with commandline '%s'", context_ptr->str, context_ptr->terminal ? "terminal" : "shell", context_ptr->autorun ? "autorun" : "stopped", context_ptr->level, context_ptr->data);
 
-    if (ladish_app_supervisor_add(
-          room_ptr->app_supervisor,
-          context_ptr->str,
-          context_ptr->uuid,
-          context_ptr->autorun,
-          context_ptr->data,
-          context_ptr->terminal,
-          context_ptr->level) == NULL)
+    app = ladish_app_supervisor_add(
+      room_ptr->app_supervisor,
+      context_ptr->str,
+      context_ptr->uuid,
+      context_ptr->autorun,
+      context_ptr->data,
+      context_ptr->terminal,
+      context_ptr->level);
+    if (app == NULL)
     {
       log_error("ladish_app_supervisor_add() failed.");
       context_ptr->error = XML_TRUE;
     }
+    else
+    {
+      ladish_app_set_start_priority(app, context_ptr->start_priority);
+    }
   }
   else if (context_ptr->element[context_ptr->depth] == PARSE_CONTEXT_DESCRIPTION)
   {
@@ -785,12 +804,7 @@ static void callback_elend(void * data, const char * UNUSED(el))
 bool ladish_room_load_project(ladish_room_handle room_handle, const char * project_dir)
 {
   char * path;
-  struct stat st;
   XML_Parser parser;
-  int bytes_read;
-  void * buffer;
-  int fd;
-  enum XML_Status xmls;
   struct ladish_parse_context parse_context;
   bool ret;
 
@@ -818,47 +832,13 @@ bool ladish_room_load_project(ladish_room_handle room_handle, const char * proje
     goto exit;
   }
 
-  if (stat(path, &st) != 0)
-  {
-    log_error("failed to stat '%s': %d (%s)", path, errno, strerror(errno));
-    goto free_path;
-  }
-
-  fd = open(path, O_RDONLY);
-  if (fd == -1)
-  {
-    log_error("failed to open '%s': %d (%s)", path, errno, strerror(errno));
-    goto free_path;
-  }
-
   parser = XML_ParserCreate(NULL);
   if (parser == NULL)
   {
     log_error("XML_ParserCreate() failed to create parser object.");
-    goto close;
-  }
-
-  //log_info("conf file size is %llu bytes", (unsigned long long)st.st_size);
-
-  /* we are expecting that conf file has small enough size to fit in memory */
-
-  buffer = XML_GetBuffer(parser, st.st_size);
-  if (buffer == NULL)
-  {
-    log_error("XML_GetBuffer() failed.");
-    goto free_parser;
-  }
-
-  bytes_read = read(fd, buffer, st.st_size);
-  if (bytes_read != st.st_size)
-  {
-    log_error("read() returned unexpected result.");
-    goto free_parser;
+    goto free_path;
   }
 
-  //log_info("\n----------\n%s\n-----------\n", buffer);
-  //goto free_parser;
-
   parse_context.error = XML_FALSE;
   parse_context.depth = -1;
   parse_context.str = NULL;
@@ -877,12 +857,7 @@ bool ladish_room_load_project(ladish_room_handle room_handle, const char * proje
     ladish_app_supervisor_set_project_name(room_ptr->app_supervisor, NULL);
   }
 
-  xmls = XML_ParseBuffer(parser, bytes_read, XML_TRUE);
-  if (xmls == XML_STATUS_ERROR && !parse_context.error)
-  {
-    log_error("XML_ParseBuffer() failed.");
-  }
-  if (xmls == XML_STATUS_ERROR || parse_context.error)
+  if (!ladish_parse_file(parser, path) || parse_context.error)
   {
     goto free_parser;
   }
@@ -893,6 +868,7 @@ bool ladish_room_load_project(ladish_room_handle room_handle, const char * proje
   ladish_app_supervisor_dump(room_ptr->app_supervisor);
 
   ladish_graph_trick_dicts(room_ptr->graph);
+  ladish_graph_restore_begin(room_ptr->graph);
   ladish_try_connect_hidden_connections(room_ptr->graph);
   ladish_app_supervisor_autorun(room_ptr->app_supervisor);
 
@@ -903,8 +879,6 @@ bool ladish_room_load_project(ladish_room_handle room_handle, const char * proje
 
 free_parser:
   XML_ParserFree(parser);
-close:
-  close(fd);
 free_path:
   free(path);
 exit:
@@ -923,109 +897,210 @@ exit:
 
 #undef room_ptr
 
-#define context_ptr ((struct ladish_parse_context *)data)
+struct ladish_project_header_context
+{
+  XML_Parser parser;
+  unsigned int element;         /* PARSE_CONTEXT_ROOT, PARSE_CONTEXT_PROJECT, PARSE_CONTEXT_DESCRIPTION or PARSE_CONTEXT_NOTES */
+  char data[MAX_DATA_SIZE];
+  size_t data_used;
+  char * name;
+  char * description;
+  char * notes;
+};
+
+#define context_ptr ((struct ladish_project_header_context *)data)
+
+static void project_header_chrdata_callback(void * data, const XML_Char * s, int len)
+{
+  if (context_ptr->element != PARSE_CONTEXT_DESCRIPTION &&
+      context_ptr->element != PARSE_CONTEXT_NOTES)
+  {
+    return;
+  }
+
+  if (context_ptr->data_used + len >= sizeof(context_ptr->data))
+  {
+    /* truncate, the header is used for display only */
+    len = sizeof(context_ptr->data) - 1 - context_ptr->data_used;
+  }
+
+  memcpy(context_ptr->data + context_ptr->data_used, s, len);
+  context_ptr->data_used += len;
+}
 
-static void project_name_elstart_callback(void * data, const char * el, const char ** attr)
+static void project_header_elstart_callback(void * data, const char * el, const char ** attr)
 {
   const char * name;
   const char * uuid_str;
   uuid_t uuid;
   size_t len;
 
-  if (strcmp(el, "project") == 0)
+  if (context_ptr->element == PARSE_CONTEXT_ROOT && strcmp(el, "project") == 0)
   {
+    context_ptr->element = PARSE_CONTEXT_PROJECT;
+
     if (ladish_get_name_and_uuid_attributes("/project", attr, &name, &uuid_str, uuid))
     {
       len = strlen(name) + 1;
-      context_ptr->str = malloc(len);
-      if (context_ptr->str == NULL)
+      context_ptr->name = malloc(len);
+      if (context_ptr->name == NULL)
       {
         log_error("malloc() failed for project name with length %zu", len);
+        return;
       }
 
-      unescape(name, len, context_ptr->str);
+      unescape(name, len, context_ptr->name);
+    }
+
+    return;
+  }
+
+  if (context_ptr->element == PARSE_CONTEXT_PROJECT)
+  {
+    if (strcmp(el, "description") == 0)
+    {
+      context_ptr->element = PARSE_CONTEXT_DESCRIPTION;
+      context_ptr->data_used = 0;
+      return;
+    }
+
+    if (strcmp(el, "notes") == 0)
+    {
+      context_ptr->element = PARSE_CONTEXT_NOTES;
+      context_ptr->data_used = 0;
+      return;
     }
+  }
+
+  /* description and notes precede the project contents, the rest of the file is not needed */
+  XML_StopParser(context_ptr->parser, XML_FALSE);
+}
 
-    XML_StopParser(context_ptr->parser, XML_TRUE);
+static void project_header_elend_callback(void * data, const char * UNUSED(el))
+{
+  char ** str_ptr;
+
+  if (context_ptr->element == PARSE_CONTEXT_DESCRIPTION)
+  {
+    str_ptr = &context_ptr->description;
+  }
+  else if (context_ptr->element == PARSE_CONTEXT_NOTES)
+  {
+    str_ptr = &context_ptr->notes;
+  }
+  else
+  {
+    /* </project> */
     return;
   }
+
+  context_ptr->element = PARSE_CONTEXT_PROJECT;
+
+  context_ptr->data[unescape(context_ptr->data, context_ptr->data_used, context_ptr->data)] = 0;
+
+  free(*str_ptr);
+  *str_ptr = strdup(context_ptr->data);
+  if (*str_ptr == NULL)
+  {
+    log_error("strdup() failed for project header text with length %zu", strlen(context_ptr->data));
+  }
 }
 
 #undef context_ptr
 
-char * ladish_get_project_name(const char * project_dir)
+static char * ladish_get_project_path(const char * project_dir)
 {
   char * path;
-  struct stat st;
-  XML_Parser parser;
-  int bytes_read;
-  void * buffer;
-  int fd;
-  enum XML_Status xmls;
-  struct ladish_parse_context parse_context;
-
-  parse_context.str = NULL;
 
   path = catdup(project_dir, LADISH_PROJECT_FILENAME);
   if (path == NULL)
   {
     log_error("catdup() failed to compose xml file path");
-    goto exit;
   }
 
-  if (stat(path, &st) != 0)
-  {
-    log_error("failed to stat '%s': %d (%s)", path, errno, strerror(errno));
-    goto free_path;
-  }
+  return path;
+}
+
+bool ladish_stat_project(const char * project_dir, struct stat * st_ptr)
+{
+  char * path;
+  bool ret;
 
-  fd = open(path, O_RDONLY);
-  if (fd == -1)
+  path = ladish_get_project_path(project_dir);
+  if (path == NULL)
   {
-    log_error("failed to open '%s': %d (%s)", path, errno, strerror(errno));
-    goto free_path;
+    return false;
   }
 
-  parser = XML_ParserCreate(NULL);
-  if (parser == NULL)
+  ret = stat(path, st_ptr) == 0;
+
+  free(path);
+
+  return ret;
+}
+
+bool
+ladish_read_project_header(
+  const char * project_dir,
+  char ** name_ptr,
+  char ** description_ptr,
+  char ** notes_ptr)
+{
+  char * path;
+  XML_Parser parser;
+  struct ladish_project_header_context * context_ptr;
+  bool ret;
+
+  ret = false;
+
+  /* allocated because of the char data buffer */
+  context_ptr = calloc(1, sizeof(struct ladish_project_header_context));
+  if (context_ptr == NULL)
   {
-    log_error("XML_ParserCreate() failed to create parser object.");
-    goto close;
+    log_error("calloc() failed for project header parse context");
+    goto exit;
   }
 
-  /* we are expecting that conf file has small enough size to fit in memory */
-
-  buffer = XML_GetBuffer(parser, st.st_size);
-  if (buffer == NULL)
+  path = ladish_get_project_path(project_dir);
+  if (path == NULL)
   {
-    log_error("XML_GetBuffer() failed.");
-    goto free_parser;
+    goto free_context;
   }
 
-  bytes_read = read(fd, buffer, st.st_size);
-  if (bytes_read != st.st_size)
+  parser = XML_ParserCreate(NULL);
+  if (parser == NULL)
   {
-    log_error("read() returned unexpected result.");
-    goto free_parser;
+    log_error("XML_ParserCreate() failed to create parser object.");
+    goto free_path;
   }
 
-  XML_SetElementHandler(parser, project_name_elstart_callback, NULL);
-  XML_SetUserData(parser, &parse_context);
+  context_ptr->parser = parser;
+  context_ptr->element = PARSE_CONTEXT_ROOT;
 
-  parse_context.parser = parser;
+  XML_SetElementHandler(parser, project_header_elstart_callback, project_header_elend_callback);
+  XML_SetCharacterDataHandler(parser, project_header_chrdata_callback);
+  XML_SetUserData(parser, context_ptr);
 
-  xmls = XML_ParseBuffer(parser, bytes_read, XML_TRUE);
-  if (xmls == XML_STATUS_ERROR)
-  {
-    log_error("XML_ParseBuffer() failed.");
-  }
+  ret = ladish_parse_file(parser, path);
 
-free_parser:
   XML_ParserFree(parser);
-close:
-  close(fd);
 free_path:
   free(path);
+free_context:
+  if (ret)
+  {
+    *name_ptr = context_ptr->name;
+    *description_ptr = context_ptr->description;
+    *notes_ptr = context_ptr->notes;
+  }
+  else
+  {
+    free(context_ptr->name);
+    free(context_ptr->description);
+    free(context_ptr->notes);
+  }
+
+  free(context_ptr);
 exit:
-  return parse_context.str;
+  return ret;
 }
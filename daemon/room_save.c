@@ -125,10 +125,8 @@ static bool ladish_room_save_project_xml(struct ladish_room * room_ptr)
     goto free_filename;
   }
 
-  fd = open(filename, O_WRONLY | O_TRUNC | O_CREAT, 0666);
-  if (fd == -1)
+  if (!ladish_write_open(filename, &fd))
   {
-    log_error("open(%s) failed: %d (%s)", filename, errno, strerror(errno));
     goto free_bak_filename;
   }
 
@@ -276,10 +274,11 @@ static bool ladish_room_save_project_xml(struct ladish_room * room_ptr)
     goto close;
   }
 
-  ret = true;
+  ret = ladish_write_close(fd, true, true);
+  goto free_bak_filename;
 
 close:
-  close(fd);
+  ladish_write_close(fd, false, false);
 free_bak_filename:
   free(bak_filename);
 free_filename:
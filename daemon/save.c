@@ -25,10 +25,31 @@
  */
 
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 
 #include "save.h"
 #include "escape.h"
 #include "studio.h"
+#include "../common/catdup.h"
+
+#define LADISH_WRITE_BUFFER_INITIAL_SIZE (64 * 1024)
+
+/* output of file opened with ladish_write_open() */
+struct ladish_write_buffer
+{
+  struct list_head siblings;
+  int fd;
+  char * path;                  /* final path */
+  char * tmp_path;              /* path of the file being written */
+  char * data;
+  size_t size;                  /* allocated size */
+  size_t used;
+  bool failed;
+};
+
+/* there are few files being saved at same time (studio and rooms) */
+static LIST_HEAD(g_write_buffers);
 
 struct ladish_write_vgraph_context
 {
@@ -68,28 +89,312 @@ is_hidden_port_interesting(
   return !ladish_app_is_running(app);
 }
 
-bool ladish_write_string(int fd, const char * string)
+static struct ladish_write_buffer * ladish_write_find_buffer(int fd)
+{
+  struct list_head * node_ptr;
+  struct ladish_write_buffer * buffer_ptr;
+
+  list_for_each(node_ptr, &g_write_buffers)
+  {
+    buffer_ptr = list_entry(node_ptr, struct ladish_write_buffer, siblings);
+    if (buffer_ptr->fd == fd)
+    {
+      return buffer_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+/* make room for size more bytes and return pointer to it, NULL on failure */
+static char * ladish_write_reserve(struct ladish_write_buffer * buffer_ptr, size_t size)
+{
+  size_t new_size;
+  char * new_data;
+
+  if (buffer_ptr->failed)
+  {
+    return NULL;
+  }
+
+  if (buffer_ptr->size - buffer_ptr->used < size)
+  {
+    new_size = buffer_ptr->size;
+    while (new_size - buffer_ptr->used < size)
+    {
+      new_size *= 2;
+    }
+
+    new_data = realloc(buffer_ptr->data, new_size);
+    if (new_data == NULL)
+    {
+      log_error("realloc() failed to grow the write buffer of '%s' to %zu bytes", buffer_ptr->path, new_size);
+      buffer_ptr->failed = true;
+      return NULL;
+    }
+
+    buffer_ptr->data = new_data;
+    buffer_ptr->size = new_size;
+  }
+
+  return buffer_ptr->data + buffer_ptr->used;
+}
+
+static bool ladish_write_fd(int fd, const char * data, size_t len)
+{
+  ssize_t ret;
+
+  while (len > 0)
+  {
+    ret = write(fd, data, len);
+    if (ret == -1)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+
+      log_error("write(%d, %zu) failed to write file: %d (%s)", fd, len, errno, strerror(errno));
+      return false;
+    }
+
+    data += ret;
+    len -= ret;
+  }
+
+  return true;
+}
+
+bool ladish_write_open(const char * path, int * fd_ptr)
+{
+  struct ladish_write_buffer * buffer_ptr;
+
+  buffer_ptr = malloc(sizeof(struct ladish_write_buffer));
+  if (buffer_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate write buffer struct");
+    goto fail;
+  }
+
+  buffer_ptr->path = strdup(path);
+  if (buffer_ptr->path == NULL)
+  {
+    log_error("strdup() failed for path '%s'", path);
+    goto free_buffer;
+  }
+
+  buffer_ptr->tmp_path = catdup(path, ".tmp");
+  if (buffer_ptr->tmp_path == NULL)
+  {
+    log_error("catdup() failed to compose temporary filename for '%s'", path);
+    goto free_path;
+  }
+
+  buffer_ptr->size = LADISH_WRITE_BUFFER_INITIAL_SIZE;
+  buffer_ptr->used = 0;
+  buffer_ptr->failed = false;
+  buffer_ptr->data = malloc(buffer_ptr->size);
+  if (buffer_ptr->data == NULL)
+  {
+    log_error("malloc() failed to allocate write buffer of %zu bytes", buffer_ptr->size);
+    goto free_tmp_path;
+  }
+
+  buffer_ptr->fd = open(buffer_ptr->tmp_path, O_WRONLY | O_TRUNC | O_CREAT, 0666);
+  if (buffer_ptr->fd == -1)
+  {
+    log_error("open(%s) failed: %d (%s)", buffer_ptr->tmp_path, errno, strerror(errno));
+    goto free_data;
+  }
+
+  list_add_tail(&buffer_ptr->siblings, &g_write_buffers);
+
+  *fd_ptr = buffer_ptr->fd;
+  return true;
+
+free_data:
+  free(buffer_ptr->data);
+free_tmp_path:
+  free(buffer_ptr->tmp_path);
+free_path:
+  free(buffer_ptr->path);
+free_buffer:
+  free(buffer_ptr);
+fail:
+  return false;
+}
+
+bool ladish_write_close(int fd, bool commit, bool sync)
+{
+  struct ladish_write_buffer * buffer_ptr;
+  bool ret;
+
+  buffer_ptr = ladish_write_find_buffer(fd);
+  if (buffer_ptr == NULL)
+  {
+    log_error("closing fd %d that was not opened with ladish_write_open()", fd);
+    ASSERT_NO_PASS;
+    close(fd);
+    return false;
+  }
+
+  list_del(&buffer_ptr->siblings);
+
+  ret = false;
+
+  if (!commit || buffer_ptr->failed)
+  {
+    goto close;
+  }
+
+  if (!ladish_write_fd(fd, buffer_ptr->data, buffer_ptr->used))
+  {
+    goto close;
+  }
+
+  if (sync && fdatasync(fd) != 0)
+  {
+    log_error("fdatasync(%s) failed: %d (%s)", buffer_ptr->tmp_path, errno, strerror(errno));
+    goto close;
+  }
+
+  ret = true;
+
+close:
+  if (close(fd) != 0 && ret)
+  {
+    log_error("close(%s) failed: %d (%s)", buffer_ptr->tmp_path, errno, strerror(errno));
+    ret = false;
+  }
+
+  if (ret && rename(buffer_ptr->tmp_path, buffer_ptr->path) != 0)
+  {
+    log_error("rename(%s, %s) failed: %d (%s)", buffer_ptr->tmp_path, buffer_ptr->path, errno, strerror(errno));
+    ret = false;
+  }
+
+  if (!ret && unlink(buffer_ptr->tmp_path) != 0)
+  {
+    log_error("unlink(%s) failed: %d (%s)", buffer_ptr->tmp_path, errno, strerror(errno));
+  }
+
+  free(buffer_ptr->data);
+  free(buffer_ptr->tmp_path);
+  free(buffer_ptr->path);
+  free(buffer_ptr);
+
+  return ret;
+}
+
+static bool ladish_write_copy(const char * path, const char * copy_path)
 {
-  size_t len;
+  char buffer[16 * 1024];
+  int input_fd;
+  int output_fd;
   ssize_t ret;
 
-  len = strlen(string);
+  input_fd = open(path, O_RDONLY);
+  if (input_fd == -1)
+  {
+    log_error("open(%s) failed: %d (%s)", path, errno, strerror(errno));
+    return false;
+  }
 
-  ret = write(fd, string, len);
-  if (ret == -1)
+  if (!ladish_write_open(copy_path, &output_fd))
   {
-    log_error("write(%d, \"%s\", %zu) failed to write file: %d (%s)", fd, string, len, errno, strerror(errno));
+    close(input_fd);
     return false;
   }
-  if ((size_t)ret != len)
+
+  for (;;)
+  {
+    ret = read(input_fd, buffer, sizeof(buffer));
+    if (ret == 0)
+    {
+      break;
+    }
+
+    if (ret == -1)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+
+      log_error("read(%s) failed: %d (%s)", path, errno, strerror(errno));
+      goto fail;
+    }
+
+    if (!ladish_write_data(output_fd, buffer, (size_t)ret))
+    {
+      goto fail;
+    }
+  }
+
+  close(input_fd);
+  return ladish_write_close(output_fd, true, false);
+
+fail:
+  close(input_fd);
+  ladish_write_close(output_fd, false, false);
+  return false;
+}
+
+bool ladish_write_backup(const char * path, const char * backup_path, bool * exists_ptr)
+{
+  if (unlink(backup_path) != 0 && errno != ENOENT)
   {
-    log_error("write() wrote wrong byte count to file (%zd != %zu).", ret, len);
+    log_error("unlink(%s) failed: %d (%s)", backup_path, errno, strerror(errno));
     return false;
   }
 
+  if (link(path, backup_path) == 0)
+  {
+    *exists_ptr = true;
+    return true;
+  }
+
+  if (errno == ENOENT)
+  {
+    *exists_ptr = false;
+    return true;
+  }
+
+  /* filesystems like vfat don't support hard links */
+  log_info("link(%s, %s) failed: %d (%s), copying", path, backup_path, errno, strerror(errno));
+
+  *exists_ptr = true;
+  return ladish_write_copy(path, backup_path);
+}
+
+bool ladish_write_data(int fd, const void * data, size_t size)
+{
+  struct ladish_write_buffer * buffer_ptr;
+  char * dst;
+
+  buffer_ptr = ladish_write_find_buffer(fd);
+  if (buffer_ptr == NULL)
+  {
+    return ladish_write_fd(fd, data, size);
+  }
+
+  dst = ladish_write_reserve(buffer_ptr, size);
+  if (dst == NULL)
+  {
+    return false;
+  }
+
+  memcpy(dst, data, size);
+  buffer_ptr->used += size;
+
   return true;
 }
 
+bool ladish_write_string(int fd, const char * string)
+{
+  return ladish_write_data(fd, string, strlen(string));
+}
+
 bool ladish_write_indented_string(int fd, int indent, const char * string)
 {
   ASSERT(indent >= 0);
@@ -111,10 +416,27 @@ bool ladish_write_indented_string(int fd, int indent, const char * string)
 
 bool ladish_write_string_escape_ex(int fd, const char * string, unsigned int flags)
 {
+  struct ladish_write_buffer * buffer_ptr;
   bool ret;
   char * escaped_buffer;
+  char * dst;
 
-  escaped_buffer = malloc(max_escaped_length(strlen(string)));
+  buffer_ptr = ladish_write_find_buffer(fd);
+  if (buffer_ptr != NULL)
+  {
+    /* escape directly into the output buffer */
+    dst = ladish_write_reserve(buffer_ptr, max_escaped_length(strlen(string)));
+    if (dst == NULL)
+    {
+      return false;
+    }
+
+    escape(&string, &dst, flags);
+    buffer_ptr->used = dst - buffer_ptr->data;
+    return true;
+  }
+
+  escaped_buffer = malloc(max_escaped_length(strlen(string)) + 1);
   if (escaped_buffer == NULL)
   {
     log_error("malloc() failed to allocate buffer for escaped string");
@@ -764,9 +1086,14 @@ ladish_save_app(
   char * escaped_buffer;
   bool ret;
   char str[37];
+  ladish_app_handle app;
+  uint8_t start_priority;
 
   uuid_unparse(uuid, str);
 
+  app = ladish_app_supervisor_find_app_by_uuid(ctx_ptr->app_supervisor, uuid);
+  start_priority = app != NULL ? ladish_app_get_start_priority(app) : 0;
+
   log_info("saving app: name='%s', %srunning, %s, level '%s', commandline='%s'", name, running ? "" : "not ", terminal ? "terminal" : "shell", level, command);
 
   ret = false;
@@ -832,6 +1159,22 @@ ladish_save_app(
     goto free_buffer;
   }
 
+  /* written only when set, so files stay loadable by older versions */
+  if (start_priority != 0)
+  {
+    sprintf(str, "%u", (unsigned int)start_priority);
+
+    if (!ladish_write_string(fd, "\" start_priority=\""))
+    {
+      goto free_buffer;
+    }
+
+    if (!ladish_write_string(fd, str))
+    {
+      goto free_buffer;
+    }
+  }
+
   if (!ladish_write_string(fd, "\">"))
   {
     goto free_buffer;
@@ -41,6 +41,22 @@ struct ladish_write_context
   int indent;
 };
 
+/* Open file for buffered writing. The output is collected in memory and
+ * written to a temporary file when ladish_write_close() is called.
+ * The temporary file is then renamed over path, so a partially written
+ * file never replaces the old one. The returned fd is to be passed to
+ * the ladish_write_*() functions and then to ladish_write_close(). */
+bool ladish_write_open(const char * path, int * fd_ptr);
+
+/* commit set to false discards the output, sync causes fdatasync() before rename */
+bool ladish_write_close(int fd, bool commit, bool sync);
+
+/* Make backup_path a copy of path without removing path even for a moment,
+ * a hard link is used when the filesystem supports it.
+ * *exists_ptr is set to false if there is no file at path to backup. */
+bool ladish_write_backup(const char * path, const char * backup_path, bool * exists_ptr);
+
+bool ladish_write_data(int fd, const void * data, size_t size);
 bool ladish_write_string(int fd, const char * string);
 bool ladish_write_indented_string(int fd, int indent, const char * string);
 bool ladish_write_string_escape(int fd, const char * string);
@@ -41,6 +41,8 @@
 #include "escape.h"
 #include "studio.h"
 #include "../proxies/notify_proxy.h"
+#include "ancestry.h"
+#include "jack_status.h"
 
 #define STUDIOS_DIR "/studios/"
 
@@ -358,6 +360,7 @@ void ladish_studio_on_event_jack_started(void)
     }
   }
 
+  ladish_graph_restore_begin(g_studio.studio_graph);
   ladish_app_supervisor_autorun(g_studio.app_supervisor);
 
   ladish_studio_emit_started();
@@ -519,6 +522,7 @@ static void ladish_studio_on_jack_server_started(void)
 {
   log_info("JACK server start detected.");
   ladish_environment_set(&g_studio.env_store, ladish_environment_jack_server_started);
+  ladish_jack_status_on_jack_started();
 }
 
 static void ladish_studio_on_jack_server_stopped(void)
@@ -604,7 +608,7 @@ bool ladish_studio_init(void)
     goto jack_graph_destroy;
   }
 
-  if (!ladish_app_supervisor_create(&g_studio.app_supervisor, STUDIO_OBJECT_PATH, "studio", g_studio.studio_graph, ladish_virtualizer_rename_app))
+  if (!ladish_app_supervisor_create(&g_studio.app_supervisor, STUDIO_OBJECT_PATH, "studio", g_studio.studio_graph, ladish_virtualizer_rename_app, ladish_virtualizer_autorun_complete))
   {
     log_error("ladish_app_supervisor_create() failed.");
     goto studio_graph_destroy;
@@ -685,6 +689,8 @@ void ladish_studio_on_child_exit(pid_t pid, int exit_status)
 {
   struct on_child_exit_context context;
 
+  ladish_ancestry_forget(pid);
+
   context.pid = pid;
   context.exit_status = exit_status;
   context.found = false;
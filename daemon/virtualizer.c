@@ -28,7 +28,7 @@
 #include "../dbus_constants.h"
 #include "../proxies/a2j_proxy.h"
 #include "../proxies/jmcore_proxy.h"
-#include "procfs.h"
+#include "ancestry.h"
 #include "app_supervisor.h"
 #include "studio_internal.h"
 #include "../common/catdup.h"
@@ -42,6 +42,43 @@ struct virtualizer
   ladish_graph_handle jack_graph;
   uint64_t system_client_id;
   unsigned int our_clients_count;
+  struct list_head events;      /* graph events waiting for lookups of earlier events to complete */
+  bool processing_events;
+};
+
+#define VIRTUALIZER_EVENT_CLIENT_APPEARED      0
+#define VIRTUALIZER_EVENT_CLIENT_DISAPPEARED   1
+#define VIRTUALIZER_EVENT_PORT_APPEARED        2
+#define VIRTUALIZER_EVENT_PORT_RENAMED         3
+#define VIRTUALIZER_EVENT_PORT_DISAPPEARED     4
+#define VIRTUALIZER_EVENT_PORTS_CONNECTED      5
+#define VIRTUALIZER_EVENT_PORTS_DISCONNECTED   6
+
+/* JACK graph events are processed in order of arrival. The pid and a2j
+ * lookups that events need are started as soon as the event arrives so
+ * lookups for many clients and ports run in parallel. */
+struct virtualizer_event
+{
+  struct list_head siblings;
+  struct virtualizer * virtualizer_ptr;
+  unsigned int type;
+  bool pending;                 /* lookup in progress, call is valid */
+  cdbus_pending_call_handle call;
+  uint64_t client_id;
+  uint64_t port_id;
+  uint64_t client2_id;
+  uint64_t port2_id;
+  char * name;
+  char * name2;
+  bool is_input;
+  bool is_terminal;
+  bool is_midi;
+  bool is_a2j;
+  bool pid_known;
+  pid_t pid;
+  char * alsa_client_name;
+  char * alsa_port_name;
+  uint32_t alsa_client_id;
 };
 
 /* 47c1cd18-7b21-4389-bec4-6e0658e1d6b1 */
@@ -55,7 +92,8 @@ UUID_DEFINE(g_a2j_uuid,0xBE,0x23,0xA2,0x42,0xE2,0xB2,0x11,0xDE,0xB7,0x95,0x00,0x
 
 struct app_find_context
 {
-  pid_t pid;
+  pid_t chain[LADISH_ANCESTRY_MAX_DEPTH]; /* the pid and its ancestors */
+  unsigned int chain_length;
   ladish_graph_handle graph;
   ladish_app_handle app;
 };
@@ -64,30 +102,19 @@ struct app_find_context
 
 static bool lookup_app_in_supervisor(void * context, ladish_graph_handle graph, ladish_app_supervisor_handle app_supervisor)
 {
-  pid_t pid;
+  unsigned int i;
   ladish_app_handle app;
 
   /* we stop iteration when app is found */
   ASSERT(app_find_context_ptr->app == NULL && app_find_context_ptr->graph == NULL);
 
-  //log_info("checking app supervisor \"%s\" for pid %llu", ladish_app_supervisor_get_name(app_supervisor), (unsigned long long)pid);
+  //log_info("checking app supervisor \"%s\" for pid %llu", ladish_app_supervisor_get_name(app_supervisor), (unsigned long long)app_find_context_ptr->chain[0]);
 
-  pid = app_find_context_ptr->pid;
-  do
+  app = NULL;
+  for (i = 0; i < app_find_context_ptr->chain_length && app == NULL; i++)
   {
-    app = ladish_app_supervisor_find_app_by_pid(app_supervisor, pid);
-    if (app != NULL)
-      break;
-
-    pid = (pid_t)procfs_get_process_parent((unsigned long long)pid);
-#if 0
-    if (pid != 0)
-    {
-      log_info("parent pid %llu", (unsigned long long)pid);
-    }
-#endif
+    app = ladish_app_supervisor_find_app_by_pid(app_supervisor, app_find_context_ptr->chain[i]);
   }
-  while (pid != 0);
 
   if (app == NULL)
   {                            /* app not found in current supervisor */
@@ -106,7 +133,8 @@ ladish_app_handle ladish_find_app_by_pid(pid_t pid, ladish_graph_handle * graph_
 {
   struct app_find_context context;
 
-  context.pid = pid;
+  /* resolve the ancestry once, it is same for all supervisors */
+  context.chain_length = ladish_ancestry_get(pid, context.chain);
   context.app = NULL;
   context.graph = NULL;
 
@@ -273,7 +301,7 @@ static void clear(void * UNUSED(context))
   log_info("clear");
 }
 
-static void client_appeared(void * context, uint64_t id, const char * jack_name)
+static void client_appeared(void * context, uint64_t id, const char * jack_name, bool pid_known, pid_t pid)
 {
   ladish_client_handle client;
   ladish_client_handle client2;
@@ -282,7 +310,6 @@ static void client_appeared(void * context, uint64_t id, const char * jack_name)
   ladish_app_handle app;
   uuid_t app_uuid;
   const char * name;
-  pid_t pid;
   ladish_graph_handle graph;
   bool jmcore;
 
@@ -296,7 +323,7 @@ static void client_appeared(void * context, uint64_t id, const char * jack_name)
   graph = NULL;
   jmcore = false;
 
-  if (!graph_proxy_get_client_pid(virtualizer_ptr->jack_graph_proxy, id, &pid))
+  if (!pid_known)
   {
     log_info("client %"PRIu64" pid is unknown", id);
   }
@@ -536,7 +563,10 @@ port_appeared(
   const char * real_jack_port_name,
   bool is_input,
   bool is_terminal,
-  bool is_midi)
+  bool is_midi,
+  char * alsa_client_name,      /* a2j mapping result, NULL if not available, freed here */
+  char * alsa_port_name,        /* a2j mapping result, NULL if not available, freed here */
+  uint32_t alsa_client_id)      /* a2j mapping result */
 {
   ladish_client_handle jack_client;
   ladish_client_handle vclient;
@@ -551,10 +581,7 @@ port_appeared(
   ladish_app_handle app;
   bool has_app;
   uuid_t app_uuid;
-  char * alsa_client_name;
-  char * alsa_port_name;
   char * a2j_fake_jack_port_name;
-  uint32_t alsa_client_id;
   const char * jack_port_name;
   const char * vport_name;
   ladish_graph_handle vgraph;
@@ -563,8 +590,6 @@ port_appeared(
 
   log_info("port_appeared(%"PRIu64", %"PRIu64", %s (%s, %s))", client_id, port_id, real_jack_port_name, is_input ? "in" : "out", is_midi ? "midi" : "audio");
 
-  alsa_client_name = NULL;
-  alsa_port_name = NULL;
   a2j_fake_jack_port_name = NULL;
 
   type = is_midi ? JACKDBUS_PORT_TYPE_MIDI : JACKDBUS_PORT_TYPE_AUDIO;
@@ -581,7 +606,7 @@ port_appeared(
   if (jack_client == NULL)
   {
     log_error("Port of unknown JACK client with id %"PRIu64" appeared", client_id);
-    goto exit;
+    goto free_alsa_names;
   }
 
   pid = ladish_client_get_pid(jack_client);
@@ -595,7 +620,7 @@ port_appeared(
     if (vgraph == NULL)
     {
       log_error("Cannot find vgraph for appeared jmcore port '%s'", real_jack_port_name);
-      goto exit;
+      goto free_alsa_names;
     }
 
     /* jmcore port appeared */
@@ -605,7 +630,7 @@ port_appeared(
     if (!ladish_graph_add_port(virtualizer_ptr->jack_graph, jack_client, port, real_jack_port_name, type, flags, false))
     {
       log_error("ladish_graph_add_port() failed.");
-      goto exit;
+      goto free_alsa_names;
     }
 
     if (vgraph == g_studio.studio_graph)
@@ -622,11 +647,11 @@ port_appeared(
     {
       log_error("link port client not found in vgraph %s", ladish_graph_get_description(vgraph));
       ASSERT_NO_PASS;
-      goto exit;
+      goto free_alsa_names;
     }
 
     ladish_graph_show_port(vgraph, port);
-    goto exit;
+    goto free_alsa_names;
   }
   else
   {
@@ -639,14 +664,16 @@ port_appeared(
   if (is_a2j)
   {
     log_info("a2j port appeared");
-    if (!a2j_proxy_map_jack_port(real_jack_port_name, &alsa_client_name, &alsa_port_name, &alsa_client_id))
+    if (alsa_client_name == NULL || alsa_port_name == NULL)
     {
       is_a2j = false;
+      free(alsa_client_name);
+      free(alsa_port_name);
       alsa_client_name = catdup("FAILED ", jack_client_name);
       if (alsa_client_name == NULL)
       {
         log_error("catdup failed to duplicate a2j jack client name after map failure");
-        goto exit;
+        goto free_alsa_names;
       }
 
       alsa_port_name = strdup(real_jack_port_name);
@@ -654,7 +681,7 @@ port_appeared(
       {
         log_error("catdup failed to duplicate a2j jack port name after map failure");
         free(alsa_client_name);
-        goto exit;
+        goto free_alsa_names;
       }
 
       vclient_name = alsa_client_name;
@@ -936,9 +963,6 @@ free_alsa_names:
   free(a2j_fake_jack_port_name);
   free(alsa_client_name);
   free(alsa_port_name);
-
-exit:
-  return;
 }
 
 static void maybe_clear_a2j_port_pid(ladish_graph_handle vgraph, ladish_client_handle jclient, ladish_port_handle port)
@@ -1106,6 +1130,35 @@ static bool ports_connect_request(void * context, ladish_graph_handle graph_hand
   return graph_proxy_connect_ports(virtualizer_ptr->jack_graph_proxy, port1_id, port2_id);
 }
 
+static
+bool
+ports_connect_async_request(
+  void * context,
+  ladish_graph_handle graph_handle,
+  ladish_port_handle port1,
+  ladish_port_handle port2,
+  void * callback_context,
+  void (* callback)(void * callback_context, bool success))
+{
+  uint64_t port1_id;
+  uint64_t port2_id;
+
+  ASSERT(ladish_graph_get_opath(graph_handle)); /* studio or room virtual graph */
+
+  if (graph_handle == g_studio.studio_graph)
+  {
+    port1_id = ladish_port_get_jack_id(port1);
+    port2_id = ladish_port_get_jack_id(port2);
+  }
+  else
+  {
+    port1_id = ladish_port_get_jack_id_room(port1);
+    port2_id = ladish_port_get_jack_id_room(port2);
+  }
+
+  return graph_proxy_connect_ports_async(virtualizer_ptr->jack_graph_proxy, port1_id, port2_id, callback_context, callback);
+}
+
 static bool ports_disconnect_request(void * context, ladish_graph_handle graph_handle, uint64_t connection_id)
 {
   ladish_port_handle port1;
@@ -1226,6 +1279,420 @@ static void ports_disconnected(void * context, uint64_t client1_id, uint64_t por
 
 #undef virtualizer_ptr
 
+static
+struct virtualizer_event *
+virtualizer_event_create(
+  struct virtualizer * virtualizer_ptr,
+  unsigned int type,
+  const char * name,
+  const char * name2)
+{
+  struct virtualizer_event * event_ptr;
+
+  event_ptr = calloc(1, sizeof(struct virtualizer_event));
+  if (event_ptr == NULL)
+  {
+    log_error("calloc() failed for struct virtualizer_event");
+    return NULL;
+  }
+
+  event_ptr->virtualizer_ptr = virtualizer_ptr;
+  event_ptr->type = type;
+
+  if (name != NULL)
+  {
+    event_ptr->name = strdup(name);
+    if (event_ptr->name == NULL)
+    {
+      log_error("strdup() failed for virtualizer event name '%s'", name);
+      goto free;
+    }
+  }
+
+  if (name2 != NULL)
+  {
+    event_ptr->name2 = strdup(name2);
+    if (event_ptr->name2 == NULL)
+    {
+      log_error("strdup() failed for virtualizer event name '%s'", name2);
+      goto free;
+    }
+  }
+
+  return event_ptr;
+
+free:
+  free(event_ptr->name);
+  free(event_ptr);
+  return NULL;
+}
+
+static void virtualizer_event_destroy(struct virtualizer_event * event_ptr)
+{
+  if (event_ptr->pending)
+  {
+    cdbus_call_async_cancel(event_ptr->call);
+  }
+
+  free(event_ptr->name);
+  free(event_ptr->name2);
+  free(event_ptr->alsa_client_name);
+  free(event_ptr->alsa_port_name);
+  free(event_ptr);
+}
+
+static void virtualizer_event_dispatch(struct virtualizer_event * event_ptr)
+{
+  struct virtualizer * virtualizer_ptr;
+
+  virtualizer_ptr = event_ptr->virtualizer_ptr;
+
+  switch (event_ptr->type)
+  {
+  case VIRTUALIZER_EVENT_CLIENT_APPEARED:
+    client_appeared(virtualizer_ptr, event_ptr->client_id, event_ptr->name, event_ptr->pid_known, event_ptr->pid);
+    return;
+  case VIRTUALIZER_EVENT_CLIENT_DISAPPEARED:
+    client_disappeared(virtualizer_ptr, event_ptr->client_id);
+    return;
+  case VIRTUALIZER_EVENT_PORT_APPEARED:
+    port_appeared(
+      virtualizer_ptr,
+      event_ptr->client_id,
+      event_ptr->port_id,
+      event_ptr->name,
+      event_ptr->is_input,
+      event_ptr->is_terminal,
+      event_ptr->is_midi,
+      event_ptr->alsa_client_name,
+      event_ptr->alsa_port_name,
+      event_ptr->alsa_client_id);
+    /* ownership of the names is transferred */
+    event_ptr->alsa_client_name = NULL;
+    event_ptr->alsa_port_name = NULL;
+    return;
+  case VIRTUALIZER_EVENT_PORT_RENAMED:
+    port_renamed(virtualizer_ptr, event_ptr->client_id, event_ptr->port_id, event_ptr->name, event_ptr->name2);
+    return;
+  case VIRTUALIZER_EVENT_PORT_DISAPPEARED:
+    port_disappeared(virtualizer_ptr, event_ptr->client_id, event_ptr->port_id);
+    return;
+  case VIRTUALIZER_EVENT_PORTS_CONNECTED:
+    ports_connected(virtualizer_ptr, event_ptr->client_id, event_ptr->port_id, event_ptr->client2_id, event_ptr->port2_id);
+    return;
+  case VIRTUALIZER_EVENT_PORTS_DISCONNECTED:
+    ports_disconnected(virtualizer_ptr, event_ptr->client_id, event_ptr->port_id, event_ptr->client2_id, event_ptr->port2_id);
+    return;
+  }
+
+  ASSERT_NO_PASS;
+}
+
+/* process events from the head of the queue until one with lookup in progress is reached */
+static void virtualizer_process_events(struct virtualizer * virtualizer_ptr)
+{
+  struct virtualizer_event * event_ptr;
+
+  if (virtualizer_ptr->processing_events)
+  {
+    return;
+  }
+
+  virtualizer_ptr->processing_events = true;
+
+  while (!list_empty(&virtualizer_ptr->events))
+  {
+    event_ptr = list_entry(virtualizer_ptr->events.next, struct virtualizer_event, siblings);
+    if (event_ptr->pending)
+    {
+      break;
+    }
+
+    list_del(&event_ptr->siblings);
+    virtualizer_event_dispatch(event_ptr);
+    virtualizer_event_destroy(event_ptr);
+  }
+
+  virtualizer_ptr->processing_events = false;
+}
+
+static void virtualizer_queue_event(struct virtualizer * virtualizer_ptr, struct virtualizer_event * event_ptr)
+{
+  list_add_tail(&event_ptr->siblings, &virtualizer_ptr->events);
+  virtualizer_process_events(virtualizer_ptr);
+}
+
+/* Whether events can be processed immediately, without queueing them */
+static bool virtualizer_events_idle(struct virtualizer * virtualizer_ptr)
+{
+  return list_empty(&virtualizer_ptr->events) && !virtualizer_ptr->processing_events;
+}
+
+#define event_ptr ((struct virtualizer_event *)context)
+
+static void on_client_pid(void * context, bool success, pid_t pid)
+{
+  ASSERT(event_ptr->pending);
+  event_ptr->pending = false;
+
+  event_ptr->pid_known = success;
+  event_ptr->pid = pid;
+
+  virtualizer_process_events(event_ptr->virtualizer_ptr);
+}
+
+static
+void
+on_a2j_port_mapped(
+  void * context,
+  const char * alsa_client_name,
+  const char * alsa_port_name,
+  uint32_t alsa_client_id)
+{
+  ASSERT(event_ptr->pending);
+  event_ptr->pending = false;
+
+  if (alsa_client_name != NULL && alsa_port_name != NULL)
+  {
+    event_ptr->alsa_client_name = strdup(alsa_client_name);
+    event_ptr->alsa_port_name = strdup(alsa_port_name);
+    if (event_ptr->alsa_client_name == NULL || event_ptr->alsa_port_name == NULL)
+    {
+      log_error("strdup() failed for a2j alsa client/port name string");
+      free(event_ptr->alsa_client_name);
+      free(event_ptr->alsa_port_name);
+      event_ptr->alsa_client_name = NULL;
+      event_ptr->alsa_port_name = NULL;
+    }
+
+    event_ptr->alsa_client_id = alsa_client_id;
+  }
+
+  virtualizer_process_events(event_ptr->virtualizer_ptr);
+}
+
+#undef event_ptr
+
+/* The client may still be waiting for its pid in the event queue */
+static bool is_a2j_jack_client_id(struct virtualizer * virtualizer_ptr, uint64_t client_id)
+{
+  struct list_head * node_ptr;
+  struct virtualizer_event * event_ptr;
+  ladish_client_handle client;
+
+  list_for_each_prev(node_ptr, &virtualizer_ptr->events)
+  {
+    event_ptr = list_entry(node_ptr, struct virtualizer_event, siblings);
+    if (event_ptr->client_id != client_id)
+    {
+      continue;
+    }
+
+    if (event_ptr->type == VIRTUALIZER_EVENT_CLIENT_APPEARED)
+    {
+      return event_ptr->is_a2j;
+    }
+
+    if (event_ptr->type == VIRTUALIZER_EVENT_CLIENT_DISAPPEARED)
+    {
+      return false;
+    }
+  }
+
+  client = ladish_graph_find_client_by_jack_id(virtualizer_ptr->jack_graph, client_id);
+  return client != NULL && ladish_virtualizer_is_a2j_client(client);
+}
+
+#define virtualizer_ptr ((struct virtualizer *)context)
+
+static void on_client_appeared(void * context, uint64_t id, const char * jack_name)
+{
+  struct virtualizer_event * event_ptr;
+  const char * a2j_name;
+
+  event_ptr = virtualizer_event_create(virtualizer_ptr, VIRTUALIZER_EVENT_CLIENT_APPEARED, jack_name, NULL);
+  if (event_ptr == NULL)
+  {
+    log_error("Ignoring client %"PRIu64" (%s)", id, jack_name);
+    return;
+  }
+
+  event_ptr->client_id = id;
+
+  a2j_name = a2j_proxy_get_jack_client_name_cached();
+  event_ptr->is_a2j = a2j_name != NULL && strcmp(a2j_name, jack_name) == 0;
+
+  event_ptr->pending = graph_proxy_get_client_pid_async(virtualizer_ptr->jack_graph_proxy, id, event_ptr, on_client_pid, &event_ptr->call);
+
+  virtualizer_queue_event(virtualizer_ptr, event_ptr);
+}
+
+static void on_client_disappeared(void * context, uint64_t id)
+{
+  struct virtualizer_event * event_ptr;
+
+  if (virtualizer_events_idle(virtualizer_ptr))
+  {
+    client_disappeared(context, id);
+    return;
+  }
+
+  event_ptr = virtualizer_event_create(virtualizer_ptr, VIRTUALIZER_EVENT_CLIENT_DISAPPEARED, NULL, NULL);
+  if (event_ptr == NULL)
+  {
+    log_error("Ignoring disappear of client %"PRIu64, id);
+    return;
+  }
+
+  event_ptr->client_id = id;
+
+  virtualizer_queue_event(virtualizer_ptr, event_ptr);
+}
+
+static
+void
+on_port_appeared(
+  void * context,
+  uint64_t client_id,
+  uint64_t port_id,
+  const char * real_jack_port_name,
+  bool is_input,
+  bool is_terminal,
+  bool is_midi)
+{
+  struct virtualizer_event * event_ptr;
+
+  if (virtualizer_events_idle(virtualizer_ptr) && !is_a2j_jack_client_id(virtualizer_ptr, client_id))
+  {
+    port_appeared(context, client_id, port_id, real_jack_port_name, is_input, is_terminal, is_midi, NULL, NULL, 0);
+    return;
+  }
+
+  event_ptr = virtualizer_event_create(virtualizer_ptr, VIRTUALIZER_EVENT_PORT_APPEARED, real_jack_port_name, NULL);
+  if (event_ptr == NULL)
+  {
+    log_error("Ignoring port %"PRIu64":%"PRIu64" (%s)", client_id, port_id, real_jack_port_name);
+    return;
+  }
+
+  event_ptr->client_id = client_id;
+  event_ptr->port_id = port_id;
+  event_ptr->is_input = is_input;
+  event_ptr->is_terminal = is_terminal;
+  event_ptr->is_midi = is_midi;
+
+  if (is_a2j_jack_client_id(virtualizer_ptr, client_id))
+  {
+    event_ptr->pending = a2j_proxy_map_jack_port_async(real_jack_port_name, event_ptr, on_a2j_port_mapped, &event_ptr->call);
+  }
+
+  virtualizer_queue_event(virtualizer_ptr, event_ptr);
+}
+
+static
+void
+on_port_renamed(
+  void * context,
+  uint64_t client_id,
+  uint64_t port_id,
+  const char * old_port_name,
+  const char * new_port_name)
+{
+  struct virtualizer_event * event_ptr;
+
+  if (virtualizer_events_idle(virtualizer_ptr))
+  {
+    port_renamed(context, client_id, port_id, old_port_name, new_port_name);
+    return;
+  }
+
+  event_ptr = virtualizer_event_create(virtualizer_ptr, VIRTUALIZER_EVENT_PORT_RENAMED, old_port_name, new_port_name);
+  if (event_ptr == NULL)
+  {
+    log_error("Ignoring rename of port %"PRIu64":%"PRIu64" to '%s'", client_id, port_id, new_port_name);
+    return;
+  }
+
+  event_ptr->client_id = client_id;
+  event_ptr->port_id = port_id;
+
+  virtualizer_queue_event(virtualizer_ptr, event_ptr);
+}
+
+static void on_port_disappeared(void * context, uint64_t client_id, uint64_t port_id)
+{
+  struct virtualizer_event * event_ptr;
+
+  if (virtualizer_events_idle(virtualizer_ptr))
+  {
+    port_disappeared(context, client_id, port_id);
+    return;
+  }
+
+  event_ptr = virtualizer_event_create(virtualizer_ptr, VIRTUALIZER_EVENT_PORT_DISAPPEARED, NULL, NULL);
+  if (event_ptr == NULL)
+  {
+    log_error("Ignoring disappear of port %"PRIu64":%"PRIu64, client_id, port_id);
+    return;
+  }
+
+  event_ptr->client_id = client_id;
+  event_ptr->port_id = port_id;
+
+  virtualizer_queue_event(virtualizer_ptr, event_ptr);
+}
+
+static
+void
+queue_connection_event(
+  void * context,
+  unsigned int type,
+  uint64_t client1_id,
+  uint64_t port1_id,
+  uint64_t client2_id,
+  uint64_t port2_id)
+{
+  struct virtualizer_event * event_ptr;
+
+  event_ptr = virtualizer_event_create(virtualizer_ptr, type, NULL, NULL);
+  if (event_ptr == NULL)
+  {
+    log_error("Ignoring connection change %"PRIu64":%"PRIu64" %"PRIu64":%"PRIu64"", client1_id, port1_id, client2_id, port2_id);
+    return;
+  }
+
+  event_ptr->client_id = client1_id;
+  event_ptr->port_id = port1_id;
+  event_ptr->client2_id = client2_id;
+  event_ptr->port2_id = port2_id;
+
+  virtualizer_queue_event(virtualizer_ptr, event_ptr);
+}
+
+static void on_ports_connected(void * context, uint64_t client1_id, uint64_t port1_id, uint64_t client2_id, uint64_t port2_id)
+{
+  if (virtualizer_events_idle(virtualizer_ptr))
+  {
+    ports_connected(context, client1_id, port1_id, client2_id, port2_id);
+    return;
+  }
+
+  queue_connection_event(context, VIRTUALIZER_EVENT_PORTS_CONNECTED, client1_id, port1_id, client2_id, port2_id);
+}
+
+static void on_ports_disconnected(void * context, uint64_t client1_id, uint64_t port1_id, uint64_t client2_id, uint64_t port2_id)
+{
+  if (virtualizer_events_idle(virtualizer_ptr))
+  {
+    ports_disconnected(context, client1_id, port1_id, client2_id, port2_id);
+    return;
+  }
+
+  queue_connection_event(context, VIRTUALIZER_EVENT_PORTS_DISCONNECTED, client1_id, port1_id, client2_id, port2_id);
+}
+
+#undef virtualizer_ptr
+
 bool
 ladish_virtualizer_create(
   graph_proxy_handle jack_graph_proxy,
@@ -1245,19 +1712,21 @@ ladish_virtualizer_create(
   virtualizer_ptr->jack_graph = jack_graph;
   virtualizer_ptr->system_client_id = 0;
   virtualizer_ptr->our_clients_count = 0;
+  INIT_LIST_HEAD(&virtualizer_ptr->events);
+  virtualizer_ptr->processing_events = false;
 
   if (!graph_proxy_attach(
         jack_graph_proxy,
         virtualizer_ptr,
         clear,
-        client_appeared,
+        on_client_appeared,
         NULL,                   /* jackdbus does not have client rename functionality (yet) */
-        client_disappeared,
-        port_appeared,
-        port_renamed,
-        port_disappeared,
-        ports_connected,
-        ports_disconnected))
+        on_client_disappeared,
+        on_port_appeared,
+        on_port_renamed,
+        on_port_disappeared,
+        on_ports_connected,
+        on_ports_disconnected))
   {
     free(virtualizer_ptr);
     return false;
@@ -1275,6 +1744,7 @@ ladish_virtualizer_set_graph_connection_handlers(
   ladish_graph_handle graph)
 {
   ladish_graph_set_connection_handlers(graph, virtualizer_ptr, ports_connect_request, ports_disconnect_request);
+  ladish_graph_set_connect_async_handler(graph, ports_connect_async_request);
 }
 
 unsigned int
@@ -1512,15 +1982,33 @@ void
 ladish_virtualizer_destroy(
   ladish_virtualizer_handle handle)
 {
+  struct virtualizer_event * event_ptr;
+
   log_info("ladish_virtualizer_destroy() called");
 
-  graph_proxy_detach((graph_proxy_handle)handle, virtualizer_ptr);
+  graph_proxy_detach(virtualizer_ptr->jack_graph_proxy, virtualizer_ptr);
+
+  /* cancel pending lookups, queued events are dropped together with the JACK graph */
+  while (!list_empty(&virtualizer_ptr->events))
+  {
+    event_ptr = list_entry(virtualizer_ptr->events.next, struct virtualizer_event, siblings);
+    list_del(&event_ptr->siblings);
+    virtualizer_event_destroy(event_ptr);
+  }
+
   free(virtualizer_ptr);
 }
 
 #undef virtualizer_ptr
 
 #define vgraph ((ladish_graph_handle)vgraph_context)
+void
+ladish_virtualizer_autorun_complete(
+  void * vgraph_context)
+{
+  ladish_graph_restore_autorun_complete(vgraph);
+}
+
 void
 ladish_virtualizer_rename_app(
   void * vgraph_context,
@@ -61,6 +61,10 @@ ladish_virtualizer_remove_app(
   const uuid_t app_uuid,
   const char * app_name);
 
+void
+ladish_virtualizer_autorun_complete(
+  void * vgraph_context);
+
 void
 ladish_virtualizer_rename_app(
   void * vgraph_context,
@@ -74,6 +74,21 @@
 #define GRAPH_DICT_OBJECT_TYPE_PORT           2
 #define GRAPH_DICT_OBJECT_TYPE_CONNECTION     3
 
+#define GRAPH_CHANGE_CLIENT_APPEARED          1
+#define GRAPH_CHANGE_CLIENT_DISAPPEARED       2
+#define GRAPH_CHANGE_CLIENT_RENAMED           3
+#define GRAPH_CHANGE_PORT_APPEARED            4
+#define GRAPH_CHANGE_PORT_DISAPPEARED         5
+#define GRAPH_CHANGE_PORT_RENAMED             6
+#define GRAPH_CHANGE_PORTS_CONNECTED          7
+#define GRAPH_CHANGE_PORTS_DISCONNECTED       8
+
+#define GRAPH_MANAGER_OP_CONNECT              1 /* id1 and id2 are ports */
+#define GRAPH_MANAGER_OP_DISCONNECT           2 /* id1 and id2 are ports */
+#define GRAPH_MANAGER_OP_RENAME_CLIENT        3 /* id1 is client */
+#define GRAPH_MANAGER_OP_RENAME_PORT          4 /* id1 is port */
+#define GRAPH_MANAGER_OP_MOVE_PORT            5 /* id1 is port, id2 is the new client */
+
 #define URI_CANVAS_WIDTH    "http://ladish.org/ns/canvas/width"
 #define URI_CANVAS_HEIGHT   "http://ladish.org/ns/canvas/height"
 #define URI_CANVAS_X        "http://ladish.org/ns/canvas/x"
@@ -31,12 +31,22 @@
 #include "../common/catdup.h"
 #include "internal.h"
 
+/* milliseconds, module moves within this time are stored with single call */
+#define STORE_POSITIONS_DELAY 500
+
 struct graph_canvas
 {
   graph_proxy_handle graph;
   canvas_handle canvas;
   void (* fill_menu)(GtkMenu * menu);
   struct list_head clients;
+
+  /* Dict entries fetched with single call when the graph is (re)filled,
+   * "type:id:key" -> value. Dropped when the main loop becomes idle. */
+  GHashTable * dict_cache;
+  guint dict_cache_drop_source;
+
+  guint store_positions_source;
 };
 
 struct client
@@ -48,6 +58,9 @@ struct client
   struct graph_canvas * owner_ptr;
   unsigned int inport_count;
   unsigned int outport_count;
+  bool position_dirty;          /* x and y are not stored yet */
+  double x;
+  double y;
 };
 
 struct port
@@ -132,46 +145,209 @@ disconnect_request(
 #undef port1_ptr
 #undef port2_ptr
 
-#define client_ptr ((struct client *)module_context)
-
-void
-module_location_changed(
-  void * module_context,
-  double x,
-  double y)
+static void store_positions(struct graph_canvas * graph_canvas_ptr)
 {
-  char x_str[100];
-  char y_str[100];
+  struct list_head * node_ptr;
+  struct client * client_ptr;
+  struct graph_proxy_dict_entry * entries;
+  char (* values)[100];
+  unsigned int count;
+  unsigned int i;
   char * locale;
 
-  log_info("module_location_changed(id = %3llu, x = %6.1f, y = %6.1f)", (unsigned long long)client_ptr->id, x, y);
+  count = 0;
+  list_for_each(node_ptr, &graph_canvas_ptr->clients)
+  {
+    client_ptr = list_entry(node_ptr, struct client, siblings);
+    if (client_ptr->position_dirty)
+    {
+      count += 2;
+    }
+  }
 
-  locale = strdup(setlocale(LC_NUMERIC, NULL));
-  if (locale == NULL)
+  if (count == 0)
   {
-    log_error("strdup() failed for locale string");
     return;
   }
 
+  entries = malloc(count * sizeof(struct graph_proxy_dict_entry));
+  values = malloc(count * sizeof(*values));
+  locale = strdup(setlocale(LC_NUMERIC, NULL));
+  if (entries == NULL || values == NULL || locale == NULL)
+  {
+    log_error("memory allocation failed when storing positions of %u modules", count / 2);
+    goto exit;
+  }
+
   setlocale(LC_NUMERIC, "POSIX");
-  sprintf(x_str, "%f", x);
-  sprintf(y_str, "%f", y);
+
+  i = 0;
+  list_for_each(node_ptr, &graph_canvas_ptr->clients)
+  {
+    client_ptr = list_entry(node_ptr, struct client, siblings);
+    if (!client_ptr->position_dirty)
+    {
+      continue;
+    }
+
+    client_ptr->position_dirty = false;
+
+    sprintf(values[i], "%f", client_ptr->x);
+    entries[i].object_type = GRAPH_DICT_OBJECT_TYPE_CLIENT;
+    entries[i].object_id = client_ptr->id;
+    entries[i].key = URI_CANVAS_X;
+    entries[i].value = values[i];
+    i++;
+
+    sprintf(values[i], "%f", client_ptr->y);
+    entries[i].object_type = GRAPH_DICT_OBJECT_TYPE_CLIENT;
+    entries[i].object_id = client_ptr->id;
+    entries[i].key = URI_CANVAS_Y;
+    entries[i].value = values[i];
+    i++;
+  }
+
   setlocale(LC_NUMERIC, locale);
+
+  if (!graph_proxy_dict_set_many(graph_canvas_ptr->graph, entries, count))
+  {
+    /* daemon without SetMany() */
+    for (i = 0; i < count; i++)
+    {
+      graph_proxy_dict_entry_set(graph_canvas_ptr->graph, entries[i].object_type, entries[i].object_id, entries[i].key, entries[i].value);
+    }
+  }
+
+exit:
   free(locale);
+  free(values);
+  free(entries);
+}
 
-  graph_proxy_dict_entry_set(
-    client_ptr->owner_ptr->graph,
-    GRAPH_DICT_OBJECT_TYPE_CLIENT,
-    client_ptr->id,
-    URI_CANVAS_X,
-    x_str);
+static gboolean store_positions_timeout(gpointer graph_canvas)
+{
+  ((struct graph_canvas *)graph_canvas)->store_positions_source = 0;
+  store_positions(graph_canvas);
+  return FALSE;
+}
+
+static void store_positions_now(struct graph_canvas * graph_canvas_ptr)
+{
+  if (graph_canvas_ptr->store_positions_source != 0)
+  {
+    g_source_remove(graph_canvas_ptr->store_positions_source);
+    graph_canvas_ptr->store_positions_source = 0;
+    store_positions(graph_canvas_ptr);
+  }
+}
 
-  graph_proxy_dict_entry_set(
-    client_ptr->owner_ptr->graph,
-    GRAPH_DICT_OBJECT_TYPE_CLIENT,
-    client_ptr->id,
-    URI_CANVAS_Y,
-    y_str);
+static void dict_cache_drop(struct graph_canvas * graph_canvas_ptr)
+{
+  if (graph_canvas_ptr->dict_cache_drop_source != 0)
+  {
+    g_source_remove(graph_canvas_ptr->dict_cache_drop_source);
+    graph_canvas_ptr->dict_cache_drop_source = 0;
+  }
+
+  if (graph_canvas_ptr->dict_cache != NULL)
+  {
+    g_hash_table_destroy(graph_canvas_ptr->dict_cache);
+    graph_canvas_ptr->dict_cache = NULL;
+  }
+}
+
+static gboolean dict_cache_drop_idle(gpointer graph_canvas)
+{
+  ((struct graph_canvas *)graph_canvas)->dict_cache_drop_source = 0;
+  dict_cache_drop(graph_canvas);
+  return FALSE;
+}
+
+static void dict_cache_fill(void * graph_canvas, const struct graph_proxy_dict_entry * entry_ptr)
+{
+  g_hash_table_insert(
+    ((struct graph_canvas *)graph_canvas)->dict_cache,
+    g_strdup_printf("%"PRIu32":%"PRIu64":%s", entry_ptr->object_type, entry_ptr->object_id, entry_ptr->key),
+    g_strdup(entry_ptr->value));
+}
+
+/* Called before the graph is filled, the clients and ports that will
+ * appear next get their dict entries from the cache instead of D-Bus */
+static void dict_cache_prefetch(struct graph_canvas * graph_canvas_ptr)
+{
+  static const char * const keys[] = {URI_CANVAS_X, URI_CANVAS_Y, URI_A2J_PORT};
+
+  dict_cache_drop(graph_canvas_ptr);
+
+  graph_canvas_ptr->dict_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+  if (!graph_proxy_dict_get_many(graph_canvas_ptr->graph, keys, sizeof(keys) / sizeof(keys[0]), graph_canvas_ptr, dict_cache_fill))
+  {
+    /* daemon without GetMany(), query the entries one by one */
+    dict_cache_drop(graph_canvas_ptr);
+    return;
+  }
+
+  graph_canvas_ptr->dict_cache_drop_source = g_idle_add(dict_cache_drop_idle, graph_canvas_ptr);
+}
+
+static
+bool
+dict_entry_get(
+  struct graph_canvas * graph_canvas_ptr,
+  uint32_t object_type,
+  uint64_t object_id,
+  const char * key,
+  char ** value_ptr_ptr)
+{
+  char * cache_key;
+  const char * value;
+
+  if (graph_canvas_ptr->dict_cache == NULL)
+  {
+    return graph_proxy_dict_entry_get(graph_canvas_ptr->graph, object_type, object_id, key, value_ptr_ptr);
+  }
+
+  cache_key = g_strdup_printf("%"PRIu32":%"PRIu64":%s", object_type, object_id, key);
+  value = g_hash_table_lookup(graph_canvas_ptr->dict_cache, cache_key);
+  g_free(cache_key);
+
+  if (value == NULL)
+  {
+    return false;
+  }
+
+  *value_ptr_ptr = strdup(value);
+  if (*value_ptr_ptr == NULL)
+  {
+    log_error("strdup() failed for dict value");
+    return false;
+  }
+
+  return true;
+}
+
+#define client_ptr ((struct client *)module_context)
+
+void
+module_location_changed(
+  void * module_context,
+  double x,
+  double y)
+{
+  struct graph_canvas * graph_canvas_ptr;
+
+  log_info("module_location_changed(id = %3llu, x = %6.1f, y = %6.1f)", (unsigned long long)client_ptr->id, x, y);
+
+  client_ptr->x = x;
+  client_ptr->y = y;
+  client_ptr->position_dirty = true;
+
+  graph_canvas_ptr = client_ptr->owner_ptr;
+  if (graph_canvas_ptr->store_positions_source == 0)
+  {
+    graph_canvas_ptr->store_positions_source = g_timeout_add(STORE_POSITIONS_DELAY, store_positions_timeout, graph_canvas_ptr);
+  }
 }
 
 static void on_popup_menu_action_client_rename(GtkWidget * UNUSED(menuitem), gpointer module_context)
@@ -382,6 +558,9 @@ graph_canvas_create(
 
   graph_canvas_ptr->graph = NULL;
   INIT_LIST_HEAD(&graph_canvas_ptr->clients);
+  graph_canvas_ptr->dict_cache = NULL;
+  graph_canvas_ptr->dict_cache_drop_source = 0;
+  graph_canvas_ptr->store_positions_source = 0;
 
   *graph_canvas_handle_ptr = (graph_canvas_handle)graph_canvas_ptr;
 
@@ -396,7 +575,9 @@ clear(
   void * graph_canvas)
 {
   log_info("canvas::clear()");
+  store_positions_now(graph_canvas_ptr);
   canvas_clear(graph_canvas_ptr->canvas);
+  dict_cache_prefetch(graph_canvas_ptr);
 }
 
 static
@@ -432,12 +613,13 @@ client_appeared(
   client_ptr->outport_count = 0;
   INIT_LIST_HEAD(&client_ptr->ports);
   client_ptr->owner_ptr = graph_canvas_ptr;
+  client_ptr->position_dirty = false;
 
   x = 0;
   y = 0;
 
-  if (!graph_proxy_dict_entry_get(
-        client_ptr->owner_ptr->graph,
+  if (!dict_entry_get(
+        graph_canvas_ptr,
         GRAPH_DICT_OBJECT_TYPE_CLIENT,
         id,
         URI_CANVAS_X,
@@ -447,8 +629,8 @@ client_appeared(
     x = width / 2 - 200 + rand() % 300;
   }
 
-  if (!graph_proxy_dict_entry_get(
-        client_ptr->owner_ptr->graph,
+  if (!dict_entry_get(
+        graph_canvas_ptr,
         GRAPH_DICT_OBJECT_TYPE_CLIENT,
         id,
         URI_CANVAS_Y,
@@ -593,8 +775,8 @@ port_appeared(
     color = 0x244678C0;
   }
 
-  if (!graph_proxy_dict_entry_get(
-        client_ptr->owner_ptr->graph,
+  if (!dict_entry_get(
+        graph_canvas_ptr,
         GRAPH_DICT_OBJECT_TYPE_PORT,
         port_id,
         URI_A2J_PORT,
@@ -860,6 +1042,8 @@ graph_canvas_detach(
   graph_canvas_handle graph_canvas)
 {
   ASSERT(graph_canvas_ptr->graph != NULL);
+  store_positions_now(graph_canvas_ptr);
+  dict_cache_drop(graph_canvas_ptr);
   graph_proxy_detach(graph_canvas_ptr->graph, graph_canvas);
   graph_canvas_ptr->graph = NULL;
 }
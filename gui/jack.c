@@ -35,6 +35,7 @@
 #include "../proxies/jack_proxy.h"
 #include "../proxies/a2j_proxy.h"
 #include "../proxies/conf_proxy.h"
+#include "../proxies/control_proxy.h"
 #include "gtk_builder.h"
 #include "ask_dialog.h"
 
@@ -45,12 +46,12 @@
 
 unsigned int g_jack_state = JACK_STATE_NA;
 static uint32_t g_xruns;
+static uint32_t g_dsp_load;     /* last reported by the daemon, in percents rounded to a multiple of 5 */
 static double g_jack_max_dsp_load = 0.0;
 static GtkWidget * g_xrun_progress_bar;
 static uint32_t g_sample_rate;
 static bool g_jack_view_enabled = false;
 static graph_view_handle g_jack_view = NULL;
-static guint g_jack_poll_source_tag;
 
 static void update_raw_jack_visibility(void)
 {
@@ -113,45 +114,27 @@ static void update_buffer_size(bool force)
   }
 }
 
-static void update_load(void)
+static void update_load(uint32_t xruns, uint32_t load)
 {
-  double load;
   char tmp_buf[100];
-  uint32_t xruns;
 
-  if (jack_proxy_get_xruns(&xruns))
-  {
-    snprintf(tmp_buf, sizeof(tmp_buf),
-             ngettext("%"PRIu32" dropout",
-                      "%"PRIu32" dropouts",
-                      xruns), xruns);
+  snprintf(tmp_buf, sizeof(tmp_buf),
+           ngettext("%"PRIu32" dropout",
+                    "%"PRIu32" dropouts",
+                    xruns), xruns);
 
-    set_xruns_text(tmp_buf);
-    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(g_xrun_progress_bar), tmp_buf);
-  }
-  else
-  {
-    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(g_xrun_progress_bar), _("error"));
-    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(g_xrun_progress_bar), 0.0);
-    set_xruns_text("?");
-  }
-
-  if (jack_proxy_get_dsp_load(&load))
-  {
-    if (load > g_jack_max_dsp_load)
-    {
-      g_jack_max_dsp_load = load;
-      gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(g_xrun_progress_bar), load / 100.0);
-    }
+  set_xruns_text(tmp_buf);
+  gtk_progress_bar_set_text(GTK_PROGRESS_BAR(g_xrun_progress_bar), tmp_buf);
 
-    snprintf(tmp_buf, sizeof(tmp_buf), _("DSP: %5.1f%% (%5.1f%%)"), (float)load, (float)g_jack_max_dsp_load);
-    set_dsp_load_text(tmp_buf);
-  }
-  else
+  if (load > g_jack_max_dsp_load)
   {
-    set_xruns_text("?");
+    g_jack_max_dsp_load = load;
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(g_xrun_progress_bar), load / 100.0);
   }
 
+  snprintf(tmp_buf, sizeof(tmp_buf), _("DSP: %5.1f%% (%5.1f%%)"), (float)load, (float)g_jack_max_dsp_load);
+  set_dsp_load_text(tmp_buf);
+
   if ((g_xruns == 0 && xruns != 0) || (g_xruns != 0 && xruns == 0))
   {
     g_xruns = xruns;
@@ -163,12 +146,11 @@ static void update_load(void)
   }
 }
 
-static gboolean poll_jack(gpointer UNUSED(data))
+static void on_jack_status_changed(void * UNUSED(context), uint32_t xruns, uint32_t buffer_size, uint32_t dsp_load)
 {
-  update_load();
-  update_buffer_size(false);
-
-  return TRUE;
+  g_dsp_load = dsp_load;
+  update_load(xruns, dsp_load);
+  buffer_size_set(buffer_size, false);
 }
 
 static void jack_appeared(void)
@@ -191,7 +173,8 @@ static void jack_started(void)
   update_buffer_size(true);
   enable_action(g_clear_xruns_and_max_dsp_action);
 
-  g_jack_poll_source_tag = g_timeout_add(100, poll_jack, NULL);
+  /* the daemon samples JACK and reports only changes */
+  control_proxy_subscribe_jack_status(NULL, on_jack_status_changed);
 }
 
 static void jack_stopped(void)
@@ -200,7 +183,7 @@ static void jack_stopped(void)
   {
     log_info("JACK stopped");
 
-    g_source_remove(g_jack_poll_source_tag);
+    control_proxy_unsubscribe_jack_status();
   }
 
   g_jack_state = JACK_STATE_STOPPED;
@@ -228,6 +211,9 @@ void clear_xruns_and_max_dsp(void)
   log_info("clearing xruns and max dsp load");
   jack_proxy_reset_xruns();
   g_jack_max_dsp_load = 0.0;
+
+  /* the daemon reports only changes, refresh the display now */
+  update_load(0, g_dsp_load);
 }
 
 void menu_request_jack_latency_change(uint32_t buffer_size)
@@ -28,94 +28,405 @@
 
 #include <unistd.h>
 #include <signal.h>
+#include <math.h>
+#include <float.h>
 #include <jack/jack.h>
 #include <jack/midiport.h>
 
 #include "cdbus/helpers.h"
 #include "dbus_constants.h"
+#include "jmcore_copy.h"
 
 extern const struct cdbus_interface_descriptor g_interface;
 
+/* how long to wait for the realtime thread before registering ports
+ * with names of just destroyed pairs, a cycle is normally much shorter */
+#define JMCORE_RECLAIM_WAIT_STEP 1000 /* microseconds */
+#define JMCORE_RECLAIM_WAIT_STEPS 1000
+
 static const char * g_dbus_unique_name;
 static cdbus_object_path g_object;
 static bool g_quit;
-static unsigned int g_unique_index;
 
-struct list_head g_pairs;
+/* All pairs are served by a single JACK client. The list of pairs is owned
+ * by the main (D-Bus) thread. The realtime thread sees them through an
+ * immutable table that is replaced, never modified, when pairs are created
+ * or destroyed. Old tables (and the pairs removed with them) are freed only
+ * after the realtime thread is known to no longer use them. */
 
 struct port_pair
 {
   struct list_head siblings;
-  jack_client_t * client;
-  bool dead;
   bool midi;
+  float gain;                           /* audio only */
+  bool flush_denormals;                 /* audio only, also flushed when gain is not 1.0 */
+  bool tied;                            /* audio only, output buffer is the input buffer */
   jack_port_t * input_port;
   jack_port_t * output_port;
   char * input_port_name;
   char * output_port_name;
 };
 
-#define pair_ptr ((struct port_pair *)arg)
+/* what the realtime thread needs to know about a pair */
+struct pair_table_entry
+{
+  jack_port_t * input_port;
+  jack_port_t * output_port;
+  float gain;
+  bool flush_denormals;
+};
 
-void shutdown_callback(void * arg)
+struct pair_table
 {
-  pair_ptr->dead = true;
+  struct list_head siblings;            /* link in g_retired_tables */
+  unsigned int sequence;                /* g_rt_sequence when the table was retired */
+  struct list_head retired_pairs;       /* pairs that were removed by the table swap */
+  unsigned int audio_count;             /* audio entries come first, tied pairs are not in the table */
+  unsigned int midi_count;
+  struct pair_table_entry entries[];
+};
+
+static struct list_head g_pairs;
+static struct list_head g_retired_tables;
+static jack_client_t * g_client;
+static struct pair_table * g_table;     /* table used by the realtime thread */
+static unsigned int g_rt_sequence;      /* odd while the process callback runs */
+static bool g_jack_dead;
+
+void shutdown_callback(void * UNUSED(arg))
+{
+  __atomic_store_n(&g_jack_dead, true, __ATOMIC_SEQ_CST);
 }
 
-int process_callback(jack_nframes_t nframes, void * arg)
+/* JACK has no call that copies a whole midi buffer (its layout is private
+ * to the JACK implementation), so events are forwarded one by one. */
+static void copy_midi(void * output, void * input)
 {
-  void * input;
-  void * output;
   jack_midi_event_t midi_event;
-  jack_nframes_t midi_event_index;
+  uint32_t midi_event_count;
+  uint32_t midi_event_index;
+  jack_midi_data_t * buffer;
 
-  input = jack_port_get_buffer(pair_ptr->input_port, nframes);
-  output = jack_port_get_buffer(pair_ptr->output_port, nframes);
+  jack_midi_clear_buffer(output);
 
-  if (!pair_ptr->midi)
+  midi_event_count = jack_midi_get_event_count(input);
+  for (midi_event_index = 0; midi_event_index < midi_event_count; midi_event_index++)
   {
-    memcpy(output, input, nframes * sizeof(jack_default_audio_sample_t));
+    if (jack_midi_event_get(&midi_event, input, midi_event_index) != 0)
+    {
+      break;
+    }
+
+    buffer = jack_midi_event_reserve(output, midi_event.time, midi_event.size);
+    if (buffer == NULL)
+    {
+      break;                    /* output buffer is full */
+    }
+
+    memcpy(buffer, midi_event.buffer, midi_event.size);
   }
-  else
+}
+
+int process_callback(jack_nframes_t nframes, void * UNUSED(arg))
+{
+  struct pair_table * table_ptr;
+  struct pair_table_entry * entry_ptr;
+  struct pair_table_entry * audio_end_ptr;
+  struct pair_table_entry * midi_end_ptr;
+
+  __atomic_add_fetch(&g_rt_sequence, 1, __ATOMIC_SEQ_CST);
+
+  table_ptr = __atomic_load_n(&g_table, __ATOMIC_SEQ_CST);
+  if (table_ptr != NULL)
   {
-    jack_midi_clear_buffer(output);
-    midi_event_index = 0;
-    while (jack_midi_event_get(&midi_event, input, midi_event_index) == 0)
+    audio_end_ptr = table_ptr->entries + table_ptr->audio_count;
+    midi_end_ptr = audio_end_ptr + table_ptr->midi_count;
+
+    for (entry_ptr = table_ptr->entries; entry_ptr < audio_end_ptr; entry_ptr++)
+    {
+      forward_audio(
+        jack_port_get_buffer(entry_ptr->output_port, nframes),
+        jack_port_get_buffer(entry_ptr->input_port, nframes),
+        nframes,
+        entry_ptr->gain,
+        entry_ptr->flush_denormals);
+    }
+
+    for (; entry_ptr < midi_end_ptr; entry_ptr++)
     {
-      jack_midi_event_write(output, midi_event.time, midi_event.buffer, midi_event.size);
-      midi_event_index++;
+      copy_midi(
+        jack_port_get_buffer(entry_ptr->output_port, nframes),
+        jack_port_get_buffer(entry_ptr->input_port, nframes));
     }
   }
 
+  __atomic_add_fetch(&g_rt_sequence, 1, __ATOMIC_SEQ_CST);
+
   return 0;
 }
 
-#undef pair_ptr
-
 static void destroy_pair(struct port_pair * pair_ptr)
 {
-  list_del(&pair_ptr->siblings);
-  jack_client_close(pair_ptr->client);
+  /* when the client is already closed, its ports are gone too */
+  if (g_client != NULL)
+  {
+    jack_port_unregister(g_client, pair_ptr->output_port);
+    jack_port_unregister(g_client, pair_ptr->input_port);
+  }
+
   free(pair_ptr->input_port_name);
   free(pair_ptr->output_port_name);
   free(pair_ptr);
 }
 
-static void bury_zombie_pairs(void)
+static void destroy_pairs(struct list_head * pairs)
+{
+  struct port_pair * pair_ptr;
+
+  while (!list_empty(pairs))
+  {
+    pair_ptr = list_entry(pairs->next, struct port_pair, siblings);
+    list_del(&pair_ptr->siblings);
+    destroy_pair(pair_ptr);
+  }
+}
+
+static void free_table(struct pair_table * table_ptr)
+{
+  destroy_pairs(&table_ptr->retired_pairs);
+  free(table_ptr);
+}
+
+/* free retired tables that cannot be in use by the realtime thread anymore */
+static void reclaim_retired_tables(bool force)
 {
   struct list_head * node_ptr;
   struct list_head * temp_node_ptr;
+  struct pair_table * table_ptr;
+  unsigned int sequence;
+
+  sequence = __atomic_load_n(&g_rt_sequence, __ATOMIC_SEQ_CST);
+
+  list_for_each_safe(node_ptr, temp_node_ptr, &g_retired_tables)
+  {
+    table_ptr = list_entry(node_ptr, struct pair_table, siblings);
+
+    /* The process callback was either not running at the time of the swap,
+     * or it has finished the cycle that could have seen the old table */
+    if (force || (table_ptr->sequence & 1) == 0 || table_ptr->sequence != sequence)
+    {
+      list_del(&table_ptr->siblings);
+      free_table(table_ptr);
+    }
+  }
+}
+
+/* Wait for the realtime thread to leave the cycle that could use the retired
+ * tables and free them. The JACK ports of the retired pairs are unregistered
+ * then, so their names can be registered again. */
+static void wait_retired_tables(void)
+{
+  unsigned int i;
+
+  for (i = 0; i < JMCORE_RECLAIM_WAIT_STEPS; i++)
+  {
+    reclaim_retired_tables(false);
+    if (list_empty(&g_retired_tables))
+    {
+      return;
+    }
+
+    usleep(JMCORE_RECLAIM_WAIT_STEP);
+  }
+
+  log_error("realtime thread did not finish its cycle, ports of destroyed pairs are still registered");
+}
+
+static
+void
+fill_table_entry(
+  struct pair_table * table_ptr,
+  struct port_pair * pair_ptr)
+{
+  struct pair_table_entry * entry_ptr;
+
+  entry_ptr = table_ptr->entries + table_ptr->audio_count + table_ptr->midi_count;
+  entry_ptr->input_port = pair_ptr->input_port;
+  entry_ptr->output_port = pair_ptr->output_port;
+  entry_ptr->gain = pair_ptr->gain;
+  entry_ptr->flush_denormals = pair_ptr->flush_denormals;
+}
+
+/* Make a table from the current pairs and atomically replace the table used by the
+ * realtime thread with it. The removed pairs, if any, must be already out of g_pairs.
+ * They will be destroyed together with the old table. On failure they are left in
+ * the removed_pairs list. */
+static bool swap_table(struct list_head * removed_pairs)
+{
+  struct pair_table * old_table_ptr;
+  struct pair_table * new_table_ptr;
+  struct list_head * node_ptr;
+  struct port_pair * pair_ptr;
+  unsigned int count;
+
+  count = 0;
+  list_for_each(node_ptr, &g_pairs)
+  {
+    count++;
+  }
+
+  new_table_ptr = malloc(sizeof(struct pair_table) + count * sizeof(struct pair_table_entry));
+  if (new_table_ptr == NULL)
+  {
+    log_error("malloc() failed for pair table with %u pairs", count);
+    return false;
+  }
+
+  INIT_LIST_HEAD(&new_table_ptr->retired_pairs);
+  new_table_ptr->audio_count = 0;
+  new_table_ptr->midi_count = 0;
+
+  /* batch audio pairs first, then midi ones */
+  list_for_each(node_ptr, &g_pairs)
+  {
+    pair_ptr = list_entry(node_ptr, struct port_pair, siblings);
+    if (!pair_ptr->midi && !pair_ptr->tied)
+    {
+      fill_table_entry(new_table_ptr, pair_ptr);
+      new_table_ptr->audio_count++;
+    }
+  }
+
+  list_for_each(node_ptr, &g_pairs)
+  {
+    pair_ptr = list_entry(node_ptr, struct port_pair, siblings);
+    if (pair_ptr->midi)
+    {
+      fill_table_entry(new_table_ptr, pair_ptr);
+      new_table_ptr->midi_count++;
+    }
+  }
+
+  old_table_ptr = g_table;
+  __atomic_store_n(&g_table, new_table_ptr, __ATOMIC_SEQ_CST);
+
+  if (old_table_ptr != NULL)
+  {
+    old_table_ptr->sequence = __atomic_load_n(&g_rt_sequence, __ATOMIC_SEQ_CST);
+    if (removed_pairs != NULL)
+    {
+      list_splice_init(removed_pairs, &old_table_ptr->retired_pairs);
+    }
+    list_add_tail(&old_table_ptr->siblings, &g_retired_tables);
+  }
+  else
+  {
+    ASSERT(removed_pairs == NULL || list_empty(removed_pairs));
+  }
+
+  reclaim_retired_tables(false);
+
+  return true;
+}
+
+static struct port_pair * find_pair(const char * port)
+{
+  struct list_head * node_ptr;
   struct port_pair * pair_ptr;
 
-  list_for_each_safe(node_ptr, temp_node_ptr, &g_pairs)
+  list_for_each(node_ptr, &g_pairs)
   {
     pair_ptr = list_entry(node_ptr, struct port_pair, siblings);
-    if (pair_ptr->dead)
+    if (strcmp(pair_ptr->input_port_name, port) == 0 ||
+        strcmp(pair_ptr->output_port_name, port) == 0)
+    {
+      return pair_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+static bool open_jack_client(void)
+{
+  int ret;
+
+  if (g_client != NULL)
+  {
+    return true;
+  }
+
+  g_client = jack_client_open("jmcore", JackNoStartServer, NULL);
+  if (g_client == NULL)
+  {
+    log_error("Cannot connect to JACK server");
+    return false;
+  }
+
+  g_jack_dead = false;
+
+  ret = jack_set_process_callback(g_client, process_callback, NULL);
+  if (ret != 0)
+  {
+    log_error("JACK process callback setup failed");
+    goto close;
+  }
+
+  jack_on_shutdown(g_client, shutdown_callback, NULL);
+
+  ret = jack_activate(g_client);
+  if (ret != 0)
+  {
+    log_error("JACK client activation failed");
+    goto close;
+  }
+
+  return true;
+
+close:
+  jack_client_close(g_client);
+  g_client = NULL;
+  return false;
+}
+
+static void close_jack_client(void)
+{
+  if (g_client == NULL)
+  {
+    return;
+  }
+
+  /* jack_client_close() waits the realtime thread to stop and frees all ports */
+  jack_client_close(g_client);
+  g_client = NULL;
+
+  reclaim_retired_tables(true);
+
+  if (g_table != NULL)
+  {
+    free(g_table);
+    g_table = NULL;
+  }
+
+  destroy_pairs(&g_pairs);
+}
+
+static void run(void)
+{
+  if (g_client != NULL)
+  {
+    if (__atomic_load_n(&g_jack_dead, __ATOMIC_SEQ_CST))
+    {
+      log_info("JACK server shut down, burying all pairs");
+      close_jack_client();
+    }
+    else if (list_empty(&g_pairs))
     {
-      log_info("Bury zombie '%s':'%s'", pair_ptr->input_port_name, pair_ptr->output_port_name);
-      destroy_pair(pair_ptr);
+      close_jack_client();
     }
   }
+
+  reclaim_retired_tables(false);
 }
 
 static bool connect_dbus(void)
@@ -211,6 +522,7 @@ bool install_term_signal_handler(int signum, bool ignore_if_already_ignored)
 int main(int UNUSED(argc), char ** UNUSED(argv))
 {
   INIT_LIST_HEAD(&g_pairs);
+  INIT_LIST_HEAD(&g_retired_tables);
 
   install_term_signal_handler(SIGTERM, false);
   install_term_signal_handler(SIGINT, true);
@@ -224,13 +536,10 @@ int main(int UNUSED(argc), char ** UNUSED(argv))
   while (!g_quit)
   {
     dbus_connection_read_write_dispatch(cdbus_g_dbus_connection, 50);
-    bury_zombie_pairs();
+    run();
   }
 
-  while (!list_empty(&g_pairs))
-  {
-    destroy_pair(list_entry(g_pairs.next, struct port_pair, siblings));
-  }
+  close_jack_client();
 
   disconnect_dbus();
   return 0;
@@ -248,37 +557,22 @@ static void jmcore_get_pid(struct cdbus_method_call * call_ptr)
   cdbus_method_return_new_single(call_ptr, DBUS_TYPE_INT64, &pid);
 }
 
-static void jmcore_create(struct cdbus_method_call * call_ptr)
+/* Register the ports of a new pair. On failure, the D-Bus error is set and NULL is returned. */
+static
+struct port_pair *
+create_pair(
+  struct cdbus_method_call * call_ptr,
+  bool midi,
+  const char * input,
+  const char * output)
 {
-  dbus_bool_t midi;
-  const char * input;
-  const char * output;
   struct port_pair * pair_ptr;
-  int ret;
-  char client_name[256];
-
-  g_unique_index++;
-  sprintf(client_name, "jmcore-%u", g_unique_index);
-
-  dbus_error_init(&cdbus_g_dbus_error);
-  if (!dbus_message_get_args(
-        call_ptr->message,
-        &cdbus_g_dbus_error,
-        DBUS_TYPE_BOOLEAN, &midi,
-        DBUS_TYPE_STRING, &input,
-        DBUS_TYPE_STRING, &output,
-        DBUS_TYPE_INVALID))
-  {
-    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": %s",  call_ptr->method_name, cdbus_g_dbus_error.message);
-    dbus_error_free(&cdbus_g_dbus_error);
-    goto exit;
-  }
 
   pair_ptr = malloc(sizeof(struct port_pair));
   if (pair_ptr == NULL)
   {
     cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Allocation of port pair structure failed");
-    goto exit;
+    goto fail;
   }
 
   pair_ptr->input_port_name = strdup(input);
@@ -289,80 +583,168 @@ static void jmcore_create(struct cdbus_method_call * call_ptr)
   }
 
   pair_ptr->output_port_name = strdup(output);
-  if (pair_ptr->input_port_name == NULL)
+  if (pair_ptr->output_port_name == NULL)
   {
     cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Allocation of port name buffer failed");
     goto free_input_name;
   }
 
-  pair_ptr->client = jack_client_open(client_name, JackNoStartServer, NULL);
-  if (pair_ptr->client == NULL)
+  if (!open_jack_client())
   {
     cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Cannot connect to JACK server");
     goto free_output_name;
   }
 
   pair_ptr->midi = midi;
-  pair_ptr->dead = false;
-
-  ret = jack_set_process_callback(pair_ptr->client, process_callback, pair_ptr);
-  if (ret != 0)
-  {
-    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "JACK process callback setup failed");
-    goto close_client;
-  }
+  pair_ptr->gain = 1.0;
+  pair_ptr->flush_denormals = false;
+  pair_ptr->tied = false;
 
-  jack_on_shutdown(pair_ptr->client, shutdown_callback, pair_ptr);
+  /* a pair that was just destroyed may still hold the port names */
+  wait_retired_tables();
 
-  pair_ptr->input_port = jack_port_register(pair_ptr->client, input, midi ? JACK_DEFAULT_MIDI_TYPE : JACK_DEFAULT_AUDIO_TYPE, JackPortIsInput, 0);
+  pair_ptr->input_port = jack_port_register(g_client, input, midi ? JACK_DEFAULT_MIDI_TYPE : JACK_DEFAULT_AUDIO_TYPE, JackPortIsInput, 0);
   if (pair_ptr->input_port == NULL)
   {
     cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Port '%s' registration failed.", input);
     goto free_output_name;
   }
 
-  pair_ptr->output_port = jack_port_register(pair_ptr->client, output, midi ? JACK_DEFAULT_MIDI_TYPE : JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0);
-  if (pair_ptr->input_port == NULL)
+  pair_ptr->output_port = jack_port_register(g_client, output, midi ? JACK_DEFAULT_MIDI_TYPE : JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0);
+  if (pair_ptr->output_port == NULL)
   {
     cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Port '%s' registration failed.", output);
     goto unregister_input_port;
   }
 
-  list_add_tail(&pair_ptr->siblings, &g_pairs);
+  return pair_ptr;
 
-  ret = jack_activate(pair_ptr->client);
-  if (ret != 0)
-  {
-    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "JACK client activation failed");
-    goto remove_from_list;
-  }
-
-  cdbus_method_return_new_void(call_ptr);
-  goto exit;
-
-remove_from_list:
-  list_del(&pair_ptr->siblings);
-//unregister_output_port:
-  jack_port_unregister(pair_ptr->client, pair_ptr->output_port);
 unregister_input_port:
-  jack_port_unregister(pair_ptr->client, pair_ptr->input_port);
-close_client:
-  jack_client_close(pair_ptr->client);
+  jack_port_unregister(g_client, pair_ptr->input_port);
 free_output_name:
   free(pair_ptr->output_port_name);
 free_input_name:
   free(pair_ptr->input_port_name);
 free_pair:
   free(pair_ptr);
-exit:
-  return;
+fail:
+  return NULL;
+}
+
+static void jmcore_create(struct cdbus_method_call * call_ptr)
+{
+  dbus_bool_t midi;
+  const char * input;
+  const char * output;
+  struct port_pair * pair_ptr;
+
+  dbus_error_init(&cdbus_g_dbus_error);
+  if (!dbus_message_get_args(
+        call_ptr->message,
+        &cdbus_g_dbus_error,
+        DBUS_TYPE_BOOLEAN, &midi,
+        DBUS_TYPE_STRING, &input,
+        DBUS_TYPE_STRING, &output,
+        DBUS_TYPE_INVALID))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": %s",  call_ptr->method_name, cdbus_g_dbus_error.message);
+    dbus_error_free(&cdbus_g_dbus_error);
+    return;
+  }
+
+  pair_ptr = create_pair(call_ptr, midi, input, output);
+  if (pair_ptr == NULL)
+  {
+    return;
+  }
+
+  list_add_tail(&pair_ptr->siblings, &g_pairs);
+
+  if (!swap_table(NULL))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Allocation of pair table failed");
+    list_del(&pair_ptr->siblings);
+    destroy_pair(pair_ptr);
+    return;
+  }
+
+  cdbus_method_return_new_void(call_ptr);
+}
+
+/* Create all pairs or none of them. The realtime thread gets them all with a single table swap. */
+static void jmcore_create_many(struct cdbus_method_call * call_ptr)
+{
+  DBusMessageIter iter;
+  DBusMessageIter array_iter;
+  DBusMessageIter struct_iter;
+  struct list_head pairs;
+  dbus_bool_t midi;
+  const char * input;
+  const char * output;
+  struct port_pair * pair_ptr;
+  unsigned int count;
+
+  if (strcmp(dbus_message_get_signature(call_ptr->message), "a(bss)") != 0)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": signature is not \"a(bss)\"",  call_ptr->method_name);
+    return;
+  }
+
+  INIT_LIST_HEAD(&pairs);
+  count = 0;
+
+  dbus_message_iter_init(call_ptr->message, &iter);
+
+  for (dbus_message_iter_recurse(&iter, &array_iter);
+       dbus_message_iter_get_arg_type(&array_iter) != DBUS_TYPE_INVALID;
+       dbus_message_iter_next(&array_iter))
+  {
+    dbus_message_iter_recurse(&array_iter, &struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &midi);
+    dbus_message_iter_next(&struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &input);
+    dbus_message_iter_next(&struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &output);
+
+    pair_ptr = create_pair(call_ptr, midi, input, output);
+    if (pair_ptr == NULL)
+    {
+      destroy_pairs(&pairs);
+      return;
+    }
+
+    list_add_tail(&pair_ptr->siblings, &pairs);
+    count++;
+  }
+
+  list_splice_init(&pairs, g_pairs.prev);
+
+  if (!swap_table(NULL))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Allocation of pair table failed");
+
+    /* the new pairs are at the end of the list */
+    while (count > 0)
+    {
+      list_move(g_pairs.prev, &pairs);
+      count--;
+    }
+
+    destroy_pairs(&pairs);
+    return;
+  }
+
+  cdbus_method_return_new_void(call_ptr);
 }
 
 static void jmcore_destroy(struct cdbus_method_call * call_ptr)
 {
   const char * port;
-  struct list_head * node_ptr;
   struct port_pair * pair_ptr;
+  struct list_head removed_pairs;
 
   dbus_error_init(&cdbus_g_dbus_error);
   if (!dbus_message_get_args(call_ptr->message, &cdbus_g_dbus_error, DBUS_TYPE_STRING, &port, DBUS_TYPE_INVALID))
@@ -372,20 +754,239 @@ static void jmcore_destroy(struct cdbus_method_call * call_ptr)
     return;
   }
 
-  list_for_each(node_ptr, &g_pairs)
+  pair_ptr = find_pair(port);
+  if (pair_ptr == NULL)
   {
-    pair_ptr = list_entry(node_ptr, struct port_pair, siblings);
-    if (strcmp(pair_ptr->input_port_name, port) == 0 ||
-        strcmp(pair_ptr->output_port_name, port) == 0)
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "port '%s' not found.", port);
+    return;
+  }
+
+  list_del(&pair_ptr->siblings);
+  INIT_LIST_HEAD(&removed_pairs);
+  list_add_tail(&pair_ptr->siblings, &removed_pairs);
+
+  /* the pair is destroyed when the retired table is reclaimed,
+   * at latest when ports are registered again */
+  if (!swap_table(&removed_pairs))
+  {
+    list_splice_init(&removed_pairs, g_pairs.prev);
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Allocation of pair table failed");
+    return;
+  }
+
+  cdbus_method_return_new_void(call_ptr);
+}
+
+/* Ports that are not found are logged and skipped, so a partially linked room can still be stopped */
+static void jmcore_destroy_many(struct cdbus_method_call * call_ptr)
+{
+  DBusMessageIter iter;
+  DBusMessageIter array_iter;
+  struct list_head removed_pairs;
+  const char * port;
+  struct port_pair * pair_ptr;
+
+  if (strcmp(dbus_message_get_signature(call_ptr->message), "as") != 0)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": signature is not \"as\"",  call_ptr->method_name);
+    return;
+  }
+
+  INIT_LIST_HEAD(&removed_pairs);
+
+  dbus_message_iter_init(call_ptr->message, &iter);
+
+  for (dbus_message_iter_recurse(&iter, &array_iter);
+       dbus_message_iter_get_arg_type(&array_iter) != DBUS_TYPE_INVALID;
+       dbus_message_iter_next(&array_iter))
+  {
+    dbus_message_iter_get_basic(&array_iter, &port);
+
+    pair_ptr = find_pair(port);
+    if (pair_ptr == NULL)
+    {
+      log_error("port '%s' not found.", port);
+      continue;
+    }
+
+    list_move_tail(&pair_ptr->siblings, &removed_pairs);
+  }
+
+  if (list_empty(&removed_pairs))
+  {
+    cdbus_method_return_new_void(call_ptr);
+    return;
+  }
+
+  if (!swap_table(&removed_pairs))
+  {
+    list_splice_init(&removed_pairs, g_pairs.prev);
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Allocation of pair table failed");
+    return;
+  }
+
+  cdbus_method_return_new_void(call_ptr);
+}
+
+static void jmcore_set_gain(struct cdbus_method_call * call_ptr)
+{
+  const char * port;
+  double gain;
+  float old_gain;
+  struct port_pair * pair_ptr;
+
+  dbus_error_init(&cdbus_g_dbus_error);
+  if (!dbus_message_get_args(call_ptr->message, &cdbus_g_dbus_error, DBUS_TYPE_STRING, &port, DBUS_TYPE_DOUBLE, &gain, DBUS_TYPE_INVALID))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": %s",  call_ptr->method_name, cdbus_g_dbus_error.message);
+    dbus_error_free(&cdbus_g_dbus_error);
+    return;
+  }
+
+  /* the realtime thread multiplies by whatever it gets */
+  if (!isfinite(gain) || gain < 0.0 || gain > FLT_MAX)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid gain %f, it must be finite and not negative.", gain);
+    return;
+  }
+
+  pair_ptr = find_pair(port);
+  if (pair_ptr == NULL)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "port '%s' not found.", port);
+    return;
+  }
+
+  if (pair_ptr->midi)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Gain cannot be applied to midi port '%s'.", port);
+    return;
+  }
+
+  if (pair_ptr->tied && gain != 1.0)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Gain cannot be applied to port '%s' in passthrough mode.", port);
+    return;
+  }
+
+  old_gain = pair_ptr->gain;
+  pair_ptr->gain = gain;
+
+  if (!swap_table(NULL))
+  {
+    pair_ptr->gain = old_gain;
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Allocation of pair table failed");
+    return;
+  }
+
+  cdbus_method_return_new_void(call_ptr);
+}
+
+/* Denormals are always flushed when gain is applied. At unity gain,
+ * samples are copied unchanged unless flushing is enabled. */
+static void jmcore_set_flush_denormals(struct cdbus_method_call * call_ptr)
+{
+  const char * port;
+  dbus_bool_t enable;
+  struct port_pair * pair_ptr;
+
+  dbus_error_init(&cdbus_g_dbus_error);
+  if (!dbus_message_get_args(call_ptr->message, &cdbus_g_dbus_error, DBUS_TYPE_STRING, &port, DBUS_TYPE_BOOLEAN, &enable, DBUS_TYPE_INVALID))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": %s",  call_ptr->method_name, cdbus_g_dbus_error.message);
+    dbus_error_free(&cdbus_g_dbus_error);
+    return;
+  }
+
+  pair_ptr = find_pair(port);
+  if (pair_ptr == NULL)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "port '%s' not found.", port);
+    return;
+  }
+
+  if (pair_ptr->midi)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Denormals cannot be flushed for midi port '%s'.", port);
+    return;
+  }
+
+  if (pair_ptr->tied && enable)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Denormals cannot be flushed for port '%s' in passthrough mode.", port);
+    return;
+  }
+
+  pair_ptr->flush_denormals = enable;
+
+  if (!swap_table(NULL))
+  {
+    pair_ptr->flush_denormals = !enable;
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Allocation of pair table failed");
+    return;
+  }
+
+  cdbus_method_return_new_void(call_ptr);
+}
+
+/* Passthrough ties the output port to the input port, JACK then gives
+ * the input buffer to readers of the output port and no copy is made.
+ * Not all JACK implementations support this, jackd2 does not. */
+static void jmcore_set_passthrough(struct cdbus_method_call * call_ptr)
+{
+  const char * port;
+  dbus_bool_t enable;
+  dbus_bool_t active;
+  struct port_pair * pair_ptr;
+
+  dbus_error_init(&cdbus_g_dbus_error);
+  if (!dbus_message_get_args(call_ptr->message, &cdbus_g_dbus_error, DBUS_TYPE_STRING, &port, DBUS_TYPE_BOOLEAN, &enable, DBUS_TYPE_INVALID))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": %s",  call_ptr->method_name, cdbus_g_dbus_error.message);
+    dbus_error_free(&cdbus_g_dbus_error);
+    return;
+  }
+
+  pair_ptr = find_pair(port);
+  if (pair_ptr == NULL)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "port '%s' not found.", port);
+    return;
+  }
+
+  if (enable && !pair_ptr->tied && !pair_ptr->midi && pair_ptr->gain == 1.0 && !pair_ptr->flush_denormals)
+  {
+    /* While the realtime thread still copies this pair, it copies the tied buffer onto itself */
+    if (jack_port_tie(pair_ptr->input_port, pair_ptr->output_port) == 0)
     {
-      destroy_pair(pair_ptr);
-      cdbus_method_return_new_void(call_ptr);
+      pair_ptr->tied = true;
+      if (!swap_table(NULL))
+      {
+        /* harmless, the pair stays in the table */
+        log_error("pair table swap failed for passthrough of '%s'", port);
+      }
+    }
+    else
+    {
+      log_info("JACK cannot tie port '%s', passthrough is not available", port);
+    }
+  }
+  else if (!enable && pair_ptr->tied)
+  {
+    /* put the pair back in the table before untying, so there is no cycle without a copy */
+    pair_ptr->tied = false;
+    if (!swap_table(NULL))
+    {
+      pair_ptr->tied = true;
+      cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Allocation of pair table failed");
       return;
     }
+
+    jack_port_untie(pair_ptr->output_port);
   }
 
-  cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "port '%s' not found.", port);
-  return;
+  active = pair_ptr->tied;
+  cdbus_method_return_new_single(call_ptr, DBUS_TYPE_BOOLEAN, &active);
 }
 
 static void jmcore_exit(struct cdbus_method_call * call_ptr)
@@ -409,6 +1010,30 @@ CDBUS_METHOD_ARGS_BEGIN(destroy, "Destroy port pair")
   CDBUS_METHOD_ARG_DESCRIBE_IN("port", "s", "Port name")
 CDBUS_METHOD_ARGS_END
 
+CDBUS_METHOD_ARGS_BEGIN(create_many, "Create multiple port pairs, either all of them or none")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("pairs", "a(bss)", "Port pairs (midi, input port name, output port name)")
+CDBUS_METHOD_ARGS_END
+
+CDBUS_METHOD_ARGS_BEGIN(destroy_many, "Destroy multiple port pairs, unknown ports are ignored")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("ports", "as", "Port names")
+CDBUS_METHOD_ARGS_END
+
+CDBUS_METHOD_ARGS_BEGIN(set_gain, "Set gain of audio port pair")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("port", "s", "Port name")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("gain", "d", "Linear gain, 1.0 for unity")
+CDBUS_METHOD_ARGS_END
+
+CDBUS_METHOD_ARGS_BEGIN(set_flush_denormals, "Enable or disable flushing of denormals of audio port pair at unity gain")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("port", "s", "Port name")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("enable", "b", "Whether to flush denormals")
+CDBUS_METHOD_ARGS_END
+
+CDBUS_METHOD_ARGS_BEGIN(set_passthrough, "Enable or disable zero-copy passthrough of audio port pair")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("port", "s", "Port name")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("enable", "b", "Whether to tie the output port to the input port")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("active", "b", "Whether passthrough is active")
+CDBUS_METHOD_ARGS_END
+
 CDBUS_METHOD_ARGS_BEGIN(exit, "Tell jmcore D-Bus service to exit")
 CDBUS_METHOD_ARGS_END
 
@@ -416,6 +1041,11 @@ CDBUS_METHODS_BEGIN
   CDBUS_METHOD_DESCRIBE(get_pid, jmcore_get_pid)
   CDBUS_METHOD_DESCRIBE(create, jmcore_create)
   CDBUS_METHOD_DESCRIBE(destroy, jmcore_destroy)
+  CDBUS_METHOD_DESCRIBE(create_many, jmcore_create_many)
+  CDBUS_METHOD_DESCRIBE(destroy_many, jmcore_destroy_many)
+  CDBUS_METHOD_DESCRIBE(set_gain, jmcore_set_gain)
+  CDBUS_METHOD_DESCRIBE(set_flush_denormals, jmcore_set_flush_denormals)
+  CDBUS_METHOD_DESCRIBE(set_passthrough, jmcore_set_passthrough)
   CDBUS_METHOD_DESCRIBE(exit, jmcore_exit)
 CDBUS_METHODS_END
 
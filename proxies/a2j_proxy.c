@@ -228,6 +228,74 @@ a2j_proxy_map_jack_port(
   return true;
 }
 
+struct a2j_proxy_map_jack_port_cookie
+{
+  void * context;
+  void (* callback)(void * context, const char * alsa_client_name, const char * alsa_port_name, uint32_t alsa_client_id);
+};
+
+#define cookie_ptr ((struct a2j_proxy_map_jack_port_cookie *)void_cookie)
+
+static void a2j_proxy_map_jack_port_handle_reply(void * UNUSED(context), void * void_cookie, DBusMessage * reply_ptr)
+{
+  dbus_uint32_t alsa_client_id;
+  dbus_uint32_t alsa_port_id;
+  const char * alsa_client_name;
+  const char * alsa_port_name;
+
+  if (!cdbus_call_async_get_reply_args(
+        reply_ptr,
+        "a2j::map_jack_port_to_alsa",
+        "uuss",
+        &alsa_client_id,
+        &alsa_port_id,
+        &alsa_client_name,
+        &alsa_port_name))
+  {
+    cookie_ptr->callback(cookie_ptr->context, NULL, NULL, 0);
+    return;
+  }
+
+  cookie_ptr->callback(cookie_ptr->context, alsa_client_name, alsa_port_name, alsa_client_id);
+}
+
+#undef cookie_ptr
+
+bool
+a2j_proxy_map_jack_port_async(
+  const char * jack_port_name,
+  void * context,
+  void (* callback)(
+    void * context,
+    const char * alsa_client_name,
+    const char * alsa_port_name,
+    uint32_t alsa_client_id),
+  cdbus_pending_call_handle * call_ptr)
+{
+  DBusMessage * request_ptr;
+  struct a2j_proxy_map_jack_port_cookie cookie;
+  bool ret;
+
+  request_ptr = cdbus_new_method_call_message(A2J_SERVICE, A2J_OBJECT, A2J_IFACE_CONTROL, "map_jack_port_to_alsa", "s", &jack_port_name, NULL);
+  if (request_ptr == NULL)
+  {
+    return false;
+  }
+
+  cookie.context = context;
+  cookie.callback = callback;
+
+  ret = cdbus_call_async_start(0, request_ptr, NULL, &cookie, sizeof(cookie), a2j_proxy_map_jack_port_handle_reply, call_ptr);
+  if (!ret)
+  {
+    log_error("a2j::map_jack_port_to_alsa() failed.");
+  }
+
+  dbus_message_unref(request_ptr);
+
+  return ret;
+}
+
 bool a2j_proxy_is_started(void)
 {
   dbus_bool_t started;
@@ -41,6 +41,19 @@ a2j_proxy_map_jack_port(
     char ** alsa_port_name_ptr_ptr,
     uint32_t * alsa_client_id_ptr);
 
+/* On failure, callback is called with NULL names.
+ * The name strings are valid only during the callback. */
+bool
+a2j_proxy_map_jack_port_async(
+  const char * jack_port_name,
+  void * context,
+  void (* callback)(
+    void * context,
+    const char * alsa_client_name,
+    const char * alsa_port_name,
+    uint32_t alsa_client_id),
+  cdbus_pending_call_handle * call_ptr);
+
 bool a2j_proxy_is_started(void);
 bool a2j_proxy_start_bridge(void);
 bool a2j_proxy_stop_bridge(void);
@@ -28,6 +28,9 @@
 #include "control_proxy.h"
 
 static bool g_clean_exit;
+static bool g_signal_hooks_registered;
+static void * g_jack_status_context;
+static void (* g_jack_status_callback)(void * context, uint32_t xruns, uint32_t buffer_size, uint32_t dsp_load);
 
 static void on_studio_appeared(void * UNUSED(context), DBusMessage * UNUSED(message_ptr))
 {
@@ -46,6 +49,31 @@ static void on_clean_exit(void * UNUSED(context), DBusMessage * UNUSED(message_p
   g_clean_exit = true;
 }
 
+static void on_jack_status_changed(void * UNUSED(context), DBusMessage * message_ptr)
+{
+  dbus_uint32_t xruns;
+  dbus_uint32_t buffer_size;
+  dbus_uint32_t dsp_load;
+
+  if (!dbus_message_get_args(
+        message_ptr,
+        &cdbus_g_dbus_error,
+        DBUS_TYPE_UINT32, &xruns,
+        DBUS_TYPE_UINT32, &buffer_size,
+        DBUS_TYPE_UINT32, &dsp_load,
+        DBUS_TYPE_INVALID))
+  {
+    log_error("Invalid parameters of JackStatusChanged signal: %s",  cdbus_g_dbus_error.message);
+    dbus_error_free(&cdbus_g_dbus_error);
+    return;
+  }
+
+  if (g_jack_status_callback != NULL)
+  {
+    g_jack_status_callback(g_jack_status_context, xruns, buffer_size, dsp_load);
+  }
+}
+
 /* this must be static because it is referenced by the
  * dbus helper layer when hooks are active */
 static struct cdbus_signal_hook g_signal_hooks[] =
@@ -53,6 +81,7 @@ static struct cdbus_signal_hook g_signal_hooks[] =
   {"StudioAppeared", on_studio_appeared},
   {"StudioDisappeared", on_studio_disappeared},
   {"CleanExit", on_clean_exit},
+  {"JackStatusChanged", on_jack_status_changed},
   {NULL, NULL}
 };
 
@@ -70,11 +99,31 @@ static bool control_proxy_is_studio_loaded(bool * present_ptr)
   return true;
 }
 
+/* when the control object is not tracked yet, subscription is sent later by control_proxy_init() */
+static bool control_proxy_send_jack_status_subscription(void)
+{
+  if (!g_signal_hooks_registered || g_jack_status_callback == NULL)
+  {
+    return true;
+  }
+
+  if (!cdbus_call(0, SERVICE_NAME, CONTROL_OBJECT_PATH, IFACE_CONTROL, "SubscribeJackStatus", "", ""))
+  {
+    log_error("SubscribeJackStatus() failed.");
+    return false;
+  }
+
+  return true;
+}
+
 void on_lifestatus_changed(bool appeared)
 {
   if (appeared)
   {
     control_proxy_on_daemon_appeared();
+
+    /* subscriptions don't survive daemon restarts */
+    control_proxy_send_jack_status_subscription();
   }
   else
   {
@@ -121,11 +170,15 @@ bool control_proxy_init(void)
     return false;
   }
 
+  g_signal_hooks_registered = true;
+  control_proxy_send_jack_status_subscription();
+
   return true;
 }
 
 void control_proxy_uninit(void)
 {
+  g_signal_hooks_registered = false;
   cdbus_unregister_object_signal_hooks(cdbus_g_dbus_connection, SERVICE_NAME, CONTROL_OBJECT_PATH, IFACE_CONTROL);
   cdbus_unregister_service_lifetime_hook(cdbus_g_dbus_connection, SERVICE_NAME);
 }
@@ -263,3 +316,31 @@ bool control_proxy_get_room_template_list(void (* callback)(void * context, cons
   dbus_message_unref(reply_ptr);
   return true;
 }
+
+bool
+control_proxy_subscribe_jack_status(
+  void * context,
+  void (* callback)(void * context, uint32_t xruns, uint32_t buffer_size, uint32_t dsp_load))
+{
+  g_jack_status_context = context;
+  g_jack_status_callback = callback;
+
+  return control_proxy_send_jack_status_subscription();
+}
+
+void control_proxy_unsubscribe_jack_status(void)
+{
+  if (g_jack_status_callback == NULL)
+  {
+    return;
+  }
+
+  g_jack_status_callback = NULL;
+  g_jack_status_context = NULL;
+
+  if (g_signal_hooks_registered &&
+      !cdbus_call(0, SERVICE_NAME, CONTROL_OBJECT_PATH, IFACE_CONTROL, "UnsubscribeJackStatus", "", ""))
+  {
+    log_error("UnsubscribeJackStatus() failed.");
+  }
+}
@@ -44,4 +44,11 @@ bool control_proxy_exit(void);
 void control_proxy_ping(void);
 bool control_proxy_get_room_template_list(void (* callback)(void * context, const char * template_name), void * context);
 
+/* callback is called with JACK status reported by the daemon, only on changes; dsp_load is in percents, rounded to a multiple of 5 */
+bool
+control_proxy_subscribe_jack_status(
+  void * context,
+  void (* callback)(void * context, uint32_t xruns, uint32_t buffer_size, uint32_t dsp_load));
+void control_proxy_unsubscribe_jack_status(void);
+
 #endif /* #ifndef CONTROL_PROXY_H__8BC89E98_FE1B_4831_8B89_1A48F676E019__INCLUDED */
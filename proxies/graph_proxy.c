@@ -47,9 +47,25 @@ struct graph
   char * service;
   char * object;
   uint64_t version;
+  bool batch;                             /* version was set by a signal, more signals of its batch may follow */
   bool active;
   bool graph_dict_supported;
   bool graph_manager_supported;
+  bool graph_changes_supported;
+  cdbus_pending_call_handle changes_call; /* GetGraphChanges() in progress, NULL if none */
+  struct list_head queued_signals;        /* signals received while changes_call is in progress */
+};
+
+struct queued_signal
+{
+  struct list_head siblings;
+  DBusMessage * message_ptr;
+};
+
+struct graph_changes_cookie
+{
+  struct graph * graph;
+  uint64_t version;             /* version known when the call was made */
 };
 
 static struct cdbus_signal_hook g_signal_hooks[];
@@ -218,6 +234,147 @@ ports_disconnected(
   }
 }
 
+/* returns false if changes since version are not available and the whole graph must be fetched */
+static bool apply_changes(struct graph * graph_ptr, dbus_uint64_t version, DBusMessage * reply_ptr)
+{
+  DBusMessageIter iter;
+  DBusMessageIter changes_array_iter;
+  DBusMessageIter change_struct_iter;
+  const char * reply_signature;
+  dbus_uint64_t current_version;
+  dbus_bool_t complete;
+  dbus_uint64_t change_version;
+  dbus_uint32_t change_type;
+  dbus_uint64_t client1_id;
+  dbus_uint64_t port1_id;
+  dbus_uint64_t client2_id;
+  dbus_uint64_t port2_id;
+  const char * name;
+  const char * old_name;
+  dbus_uint32_t port_flags;
+  dbus_uint32_t port_type;
+
+  if (reply_ptr == NULL)
+  {
+    log_error("GetGraphChanges() reply not received");
+    return false;
+  }
+
+  if (dbus_message_get_type(reply_ptr) == DBUS_MESSAGE_TYPE_ERROR)
+  {
+    log_error("GetGraphChanges() failed.");
+    graph_ptr->graph_changes_supported = false;
+    return false;
+  }
+
+  reply_signature = dbus_message_get_signature(reply_ptr);
+
+  if (strcmp(reply_signature, "tba(tuttttssuu)") != 0)
+  {
+    log_error("GetGraphChanges() reply signature mismatch. '%s'", reply_signature);
+    graph_ptr->graph_changes_supported = false;
+    return false;
+  }
+
+  dbus_message_iter_init(reply_ptr, &iter);
+
+  dbus_message_iter_get_basic(&iter, &current_version);
+  dbus_message_iter_next(&iter);
+
+  dbus_message_iter_get_basic(&iter, &complete);
+  dbus_message_iter_next(&iter);
+
+  if (!complete)
+  {
+    log_info("graph change journal does not reach version %llu, fetching whole graph", (unsigned long long)version);
+    return false;
+  }
+
+  for (dbus_message_iter_recurse(&iter, &changes_array_iter);
+       dbus_message_iter_get_arg_type(&changes_array_iter) != DBUS_TYPE_INVALID;
+       dbus_message_iter_next(&changes_array_iter))
+  {
+    dbus_message_iter_recurse(&changes_array_iter, &change_struct_iter);
+
+    dbus_message_iter_get_basic(&change_struct_iter, &change_version);
+    dbus_message_iter_next(&change_struct_iter);
+
+    dbus_message_iter_get_basic(&change_struct_iter, &change_type);
+    dbus_message_iter_next(&change_struct_iter);
+
+    dbus_message_iter_get_basic(&change_struct_iter, &client1_id);
+    dbus_message_iter_next(&change_struct_iter);
+
+    dbus_message_iter_get_basic(&change_struct_iter, &port1_id);
+    dbus_message_iter_next(&change_struct_iter);
+
+    dbus_message_iter_get_basic(&change_struct_iter, &client2_id);
+    dbus_message_iter_next(&change_struct_iter);
+
+    dbus_message_iter_get_basic(&change_struct_iter, &port2_id);
+    dbus_message_iter_next(&change_struct_iter);
+
+    dbus_message_iter_get_basic(&change_struct_iter, &name);
+    dbus_message_iter_next(&change_struct_iter);
+
+    dbus_message_iter_get_basic(&change_struct_iter, &old_name);
+    dbus_message_iter_next(&change_struct_iter);
+
+    dbus_message_iter_get_basic(&change_struct_iter, &port_flags);
+    dbus_message_iter_next(&change_struct_iter);
+
+    dbus_message_iter_get_basic(&change_struct_iter, &port_type);
+    dbus_message_iter_next(&change_struct_iter);
+
+    /* Changes made in one batch share version,
+       so compare with the version known before the call */
+    if (change_version <= version)
+    {
+      continue;
+    }
+
+    graph_ptr->version = change_version;
+
+    switch (change_type)
+    {
+    case GRAPH_CHANGE_CLIENT_APPEARED:
+      client_appeared(graph_ptr, client1_id, name);
+      break;
+    case GRAPH_CHANGE_CLIENT_DISAPPEARED:
+      client_disappeared(graph_ptr, client1_id);
+      break;
+    case GRAPH_CHANGE_CLIENT_RENAMED:
+      client_renamed(graph_ptr, client1_id, old_name, name);
+      break;
+    case GRAPH_CHANGE_PORT_APPEARED:
+      port_appeared(graph_ptr, client1_id, port1_id, name, port_flags, port_type);
+      break;
+    case GRAPH_CHANGE_PORT_DISAPPEARED:
+      port_disappeared(graph_ptr, client1_id, port1_id);
+      break;
+    case GRAPH_CHANGE_PORT_RENAMED:
+      port_renamed(graph_ptr, client1_id, port1_id, old_name, name);
+      break;
+    case GRAPH_CHANGE_PORTS_CONNECTED:
+      ports_connected(graph_ptr, client1_id, port1_id, client2_id, port2_id);
+      break;
+    case GRAPH_CHANGE_PORTS_DISCONNECTED:
+      ports_disconnected(graph_ptr, client1_id, port1_id, client2_id, port2_id);
+      break;
+    default:
+      log_error("Unknown graph change type %u", (unsigned int)change_type);
+    }
+  }
+
+  if (current_version > graph_ptr->version)
+  {
+    graph_ptr->version = current_version;
+  }
+
+  graph_ptr->batch = false;
+  return true;
+}
+
 static void refresh_internal(struct graph * graph_ptr, bool force)
 {
   DBusMessage* reply_ptr;
@@ -282,6 +439,7 @@ static void refresh_internal(struct graph * graph_ptr, bool force)
 
   //log_info("got new graph version %llu", (unsigned long long)version);
   graph_ptr->version = version;
+  graph_ptr->batch = false;
 
   //info_msg((std::string)"clients " + (char)dbus_message_iter_get_arg_type(&iter));
 
@@ -417,10 +575,15 @@ graph_proxy_create(
   INIT_LIST_HEAD(&graph_ptr->monitors);
 
   graph_ptr->version = 0;
+  graph_ptr->batch = false;
   graph_ptr->active = false;
 
   graph_ptr->graph_dict_supported = graph_dict_supported;
   graph_ptr->graph_manager_supported = graph_manager_supported;
+  /* only ladish graphs keep a change journal, jackdbus does not */
+  graph_ptr->graph_changes_supported = strcmp(service, SERVICE_NAME) == 0;
+  graph_ptr->changes_call = NULL;
+  INIT_LIST_HEAD(&graph_ptr->queued_signals);
 
   *graph_proxy_handle_ptr = (graph_proxy_handle)graph_ptr;
 
@@ -452,8 +615,23 @@ void
 graph_proxy_destroy(
   graph_proxy_handle graph)
 {
+  struct queued_signal * signal_ptr;
+
   ASSERT(list_empty(&graph_ptr->monitors));
 
+  if (graph_ptr->changes_call != NULL)
+  {
+    cdbus_call_async_cancel(graph_ptr->changes_call);
+  }
+
+  while (!list_empty(&graph_ptr->queued_signals))
+  {
+    signal_ptr = list_entry(graph_ptr->queued_signals.next, struct queued_signal, siblings);
+    list_del(&signal_ptr->siblings);
+    dbus_message_unref(signal_ptr->message_ptr);
+    free(signal_ptr);
+  }
+
   if (graph_ptr->active)
   {
     cdbus_unregister_object_signal_hooks(
@@ -583,6 +761,53 @@ graph_proxy_connect_ports(
   return true;
 }
 
+struct graph_proxy_connect_ports_cookie
+{
+  void * context;
+  void (* callback)(void * context, bool success);
+};
+
+#define cookie_ptr ((struct graph_proxy_connect_ports_cookie *)void_cookie)
+
+static void graph_proxy_connect_ports_handle_reply(void * UNUSED(context), void * void_cookie, DBusMessage * reply_ptr)
+{
+  cookie_ptr->callback(cookie_ptr->context, cdbus_call_async_get_reply_args(reply_ptr, "ConnectPortsByID", ""));
+}
+
+#undef cookie_ptr
+
+bool
+graph_proxy_connect_ports_async(
+  graph_proxy_handle graph,
+  uint64_t port1_id,
+  uint64_t port2_id,
+  void * context,
+  void (* callback)(void * context, bool success))
+{
+  DBusMessage * request_ptr;
+  struct graph_proxy_connect_ports_cookie cookie;
+  bool ret;
+
+  request_ptr = cdbus_new_method_call_message(graph_ptr->service, graph_ptr->object, JACKDBUS_IFACE_PATCHBAY, "ConnectPortsByID", "tt", &port1_id, &port2_id, NULL);
+  if (request_ptr == NULL)
+  {
+    return false;
+  }
+
+  cookie.context = context;
+  cookie.callback = callback;
+
+  ret = cdbus_call_async_start(0, request_ptr, NULL, &cookie, sizeof(cookie), graph_proxy_connect_ports_handle_reply, NULL);
+  if (!ret)
+  {
+    log_error("ConnectPortsByID() failed.");
+  }
+
+  dbus_message_unref(request_ptr);
+
+  return ret;
+}
+
 bool
 graph_proxy_disconnect_ports(
   graph_proxy_handle graph,
@@ -598,6 +823,176 @@ graph_proxy_disconnect_ports(
   return true;
 }
 
+/* returns whether the signal was queued because GetGraphChanges() is in progress */
+static bool queue_signal(void * graph, DBusMessage * message_ptr)
+{
+  struct queued_signal * signal_ptr;
+
+  if (graph_ptr->changes_call == NULL)
+  {
+    return false;
+  }
+
+  signal_ptr = malloc(sizeof(struct queued_signal));
+  if (signal_ptr == NULL)
+  {
+    /* the version gap will be noticed again on next signal */
+    log_error("malloc() failed to allocate struct queued_signal");
+    return true;
+  }
+
+  signal_ptr->message_ptr = dbus_message_ref(message_ptr);
+  list_add_tail(&signal_ptr->siblings, &graph_ptr->queued_signals);
+  return true;
+}
+
+static void replay_queued_signals(void * graph)
+{
+  struct list_head queue;
+  struct queued_signal * signal_ptr;
+  const struct cdbus_signal_hook * hook_ptr;
+
+  INIT_LIST_HEAD(&queue);
+  list_splice_init(&graph_ptr->queued_signals, &queue);
+
+  /* if a signal starts GetGraphChanges() again, the rest get queued again in order */
+  while (!list_empty(&queue))
+  {
+    signal_ptr = list_entry(queue.next, struct queued_signal, siblings);
+    list_del(&signal_ptr->siblings);
+
+    for (hook_ptr = g_signal_hooks; hook_ptr->signal_name != NULL; hook_ptr++)
+    {
+      if (dbus_message_has_member(signal_ptr->message_ptr, hook_ptr->signal_name))
+      {
+        hook_ptr->hook_function(graph, signal_ptr->message_ptr);
+        break;
+      }
+    }
+
+    dbus_message_unref(signal_ptr->message_ptr);
+    free(signal_ptr);
+  }
+}
+
+#define cookie_ptr ((struct graph_changes_cookie *)void_cookie)
+
+static void on_graph_changes_reply(void * UNUSED(context), void * void_cookie, DBusMessage * reply_ptr)
+{
+  void * graph = cookie_ptr->graph;
+
+  graph_ptr->changes_call = NULL;
+
+  if (!apply_changes(graph_ptr, cookie_ptr->version, reply_ptr))
+  {
+    refresh_internal(graph_ptr, false);
+  }
+
+  replay_queued_signals(graph);
+}
+
+#undef cookie_ptr
+
+/* Fetch changes since the known version without blocking, signals are queued until the reply is applied.
+   Falls back to fetching the whole graph synchronously if the journal is not available. */
+static void request_changes(void * graph)
+{
+  DBusMessage * request_ptr;
+  struct graph_changes_cookie cookie;
+  dbus_uint64_t version;
+
+  if (graph_ptr->graph_changes_supported)
+  {
+    version = graph_ptr->version;
+
+    request_ptr = cdbus_new_method_call_message(graph_ptr->service, graph_ptr->object, JACKDBUS_IFACE_PATCHBAY, "GetGraphChanges", "t", &version, NULL);
+    if (request_ptr != NULL)
+    {
+      cookie.graph = graph_ptr;
+      cookie.version = version;
+
+      if (cdbus_call_async_start(0, request_ptr, NULL, &cookie, sizeof(cookie), on_graph_changes_reply, &graph_ptr->changes_call))
+      {
+        dbus_message_unref(request_ptr);
+        return;
+      }
+
+      log_error("GetGraphChanges() failed.");
+      graph_ptr->changes_call = NULL;
+      dbus_message_unref(request_ptr);
+    }
+  }
+
+  refresh_internal(graph_ptr, false);
+}
+
+/* returns whether a signal with new_graph_version is to be applied */
+static bool update_version(void * graph, uint64_t new_graph_version, DBusMessage * message_ptr)
+{
+  if (queue_signal(graph, message_ptr))
+  {
+    return false;
+  }
+
+  /* changes made in one batch share version */
+  if (new_graph_version == graph_ptr->version && graph_ptr->batch)
+  {
+    return true;
+  }
+
+  if (new_graph_version <= graph_ptr->version)
+  {
+    return false;
+  }
+
+  if (graph_ptr->graph_changes_supported && new_graph_version != graph_ptr->version + 1)
+  {
+    /* Versions are consumed only by signalled changes, so signals were missed.
+       The journal has them and includes the change announced by this signal. */
+    request_changes(graph);
+    queue_signal(graph, message_ptr);
+    return false;
+  }
+
+  graph_ptr->version = new_graph_version;
+  graph_ptr->batch = graph_ptr->graph_changes_supported;
+  return true;
+}
+
+static void on_graph_changed(void * graph, DBusMessage * message_ptr)
+{
+  dbus_uint64_t new_graph_version;
+
+  if (!dbus_message_get_args(
+        message_ptr,
+        &cdbus_g_dbus_error,
+        DBUS_TYPE_UINT64, &new_graph_version,
+        DBUS_TYPE_INVALID))
+  {
+    log_error("dbus_message_get_args() failed to extract GraphChanged signal arguments (%s)", cdbus_g_dbus_error.message);
+    dbus_error_free(&cdbus_g_dbus_error);
+    return;
+  }
+
+  if (queue_signal(graph, message_ptr))
+  {
+    return;
+  }
+
+  /* ladish emits it after the signals of a batch */
+  if (new_graph_version == graph_ptr->version)
+  {
+    graph_ptr->batch = false;
+    return;
+  }
+
+  /* fetching whole graph on each GraphChanged signal from jackdbus would be too expensive */
+  if (graph_ptr->graph_changes_supported && new_graph_version > graph_ptr->version)
+  {
+    request_changes(graph);
+  }
+}
+
 static void on_client_appeared(void * graph, DBusMessage * message_ptr)
 {
   dbus_uint64_t new_graph_version;
@@ -619,10 +1014,8 @@ static void on_client_appeared(void * graph, DBusMessage * message_ptr)
 
   //log_info("ClientAppeared, %s(%llu), graph %llu", client_name, client_id, new_graph_version);
 
-  if (new_graph_version > graph_ptr->version)
+  if (update_version(graph, new_graph_version, message_ptr))
   {
-    //log_info("got new graph version %llu", (unsigned long long)new_graph_version);
-    graph_ptr->version = new_graph_version;
     client_appeared(graph_ptr, client_id, client_name);
   }
 }
@@ -648,10 +1041,8 @@ static void on_client_renamed(void * graph, DBusMessage * message_ptr)
     return;
   }
 
-  if (new_graph_version > graph_ptr->version)
+  if (update_version(graph, new_graph_version, message_ptr))
   {
-    //log_info("got new graph version %llu", (unsigned long long)new_graph_version);
-    graph_ptr->version = new_graph_version;
     client_renamed(graph_ptr, client_id, old_client_name, new_client_name);
   }
 }
@@ -677,10 +1068,8 @@ static void on_client_disappeared(void * graph, DBusMessage * message_ptr)
 
   //log_info("ClientDisappeared, %s(%llu)", client_name, client_id);
 
-  if (new_graph_version > graph_ptr->version)
+  if (update_version(graph, new_graph_version, message_ptr))
   {
-    //log_info("got new graph version %llu", (unsigned long long)new_graph_version);
-    graph_ptr->version = new_graph_version;
     client_disappeared(graph_ptr, client_id);
   }
 }
@@ -714,10 +1103,8 @@ static void on_port_appeared(void * graph, DBusMessage * message_ptr)
 
   //me->info_msg(str(boost::format("PortAppeared, %s(%llu):%s(%llu), %lu, %lu") % client_name % client_id % port_name % port_id % port_flags % port_type));
 
-  if (new_graph_version > graph_ptr->version)
+  if (update_version(graph, new_graph_version, message_ptr))
   {
-    //log_info("got new graph version %llu", (unsigned long long)new_graph_version);
-    graph_ptr->version = new_graph_version;
     port_appeared(graph_ptr, client_id, port_id, port_name, port_flags, port_type);
   }
 }
@@ -747,10 +1134,8 @@ static void on_port_renamed(void * graph, DBusMessage * message_ptr)
     return;
   }
 
-  if (new_graph_version > graph_ptr->version)
+  if (update_version(graph, new_graph_version, message_ptr))
   {
-    //log_info("got new graph version %llu", (unsigned long long)new_graph_version);
-    graph_ptr->version = new_graph_version;
     port_renamed(graph_ptr, client_id, port_id, old_port_name, new_port_name);
   }
 }
@@ -780,10 +1165,8 @@ static void on_port_disappeared(void * graph, DBusMessage * message_ptr)
 
   //me->info_msg(str(boost::format("PortDisappeared, %s(%llu):%s(%llu)") % client_name % client_id % port_name % port_id));
 
-  if (new_graph_version > graph_ptr->version)
+  if (update_version(graph, new_graph_version, message_ptr))
   {
-    //log_info("got new graph version %llu", (unsigned long long)new_graph_version);
-    graph_ptr->version = new_graph_version;
     port_disappeared(graph_ptr, client_id, port_id);
   }
 }
@@ -821,10 +1204,8 @@ static void on_ports_connected(void * graph, DBusMessage * message_ptr)
     return;
   }
 
-  if (new_graph_version > graph_ptr->version)
+  if (update_version(graph, new_graph_version, message_ptr))
   {
-    //log_info("got new graph version %llu", (unsigned long long)new_graph_version);
-    graph_ptr->version = new_graph_version;
     ports_connected(graph_ptr, client_id, port_id, client2_id, port2_id);
   }
 }
@@ -862,10 +1243,8 @@ static void on_ports_disconnected(void * graph, DBusMessage * message_ptr)
     return;
   }
 
-  if (new_graph_version > graph_ptr->version)
+  if (update_version(graph, new_graph_version, message_ptr))
   {
-    //log_info("got new graph version %llu", (unsigned long long)new_graph_version);
-    graph_ptr->version = new_graph_version;
     ports_disconnected(graph_ptr, client_id, port_id, client2_id, port2_id);
   }
 }
@@ -960,6 +1339,152 @@ graph_proxy_dict_entry_drop(
   return true;
 }
 
+bool
+graph_proxy_dict_get_many(
+  graph_proxy_handle graph,
+  const char * const * keys,
+  unsigned int keys_count,
+  void * context,
+  void (* callback)(void * context, const struct graph_proxy_dict_entry * entry_ptr))
+{
+  DBusMessage * request_ptr;
+  DBusMessage * reply_ptr;
+  DBusMessageIter iter;
+  DBusMessageIter array_iter;
+  DBusMessageIter struct_iter;
+  const char * reply_signature;
+  struct graph_proxy_dict_entry entry;
+
+  if (!graph_ptr->graph_dict_supported)
+  {
+    return false;
+  }
+
+  request_ptr = dbus_message_new_method_call(graph_ptr->service, graph_ptr->object, IFACE_GRAPH_DICT, "GetMany");
+  if (request_ptr == NULL)
+  {
+    log_error("dbus_message_new_method_call() failed.");
+    return false;
+  }
+
+  if (!dbus_message_append_args(request_ptr, DBUS_TYPE_ARRAY, DBUS_TYPE_STRING, &keys, (int)keys_count, DBUS_TYPE_INVALID))
+  {
+    log_error("Ran out of memory trying to construct " IFACE_GRAPH_DICT ".GetMany() request");
+    dbus_message_unref(request_ptr);
+    return false;
+  }
+
+  reply_ptr = cdbus_call_raw(0, request_ptr);
+  dbus_message_unref(request_ptr);
+  if (reply_ptr == NULL)
+  {
+    log_error(IFACE_GRAPH_DICT ".GetMany() failed: %s", cdbus_call_last_error_get_message());
+    return false;
+  }
+
+  reply_signature = dbus_message_get_signature(reply_ptr);
+
+  if (strcmp(reply_signature, "a(utss)") != 0)
+  {
+    log_error("GetMany() reply signature mismatch. '%s'", reply_signature);
+    dbus_message_unref(reply_ptr);
+    return false;
+  }
+
+  dbus_message_iter_init(reply_ptr, &iter);
+
+  for (dbus_message_iter_recurse(&iter, &array_iter);
+       dbus_message_iter_get_arg_type(&array_iter) != DBUS_TYPE_INVALID;
+       dbus_message_iter_next(&array_iter))
+  {
+    dbus_message_iter_recurse(&array_iter, &struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &entry.object_type);
+    dbus_message_iter_next(&struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &entry.object_id);
+    dbus_message_iter_next(&struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &entry.key);
+    dbus_message_iter_next(&struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &entry.value);
+
+    callback(context, &entry);
+  }
+
+  dbus_message_unref(reply_ptr);
+
+  return true;
+}
+
+bool
+graph_proxy_dict_set_many(
+  graph_proxy_handle graph,
+  const struct graph_proxy_dict_entry * entries,
+  unsigned int count)
+{
+  DBusMessage * request_ptr;
+  DBusMessage * reply_ptr;
+  DBusMessageIter iter;
+  DBusMessageIter array_iter;
+  DBusMessageIter struct_iter;
+  unsigned int i;
+
+  if (!graph_ptr->graph_dict_supported)
+  {
+    return false;
+  }
+
+  request_ptr = dbus_message_new_method_call(graph_ptr->service, graph_ptr->object, IFACE_GRAPH_DICT, "SetMany");
+  if (request_ptr == NULL)
+  {
+    log_error("dbus_message_new_method_call() failed.");
+    return false;
+  }
+
+  dbus_message_iter_init_append(request_ptr, &iter);
+
+  if (!dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "(utss)", &array_iter))
+  {
+    goto oom;
+  }
+
+  for (i = 0; i < count; i++)
+  {
+    if (!dbus_message_iter_open_container(&array_iter, DBUS_TYPE_STRUCT, NULL, &struct_iter) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_UINT32, &entries[i].object_type) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_UINT64, &entries[i].object_id) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, &entries[i].key) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, &entries[i].value) ||
+        !dbus_message_iter_close_container(&array_iter, &struct_iter))
+    {
+      goto oom;
+    }
+  }
+
+  if (!dbus_message_iter_close_container(&iter, &array_iter))
+  {
+    goto oom;
+  }
+
+  reply_ptr = cdbus_call_raw(0, request_ptr);
+  dbus_message_unref(request_ptr);
+  if (reply_ptr == NULL)
+  {
+    log_error(IFACE_GRAPH_DICT ".SetMany() failed: %s", cdbus_call_last_error_get_message());
+    return false;
+  }
+
+  dbus_message_unref(reply_ptr);
+  return true;
+
+oom:
+  log_error("Ran out of memory trying to construct " IFACE_GRAPH_DICT ".SetMany() request");
+  dbus_message_unref(request_ptr);
+  return false;
+}
+
 bool graph_proxy_get_client_pid(graph_proxy_handle graph, uint64_t client_id, pid_t * pid_ptr)
 {
   int64_t pid;
@@ -975,6 +1500,61 @@ bool graph_proxy_get_client_pid(graph_proxy_handle graph, uint64_t client_id, pi
   return true;
 }
 
+struct graph_proxy_get_client_pid_cookie
+{
+  void * context;
+  void (* callback)(void * context, bool success, pid_t pid);
+};
+
+#define cookie_ptr ((struct graph_proxy_get_client_pid_cookie *)void_cookie)
+
+static void graph_proxy_get_client_pid_handle_reply(void * UNUSED(context), void * void_cookie, DBusMessage * reply_ptr)
+{
+  int64_t pid;
+
+  if (!cdbus_call_async_get_reply_args(reply_ptr, "GetClientPID", "x", &pid))
+  {
+    cookie_ptr->callback(cookie_ptr->context, false, 0);
+    return;
+  }
+
+  cookie_ptr->callback(cookie_ptr->context, true, pid);
+}
+
+#undef cookie_ptr
+
+bool
+graph_proxy_get_client_pid_async(
+  graph_proxy_handle graph,
+  uint64_t client_id,
+  void * context,
+  void (* callback)(void * context, bool success, pid_t pid),
+  cdbus_pending_call_handle * call_ptr)
+{
+  DBusMessage * request_ptr;
+  struct graph_proxy_get_client_pid_cookie cookie;
+  bool ret;
+
+  request_ptr = cdbus_new_method_call_message(graph_ptr->service, graph_ptr->object, JACKDBUS_IFACE_PATCHBAY, "GetClientPID", "t", &client_id, NULL);
+  if (request_ptr == NULL)
+  {
+    return false;
+  }
+
+  cookie.context = context;
+  cookie.callback = callback;
+
+  ret = cdbus_call_async_start(0, request_ptr, NULL, &cookie, sizeof(cookie), graph_proxy_get_client_pid_handle_reply, call_ptr);
+  if (!ret)
+  {
+    log_error("GetClientPID() failed.");
+  }
+
+  dbus_message_unref(request_ptr);
+
+  return ret;
+}
+
 bool
 graph_proxy_split(
   graph_proxy_handle graph,
@@ -1117,6 +1697,7 @@ graph_proxy_remove_client(
  * dbus helper layer when hooks are active */
 static struct cdbus_signal_hook g_signal_hooks[] =
 {
+  {"GraphChanged", on_graph_changed},
   {"ClientAppeared", on_client_appeared},
   {"ClientRenamed", on_client_renamed},
   {"ClientDisappeared", on_client_disappeared},
@@ -82,6 +82,16 @@ graph_proxy_connect_ports(
   uint64_t port1_id,
   uint64_t port2_id);
 
+/* Send the connect request without waiting for the reply.
+ * callback is called once the reply is received, unless false is returned. */
+bool
+graph_proxy_connect_ports_async(
+  graph_proxy_handle graph,
+  uint64_t port1_id,
+  uint64_t port2_id,
+  void * context,
+  void (* callback)(void * context, bool success));
+
 bool
 graph_proxy_disconnect_ports(
   graph_proxy_handle graph,
@@ -111,8 +121,41 @@ graph_proxy_dict_entry_drop(
   uint64_t object_id,
   const char * key);
 
+struct graph_proxy_dict_entry
+{
+  uint32_t object_type;
+  uint64_t object_id;
+  const char * key;
+  const char * value;
+};
+
+/* Query keys for the graph and all its objects with single call.
+ * callback is called for each existing entry, before the function returns. */
+bool
+graph_proxy_dict_get_many(
+  graph_proxy_handle graph,
+  const char * const * keys,
+  unsigned int keys_count,
+  void * context,
+  void (* callback)(void * context, const struct graph_proxy_dict_entry * entry_ptr));
+
+bool
+graph_proxy_dict_set_many(
+  graph_proxy_handle graph,
+  const struct graph_proxy_dict_entry * entries,
+  unsigned int count);
+
 bool graph_proxy_get_client_pid(graph_proxy_handle graph, uint64_t client_id, pid_t * pid_ptr);
 
+/* callback is called with success set to false if the pid is unknown or the call failed */
+bool
+graph_proxy_get_client_pid_async(
+  graph_proxy_handle graph,
+  uint64_t client_id,
+  void * context,
+  void (* callback)(void * context, bool success, pid_t pid),
+  cdbus_pending_call_handle * call_ptr);
+
 bool
 graph_proxy_split(
   graph_proxy_handle graph,
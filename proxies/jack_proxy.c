@@ -661,11 +661,19 @@ static void jack_proxy_session_save_one_handle_reply(void * UNUSED(context), voi
     return;
   }
 
+  if (dbus_message_get_type(reply_ptr) == DBUS_MESSAGE_TYPE_ERROR)
+  {
+    log_error(JACKDBUS_IFACE_SESSMGR ".Notify() failed. %s", dbus_message_get_error_name(reply_ptr));
+    cookie_ptr->callback(cookie_ptr->context, NULL);
+    return;
+  }
+
   reply_signature = dbus_message_get_signature(reply_ptr);
 
   if (strcmp(reply_signature, "a(sssu)") != 0)
   {
     log_error(JACKDBUS_IFACE_SESSMGR ".Notify() reply signature mismatch. '%s'", reply_signature);
+    cookie_ptr->callback(cookie_ptr->context, NULL);
     return;
   }
 
@@ -680,6 +688,7 @@ static void jack_proxy_session_save_one_handle_reply(void * UNUSED(context), voi
     if (commandline != NULL)
     {
       log_error(JACKDBUS_IFACE_SESSMGR ".Notify() save returned more than one command");
+      cookie_ptr->callback(cookie_ptr->context, NULL);
       return;
     }
 
@@ -705,6 +714,7 @@ static void jack_proxy_session_save_one_handle_reply(void * UNUSED(context), voi
   if (commandline == NULL)
   {
     log_error(JACKDBUS_IFACE_SESSMGR ".Notify() save returned no commands");
+    cookie_ptr->callback(cookie_ptr->context, NULL);
     return;
   }
 
@@ -722,6 +732,21 @@ jack_proxy_session_save_one(
   void (* completion_callback)(
     void * context,
     const char * commandline))
+{
+  return jack_proxy_session_save_one_async(queue, target, path, CDBUS_CALL_NO_TIMEOUT, callback_context, completion_callback, NULL);
+}
+
+bool
+jack_proxy_session_save_one_async(
+  bool queue,
+  const char * target,
+  const char * path,
+  unsigned int timeout,
+  void * callback_context,
+  void (* completion_callback)(
+    void * context,
+    const char * commandline),
+  cdbus_pending_call_handle * call_ptr)
 {
   bool ret;
   dbus_bool_t dbus_bool;
@@ -751,7 +776,7 @@ jack_proxy_session_save_one(
   cookie.context = callback_context;
   cookie.callback = completion_callback;
 
-  ret = cdbus_call_async(request_ptr, callback_context, &cookie, sizeof(cookie), jack_proxy_session_save_one_handle_reply);
+  ret = cdbus_call_async_start(timeout, request_ptr, callback_context, &cookie, sizeof(cookie), jack_proxy_session_save_one_handle_reply, call_ptr);
 
   dbus_message_unref(request_ptr);
 
@@ -774,6 +799,56 @@ jack_proxy_session_has_callback(
   return true;
 }
 
+struct jack_proxy_session_has_callback_cookie
+{
+  void * context;
+  void (* callback)(void * context, bool success, bool has_callback);
+};
+
+#define cookie_ptr ((struct jack_proxy_session_has_callback_cookie *)void_cookie)
+
+static void jack_proxy_session_has_callback_handle_reply(void * UNUSED(context), void * void_cookie, DBusMessage * reply_ptr)
+{
+  dbus_bool_t has_callback;
+
+  if (!cdbus_call_async_get_reply_args(reply_ptr, "HasSessionCallback", "b", &has_callback))
+  {
+    cookie_ptr->callback(cookie_ptr->context, false, false);
+    return;
+  }
+
+  cookie_ptr->callback(cookie_ptr->context, true, has_callback);
+}
+
+#undef cookie_ptr
+
+bool
+jack_proxy_session_has_callback_async(
+  const char * client,
+  void * context,
+  void (* callback)(void * context, bool success, bool has_callback),
+  cdbus_pending_call_handle * call_ptr)
+{
+  DBusMessage * request_ptr;
+  struct jack_proxy_session_has_callback_cookie cookie;
+  bool ret;
+
+  request_ptr = cdbus_new_method_call_message(JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_SESSMGR, "HasSessionCallback", "s", &client, NULL);
+  if (request_ptr == NULL)
+  {
+    return false;
+  }
+
+  cookie.context = context;
+  cookie.callback = callback;
+
+  ret = cdbus_call_async_start(0, request_ptr, NULL, &cookie, sizeof(cookie), jack_proxy_session_has_callback_handle_reply, call_ptr);
+
+  dbus_message_unref(request_ptr);
+
+  return ret;
+}
+
 bool jack_proxy_exit(void)
 {
   if (!cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "Exit", "", ""))
@@ -145,11 +145,32 @@ jack_proxy_session_save_one(
     void * context,
     const char * commandline));
 
+/* The completion callback is called with NULL commandline on failure,
+ * including when the reply does not arrive within timeout milliseconds */
+bool
+jack_proxy_session_save_one_async(
+  bool queue,
+  const char * target,
+  const char * path,
+  unsigned int timeout,
+  void * callback_context,
+  void (* completion_callback)(
+    void * context,
+    const char * commandline),
+  cdbus_pending_call_handle * call_ptr);
+
 bool
 jack_proxy_session_has_callback(
   const char * client,
   bool * has_callback_ptr);
 
+bool
+jack_proxy_session_has_callback_async(
+  const char * client,
+  void * context,
+  void (* callback)(void * context, bool success, bool has_callback),
+  cdbus_pending_call_handle * call_ptr);
+
 bool jack_proxy_exit(void);
 
 #endif /* #ifndef JACK_PROXY_H__88702EEC_4B82_407F_A664_AD70C1E14D02__INCLUDED */
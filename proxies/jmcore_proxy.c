@@ -94,3 +94,125 @@ bool jmcore_proxy_destroy_link(const char * port_name)
 
   return true;
 }
+
+bool jmcore_proxy_create_links(const struct jmcore_proxy_link * links, unsigned int count)
+{
+  DBusMessage * request_ptr;
+  DBusMessage * reply_ptr;
+  DBusMessageIter top_iter;
+  DBusMessageIter array_iter;
+  DBusMessageIter struct_iter;
+  dbus_bool_t dbus_midi;
+  unsigned int i;
+
+  if (count == 0)
+  {
+    return true;
+  }
+
+  request_ptr = dbus_message_new_method_call(JMCORE_SERVICE_NAME, JMCORE_OBJECT_PATH, JMCORE_IFACE, "create_many");
+  if (request_ptr == NULL)
+  {
+    log_error("dbus_message_new_method_call() failed.");
+    return false;
+  }
+
+  dbus_message_iter_init_append(request_ptr, &top_iter);
+
+  if (!dbus_message_iter_open_container(&top_iter, DBUS_TYPE_ARRAY, "(bss)", &array_iter))
+  {
+    goto oom;
+  }
+
+  for (i = 0; i < count; i++)
+  {
+    dbus_midi = links[i].midi;
+
+    if (!dbus_message_iter_open_container(&array_iter, DBUS_TYPE_STRUCT, NULL, &struct_iter) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_BOOLEAN, &dbus_midi) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, &links[i].input_port_name) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, &links[i].output_port_name) ||
+        !dbus_message_iter_close_container(&array_iter, &struct_iter))
+    {
+      goto oom;
+    }
+  }
+
+  if (!dbus_message_iter_close_container(&top_iter, &array_iter))
+  {
+    goto oom;
+  }
+
+  reply_ptr = cdbus_call_raw(0, request_ptr);
+  dbus_message_unref(request_ptr);
+  if (reply_ptr == NULL)
+  {
+    log_error("jmcore::create_many() failed: %s", cdbus_call_last_error_get_message());
+    return false;
+  }
+
+  dbus_message_unref(reply_ptr);
+  return true;
+
+oom:
+  log_error("Ran out of memory trying to construct jmcore::create_many() request");
+  dbus_message_unref(request_ptr);
+  return false;
+}
+
+bool jmcore_proxy_destroy_links(const char * const * port_names, unsigned int count)
+{
+  DBusMessage * request_ptr;
+  DBusMessage * reply_ptr;
+  DBusMessageIter top_iter;
+  DBusMessageIter array_iter;
+  unsigned int i;
+
+  if (count == 0)
+  {
+    return true;
+  }
+
+  request_ptr = dbus_message_new_method_call(JMCORE_SERVICE_NAME, JMCORE_OBJECT_PATH, JMCORE_IFACE, "destroy_many");
+  if (request_ptr == NULL)
+  {
+    log_error("dbus_message_new_method_call() failed.");
+    return false;
+  }
+
+  dbus_message_iter_init_append(request_ptr, &top_iter);
+
+  if (!dbus_message_iter_open_container(&top_iter, DBUS_TYPE_ARRAY, "s", &array_iter))
+  {
+    goto oom;
+  }
+
+  for (i = 0; i < count; i++)
+  {
+    if (!dbus_message_iter_append_basic(&array_iter, DBUS_TYPE_STRING, port_names + i))
+    {
+      goto oom;
+    }
+  }
+
+  if (!dbus_message_iter_close_container(&top_iter, &array_iter))
+  {
+    goto oom;
+  }
+
+  reply_ptr = cdbus_call_raw(0, request_ptr);
+  dbus_message_unref(request_ptr);
+  if (reply_ptr == NULL)
+  {
+    log_error("jmcore::destroy_many() failed: %s", cdbus_call_last_error_get_message());
+    return false;
+  }
+
+  dbus_message_unref(reply_ptr);
+  return true;
+
+oom:
+  log_error("Ran out of memory trying to construct jmcore::destroy_many() request");
+  dbus_message_unref(request_ptr);
+  return false;
+}
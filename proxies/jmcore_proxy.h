@@ -29,6 +29,13 @@
 
 #include "common.h"
 
+struct jmcore_proxy_link
+{
+  bool midi;
+  const char * input_port_name;
+  const char * output_port_name;
+};
+
 bool jmcore_proxy_init(void);
 void jmcore_proxy_uninit(void);
 int64_t jmcore_proxy_get_pid_cached(void);
@@ -36,4 +43,10 @@ bool jmcore_proxy_get_pid_noncached(int64_t * pid_ptr);
 bool jmcore_proxy_create_link(bool midi, const char * input_port_name, const char * output_port_name);
 bool jmcore_proxy_destroy_link(const char * port_name);
 
+/* Create all links in one call, either all links are created or none */
+bool jmcore_proxy_create_links(const struct jmcore_proxy_link * links, unsigned int count);
+
+/* Destroy links in one call, unknown ports are ignored by jmcore */
+bool jmcore_proxy_destroy_links(const char * const * port_names, unsigned int count);
+
 #endif /* #ifndef JMCORE_PROXY_H__A39B2531_CD34_48B9_8561_323755ED551D__INCLUDED */